@@ -95,8 +95,8 @@ const char * const AdPlugXMMS::exts[] = {
 
 /***** Defines *****/
 
-// Sound buffer size in samples
-#define SNDBUFSIZE	512
+// Sound buffer length in ms
+#define SNDBUFTIME	50
 
 // 4 byte sample size (16 bit depth & stereo)
 #define SAMPLESIZE 4
@@ -180,6 +180,7 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
   int emulator = aud_get_int (CFG_ID, "Emulator");
   int freq = aud_get_int (CFG_ID, "Frequency");
   bool endless = aud_get_bool (CFG_ID, "Endless");
+  bool fastseek = aud_get_bool (CFG_ID, "FastSeek");
 
   // Set XMMS main window information
   dbg_printf ("xmms, ");
@@ -213,6 +214,9 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
       static_cast<CEmuopl *>(opl.get())->settype(Copl::TYPE_OPL2);
   }
 
+  // seeks only run the player, the emulator is brought up to date after
+  CSkipOpl skipopl (opl.get ());
+
   long toadd = 0, i, towrite;
   char *sndbuf, *sndbufpos;
   bool playing = true;  // Song self-end indicator.
@@ -220,7 +224,8 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
   // Try to load module
   dbg_printf ("factory, ");
   CFileVFSProvider fp (fd);
-  if (!(plr.p.capture(CAdPlug::factory (filename, opl.get (), CAdPlug::players, fp))))
+  Copl *playopl = fastseek ? (Copl *) &skipopl : opl.get ();
+  if (!(plr.p.capture(CAdPlug::factory (filename, playopl, CAdPlug::players, fp))))
   {
     dbg_printf ("error!\n");
     // MessageBox("AdPlug :: Error", "File could not be opened!", "Ok");
@@ -235,16 +240,18 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
     plr.subsong = 0;
   }
 
-  // Allocate audio buffer
+  // Allocate audio buffer, large enough that the emulator is mostly
+  // called for a whole player tick at a time
   dbg_printf ("buffer, ");
-  // 4 byte sample size
-  sndbuf = (char *) malloc (SNDBUFSIZE * 4);
+  long sndbufsize = std::max (freq * SNDBUFTIME / 1000, 512);
+  sndbuf = (char *) malloc (sndbufsize * SAMPLESIZE);
 
   // Rewind player to right subsong
   dbg_printf ("rewind, ");
   plr.p->rewind (plr.subsong);
 
-  int time = 0;
+  // in ms; kept as a double, rounding each tick makes long seeks drift
+  double time = 0;
 
   // main playback loop
   dbg_printf ("loop.\n");
@@ -258,6 +265,9 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
     // seek requested ?
     if (seek != -1)
     {
+      if (fastseek)
+        skipopl.set_skipping (true);
+
       // backward seek ?
       if (seek < time)
       {
@@ -267,11 +277,14 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
 
       // seek to requested position
       while (time < seek && plr.p->update ())
-        time += (int) (1000 / plr.p->getrefresh ());
+        time += 1000 / plr.p->getrefresh ();
+
+      if (fastseek)
+        skipopl.set_skipping (false);
     }
 
     // fill sound buffer
-    towrite = SNDBUFSIZE;
+    towrite = sndbufsize;
     sndbufpos = sndbuf;
     while (towrite > 0)
     {
@@ -280,7 +293,7 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
         toadd += freq;
         playing = plr.p->update ();
         if (playing)
-          time += (int) (1000 / plr.p->getrefresh ());
+          time += 1000 / plr.p->getrefresh ();
       }
       i = std::min (towrite, (long) (toadd / plr.p->getrefresh () + 4) & ~3);
       opl->update ((short *) sndbufpos, i);
@@ -289,7 +302,7 @@ bool AdPlugXMMS::play (const char * filename, VFSFile & fd)
       toadd -= (long) (plr.p->getrefresh () * i);
     }
 
-    write_audio (sndbuf, SNDBUFSIZE * SAMPLESIZE);
+    write_audio (sndbuf, sndbufsize * SAMPLESIZE);
   }
 
   // free everything and exit
@@ -328,6 +341,7 @@ const char * const AdPlugXMMS::defaults[] = {
  "Frequency", "44100",
  "Endless", "FALSE",
  "Emulator", "0",
+ "FastSeek", "TRUE",
  nullptr};
 
 /***** Configuration UI *****/
@@ -354,7 +368,9 @@ const PreferencesWidget AdPlugXMMS::widgets[] = {
     WidgetInt (CFG_ID, "Frequency"), {8000, 192000, 50, N_("Hz")}),
   WidgetLabel (N_("<b>Miscellaneous</b>")),
   WidgetCheck (N_("Repeat song in endless loop"),
-    WidgetBool (CFG_ID, "Endless"))
+    WidgetBool (CFG_ID, "Endless")),
+  WidgetCheck (N_("Skip OPL emulation while seeking"),
+    WidgetBool (CFG_ID, "FastSeek"))
 };
 
 const PluginPreferences AdPlugXMMS::prefs = {{widgets}};
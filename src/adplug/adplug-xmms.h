@@ -22,8 +22,11 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <libbinio/binio.h>
 #include <adplug/fprovide.h>
+#include <adplug/opl.h>
 
 #include <libaudcore/vfs.h>
 
@@ -103,4 +106,87 @@ private:
   VFSFile &m_file;
 };
 
+// Sits between the player and the OPL emulator and keeps a copy of every
+// register. While skipping, writes only go to the copy, so seeking costs no
+// more than running the player's sequencer; the emulator is then reset and
+// loaded with the registers as they are at the new position.
+class CSkipOpl : public Copl
+{
+public:
+  CSkipOpl(Copl *chip) :
+    m_chip(chip)
+  {
+    currType = chip->gettype();
+    memset(m_regs, 0, sizeof m_regs);
+  }
+
+  void write(int reg, int val)
+  {
+    m_regs[currChip][reg & 0xff] = val;
+    if (!m_skipping)
+      m_chip->write(reg, val);
+  }
+
+  void setchip(int n)
+  {
+    Copl::setchip(n);
+    if (!m_skipping)
+      m_chip->setchip(n);
+  }
+
+  void init()
+  {
+    memset(m_regs, 0, sizeof m_regs);
+    if (!m_skipping)
+      m_chip->init();
+  }
+
+  void update(short *buf, int samples)
+  {
+    m_chip->update(buf, samples);
+  }
+
+  void set_skipping(bool skipping)
+  {
+    if (skipping == m_skipping)
+      return;
+
+    m_skipping = skipping;
+    if (!skipping)
+      restore();
+  }
+
+private:
+  void restore()
+  {
+    m_chip->init();
+
+    // the emulator starts out with all registers zero; the OPL3 mode bits
+    // come first and the key-on registers last, so that notes are started
+    // with their final settings
+    for (int pass = 0; pass < 3; pass++)
+    {
+      for (int chip = 1; chip >= 0; chip--)
+      {
+        m_chip->setchip(chip);
+
+        for (int reg = 0; reg < 0x100; reg++)
+        {
+          bool mode = (reg == 0x05 || reg == 0x01);
+          bool key = ((reg >= 0xb0 && reg <= 0xb8) || reg == 0xbd);
+
+          if (m_regs[chip][reg] && pass == (mode ? 0 : key ? 2 : 1))
+            m_chip->write(reg, m_regs[chip][reg]);
+        }
+      }
+    }
+
+    m_chip->setchip(currChip);
+  }
+
+  Copl *m_chip;
+  bool m_skipping = false;
+  unsigned char m_regs[2][0x100];
+};
+
 #endif
@@ -18,7 +18,6 @@
 *
 */
 
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -66,11 +65,12 @@ protected:
 
     static bool audio_init ();
     static void audio_generate (double seconds);
+    static void audio_flush (bool discard);
     static void audio_cleanup ();
 
     static void generate_ticks (midifile_t & midifile, int num_ticks);
     static void play_loop (midifile_t & midifile);
-    static int skip_to (midifile_t & midifile, int seektime);
+    static int skip_to (midifile_t & midifile, int seektime, int & pos);
 };
 
 EXPORT AMIDIPlug aud_plugin_instance;
@@ -98,6 +98,8 @@ bool AMIDIPlug::init ()
         "fsyn_synth_polyphony", "-1",
         "fsyn_synth_reverb", "-1",
         "fsyn_synth_chorus", "-1",
+        "fsyn_synth_cpu_cores", "1",
+        "fsyn_dynamic_loading", "FALSE",
         "skip_leading", "FALSE",
         "skip_trailing", "FALSE",
         nullptr
@@ -105,6 +107,11 @@ bool AMIDIPlug::init ()
 
     aud_config_set_defaults ("amidiplug", defaults);
 
+    /* start loading the soundfonts now; the plugin is initialized when the
+       first MIDI file is probed, usually well before it is played */
+    backend_init ();
+    m_backend_initialized = true;
+
     return true;
 }
 
@@ -162,9 +169,14 @@ bool AMIDIPlug::read_tag (const char * filename, VFSFile & file, Tuple & tuple,
 }
 
 
+/* audio is written out in blocks of this many frames; events in between are
+   applied at the exact frame they fall on */
+#define BLOCK_FRAMES 1024
+
 static int s_samplerate, s_channels;
-static int s_bufsize;
-static int16_t * s_buf;
+static float * s_buf;
+static int s_buf_frames;    /* frames rendered into s_buf */
+static double s_due_frames; /* frames to render, fractions carried over */
 
 bool AMIDIPlug::audio_init ()
 {
@@ -172,32 +184,50 @@ bool AMIDIPlug::audio_init ()
 
     backend_audio_info (& s_channels, & bitdepth, & s_samplerate);
 
-    if (bitdepth != 16)
+    if (bitdepth != 32)
         return false;
 
-    open_audio (FMT_S16_NE, s_samplerate, s_channels);
+    open_audio (FMT_FLOAT, s_samplerate, s_channels);
 
-    s_bufsize = 2 * s_channels * (s_samplerate / 4);
-    s_buf = new int16_t[s_bufsize / 2];
+    s_buf = new float[BLOCK_FRAMES * s_channels];
+    s_buf_frames = 0;
+    s_due_frames = 0;
 
     return true;
 }
 
 void AMIDIPlug::audio_generate (double seconds)
 {
-    int total = 2 * s_channels * (int) round (seconds * s_samplerate);
+    s_due_frames += seconds * s_samplerate;
 
-    while (total)
+    while (s_due_frames >= 1)
     {
-        int chunk = (total < s_bufsize) ? total : s_bufsize;
+        int chunk = aud::min ((int) aud::min (s_due_frames, (double) BLOCK_FRAMES),
+         BLOCK_FRAMES - s_buf_frames);
+
+        backend_generate_audio (s_buf + s_buf_frames * s_channels,
+         chunk * s_channels * sizeof (float));
 
-        backend_generate_audio (s_buf, chunk);
-        write_audio (s_buf, chunk);
+        s_buf_frames += chunk;
+        s_due_frames -= chunk;
 
-        total -= chunk;
+        if (s_buf_frames == BLOCK_FRAMES)
+            audio_flush (false);
     }
 }
 
+/* write out (or drop, after a seek) the partly filled block */
+void AMIDIPlug::audio_flush (bool discard)
+{
+    if (! discard && s_buf_frames)
+        write_audio (s_buf, s_buf_frames * s_channels * sizeof (float));
+
+    s_buf_frames = 0;
+
+    if (discard)
+        s_due_frames = 0;
+}
+
 void AMIDIPlug::audio_cleanup ()
 {
     delete[] s_buf;
@@ -205,19 +235,13 @@ void AMIDIPlug::audio_cleanup ()
 
 bool AMIDIPlug::play (const char * filename, VFSFile & file)
 {
-    if (__sync_bool_compare_and_swap (& backend_settings_changed, true, false)
-     && m_backend_initialized)
+    if (__sync_bool_compare_and_swap (& backend_settings_changed, true, false))
     {
-        AUDDBG ("Settings changed, reinitializing backend\n");
-        backend_cleanup ();
-        m_backend_initialized = false;
+        AUDDBG ("Settings changed, updating backend\n");
+        backend_update ();
     }
 
-    if (! m_backend_initialized)
-    {
-        backend_init ();
-        m_backend_initialized = true;
-    }
+    backend_wait ();
 
     if (! audio_init ())
         return false;
@@ -248,40 +272,19 @@ void AMIDIPlug::generate_ticks (midifile_t & midifile, int num_ticks)
 void AMIDIPlug::play_loop (midifile_t & midifile)
 {
     int tick = midifile.start_tick;
+    int pos = 0; /* next event in midifile.events */
     bool stopped = false;
 
-    /* initialize current position in each track */
-    for (midifile_track_t & track : midifile.tracks)
-        track.current_event = track.events.head ();
-
     while (! (stopped = check_stop ()))
     {
         int seektime = check_seek ();
         if (seektime >= 0)
-            tick = skip_to (midifile, seektime);
-
-        midievent_t * event = nullptr;
-        midifile_track_t * event_track = nullptr;
-        int min_tick = midifile.max_tick + 1;
-
-        /* search next event */
-        for (midifile_track_t & track : midifile.tracks)
-        {
-            midievent_t * e2 = track.current_event;
-
-            if ((e2) && (e2->tick < min_tick))
-            {
-                min_tick = e2->tick;
-                event = e2;
-                event_track = & track;
-            }
-        }
+            tick = skip_to (midifile, seektime, pos);
 
-        if (!event)
+        if (pos >= midifile.events.len () || midifile.events[pos]->tick > midifile.max_tick)
             break; /* end of song reached */
 
-        /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        midievent_t * event = midifile.events[pos ++];
 
         if (event->tick > tick)
         {
@@ -345,62 +348,32 @@ void AMIDIPlug::play_loop (midifile_t & midifile)
     }
 
     if (! stopped)
+    {
         generate_ticks (midifile, midifile.max_tick - tick);
+        audio_flush (false);
+    }
 
     backend_reset ();
 }
 
 
-/* amidigplug_skipto: re-do all events that influence the playing of our
-   midi file; re-do them using a time-tick of 0, so they are processed
-   istantaneously and proceed this way until the playing_tick is reached */
-int AMIDIPlug::skip_to (midifile_t & midifile, int seektime)
+/* amidigplug_skipto: look up the tick for the requested time in the tempo
+   map and the first event to play in the event list; then re-do all events
+   before it that influence the playing of our midi file, using a time-tick
+   of 0, so they are processed istantaneously */
+int AMIDIPlug::skip_to (midifile_t & midifile, int seektime, int & pos)
 {
+    audio_flush (true);
     backend_reset ();
 
-    int tick = midifile.start_tick;
-    if (midifile.avg_microsec_per_tick > 0)
-        tick += (int64_t) seektime * 1000 / midifile.avg_microsec_per_tick;
+    int tick = midifile.microsec_to_tick ((int64_t) seektime * 1000);
+    int end = midifile.find_event (tick);
 
-    /* initialize current position in each track */
-    for (midifile_track_t & track : midifile.tracks)
-        track.current_event = track.events.head ();
+    AUDDBG ("SKIPTO request, seeking to tick %i (event %i)\n", tick, end);
 
-    for (;;)
+    for (pos = 0; pos < end; pos ++)
     {
-        midievent_t * event = nullptr;
-        midifile_track_t * event_track = nullptr;
-        int min_tick = midifile.max_tick + 1;
-
-        /* search next event */
-        for (midifile_track_t & track : midifile.tracks)
-        {
-            midievent_t * e2 = track.current_event;
-
-            if ((e2) && (e2->tick < min_tick))
-            {
-                min_tick = e2->tick;
-                event = e2;
-                event_track = & track;
-            }
-        }
-
-        /* unlikely here... unless very strange MIDI files are played :) */
-        if (!event)
-        {
-            AUDDBG ("SKIPTO request, reached the last event but not the requested tick (!)\n");
-            break; /* end of song reached */
-        }
-
-        /* reached the requested tick, job done */
-        if (event->tick >= tick)
-        {
-            AUDDBG ("SKIPTO request, reached the requested tick, exiting from skipto loop\n");
-            break;
-        }
-
-        /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+        midievent_t * event = midifile.events[pos];
 
         switch (event->type)
         {
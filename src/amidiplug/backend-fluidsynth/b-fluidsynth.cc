@@ -18,9 +18,12 @@
 *
 */
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <chrono>
+
 #include <fluidsynth.h>
 
 #include <libaudcore/audstrings.h>
@@ -32,12 +35,26 @@
 #include "../i_configure.h"
 #include "../i_midievent.h"
 
+typedef struct
+{
+    int samplerate;
+    int gain;
+    int polyphony;
+    int reverb;
+    int chorus;
+    int cpu_cores;
+    bool dynamic_loading;
+    String soundfont_file;
+}
+backend_settings_t;
+
 typedef struct
 {
     fluid_settings_t * settings;
     fluid_synth_t * synth;
 
     Index<int> soundfont_ids;
+    backend_settings_t current;     /* what the synth was set up with */
 }
 sequencer_client_t;
 
@@ -45,41 +62,114 @@ sequencer_client_t;
 static sequencer_client_t sc;
 /* options */
 
+/* the synth is set up and the soundfonts are loaded in the background, so
+   that a large soundfont is (mostly) loaded by the time playback starts */
+static pthread_mutex_t load_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t load_thread;
+static bool load_started = false;
+
 static void i_soundfont_load ();
 
-void backend_init ()
+static backend_settings_t get_settings ()
+{
+    backend_settings_t s;
+
+    s.samplerate = aud_get_int ("amidiplug", "fsyn_synth_samplerate");
+    s.gain = aud_get_int ("amidiplug", "fsyn_synth_gain");
+    s.polyphony = aud_get_int ("amidiplug", "fsyn_synth_polyphony");
+    s.reverb = aud_get_int ("amidiplug", "fsyn_synth_reverb");
+    s.chorus = aud_get_int ("amidiplug", "fsyn_synth_chorus");
+    s.cpu_cores = aud_get_int ("amidiplug", "fsyn_synth_cpu_cores");
+    s.dynamic_loading = aud_get_bool ("amidiplug", "fsyn_dynamic_loading");
+    s.soundfont_file = aud_get_str ("amidiplug", "fsyn_soundfont_file");
+
+    return s;
+}
+
+/* gain and polyphony can be changed on a running synth; going back to
+   the defaults, or changing anything else, takes a new one */
+static bool needs_reload (const backend_settings_t & a, const backend_settings_t & b)
+{
+    return a.samplerate != b.samplerate || a.reverb != b.reverb ||
+     a.chorus != b.chorus || a.cpu_cores != b.cpu_cores ||
+     a.dynamic_loading != b.dynamic_loading ||
+     strcmp (a.soundfont_file, b.soundfont_file) ||
+     (b.gain == -1 && a.gain != -1) || (b.polyphony == -1 && a.polyphony != -1);
+}
+
+static void apply_realtime_settings (const backend_settings_t & s)
+{
+    if (s.gain != -1)
+        fluid_settings_setnum (sc.settings, "synth.gain", s.gain / 10.0);
+
+    if (s.polyphony != -1)
+        fluid_settings_setint (sc.settings, "synth.polyphony", s.polyphony);
+}
+
+static void * load_worker (void *)
 {
+    auto start = std::chrono::steady_clock::now ();
+    const backend_settings_t & s = sc.current;
+
     sc.settings = new_fluid_settings();
 
-    fluid_settings_setnum (sc.settings, "synth.sample-rate",
-     aud_get_int ("amidiplug", "fsyn_synth_samplerate"));
+    fluid_settings_setnum (sc.settings, "synth.sample-rate", s.samplerate);
 
-    int gain = aud_get_int ("amidiplug", "fsyn_synth_gain");
-    int polyphony = aud_get_int ("amidiplug", "fsyn_synth_polyphony");
-    int reverb = aud_get_int ("amidiplug", "fsyn_synth_reverb");
-    int chorus = aud_get_int ("amidiplug", "fsyn_synth_chorus");
+    apply_realtime_settings (s);
 
-    if (gain != -1)
-        fluid_settings_setnum (sc.settings, "synth.gain", gain / 10.0);
+    if (s.reverb != -1)
+        fluid_settings_setint (sc.settings, "synth.reverb.active", s.reverb);
 
-    if (polyphony != -1)
-        fluid_settings_setint (sc.settings, "synth.polyphony", polyphony);
+    if (s.chorus != -1)
+        fluid_settings_setint (sc.settings, "synth.chorus.active", s.chorus);
 
-    if (reverb != -1)
-        fluid_settings_setint (sc.settings, "synth.reverb.active", reverb);
+    /* voices are rendered by this many threads */
+    if (s.cpu_cores > 1)
+        fluid_settings_setint (sc.settings, "synth.cpu-cores", s.cpu_cores);
 
-    if (chorus != -1)
-        fluid_settings_setint (sc.settings, "synth.chorus.active", chorus);
+    /* only load the samples of the presets in use (FluidSynth 2.0 and up) */
+    if (s.dynamic_loading)
+        fluid_settings_setint (sc.settings, "synth.dynamic-sample-loading", 1);
 
     sc.synth = new_fluid_synth (sc.settings);
 
     /* load soundfonts */
     i_soundfont_load();
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>
+     (std::chrono::steady_clock::now () - start).count ();
+    AUDINFO ("FluidSynth set up with %d soundfont(s) in %d ms\n",
+     sc.soundfont_ids.len (), (int) ms);
+
+    return nullptr;
 }
 
+/* load_mutex must be locked */
+static void start_loading ()
+{
+    sc.current = get_settings ();
 
-void backend_cleanup ()
+    if (pthread_create (& load_thread, nullptr, load_worker, nullptr))
+        load_worker (nullptr);
+    else
+        load_started = true;
+}
+
+/* load_mutex must be locked */
+static void finish_loading ()
+{
+    if (load_started)
+    {
+        pthread_join (load_thread, nullptr);
+        load_started = false;
+    }
+}
+
+/* load_mutex must be locked */
+static void unload ()
 {
+    finish_loading ();
+
     /* unload soundfonts */
     for (int id : sc.soundfont_ids)
         fluid_synth_sfunload (sc.synth, id, 0);
@@ -90,6 +180,58 @@ void backend_cleanup ()
 }
 
 
+void backend_init ()
+{
+    pthread_mutex_lock (& load_mutex);
+    start_loading ();
+    pthread_mutex_unlock (& load_mutex);
+}
+
+
+void backend_cleanup ()
+{
+    pthread_mutex_lock (& load_mutex);
+    unload ();
+    pthread_mutex_unlock (& load_mutex);
+}
+
+
+void backend_update ()
+{
+    pthread_mutex_lock (& load_mutex);
+
+    finish_loading ();
+
+    backend_settings_t settings = get_settings ();
+
+    if (needs_reload (sc.current, settings))
+    {
+        AUDDBG ("Synthesizer settings changed, reloading\n");
+        unload ();
+        start_loading ();
+    }
+    else
+    {
+        apply_realtime_settings (settings);
+        sc.current = settings;
+    }
+
+    pthread_mutex_unlock (& load_mutex);
+}
+
+
+void backend_wait ()
+{
+    pthread_mutex_lock (& load_mutex);
+
+    if (load_started)
+        AUDDBG ("Waiting for the soundfonts to be loaded\n");
+
+    finish_loading ();
+    pthread_mutex_unlock (& load_mutex);
+}
+
+
 void backend_reset ()
 {
     fluid_synth_system_reset (sc.synth);  /* all notes off and channels reset */
@@ -184,14 +326,14 @@ void seq_event_allnoteoff (int unused)
 
 void backend_generate_audio (void * buf, int bufsize)
 {
-    fluid_synth_write_s16 (sc.synth, bufsize / 4, buf, 0, 2, buf, 1, 2);
+    fluid_synth_write_float (sc.synth, bufsize / (2 * sizeof (float)), buf, 0, 2, buf, 1, 2);
 }
 
 
 void backend_audio_info (int * channels, int * bitdepth, int * samplerate)
 {
     *channels = 2;
-    *bitdepth = 16; /* always 16 bit, we use fluid_synth_write_s16() */
+    *bitdepth = 32; /* always 32 bit float, we use fluid_synth_write_float() */
     *samplerate = aud_get_int ("amidiplug", "fsyn_synth_samplerate");
 }
 
@@ -202,7 +344,7 @@ void backend_audio_info (int * channels, int * bitdepth, int * samplerate)
 
 static void i_soundfont_load ()
 {
-    String soundfont_file = aud_get_str ("amidiplug", "fsyn_soundfont_file");
+    const String & soundfont_file = sc.current.soundfont_file;
 
     if (soundfont_file[0])
     {
@@ -23,8 +23,10 @@
 
 struct midievent_t;
 
-void backend_init ();
+void backend_init ();      /* returns at once, loading goes on in the background */
 void backend_cleanup ();
+void backend_update ();    /* applies changed settings */
+void backend_wait ();      /* waits until the synth is ready to play */
 void backend_reset ();
 
 void backend_audio_info (int *, int *, int *);
@@ -152,7 +152,12 @@ static const PreferencesWidget amidiplug_widgets[] = {
     WidgetBox ({{chorus_widgets}, true}),
     WidgetSpin (N_("Sample rate:"),
         WidgetInt ("amidiplug", "fsyn_synth_samplerate", backend_change),
-        {22050, 96000, 1, N_("Hz")})
+        {22050, 96000, 1, N_("Hz")}),
+    WidgetSpin (N_("Rendering threads:"),
+        WidgetInt ("amidiplug", "fsyn_synth_cpu_cores", backend_change),
+        {1, 256, 1}),
+    WidgetCheck (N_("Load samples only when used (saves memory)"),
+        WidgetBool ("amidiplug", "fsyn_dynamic_loading", backend_change))
 };
 
 const PluginPreferences amidiplug_prefs = {
@@ -23,6 +23,8 @@
 
 #include "i_midi.h"
 
+#include <algorithm>
+
 #include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
 #include <libaudcore/vfs.h>
@@ -582,52 +584,38 @@ bool midifile_t::setget_tempo ()
 }
 
 
-/* this will set the midi length in microseconds
-   COMMENT: this will also reset current position in each track! */
-void midifile_t::setget_length ()
+/* merge the events of all tracks into one list sorted by tick; on the same
+   tick, events of earlier tracks come first */
+void midifile_t::merge_tracks ()
 {
-    int64_t length_microsec = 0;
-    int last_tick = start_tick;
-    /* get the first microsec_per_tick ratio */
-    int microsec_per_tick = (int) (current_tempo / ppq);
+    events.clear ();
 
-    /* initialize current position in each track */
     for (midifile_track_t & track : tracks)
-        track.current_event = track.events.head ();
-
-    /* search for tempo events in each track; in fact, since the program
-       currently supports type 0 and type 1 MIDI files, we should find
-       tempo events only in one track */
-    AUDDBG ("LENGTH calc: starting calc loop\n");
-
-    for (;;)
     {
-        midievent_t * event = nullptr;
-        midifile_track_t * event_track = nullptr;
-        int min_tick = max_tick + 1;
+        for (midievent_t * event = track.events.head (); event; event = track.events.next (event))
+            events.append (event);
+    }
 
-        /* search next event */
-        for (midifile_track_t & track : tracks)
-        {
-            midievent_t * e2 = track.current_event;
+    std::stable_sort (events.begin (), events.end (),
+     [] (const midievent_t * a, const midievent_t * b)
+        { return a->tick < b->tick; });
+}
 
-            if (e2 && e2->tick < min_tick)
-            {
-                min_tick = e2->tick;
-                event = e2;
-                event_track = & track;
-            }
-        }
 
-        if (!event)
-        {
-            /* calculate the remaining length */
-            length_microsec += (microsec_per_tick * (max_tick - last_tick));
-            break; /* end of song reached */
-        }
+/* build the tempo map and get the length of the file */
+void midifile_t::setget_length ()
+{
+    midifile_tempo_t & first = tempo_map.append ();
+    first.tick = start_tick;
+    first.tempo = current_tempo;
+    first.microsec = 0;
 
-        /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
+    AUDDBG ("LENGTH calc: starting calc loop\n");
+
+    for (midievent_t * event : events)
+    {
+        if (event->tick > max_tick)
+            break;
 
         /* check if this is a tempo event */
         if (event->type == SND_SEQ_EVENT_TEMPO)
@@ -635,98 +623,78 @@ void midifile_t::setget_length ()
             int tick = aud::max (event->tick, start_tick);
             AUDDBG ("LENGTH calc: tempo event (%i) on tick %i\n", event->tempo, tick);
 
-            /* increment length_microsec with the amount of microsec before tempo change */
-            length_microsec += (microsec_per_tick * (tick - last_tick));
-            /* now update last_tick and the microsec_per_tick ratio */
-            last_tick = tick;
-            microsec_per_tick = (int) (event->tempo / ppq);
+            if (tick > tempo_map[tempo_map.len () - 1].tick)
+            {
+                int64_t microsec = tick_to_microsec (tick);
+                midifile_tempo_t & change = tempo_map.append ();
+                change.tick = tick;
+                change.microsec = microsec;
+            }
+
+            tempo_map[tempo_map.len () - 1].tempo = event->tempo;
         }
     }
 
-    /* IMPORTANT
-       this couple of important values is set by midifile_t::set_length */
-    length = length_microsec;
-
-    if (max_tick > start_tick)
-        avg_microsec_per_tick = (int) (length_microsec / (max_tick - start_tick));
-    else
-        avg_microsec_per_tick = 0;
-
-    return;
+    length = tick_to_microsec (max_tick);
 }
 
 
-/* this will get the weighted average bpm of the midi file;
-   if the file has a variable bpm, 'bpm' is set to -1;
-   COMMENT: this will also reset current position in each track! */
-void midifile_t::get_bpm (int * bpm, int * wavg_bpm)
+/* time of a tick from start_tick on, following the tempo changes */
+int64_t midifile_t::tick_to_microsec (int tick)
 {
-    int last_tick = start_tick;
-    unsigned weighted_avg_tempo = 0;
-    bool is_monotempo = true;
-    int last_tempo = current_tempo;
-
-    /* initialize current position in each track */
-    for (midifile_track_t & track : tracks)
-        track.current_event = track.events.head ();
-
-    /* search for tempo events in each track; in fact, since the program
-       currently supports type 0 and type 1 MIDI files, we should find
-       tempo events only in one track */
-    AUDDBG ("BPM calc: starting calc loop\n");
+    auto change = std::upper_bound (tempo_map.begin () + 1, tempo_map.end (), tick,
+     [] (int tick, const midifile_tempo_t & change)
+        { return tick < change.tick; }) - 1;
 
-    for (;;)
-    {
-        midievent_t * event = nullptr;
-        midifile_track_t * event_track = nullptr;
-        int min_tick = max_tick + 1;
+    tick = aud::max (tick, change->tick);
+    return change->microsec + (int64_t) (tick - change->tick) * change->tempo / ppq;
+}
 
-        /* search next event */
-        for (midifile_track_t & track : tracks)
-        {
-            midievent_t * e2 = track.current_event;
 
-            if (e2 && e2->tick < min_tick)
-            {
-                min_tick = e2->tick;
-                event = e2;
-                event_track = & track;
-            }
-        }
+/* tick played at a time from start_tick on */
+int midifile_t::microsec_to_tick (int64_t microsec)
+{
+    auto change = std::upper_bound (tempo_map.begin () + 1, tempo_map.end (), microsec,
+     [] (int64_t microsec, const midifile_tempo_t & change)
+        { return microsec < change.microsec; }) - 1;
 
-        if (!event)
-        {
-            /* calculate the remaining length */
-            if (max_tick > start_tick)
-                weighted_avg_tempo += (unsigned) (last_tempo *
-                 ((float) (max_tick - last_tick) / (float) (max_tick - start_tick)));
+    if (microsec <= change->microsec || change->tempo <= 0)
+        return change->tick;
 
-            break; /* end of song reached */
-        }
+    return change->tick + (int) ((microsec - change->microsec) * ppq / change->tempo);
+}
 
-        /* advance pointer to next event */
-        event_track->current_event = event_track->events.next (event);
 
-        /* check if this is a tempo event */
-        if (event->type == SND_SEQ_EVENT_TEMPO)
-        {
-            int tick = aud::max (event->tick, start_tick);
-            AUDDBG ("BPM calc: tempo event (%i) on tick %i\n", event->tempo, tick);
+/* index of the first event at or after a tick */
+int midifile_t::find_event (int tick)
+{
+    return std::lower_bound (events.begin (), events.end (), tick,
+     [] (const midievent_t * event, int tick)
+        { return event->tick < tick; }) - events.begin ();
+}
 
-            /* check if this is a tempo change (real change, tempo should be
-               different) in the midi file (and it shouldn't be at tick 0); */
-            if (is_monotempo && tick > start_tick && event->tempo != last_tempo)
-                is_monotempo = false;
 
-            /* add the previous tempo change multiplied for its weight (the tick interval for the tempo )  */
-            if (max_tick > start_tick)
-                weighted_avg_tempo += (unsigned) (last_tempo *
-                 ((float) (tick - last_tick) / (float) (max_tick - start_tick)));
+/* this will get the weighted average bpm of the midi file;
+   if the file has a variable bpm, 'bpm' is set to -1 */
+void midifile_t::get_bpm (int * bpm, int * wavg_bpm)
+{
+    unsigned weighted_avg_tempo = 0;
+    bool is_monotempo = true;
 
-            /* now update last_tick and the microsec_per_tick ratio */
-            last_tick = tick;
-            last_tempo = event->tempo;
-        }
+    for (int i = 0; i < tempo_map.len (); i ++)
+    {
+        const midifile_tempo_t & change = tempo_map[i];
+        int next_tick = (i + 1 < tempo_map.len ()) ? tempo_map[i + 1].tick : max_tick;
+
+        /* check if this is a tempo change (real change, tempo should be
+           different) in the midi file (and it shouldn't be at tick 0); */
+        if (i > 0 && change.tempo != tempo_map[i - 1].tempo)
+            is_monotempo = false;
+
+        /* add the tempo multiplied for its weight (the tick interval for the tempo) */
+        if (max_tick > start_tick)
+            weighted_avg_tempo += (unsigned) (change.tempo *
+             ((float) (next_tick - change.tick) / (float) (max_tick - start_tick)));
     }
 
     AUDDBG ("BPM calc: weighted average tempo: %i\n", weighted_avg_tempo);
@@ -778,7 +746,8 @@ bool midifile_t::parse_from_file (const char * filename, VFSFile & file)
         if (!setget_tempo ())
             WARNANDBREAK ("%s: invalid values while setting ppq and tempo\n", filename);
 
-        /* fill length, keeping in count tempo-changes */
+        /* index the events and fill length, keeping in count tempo-changes */
+        merge_tracks ();
         setget_length ();
 
         /* ok, mf has been filled with information; successfully return */
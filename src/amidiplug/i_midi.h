@@ -232,7 +232,6 @@ struct midifile_track_t
     List<midievent_t> events;           /* list of all events in this track */
     int start_tick;                     /* start of this track */
     int end_tick;			/* length of this track */
-    midievent_t * current_event;	/* used while loading and playing */
 
     midievent_t * add_event ()
     {
@@ -246,9 +245,19 @@ struct midifile_track_t
 };
 
 
+struct midifile_tempo_t
+{
+    int tick;                           /* first tick played at this tempo */
+    int tempo;                          /* microseconds per quarter note */
+    int64_t microsec;                   /* time of that tick from start_tick */
+};
+
+
 struct midifile_t
 {
     Index<midifile_track_t> tracks;
+    Index<midievent_t *> events;        /* events of all tracks, by tick */
+    Index<midifile_tempo_t> tempo_map;  /* tempo changes from start_tick on */
 
     unsigned short format = 0;
     int start_tick = 0;
@@ -259,10 +268,12 @@ struct midifile_t
     int ppq = 0;
     int current_tempo = 0;
 
-    int avg_microsec_per_tick = 0;
     int64_t length = 0;
 
     void get_bpm (int *, int *);
+    int64_t tick_to_microsec (int tick);
+    int microsec_to_tick (int64_t microsec);
+    int find_event (int tick);
     bool parse_from_file (const char *, VFSFile & file);
 
 private:
@@ -281,6 +292,7 @@ private:
     bool parse_smf (int);
     bool parse_riff ();
     bool setget_tempo ();
+    void merge_tracks ();
     void setget_length ();
 };
 
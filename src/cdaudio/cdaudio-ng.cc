@@ -19,10 +19,12 @@
  */
 
 #include <errno.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /* prevent libcdio from redefining PACKAGE, VERSION, etc. */
 #define EXTERNAL_LIBCDIO_CONFIG_H
@@ -40,6 +42,14 @@
 #include <cdio/cdda.h>
 #endif
 
+#ifdef HAVE_LIBCDIO_PARANOIA
+#if LIBCDIO_VERSION_NUM >= 90
+#include <cdio/paranoia/paranoia.h>
+#else
+#include <cdio/paranoia.h>
+#endif
+#endif
+
 #ifdef HAVE_LIBCDDB
 #include <cddb/cddb.h>
 #endif
@@ -60,6 +70,10 @@
 #define MAX_RETRIES 10
 #define MAX_SKIPS 10
 
+#define SECTOR_SIZE CDIO_CD_FRAMESIZE_RAW
+#define READ_AHEAD_SECONDS 4
+#define PREFETCH_SECONDS 2
+
 static const char * const cdaudio_schemes[] = {"cdda", nullptr};
 
 class CDAudio : public InputPlugin
@@ -111,6 +125,33 @@ static cdrom_drive_t *pcdrom_drive = nullptr;
 static Index<trackinfo_t> trackinfo;
 static QueuedFunc purge_func;
 
+/* Sectors are read ahead of playback by a separate thread into a ring buffer.
+ * The buffer holds a contiguous run of sectors starting at first_lsn.  The
+ * reader appends at the tail and the play thread consumes from the head;
+ * only the reader thread moves the buffer to a new position (on a seek
+ * request).  Data read past the end of a track is kept so that the next track
+ * can start without waiting for the drive.  Lock ra_mutex to access. */
+struct ReadAhead
+{
+    pthread_t thread;
+    bool stop = false;
+    bool failed = false;
+    bool paranoia = false;
+
+    Index<unsigned char> ring;
+    int capacity = 0;   /* in sectors */
+    int head = 0;       /* ring index of first buffered sector */
+    int fill = 0;       /* number of buffered sectors */
+    int first_lsn = 0;  /* LSN of first buffered sector */
+    int limit_lsn = 0;  /* last LSN to be read */
+    int seek_lsn = -1;  /* pending seek request */
+    int max_batch = 1;  /* largest single read, in sectors */
+};
+
+static pthread_mutex_t ra_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ra_cond = PTHREAD_COND_INITIALIZER;
+static ReadAhead ra;
+
 static bool scan_cd ();
 static bool refresh_trackinfo (bool warning);
 static void reset_trackinfo ();
@@ -126,12 +167,16 @@ const char CDAudio::about[] =
 
 const char * const CDAudio::defaults[] = {
  "disc_speed", "2",
+ "use_paranoia", "FALSE",
  "use_cdtext", "TRUE",
 #ifdef HAVE_LIBCDDB
  "use_cddb", "TRUE",
  "cddbhttp", "FALSE",
  "cddbserver", "gnudb.gnudb.org",
  "cddbport", "8880",
+ "cddb_cache", "TRUE",
+ "cddb_cache_days", "30",
+ "cddb_offline", "FALSE",
 #endif
  nullptr
 };
@@ -143,6 +188,10 @@ const PreferencesWidget CDAudio::widgets[] = {
         {MIN_DISC_SPEED, MAX_DISC_SPEED, 1}),
     WidgetEntry (N_("Override device:"),
         WidgetString ("CDDA", "device")),
+#ifdef HAVE_LIBCDIO_PARANOIA
+    WidgetCheck (N_("Verify reads (paranoia mode)"),
+        WidgetBool ("CDDA", "use_paranoia")),
+#endif
     WidgetLabel (N_("<b>Metadata</b>")),
     WidgetCheck (N_("Use CD-Text"),
         WidgetBool ("CDDA", "use_cdtext")),
@@ -163,6 +212,16 @@ const PreferencesWidget CDAudio::widgets[] = {
     WidgetSpin (N_("Port:"),
         WidgetInt ("CDDA", "cddbport"),
         {0, 65535, 1},
+        WIDGET_CHILD),
+    WidgetCheck (N_("Cache results locally"),
+        WidgetBool ("CDDA", "cddb_cache"),
+        WIDGET_CHILD),
+    WidgetSpin (N_("Expire cached results after:"),
+        WidgetInt ("CDDA", "cddb_cache_days"),
+        {0, 3650, 1, N_("days (0 = never)")},
+        WIDGET_CHILD),
+    WidgetCheck (N_("Offline (use cached results only)"),
+        WidgetBool ("CDDA", "cddb_offline"),
         WIDGET_CHILD)
 #endif
 };
@@ -242,6 +301,210 @@ bool CDAudio::is_our_file (const char * filename, VFSFile & file)
     return !strncmp (filename, "cdda://", 7);
 }
 
+/* ra_mutex must be locked */
+static void ra_reset (int lsn)
+{
+    ra.head = 0;
+    ra.fill = 0;
+    ra.first_lsn = lsn;
+    ra.failed = false;
+}
+
+/* drops all prefetched data, since it may belong to a different disc; a
+ * read in progress is discarded as after a seek to the same position */
+static void ra_invalidate ()
+{
+    pthread_mutex_lock (& ra_mutex);
+    ra_reset (ra.first_lsn);
+    ra.seek_lsn = ra.first_lsn;
+    pthread_cond_broadcast (& ra_cond);
+    pthread_mutex_unlock (& ra_mutex);
+}
+
+/* ra_mutex must be locked */
+static void ra_wait (int ms)
+{
+    timespec ts;
+    clock_gettime (CLOCK_REALTIME, & ts);
+    ts.tv_nsec += ms * 1000000L;
+    ts.tv_sec += ts.tv_nsec / 1000000000L;
+    ts.tv_nsec %= 1000000000L;
+    pthread_cond_timedwait (& ra_cond, & ra_mutex, & ts);
+}
+
+/* ra_mutex must be locked; number of sectors that can be appended in one go */
+static int ra_writable (int want)
+{
+    int tail = (ra.head + ra.fill) % ra.capacity;
+    int count = aud::min (want, ra.capacity - ra.fill);
+    count = aud::min (count, ra.capacity - tail);
+    return aud::min (count, ra.limit_lsn + 1 - (ra.first_lsn + ra.fill));
+}
+
+#ifdef HAVE_LIBCDIO_PARANOIA
+/* reader thread only */
+static bool read_sectors_paranoia (cdrom_paranoia_t * paranoia, int & paranoia_lsn,
+ unsigned char * dest, int lsn, int count)
+{
+    if (paranoia_lsn != lsn)
+    {
+        cdio_paranoia_seek (paranoia, lsn, SEEK_SET);
+        paranoia_lsn = lsn;
+    }
+
+    for (int i = 0; i < count; i ++)
+    {
+        int16_t * data = cdio_paranoia_read (paranoia, nullptr);
+        if (! data)
+        {
+            paranoia_lsn = -1;
+            return false;
+        }
+
+#ifdef WORDS_BIGENDIAN
+        /* paranoia returns samples in host byte order */
+        for (int j = 0; j < SECTOR_SIZE / 2; j ++)
+            data[j] = (int16_t) (((uint16_t) data[j] >> 8) | ((uint16_t) data[j] << 8));
+#endif
+
+        memcpy (dest + SECTOR_SIZE * i, data, SECTOR_SIZE);
+        paranoia_lsn ++;
+    }
+
+    return true;
+}
+#endif
+
+/* state of the reading loop, owned by the thread doing the reading */
+struct Reader
+{
+#ifdef HAVE_LIBCDIO_PARANOIA
+    cdrom_paranoia_t * paranoia = nullptr;
+    int paranoia_lsn = -1;
+#endif
+    int batch = 1;
+    int retry_count = 0, skip_count = 0;
+};
+
+/* ra_mutex must be locked */
+static void reader_open (Reader & r)
+{
+#ifdef HAVE_LIBCDIO_PARANOIA
+    if (ra.paranoia && (r.paranoia = cdio_paranoia_init (pcdrom_drive)))
+        cdio_paranoia_modeset (r.paranoia, PARANOIA_MODE_FULL ^ PARANOIA_MODE_NEVERSKIP);
+#endif
+
+    r.batch = ra.max_batch;
+}
+
+static void reader_close (Reader & r)
+{
+#ifdef HAVE_LIBCDIO_PARANOIA
+    if (r.paranoia)
+        cdio_paranoia_free (r.paranoia);
+#endif
+}
+
+/* ra_mutex must be locked; it is released during the read itself
+ * returns false if there is nothing to read */
+static bool reader_step (Reader & r)
+{
+    if (ra.seek_lsn >= 0)
+    {
+        ra_reset (ra.seek_lsn);
+        ra.seek_lsn = -1;
+        r.retry_count = 0;
+        r.skip_count = 0;
+        pthread_cond_broadcast (& ra_cond);
+    }
+
+    int count = ra.failed ? 0 : ra_writable (r.batch);
+    if (count < 1)
+        return false;
+
+    int lsn = ra.first_lsn + ra.fill;
+    unsigned char * dest = & ra.ring[SECTOR_SIZE * ((ra.head + ra.fill) % ra.capacity)];
+
+    /* the play thread does not touch the free part of the ring */
+    pthread_mutex_unlock (& ra_mutex);
+
+    bool success;
+#ifdef HAVE_LIBCDIO_PARANOIA
+    if (r.paranoia)
+        success = read_sectors_paranoia (r.paranoia, r.paranoia_lsn, dest, lsn, count);
+    else
+#endif
+        success = (cdio_read_audio_sectors (pcdrom_drive->p_cdio, dest, lsn,
+         count) == DRIVER_OP_SUCCESS);
+
+    pthread_mutex_lock (& ra_mutex);
+
+    /* discard the data if the play thread has moved on meanwhile */
+    if (ra.stop || ra.seek_lsn >= 0)
+        return true;
+
+    if (success)
+    {
+        ra.fill += count;
+        r.retry_count = 0;
+        r.skip_count = 0;
+
+        /* recover gradually from earlier errors */
+        r.batch = aud::min (r.batch * 2, ra.max_batch);
+
+        pthread_cond_broadcast (& ra_cond);
+    }
+    else if (r.batch > 1)
+    {
+        /* maybe a smaller read size will help; narrow down to the bad sector */
+        r.batch /= 2;
+    }
+    else if (r.retry_count < MAX_RETRIES)
+    {
+        /* still failed; retry a few times */
+        r.retry_count ++;
+    }
+    else if (r.skip_count < MAX_SKIPS)
+    {
+        /* maybe the disk is scratched; substitute up to a second of silence */
+        int skip = ra_writable (75);
+        memset (dest, 0, SECTOR_SIZE * skip);
+        ra.fill += skip;
+        r.retry_count = 0;
+        r.skip_count ++;
+
+        pthread_cond_broadcast (& ra_cond);
+    }
+    else
+    {
+        /* still failed; give it up */
+        ra.failed = true;
+        pthread_cond_broadcast (& ra_cond);
+    }
+
+    return true;
+}
+
+/* reader thread; the drive handle stays open as long as this thread runs */
+static void * reader_thread (void *)
+{
+    pthread_mutex_lock (& ra_mutex);
+
+    Reader r;
+    reader_open (r);
+
+    while (! ra.stop)
+    {
+        if (! reader_step (r))
+            pthread_cond_wait (& ra_cond, & ra_mutex);
+    }
+
+    reader_close (r);
+
+    pthread_mutex_unlock (& ra_mutex);
+    return nullptr;
+}
+
 /* play thread only */
 bool CDAudio::play (const char * name, VFSFile & file)
 {
@@ -271,79 +534,140 @@ bool CDAudio::play (const char * name, VFSFile & file)
         return false;
     }
 
-    set_stream_bitrate (1411200);
-    open_audio (FMT_S16_LE, 44100, 2);
-
     int startlsn = trackinfo[trackno].startlsn;
     int endlsn = trackinfo[trackno].endlsn;
 
+    /* continue reading into the next track, if it directly follows */
+    int limitlsn = endlsn;
+    if (trackno < lasttrackno && cdda_track_audiop (pcdrom_drive, trackno + 1) &&
+     trackinfo[trackno + 1].startlsn == endlsn + 1)
+        limitlsn = aud::min (trackinfo[trackno + 1].endlsn, endlsn + PREFETCH_SECONDS * 75);
+
     playing = true;
 
     int buffer_size = aud_get_int ("output_buffer_size");
     int speed = aud_get_int ("CDDA", "disc_speed");
     speed = aud::clamp (speed, MIN_DISC_SPEED, MAX_DISC_SPEED);
     int sectors = aud::clamp (buffer_size / 2, 50, 250) * speed * 75 / 1000;
-    int currlsn = startlsn;
-    int retry_count = 0, skip_count = 0;
+    int capacity = aud::max (READ_AHEAD_SECONDS * 75, 2 * sectors);
 
-    Index<unsigned char> buffer;
-    buffer.insert (0, 2352 * sectors);
+    pthread_mutex_lock (& ra_mutex);
 
-    while (! check_stop ())
+    if (ra.capacity != capacity)
     {
-        int seek_time = check_seek ();
-        if (seek_time >= 0)
-            currlsn = startlsn + (seek_time * 75 / 1000);
-
-        sectors = aud::min (sectors, endlsn + 1 - currlsn);
-        if (sectors < 1)
-            break;
+        ra.ring.clear ();
+        ra.ring.insert (0, SECTOR_SIZE * capacity);
+        ra.capacity = capacity;
+        ra_reset (startlsn);
+    }
+    else if (! ra.fill || ra.first_lsn != startlsn)
+        ra_reset (startlsn);
+    else
+        AUDDBG ("Starting track %d from %d prefetched sectors.\n", trackno, ra.fill);
+
+    ra.limit_lsn = limitlsn;
+    ra.seek_lsn = -1;
+    ra.max_batch = sectors;
+    ra.paranoia = aud_get_bool ("CDDA", "use_paranoia");
+    ra.stop = false;
+
+    /* without a reader thread, the play thread reads whenever the ring runs dry */
+    Reader sync_reader;
+    bool threaded = ! pthread_create (& ra.thread, nullptr, reader_thread, nullptr);
+    if (! threaded)
+    {
+        AUDWARN ("Cannot start reader thread; reading synchronously.\n");
+        reader_open (sync_reader);
+    }
 
-        /* unlock mutex here to avoid blocking
-         * other threads must be careful not to close drive handle */
-        pthread_mutex_unlock (& mutex);
+    pthread_mutex_unlock (& ra_mutex);
 
-        int ret = cdio_read_audio_sectors (pcdrom_drive->p_cdio,
-         buffer.begin (), currlsn, sectors);
+    /* unlock mutex here to avoid blocking
+     * other threads must be careful not to close drive handle */
+    pthread_mutex_unlock (& mutex);
 
-        if (ret == DRIVER_OP_SUCCESS)
-            write_audio (buffer.begin (), 2352 * sectors);
+    /* the drive spins up while the output is being opened */
+    set_stream_bitrate (1411200);
+    open_audio (FMT_S16_LE, 44100, 2);
 
-        pthread_mutex_lock (& mutex);
+    int currlsn = startlsn;
 
-        if (ret == DRIVER_OP_SUCCESS)
-        {
-            currlsn += sectors;
-            retry_count = 0;
-            skip_count = 0;
-        }
-        else if (sectors > 16)
+    while (! check_stop ())
+    {
+        int seek_time = check_seek ();
+        if (seek_time >= 0)
         {
-            /* maybe a smaller read size will help */
-            sectors /= 2;
+            currlsn = aud::min (startlsn + (seek_time * 75 / 1000), endlsn + 1);
+
+            pthread_mutex_lock (& ra_mutex);
+            ra.seek_lsn = currlsn;
+            pthread_cond_broadcast (& ra_cond);
+            pthread_mutex_unlock (& ra_mutex);
         }
-        else if (retry_count < MAX_RETRIES)
+
+        if (currlsn > endlsn)
+            break;
+
+        pthread_mutex_lock (& ra_mutex);
+
+        if (ra.seek_lsn >= 0 || (! ra.fill && ! ra.failed))
         {
-            /* still failed; retry a few times */
-            retry_count ++;
+            if (threaded)
+                ra_wait (100);
+            else
+                reader_step (sync_reader);
         }
-        else if (skip_count < MAX_SKIPS)
+
+        const unsigned char * data = nullptr;
+        int count = 0;
+        bool failed = false;
+
+        if (ra.seek_lsn < 0)
         {
-            /* maybe the disk is scratched; try skipping ahead */
-            currlsn = aud::min (currlsn + 75, endlsn + 1);
-            skip_count ++;
+            count = aud::min (ra.fill, ra.capacity - ra.head);
+            count = aud::min (count, aud::min (sectors, endlsn + 1 - currlsn));
+            data = & ra.ring[SECTOR_SIZE * ra.head];
+            failed = (! count && ra.failed);
         }
-        else
+
+        pthread_mutex_unlock (& ra_mutex);
+
+        if (failed)
         {
-            /* still failed; give it up */
             cdaudio_error (_("Error reading audio CD."));
             break;
         }
+
+        if (! count)
+            continue;
+
+        /* the reader thread leaves buffered sectors alone */
+        write_audio (data, SECTOR_SIZE * count);
+
+        pthread_mutex_lock (& ra_mutex);
+        ra.head = (ra.head + count) % ra.capacity;
+        ra.fill -= count;
+        ra.first_lsn += count;
+        pthread_cond_broadcast (& ra_cond);
+        pthread_mutex_unlock (& ra_mutex);
+
+        currlsn += count;
     }
 
-    playing = false;
+    pthread_mutex_lock (& ra_mutex);
+    ra.stop = true;
+    pthread_cond_broadcast (& ra_cond);
+    pthread_mutex_unlock (& ra_mutex);
 
+    if (threaded)
+        pthread_join (ra.thread, nullptr);
+    else
+        reader_close (sync_reader);
+
+    pthread_mutex_lock (& mutex);
+    playing = false;
     pthread_mutex_unlock (& mutex);
+
     return true;
 }
 
@@ -489,11 +813,322 @@ static bool check_disc_mode (bool warning)
     return true;
 }
 
+#ifdef HAVE_LIBCDDB
+/* Results of CDDB queries are cached locally, so that a disc which is inserted
+ * again does not need another round-trip to the server.  The cache file has
+ * one line per disc: disc ID, time of the query, number of the last track,
+ * and then performer, title and genre for the disc and each track, separated
+ * by tabs.  Discs without a CDDB match are recorded with no further fields. */
+
+#define CACHE_FIELDS(n) (3 + 3 * ((n) + 1))
+
+static StringBuf cddb_cache_uri ()
+{
+    return filename_to_uri (filename_build ({aud_get_path (AudPath::UserDir), "cddb-cache"}));
+}
+
+/* splits a line into tab-separated fields, in place */
+static void cddb_cache_split (char * line, Index<char *> & fields)
+{
+    fields.clear ();
+
+    while (line)
+    {
+        fields.append (line);
+
+        if ((line = strchr (line, '\t')))
+            * line ++ = 0;
+    }
+}
+
+static bool cddb_cache_expired (int64_t stamp, int64_t now)
+{
+    int days = aud_get_int ("CDDA", "cddb_cache_days");
+
+    /* in offline mode, stale data is better than none */
+    if (days <= 0 || aud_get_bool ("CDDA", "cddb_offline"))
+        return false;
+
+    return now - stamp > (int64_t) days * 86400;
+}
+
+/* mutex must be locked */
+static bool cddb_cache_lookup (unsigned discid)
+{
+    if (! aud_get_bool ("CDDA", "cddb_cache"))
+        return false;
+
+    auto data = VFSFile::read_file (cddb_cache_uri (), VFS_APPEND_NULL);
+    if (! data.len ())
+        return false;
+
+    Index<char *> fields;
+    char * line = data.begin ();
+
+    while (line && * line)
+    {
+        char * next = strchr (line, '\n');
+        if (next)
+            * next ++ = 0;
+
+        cddb_cache_split (line, fields);
+        line = next;
+
+        if (fields.len () < 3 || strtoul (fields[0], nullptr, 16) != discid ||
+         atoi (fields[2]) != lasttrackno)
+            continue;
+
+        if (fields.len () != 3 && fields.len () != CACHE_FIELDS (lasttrackno))
+            continue;
+
+        if (cddb_cache_expired (strtoll (fields[1], nullptr, 10), time (nullptr)))
+        {
+            AUDDBG ("cached CDDB info for disc %x has expired\n", discid);
+            return false;
+        }
+
+        if (fields.len () == 3)
+        {
+            AUDDBG ("no CDDB info available for this disc (cached)\n");
+            return true;
+        }
+
+        for (int trackno = 0; trackno <= lasttrackno; trackno ++)
+        {
+            char * * f = & fields[3 + 3 * trackno];
+
+            if (trackno && trackno < firsttrackno)
+                continue;
+
+            trackinfo[trackno].performer = f[0][0] ? String (f[0]) : String ();
+            trackinfo[trackno].name = f[1][0] ? String (f[1]) : String ();
+            trackinfo[trackno].genre = f[2][0] ? String (f[2]) : String ();
+        }
+
+        AUDDBG ("using cached CDDB info for disc %x\n", discid);
+        return true;
+    }
+
+    return false;
+}
+
+static void cddb_cache_write_field (VFSFile & file, const char * str)
+{
+    StringBuf field = str_copy (str ? str : "");
+
+    for (char * c = field; * c; c ++)
+    {
+        if (* c == '\t' || * c == '\n' || * c == '\r')
+            * c = ' ';
+    }
+
+    file.fwrite ("\t", 1, 1);
+    file.fwrite (field, 1, field.len ());
+}
+
+/* mutex must be locked */
+static void cddb_cache_store (unsigned discid, bool found)
+{
+    if (! aud_get_bool ("CDDA", "cddb_cache"))
+        return;
+
+    StringBuf uri = cddb_cache_uri ();
+    auto data = VFSFile::read_file (uri, VFS_APPEND_NULL);
+    int64_t now = time (nullptr);
+
+    VFSFile file (uri, "w");
+    if (! file)
+    {
+        AUDERR ("Failed to write CDDB cache: %s\n", file.error ());
+        return;
+    }
+
+    /* keep other discs, dropping expired entries */
+    char * line = data.len () ? data.begin () : nullptr;
+
+    while (line && * line)
+    {
+        char * next = strchr (line, '\n');
+        if (next)
+            * next ++ = 0;
+
+        const char * tab = strchr (line, '\t');
+
+        if (tab && strtoul (line, nullptr, 16) != discid &&
+         ! cddb_cache_expired (strtoll (tab + 1, nullptr, 10), now))
+        {
+            file.fwrite (line, 1, strlen (line));
+            file.fwrite ("\n", 1, 1);
+        }
+
+        line = next;
+    }
+
+    StringBuf head = str_printf ("%08x\t%" PRId64 "\t%d", discid, now, lasttrackno);
+    file.fwrite (head, 1, head.len ());
+
+    if (found)
+    {
+        for (int trackno = 0; trackno <= lasttrackno; trackno ++)
+        {
+            cddb_cache_write_field (file, trackinfo[trackno].performer);
+            cddb_cache_write_field (file, trackinfo[trackno].name);
+            cddb_cache_write_field (file, trackinfo[trackno].genre);
+        }
+    }
+
+    file.fwrite ("\n", 1, 1);
+}
+
+/* mutex must be locked */
+static cddb_conn_t * open_cddb ()
+{
+    cddb_conn_t * pcddb_conn = cddb_new ();
+    if (pcddb_conn == nullptr)
+    {
+        cdaudio_error (_("Failed to create the CDDB connection."));
+        return nullptr;
+    }
+
+    cddb_cache_enable (pcddb_conn);
+    // cddb_cache_set_dir(pcddb_conn, "~/.cddbslave");
+
+    String server = aud_get_str ("CDDA", "cddbserver");
+    String path = aud_get_str ("CDDA", "cddbpath");
+    int port = aud_get_int ("CDDA", "cddbport");
+
+    if (aud_get_bool ("use_proxy"))
+    {
+        String prhost = aud_get_str ("proxy_host");
+        int prport = aud_get_int ("proxy_port");
+        String pruser = aud_get_str ("proxy_user");
+        String prpass = aud_get_str ("proxy_pass");
+
+        cddb_http_proxy_enable (pcddb_conn);
+        cddb_set_http_proxy_server_name (pcddb_conn, prhost);
+        cddb_set_http_proxy_server_port (pcddb_conn, prport);
+        cddb_set_http_proxy_username (pcddb_conn, pruser);
+        cddb_set_http_proxy_password (pcddb_conn, prpass);
+
+        cddb_set_server_name (pcddb_conn, server);
+        cddb_set_server_port (pcddb_conn, port);
+    }
+    else if (aud_get_bool ("CDDA", "cddbhttp"))
+    {
+        cddb_http_enable (pcddb_conn);
+        cddb_set_server_name (pcddb_conn, server);
+        cddb_set_server_port (pcddb_conn, port);
+        cddb_set_http_path_query (pcddb_conn, path);
+    }
+    else
+    {
+        cddb_set_server_name (pcddb_conn, server);
+        cddb_set_server_port (pcddb_conn, port);
+    }
+
+    return pcddb_conn;
+}
+
+/* mutex must be locked */
+static void query_cddb (cddb_conn_t * pcddb_conn, cddb_disc_t * pcddb_disc, unsigned discid)
+{
+    AUDDBG ("getting CDDB info\n");
+
+    int matches;
+    if ((matches = cddb_query (pcddb_conn, pcddb_disc)) == -1)
+    {
+        if (cddb_errno (pcddb_conn) == CDDB_ERR_OK)
+            cdaudio_error (_("Failed to query the CDDB server"));
+        else
+            cdaudio_error (_("Failed to query the CDDB server: %s"),
+                           cddb_error_str (cddb_errno (pcddb_conn)));
+
+        return;
+    }
+
+    if (matches == 0)
+    {
+        AUDDBG ("no CDDB info available for this disc\n");
+        cddb_cache_store (discid, false);
+        return;
+    }
+
+    AUDDBG ("CDDB disc category = \"%s\"\n",
+           cddb_disc_get_category_str (pcddb_disc));
+
+    cddb_read (pcddb_conn, pcddb_disc);
+    if (cddb_errno (pcddb_conn) != CDDB_ERR_OK)
+    {
+        cdaudio_error (_("Failed to read the CDDB info: %s"),
+                       cddb_error_str (cddb_errno (pcddb_conn)));
+        return;
+    }
+
+    trackinfo[0].performer = String (cddb_disc_get_artist (pcddb_disc));
+    trackinfo[0].name = String (cddb_disc_get_title (pcddb_disc));
+    trackinfo[0].genre = String (cddb_disc_get_genre (pcddb_disc));
+
+    for (int trackno = firsttrackno; trackno <= lasttrackno; trackno++)
+    {
+        cddb_track_t *pcddb_track = cddb_disc_get_track (pcddb_disc, trackno - 1);
+
+        trackinfo[trackno].performer = String (cddb_track_get_artist (pcddb_track));
+        trackinfo[trackno].name = String (cddb_track_get_title (pcddb_track));
+        trackinfo[trackno].genre = String (cddb_disc_get_genre (pcddb_disc));
+    }
+
+    cddb_cache_store (discid, true);
+}
+
+/* mutex must be locked */
+static void lookup_cddb ()
+{
+    cddb_disc_t *pcddb_disc = cddb_disc_new ();
+    if (pcddb_disc == nullptr)
+        return;
+
+    lba_t lba = cdio_get_track_lba (pcdrom_drive->p_cdio, CDIO_CDROM_LEADOUT_TRACK);
+    cddb_disc_set_length (pcddb_disc, FRAMES_TO_SECONDS (lba));
+
+    for (int trackno = firsttrackno; trackno <= lasttrackno; trackno++)
+    {
+        cddb_track_t *pcddb_track = cddb_track_new ();
+        cddb_track_set_frame_offset (pcddb_track,
+         cdio_get_track_lba (pcdrom_drive->p_cdio, trackno));
+        cddb_disc_add_track (pcddb_disc, pcddb_track);
+    }
+
+    cddb_disc_calc_discid (pcddb_disc);
+
+    unsigned discid = cddb_disc_get_discid (pcddb_disc);
+    AUDDBG ("CDDB disc id = %x\n", discid);
+
+    if (! cddb_cache_lookup (discid))
+    {
+        if (aud_get_bool ("CDDA", "cddb_offline"))
+            AUDDBG ("offline mode; not querying the CDDB server\n");
+        else
+        {
+            cddb_conn_t *pcddb_conn = open_cddb ();
+
+            if (pcddb_conn != nullptr)
+            {
+                query_cddb (pcddb_conn, pcddb_disc, discid);
+                cddb_destroy (pcddb_conn);
+            }
+        }
+    }
+
+    cddb_disc_destroy (pcddb_disc);
+}
+#endif /* HAVE_LIBCDDB */
+
 /* mutex must be locked */
 static bool scan_cd ()
 {
     AUDDBG ("Scanning CD drive.\n");
     trackinfo.clear ();
+    ra_invalidate ();
 
     /* general track initialization */
 
@@ -611,144 +1246,9 @@ static bool scan_cd ()
     if (!cdtext_was_available)
     {
 #ifdef HAVE_LIBCDDB
-        /* initialize de cddb subsystem */
-        cddb_conn_t *pcddb_conn = nullptr;
-        cddb_disc_t *pcddb_disc = nullptr;
-        cddb_track_t *pcddb_track = nullptr;
-        lba_t lba;              /* Logical Block Address */
-
         if (aud_get_bool ("CDDA", "use_cddb"))
-        {
-            pcddb_conn = cddb_new ();
-            if (pcddb_conn == nullptr)
-                cdaudio_error (_("Failed to create the CDDB connection."));
-            else
-            {
-                AUDDBG ("getting CDDB info\n");
-
-                cddb_cache_enable (pcddb_conn);
-                // cddb_cache_set_dir(pcddb_conn, "~/.cddbslave");
-
-                String server = aud_get_str ("CDDA", "cddbserver");
-                String path = aud_get_str ("CDDA", "cddbpath");
-                int port = aud_get_int ("CDDA", "cddbport");
-
-                if (aud_get_bool ("use_proxy"))
-                {
-                    String prhost = aud_get_str ("proxy_host");
-                    int prport = aud_get_int ("proxy_port");
-                    String pruser = aud_get_str ("proxy_user");
-                    String prpass = aud_get_str ("proxy_pass");
-
-                    cddb_http_proxy_enable (pcddb_conn);
-                    cddb_set_http_proxy_server_name (pcddb_conn, prhost);
-                    cddb_set_http_proxy_server_port (pcddb_conn, prport);
-                    cddb_set_http_proxy_username (pcddb_conn, pruser);
-                    cddb_set_http_proxy_password (pcddb_conn, prpass);
-
-                    cddb_set_server_name (pcddb_conn, server);
-                    cddb_set_server_port (pcddb_conn, port);
-                }
-                else if (aud_get_bool ("CDDA", "cddbhttp"))
-                {
-                    cddb_http_enable (pcddb_conn);
-                    cddb_set_server_name (pcddb_conn, server);
-                    cddb_set_server_port (pcddb_conn, port);
-                    cddb_set_http_path_query (pcddb_conn, path);
-                }
-                else
-                {
-                    cddb_set_server_name (pcddb_conn, server);
-                    cddb_set_server_port (pcddb_conn, port);
-                }
-
-                pcddb_disc = cddb_disc_new ();
-
-                lba = cdio_get_track_lba (pcdrom_drive->p_cdio,
-                                          CDIO_CDROM_LEADOUT_TRACK);
-                cddb_disc_set_length (pcddb_disc, FRAMES_TO_SECONDS (lba));
-
-                for (int trackno = firsttrackno; trackno <= lasttrackno; trackno++)
-                {
-                    pcddb_track = cddb_track_new ();
-                    cddb_track_set_frame_offset (pcddb_track,
-                                                 cdio_get_track_lba (
-                                                     pcdrom_drive->p_cdio,
-                                                     trackno));
-                    cddb_disc_add_track (pcddb_disc, pcddb_track);
-                }
-
-                cddb_disc_calc_discid (pcddb_disc);
-
-                unsigned discid = cddb_disc_get_discid (pcddb_disc);
-                AUDDBG ("CDDB disc id = %x\n", discid);
-
-                int matches;
-                if ((matches = cddb_query (pcddb_conn, pcddb_disc)) == -1)
-                {
-                    if (cddb_errno (pcddb_conn) == CDDB_ERR_OK)
-                        cdaudio_error (_("Failed to query the CDDB server"));
-                    else
-                        cdaudio_error (_("Failed to query the CDDB server: %s"),
-                                       cddb_error_str (cddb_errno
-                                                       (pcddb_conn)));
-
-                    cddb_disc_destroy (pcddb_disc);
-                    pcddb_disc = nullptr;
-                }
-                else
-                {
-                    if (matches == 0)
-                    {
-                        AUDDBG ("no CDDB info available for this disc\n");
-
-                        cddb_disc_destroy (pcddb_disc);
-                        pcddb_disc = nullptr;
-                    }
-                    else
-                    {
-                        AUDDBG ("CDDB disc category = \"%s\"\n",
-                               cddb_disc_get_category_str (pcddb_disc));
-
-                        cddb_read (pcddb_conn, pcddb_disc);
-                        if (cddb_errno (pcddb_conn) != CDDB_ERR_OK)
-                        {
-                            cdaudio_error (_("Failed to read the CDDB info: %s"),
-                                           cddb_error_str (cddb_errno
-                                                           (pcddb_conn)));
-                            cddb_disc_destroy (pcddb_disc);
-                            pcddb_disc = nullptr;
-                        }
-                        else
-                        {
-                            trackinfo[0].performer = String (cddb_disc_get_artist (pcddb_disc));
-                            trackinfo[0].name = String (cddb_disc_get_title (pcddb_disc));
-                            trackinfo[0].genre = String (cddb_disc_get_genre (pcddb_disc));
-
-                            int trackno;
-                            for (trackno = firsttrackno; trackno <= lasttrackno;
-                                 trackno++)
-                            {
-                                cddb_track_t *pcddb_track =
-                                    cddb_disc_get_track (pcddb_disc,
-                                                         trackno - 1);
-
-                                trackinfo[trackno].performer = String (cddb_track_get_artist (pcddb_track));
-                                trackinfo[trackno].name = String (cddb_track_get_title (pcddb_track));
-                                trackinfo[trackno].genre = String (cddb_disc_get_genre (pcddb_disc));
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        if (pcddb_disc != nullptr)
-            cddb_disc_destroy (pcddb_disc);
-
-        if (pcddb_conn != nullptr)
-            cddb_destroy (pcddb_conn);
-#endif /* HAVE_LIBCDDB */
+            lookup_cddb ();
+#endif
     }
 
     return true;
@@ -788,6 +1288,7 @@ static void reset_trackinfo ()
     }
 
     trackinfo.clear ();
+    ra_invalidate ();
 }
 
 /* thread safe (mutex may be locked) */
@@ -6,11 +6,22 @@
  * http://www.slack.net/~ant/libs/
  */
 
+#include <inttypes.h>
 #include <math.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
 
 #include <libaudcore/audstrings.h>
+#include <libaudcore/hash.h>
+#include <libaudcore/mainloop.h>
+#include <libaudcore/playlist.h>
 #include <libaudcore/runtime.h>
 
 #include "configure.h"
@@ -35,9 +46,124 @@ static void log_warning(Music_Emu * emu)
         AUDWARN("%s\n", str);
 }
 
+/* Whole files, decompressed if gzipped.  The emulator is loaded directly
+ * from this memory and may keep pointers into it, so it is reference-counted
+ * and has to outlive the emulator.  Recently used images of local files are
+ * kept in a cache, up to a configurable total size, so that playing a file
+ * after scanning it or switching subtunes doesn't decompress it again. */
+
+typedef std::shared_ptr<const Index<char>> ConsoleImage;
+
+struct CachedImage {
+    String path;
+    int64_t mtime, size;
+    ConsoleImage image;
+};
+
+static pthread_mutex_t image_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<CachedImage> image_cache; // most recently used last
+static int64_t image_cache_bytes;
+
+/* mutex must be locked */
+static void trim_image_cache(int64_t limit)
+{
+    int n = 0;
+    while (image_cache_bytes > limit && n < image_cache.len())
+        image_cache_bytes -= image_cache[n++].image->len();
+
+    image_cache.remove(0, n);
+}
+
+static ConsoleImage lookup_image(const char *path, const struct stat &st)
+{
+    ConsoleImage image;
+    pthread_mutex_lock(&image_mutex);
+
+    for (int i = image_cache.len(); i--;)
+    {
+        if (image_cache[i].path != path)
+            continue;
+
+        CachedImage entry = std::move(image_cache[i]);
+        image_cache.remove(i, 1);
+
+        if (entry.mtime == st.st_mtime && entry.size == st.st_size)
+        {
+            image = entry.image;
+            image_cache.append(std::move(entry));
+        }
+        else
+            image_cache_bytes -= entry.image->len();
+
+        break;
+    }
+
+    pthread_mutex_unlock(&image_mutex);
+    return image;
+}
+
+static void store_image(const char *path, const struct stat &st, const ConsoleImage &image)
+{
+    int64_t limit = (int64_t) audcfg.image_cache << 20;
+    if (image->len() > limit)
+        return;
+
+    pthread_mutex_lock(&image_mutex);
+
+    trim_image_cache(limit - image->len());
+    image_cache.append(CachedImage{String(path), (int64_t) st.st_mtime, (int64_t) st.st_size, image});
+    image_cache_bytes += image->len();
+
+    pthread_mutex_unlock(&image_mutex);
+}
+
+static ConsoleImage read_image(const char *path, VFSFile &fd)
+{
+    struct stat st;
+    bool cache = false;
+
+    if (audcfg.image_cache > 0)
+    {
+        StringBuf local = uri_to_filename(path);
+        cache = local && !stat(local, &st);
+    }
+
+    if (cache)
+    {
+        ConsoleImage image = lookup_image(path, st);
+        if (image)
+            return image;
+    }
+
+    Vfs_File_Reader vfs_in;
+    vfs_in.reset(fd);
+
+    // gzip_reader passes uncompressed files through as is
+    Gzip_Reader gzip_in;
+    if (log_err(gzip_in.open(&vfs_in)))
+        return ConsoleImage();
+
+    auto image = std::make_shared<Index<char>>();
+    image->resize(gzip_in.remain());
+    if (log_err(gzip_in.read(image->begin(), image->len())))
+        return ConsoleImage();
+
+    if (cache)
+        store_image(path, st, image);
+
+    return image;
+}
+
+static void clear_image_cache()
+{
+    pthread_mutex_lock(&image_mutex);
+    trim_image_cache(0);
+    pthread_mutex_unlock(&image_mutex);
+}
+
 /* Handles URL parsing, file opening and identification, and file
- * loading. Keeps file header around when loading rest of file to
- * avoid seeking and re-reading.
+ * loading. The file is read (and decompressed) only once, into an
+ * image shared by identification and loading.
  */
 class ConsoleFileHandler {
 public:
@@ -45,6 +171,7 @@ public:
     int m_track;             // track number (0 = first track)
     Music_Emu* m_emu;         // set to 0 to take ownership
     gme_type_t m_type;
+    ConsoleImage m_image;     // file contents, decompressed
 
     // Parses path and identifies file type
     ConsoleFileHandler(const char* path, VFSFile &fd);
@@ -53,13 +180,8 @@ public:
     // emulator couldn't be created, returns 1.
     int load(int sample_rate);
 
-    // Deletes owned emu and closes file
+    // Deletes owned emu, then releases file image
     ~ConsoleFileHandler();
-
-private:
-    char m_header[4];
-    Vfs_File_Reader vfs_in;
-    Gzip_Reader gzip_in;
 };
 
 ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
@@ -74,17 +196,13 @@ ConsoleFileHandler::ConsoleFileHandler(const char *path, VFSFile &fd)
 
     m_track -= 1;
 
-    // open vfs
-    vfs_in.reset(fd);
+    // read whole file
+    m_image = read_image(m_path, fd);
 
-    // now open gzip_reader on top of vfs
-    if (log_err(gzip_in.open(&vfs_in)))
-        return;
-
-    // read and identify header
-    if (!log_err(gzip_in.read(m_header, sizeof(m_header))))
+    // identify header
+    if (m_image && m_image->len() >= 4)
     {
-        m_type = gme_identify_extension(gme_identify_header(m_header));
+        m_type = gme_identify_extension(gme_identify_header(m_image->begin()));
         if (!m_type)
         {
             m_type = gme_identify_extension(m_path);
@@ -111,15 +229,9 @@ int ConsoleFileHandler::load(int sample_rate)
         return 1;
     }
 
-    // combine header with remaining file data
-    Remaining_Reader reader(m_header, sizeof(m_header), &gzip_in);
-    if (log_err(m_emu->load(reader)))
+    if (log_err(m_emu->load_mem(m_image->begin(), m_image->len())))
         return 1;
 
-    // files can be closed now
-    gzip_in.close();
-    vfs_in.close();
-
     log_warning(m_emu);
 
 #if 0
@@ -158,6 +270,474 @@ static int get_track_length(const track_info_t &info)
     return length;
 }
 
+/* Length detection for tracks without a length tag.  Such tracks are played
+ * through in the background, on a pool of low-priority threads, until the
+ * emulator stops, runs into silence or starts repeating itself.  Results are
+ * cached in memory and on disk, keyed by a hash of the file and the track
+ * number, and the playlist entries are then rescanned to pick them up.  The
+ * cache file has one line per track: key, length in milliseconds (-1 if the
+ * track neither ended nor looped), the number of seconds that were scanned,
+ * and 1 if the track loops. */
+
+struct ScanResult {
+    int length;
+    int budget;
+    bool looped;
+};
+
+struct ScanJob {
+    String filename;    // including track number
+    String key;
+};
+
+static pthread_mutex_t scan_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t scan_cond = PTHREAD_COND_INITIALIZER;
+static SimpleHash<String, ScanResult> scan_results;
+static SimpleHash<String, bool> scan_pending;
+static bool scan_results_loaded;
+static Index<ScanJob> scan_queue;
+static Index<String> scan_finished;
+static Index<pthread_t> scan_threads;
+static int scan_idle;
+static bool scan_quit;
+static QueuedFunc scan_notify;
+
+static StringBuf scan_cache_uri()
+{
+    return filename_to_uri(filename_build({aud_get_path(AudPath::UserDir), "console-lengths"}));
+}
+
+// 64-bit FNV-1a of the decompressed file
+static uint64_t hash_image(const Index<char> &image)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (char c : image)
+        hash = (hash ^ (unsigned char) c) * 0x100000001b3;
+
+    return hash;
+}
+
+/* mutex must be locked */
+static void load_scan_results()
+{
+    if (scan_results_loaded)
+        return;
+
+    scan_results_loaded = true;
+
+    auto data = VFSFile::read_file(scan_cache_uri(), VFS_APPEND_NULL);
+    char *line = data.len() ? data.begin() : nullptr;
+
+    while (line && *line)
+    {
+        char *next = strchr(line, '\n');
+        if (next)
+            *next++ = 0;
+
+        // lines without the loop field predate loop detection; scan again
+        auto fields = str_list_to_index(line, "\t");
+        if (fields.len() == 4)
+            scan_results.add(fields[0], {atoi(fields[1]), atoi(fields[2]), atoi(fields[3]) != 0});
+
+        line = next;
+    }
+}
+
+/* mutex must be locked */
+static void store_scan_result(const String &key, ScanResult result)
+{
+    scan_results.add(key, ScanResult(result));
+
+    VFSFile file(scan_cache_uri(), "a");
+    StringBuf line = str_printf("%s\t%d\t%d\t%d\n", (const char *) key,
+     result.length, result.budget, (int) result.looped);
+
+    if (!file || file.fwrite(line, 1, line.len()) != line.len())
+        AUDERR("Failed to write %s\n", (const char *) scan_cache_uri());
+}
+
+/* Finds where a track that never ends starts over.  Each block of output is
+ * reduced to its loudness in eight octave bands, which survives the small
+ * timing differences between passes of a loop that make the samples
+ * themselves differ.  For every candidate loop length, a streak counts the
+ * blocks that have matched the block that far back; a mismatch costs eight
+ * matches and ends the streak once they run out.  When a streak covers a
+ * whole pass, and at least 'window' blocks, the loop was found. */
+class LoopFinder {
+public:
+    static const int block_frames = 1024;
+
+    // all lengths in blocks
+    LoopFinder(int min_loop, int max_loop, int window);
+
+    // Adds a block of stereo samples.  Returns the length of the intro and
+    // one pass of the loop, in blocks, once the loop is found, else -1.
+    int add_block(const Music_Emu::sample_t *buf);
+
+private:
+    static const int bands = 8;
+
+    struct Print {
+        uint8_t level[bands];   // power of bins 2^(b+1) to 2^(b+2), in steps of 1.5 dB
+    };
+
+    struct Streak {
+        int length;
+        int score;
+    };
+
+    static bool similar(const Print &a, const Print &b);
+
+    // whether the blocks of a pass vary enough to be music and not a drone
+    bool varies(int from, int to) const;
+
+    void transform(float *re, float *im) const;
+
+    const int m_min_loop, m_max_loop, m_window;
+    float m_hann[block_frames];
+    float m_cos[block_frames / 2], m_sin[block_frames / 2];
+    Index<Print> m_prints;
+    Index<Streak> m_streaks;
+};
+
+LoopFinder::LoopFinder(int min_loop, int max_loop, int window) :
+    m_min_loop(min_loop), m_max_loop(max_loop), m_window(window)
+{
+    for (int i = 0; i < block_frames; i++)
+        m_hann[i] = 0.5 - 0.5 * cos(2 * M_PI * i / block_frames);
+
+    for (int i = 0; i < block_frames / 2; i++)
+    {
+        m_cos[i] = cos(2 * M_PI * i / block_frames);
+        m_sin[i] = sin(2 * M_PI * i / block_frames);
+    }
+
+    m_streaks.insert(0, max_loop + 1);
+}
+
+// in-place radix-2 FFT of one block
+void LoopFinder::transform(float *re, float *im) const
+{
+    for (int i = 1, j = 0; i < block_frames; i++)
+    {
+        int bit = block_frames >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+
+        if (i < j)
+        {
+            aud::swap(re[i], re[j]);
+            aud::swap(im[i], im[j]);
+        }
+    }
+
+    for (int len = 2; len <= block_frames; len <<= 1)
+    {
+        int step = block_frames / len;
+
+        for (int i = 0; i < block_frames; i += len)
+        {
+            for (int k = 0; k < len / 2; k++)
+            {
+                float wr = m_cos[k * step], wi = -m_sin[k * step];
+                int a = i + k, b = a + len / 2;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+bool LoopFinder::similar(const Print &a, const Print &b)
+{
+    int close = 0;
+    for (int i = 0; i < bands; i++)
+        close += (abs(a.level[i] - b.level[i]) <= 3);
+
+    return close >= bands - 2;
+}
+
+int LoopFinder::add_block(const Music_Emu::sample_t *buf)
+{
+    float re[block_frames], im[block_frames];
+
+    for (int i = 0; i < block_frames; i++)
+    {
+        re[i] = (buf[2 * i] + buf[2 * i + 1]) * m_hann[i];
+        im[i] = 0;
+    }
+
+    transform(re, im);
+
+    int n = m_prints.len();
+    Print &print = m_prints.append();
+
+    for (int b = 0; b < bands; b++)
+    {
+        double power = 1e4;
+        for (int i = 2 << b; i < 4 << b; i++)
+            power += re[i] * re[i] + im[i] * im[i];
+
+        print.level[b] = (uint8_t) (log2(power) * 2);
+    }
+
+    // the loop length is rarely a whole number of blocks, so the block one
+    // further back is as good a match
+    int max_loop = aud::min(m_max_loop, n - 1);
+
+    for (int loop = m_min_loop; loop <= max_loop; loop++)
+    {
+        Streak &streak = m_streaks[loop];
+
+        if (similar(print, m_prints[n - loop]) || similar(print, m_prints[n - loop - 1]))
+            streak.score++;
+        else if ((streak.score -= 8) < 0)
+        {
+            streak = Streak();
+            continue;
+        }
+
+        if (++streak.length == aud::max(loop, m_window) && varies(n + 1 - loop, n + 1))
+            return n + 1 - streak.length;
+    }
+
+    return -1;
+}
+
+bool LoopFinder::varies(int from, int to) const
+{
+    for (int b = 0; b < bands; b++)
+    {
+        int low = m_prints[from].level[b], high = low;
+
+        for (int i = from + 1; i < to; i++)
+        {
+            low = aud::min(low, (int) m_prints[i].level[b]);
+            high = aud::max(high, (int) m_prints[i].level[b]);
+        }
+
+        if (high - low >= 8)
+            return true;
+    }
+
+    return false;
+}
+
+// Plays a track until it ends or loops, returning the time of its last sound
+// in ms or, for a track that loops, the length of its intro and one pass of
+// the loop; -1 if neither happened within max_ms, or -2 if interrupted
+static int measure_track(Music_Emu *emu, int track, int max_ms, bool &looped)
+{
+    looped = false;
+
+    if (log_err(emu->start_track(track)))
+        return -1;
+
+    int const buf_size = LoopFinder::block_frames * 2;
+    Music_Emu::sample_t buf[buf_size];
+    int64_t max_samples = (int64_t) max_ms * emu->sample_rate() / 1000 * 2;
+    int64_t played = 0, last_sound = 0;
+
+    // loops from 2 seconds to 5 minutes long, repeated for at least 30 seconds
+    int blocks_per_sec = emu->sample_rate() / LoopFinder::block_frames;
+    LoopFinder loops(2 * blocks_per_sec,
+     aud::min(5 * 60, max_ms / 2000) * blocks_per_sec, 30 * blocks_per_sec);
+
+    for (int n = 0; !emu->track_ended(); n++)
+    {
+        if (played >= max_samples)
+            return -1;
+
+        if (!(n & 63))
+        {
+            pthread_mutex_lock(&scan_mutex);
+            bool quit = scan_quit;
+            pthread_mutex_unlock(&scan_mutex);
+
+            if (quit)
+                return -2;
+        }
+
+        emu->play(buf_size, buf);
+
+        int loop_end = loops.add_block(buf);
+        if (loop_end >= 0)
+        {
+            looped = true;
+            return (int64_t) loop_end * buf_size * 1000 / (emu->sample_rate() * 2);
+        }
+
+        // same threshold as the emulator's silence detection
+        for (int i = buf_size; i--;)
+        {
+            if ((unsigned) (buf[i] + 8) > 16)
+            {
+                last_sound = played + i + 1;
+                break;
+            }
+        }
+
+        played += buf_size;
+    }
+
+    if (!last_sound)
+        return -1;
+
+    return last_sound * 1000 / (emu->sample_rate() * 2);
+}
+
+static int scan_file(const char *filename, int max_ms, bool &looped)
+{
+    const char *sub;
+    uri_parse(filename, nullptr, nullptr, &sub, nullptr);
+
+    VFSFile file(str_copy(filename, sub - filename), "r");
+    if (!file)
+        return -1;
+
+    ConsoleFileHandler fh(filename, file);
+    if (!fh.m_type || fh.m_track < 0)
+        return -1;
+
+    // audio quality doesn't matter here, only where the sound stops
+    if (fh.load(fh.m_type == gme_spc_type ? 32000 : 22050))
+        return -1;
+
+    return measure_track(fh.m_emu, fh.m_track, max_ms, looped);
+}
+
+static void scan_notify_cb()
+{
+    pthread_mutex_lock(&scan_mutex);
+    auto finished = std::move(scan_finished);
+    pthread_mutex_unlock(&scan_mutex);
+
+    for (const String &filename : finished)
+        Playlist::rescan_file(filename);
+}
+
+static void *scan_worker(void *)
+{
+#ifdef SCHED_IDLE
+    sched_param param = sched_param();
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+
+    pthread_mutex_lock(&scan_mutex);
+
+    while (!scan_quit)
+    {
+        if (!scan_queue.len())
+        {
+            scan_idle++;
+            pthread_cond_wait(&scan_cond, &scan_mutex);
+            scan_idle--;
+            continue;
+        }
+
+        ScanJob job = std::move(scan_queue[0]);
+        scan_queue.remove(0, 1);
+        int budget = audcfg.detect_length_max * 60;
+
+        pthread_mutex_unlock(&scan_mutex);
+        bool looped = false;
+        int length = scan_file(job.filename, budget * 1000, looped);
+        pthread_mutex_lock(&scan_mutex);
+
+        scan_pending.remove(job.key);
+
+        if (length == -2)
+            break;
+
+        AUDDBG("%s: length %d ms%s\n", (const char *) job.filename, length,
+         looped ? " (loops)" : "");
+
+        store_scan_result(job.key, {length, budget, looped});
+        scan_finished.append(job.filename);
+        scan_notify.queue(scan_notify_cb);
+    }
+
+    pthread_mutex_unlock(&scan_mutex);
+    return nullptr;
+}
+
+/* mutex must be locked */
+static void queue_scan(const char *filename, const String &key)
+{
+    scan_pending.add(key, true);
+    scan_queue.append(ScanJob{String(filename), key});
+
+    int max_threads = audcfg.detect_length_threads;
+    if (max_threads <= 0)
+        max_threads = aud::clamp((int) sysconf(_SC_NPROCESSORS_ONLN), 1, 64);
+
+    if (scan_idle)
+        pthread_cond_signal(&scan_cond);
+    else if (scan_threads.len() < max_threads)
+    {
+        pthread_t thread;
+        if (!pthread_create(&thread, nullptr, scan_worker, nullptr))
+            scan_threads.append(thread);
+    }
+}
+
+// Returns the detected length of a track without a length tag in ms, or -1
+// if unknown.  'looped' is set if the track loops; the length then covers the
+// intro and one pass of the loop.  If 'scan' is set, unknown tracks are queued
+// for detection.
+static int get_detected_length(const char *filename, const ConsoleFileHandler &fh,
+ bool scan, bool &looped)
+{
+    String key(str_printf("%016" PRIx64 ":%d", hash_image(*fh.m_image), fh.m_track));
+    int length = -1;
+    looped = false;
+
+    pthread_mutex_lock(&scan_mutex);
+    load_scan_results();
+
+    ScanResult *result = scan_results.lookup(key);
+    if (result && (result->length > 0 || result->budget >= audcfg.detect_length_max * 60))
+    {
+        length = result->length;
+        looped = result->looped;
+    }
+    else if (scan && !scan_pending.lookup(key))
+        queue_scan(filename, key);
+
+    pthread_mutex_unlock(&scan_mutex);
+    return length;
+}
+
+void console_driver_cleanup()
+{
+    pthread_mutex_lock(&scan_mutex);
+    scan_quit = true;
+    pthread_cond_broadcast(&scan_cond);
+    pthread_mutex_unlock(&scan_mutex);
+
+    for (pthread_t thread : scan_threads)
+        pthread_join(thread, nullptr);
+
+    scan_notify.stop();
+
+    scan_threads.clear();
+    scan_queue.clear();
+    scan_finished.clear();
+    scan_pending.clear();
+    scan_results.clear();
+    scan_results_loaded = false;
+    scan_quit = false;
+
+    clear_image_cache();
+}
+
 bool ConsolePlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
     ConsoleFileHandler fh(filename, file);
@@ -191,7 +771,17 @@ bool ConsolePlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple,
     else
         tuple.set_subtunes(info.track_count, nullptr);
 
-    tuple.set_int (Tuple::Length, get_track_length (info));
+    int length = get_track_length(info);
+
+    if (info.length <= 0 && fh.m_track >= 0 && audcfg.detect_length)
+    {
+        bool looped;
+        int detected = get_detected_length(filename, fh, true, looped);
+        if (detected > 0)
+            length = looped ? detected + fade_length : detected;
+    }
+
+    tuple.set_int (Tuple::Length, length);
     tuple.set_int (Tuple::Channels, 2);
 
     return true;
@@ -199,7 +789,8 @@ bool ConsolePlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple,
 
 bool ConsolePlugin::play(const char *filename, VFSFile &file)
 {
-    int length, sample_rate;
+    int length, detected, sample_rate;
+    bool looped = false;
     track_info_t info;
 
     // identify file
@@ -243,7 +834,7 @@ bool ConsolePlugin::play(const char *filename, VFSFile &file)
     }
 
     // get info
-    length = -1;
+    length = detected = -1;
     if (!log_err(fh.m_emu->track_info(&info, fh.m_track)))
     {
         if (fh.m_type == gme_spc_type && audcfg.ignore_spc_length)
@@ -251,8 +842,15 @@ bool ConsolePlugin::play(const char *filename, VFSFile &file)
 
         length = get_track_length(info);
         set_stream_bitrate(fh.m_emu->voice_count() * 1000);
+
+        if (info.length <= 0 && audcfg.detect_length)
+            detected = get_detected_length(filename, fh, false, looped);
     }
 
+    // keep snapshots of emulator state for seeking backwards
+    fh.m_emu->set_snapshots(audcfg.snapshot_interval * 1000,
+     (long) audcfg.snapshot_memory << 20);
+
     // start track
     if (log_err(fh.m_emu->start_track(fh.m_track)))
         return false;
@@ -261,11 +859,14 @@ bool ConsolePlugin::play(const char *filename, VFSFile &file)
 
     open_audio(FMT_S16_NE, sample_rate, 2);
 
-    // set fade time
+    // set fade time; a detected length is where the sound stops anyway, or
+    // where a looping track has played its loop once
     if (length <= 0)
         length = audcfg.loop_length * 1000;
     if (length >= fade_threshold + fade_length)
         length -= fade_length / 2;
+    if (detected > 0)
+        length = detected;
     fh.m_emu->set_fade(length, fade_length);
 
     while (!check_stop())
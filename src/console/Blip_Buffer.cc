@@ -2,6 +2,8 @@
 
 #include "Blip_Buffer.h"
 
+#include "blargg_common.h"
+
 #include <assert.h>
 #include <limits.h>
 #include <string.h>
@@ -147,6 +149,20 @@ void Blip_Buffer::end_frame( blip_time_t t )
 	assert( samples_avail() <= (long) buffer_size_ ); // time outside buffer length
 }
 
+void Blip_Buffer::copy_state( Emu_State& s )
+{
+	s.copy( offset_ );
+	s.copy( reader_accum_ );
+	s.copy( modified_ );
+
+	// only the samples up to the end of the current frame plus the tail of
+	// the last impulse are non-zero
+	long count = (offset_ >> BLIP_BUFFER_ACCURACY) + blip_buffer_extra_;
+	if ( s.loading() )
+		memset( buffer_, 0, (buffer_size_ + blip_buffer_extra_) * sizeof *buffer_ );
+	s.copy( buffer_, count * sizeof *buffer_ );
+}
+
 void Blip_Buffer::remove_silence( long count )
 {
 	assert( count <= samples_avail() ); // tried to remove more samples than available
@@ -395,6 +411,26 @@ void Blip_Synth_::volume_unit( double new_unit )
 }
 #endif
 
+void Blip_Buffer::skip_samples( long count )
+{
+	long avail = samples_avail();
+	if ( count > avail )
+		count = avail;
+
+	if ( count )
+	{
+		int const bass = BLIP_READER_BASS( *this );
+		BLIP_READER_BEGIN( reader, *this );
+
+		for ( blip_long n = count; n; --n )
+			BLIP_READER_NEXT( reader, bass );
+
+		BLIP_READER_END( reader, *this );
+
+		remove_samples( count );
+	}
+}
+
 long Blip_Buffer::read_samples( blip_sample_t* BLIP_RESTRICT out, long max_samples, int stereo )
 {
 	long count = samples_avail();
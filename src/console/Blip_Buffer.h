@@ -13,6 +13,8 @@
 	typedef int blip_long;
 	typedef unsigned blip_ulong;
 
+	class Emu_State;
+
 // Time unit at source clock rate
 typedef blip_long blip_time_t;
 
@@ -70,6 +72,9 @@ public:
 	// Remove 'count' samples from those waiting to be read
 	void remove_samples( long count );
 
+	// Remove 'count' samples, leaving high-pass filter as if they had been read
+	void skip_samples( long count );
+
 // Experimental features
 
 	// Count number of clocks needed until 'count' samples will be available.
@@ -91,6 +96,9 @@ public:
 	blip_resampled_time_t resampled_duration( int t ) const     { return t * factor_; }
 	blip_resampled_time_t resampled_time( blip_time_t t ) const { return t * factor_ + offset_; }
 	blip_resampled_time_t clock_rate_factor( long clock_rate ) const;
+
+	// Save or restore samples waiting in buffer and reader state
+	void copy_state( Emu_State& );
 public:
 	Blip_Buffer();
 	~Blip_Buffer();
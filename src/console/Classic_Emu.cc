@@ -95,6 +95,26 @@ blargg_err_t Classic_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Classic_Emu::copy_buf_state( Emu_State& s )
+{
+	return buf->copy_state( s );
+}
+
+blargg_err_t Classic_Emu::run_frame()
+{
+	if ( buf_changed_count != buf->channels_changed_count() )
+	{
+		buf_changed_count = buf->channels_changed_count();
+		remute_voices();
+	}
+	int msec = buf->length();
+	blip_time_t clocks_emulated = (blargg_long) msec * clock_rate_ / 1000;
+	RETURN_ERR( run_clocks( clocks_emulated, msec ) );
+	assert( clocks_emulated );
+	buf->end_frame( clocks_emulated );
+	return 0;
+}
+
 blargg_err_t Classic_Emu::play_( long count, sample_t* out )
 {
 	long remain = count;
@@ -102,17 +122,25 @@ blargg_err_t Classic_Emu::play_( long count, sample_t* out )
 	{
 		remain -= buf->read_samples( &out [count - remain], remain );
 		if ( remain )
+			RETURN_ERR( run_frame() );
+	}
+	return 0;
+}
+
+blargg_err_t Classic_Emu::skip_muted_( long count )
+{
+	// drop frames from buffer rather than mixing and reading them
+	while ( count && !emu_track_ended() )
+	{
+		long n = min( count, buf->samples_avail() );
+		if ( n )
+		{
+			buf->remove_samples( n );
+			count -= n;
+		}
+		else
 		{
-			if ( buf_changed_count != buf->channels_changed_count() )
-			{
-				buf_changed_count = buf->channels_changed_count();
-				remute_voices();
-			}
-			int msec = buf->length();
-			blip_time_t clocks_emulated = (blargg_long) msec * clock_rate_ / 1000;
-			RETURN_ERR( run_clocks( clocks_emulated, msec ) );
-			assert( clocks_emulated );
-			buf->end_frame( clocks_emulated );
+			RETURN_ERR( run_frame() );
 		}
 	}
 	return 0;
@@ -21,6 +21,9 @@ protected:
 	long clock_rate() const { return clock_rate_; }
 	void change_clock_rate( long ); // experimental
 
+	// Save/restore samples waiting in buffer, for use by copy_state_()
+	blargg_err_t copy_buf_state( Emu_State& );
+
 	// Overridable
 	virtual void set_voice( int index, Blip_Buffer* center,
 			Blip_Buffer* left, Blip_Buffer* right ) = 0;
@@ -32,12 +35,14 @@ protected:
 	void mute_voices_( int );
 	void set_equalizer_( equalizer_t const& );
 	blargg_err_t play_( long, sample_t* );
+	blargg_err_t skip_muted_( long );
 private:
 	Multi_Buffer* buf;
 	Multi_Buffer* stereo_buffer; // nullptr if using custom buffer
 	long clock_rate_;
 	unsigned buf_changed_count;
 	int const* voice_types;
+	blargg_err_t run_frame();
 };
 
 inline void Classic_Emu::set_buffer( Multi_Buffer* new_buf )
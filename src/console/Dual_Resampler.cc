@@ -31,6 +31,13 @@ blargg_err_t Dual_Resampler::reset( int pairs )
 	return resampler.buffer_size( resampler_size );
 }
 
+void Dual_Resampler::copy_state( Emu_State& s )
+{
+	s.copy( buf_pos );
+	s.copy( sample_buf.begin(), sample_buf.size() * sizeof sample_buf [0] );
+	resampler.copy_state( s );
+}
+
 void Dual_Resampler::resize( int pairs )
 {
 	int new_sample_buf_size = pairs * 2;
@@ -100,6 +107,51 @@ void Dual_Resampler::dual_play( long count, dsample_t* out, Blip_Buffer& blip_bu
 	}
 }
 
+void Dual_Resampler::skip_frame_( Blip_Buffer& blip_buf )
+{
+	long pair_count = sample_buf_size >> 1;
+	blip_time_t blip_time = blip_buf.count_clocks( pair_count );
+	int sample_count = oversamples_per_frame - resampler.written();
+
+	int new_count = play_frame( blip_time, sample_count, resampler.buffer() );
+	assert( new_count < resampler_size );
+
+	blip_buf.end_frame( blip_time );
+	assert( blip_buf.samples_avail() == pair_count );
+
+	resampler.write( new_count );
+
+	long count = resampler.skip_output( sample_buf_size );
+	assert( count == (long) sample_buf_size );
+	(void) count;
+
+	blip_buf.skip_samples( pair_count );
+}
+
+void Dual_Resampler::dual_skip( long count, Blip_Buffer& blip_buf )
+{
+	// rest of extra buffer
+	long remain = sample_buf_size - buf_pos;
+	if ( remain > count )
+		remain = count;
+	count -= remain;
+	buf_pos += remain;
+
+	// whole frames
+	while ( count >= (long) sample_buf_size )
+	{
+		skip_frame_( blip_buf );
+		count -= sample_buf_size;
+	}
+
+	// extra
+	if ( count )
+	{
+		play_frame_( blip_buf, sample_buf.begin() );
+		buf_pos = count;
+	}
+}
+
 void Dual_Resampler::mix_samples( Blip_Buffer& blip_buf, dsample_t* out )
 {
 	Blip_Reader sn;
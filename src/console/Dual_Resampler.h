@@ -21,6 +21,13 @@ public:
 
 	void dual_play( long count, dsample_t* out, Blip_Buffer& );
 
+	// Skip 'count' samples. Whole frames are run through play_frame() but neither
+	// resampled nor mixed.
+	void dual_skip( long count, Blip_Buffer& );
+
+	// Save or restore buffered samples
+	void copy_state( Emu_State& );
+
 protected:
 	virtual int play_frame( blip_time_t, int pcm_count, dsample_t* pcm_out ) = 0;
 private:
@@ -34,6 +41,7 @@ private:
 	Fir_Resampler<12> resampler;
 	void mix_samples( Blip_Buffer&, dsample_t* );
 	void play_frame_( Blip_Buffer&, dsample_t* );
+	void skip_frame_( Blip_Buffer& );
 };
 
 inline double Dual_Resampler::setup( double oversample, double rolloff, double gain )
@@ -130,6 +130,61 @@ inline int pin_range( int n, int max, int min = 0 )
 	return n;
 }
 
+void Effects_Buffer::remove_samples( long total_samples )
+{
+	require( total_samples % 2 == 0 ); // count must be even
+
+	long remain = bufs [0].samples_avail();
+	if ( remain > (total_samples >> 1) )
+		remain = (total_samples >> 1);
+	while ( remain )
+	{
+		long count = remain;
+
+		if ( effect_remain )
+		{
+			// echo and reverb carry these samples forward, so mix them as usual
+			blip_sample_t buf [1024];
+			if ( count > (long) (sizeof buf / sizeof *buf / 2) )
+				count = sizeof buf / sizeof *buf / 2;
+			read_samples( buf, count * 2 );
+		}
+		else
+		{
+			// same buffers and state changes as read_samples()
+			int active_bufs = (stereo_remain ? 3 : 1);
+
+			stereo_remain -= count;
+			if ( stereo_remain < 0 )
+				stereo_remain = 0;
+
+			for ( int i = 0; i < buf_count; i++ )
+			{
+				if ( i < active_bufs )
+					bufs [i].skip_samples( count );
+				else
+					bufs [i].remove_silence( count ); // keep time synchronized
+			}
+		}
+
+		remain -= count;
+	}
+}
+
+blargg_err_t Effects_Buffer::copy_state( Emu_State& s )
+{
+	s.copy( stereo_remain );
+	s.copy( effect_remain );
+	for ( int i = 0; i < buf_count; i++ )
+		bufs [i].copy_state( s );
+
+	s.copy( reverb_pos );
+	s.copy( echo_pos );
+	s.copy( reverb_buf.begin(), reverb_buf.size() * sizeof reverb_buf [0] );
+	s.copy( echo_buf.begin(), echo_buf.size() * sizeof echo_buf [0] );
+	return 0;
+}
+
 void Effects_Buffer::config( const config_t& cfg )
 {
 	channels_changed();
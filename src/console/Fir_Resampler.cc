@@ -52,10 +52,11 @@ static void gen_sinc( double rolloff, int width, double offset, double spacing,
 	}
 }
 
-Fir_Resampler_::Fir_Resampler_( int width, sample_t* impulses_ ) :
+Fir_Resampler_::Fir_Resampler_( int width, sample_t* impulses_, bool paired_ ) :
 	width_( width ),
 	write_offset( width * stereo - stereo ),
-	impulses( impulses_ )
+	impulses( impulses_ ),
+	paired( paired_ )
 {
 	write_pos = 0;
 	res       = 1;
@@ -117,11 +118,27 @@ double Fir_Resampler_::time_ratio( double new_factor, double rolloff, double gai
 	double filter = (ratio_ < 1.0) ? 1.0 : 1.0 / ratio_;
 	double pos = 0.0;
 	input_per_cycle = 0;
+	int const imp_width = paired ? width_ * 2 : width_;
 	for ( int i = 0; i < res; i++ )
 	{
+		sample_t* imp = impulses + i * imp_width;
 		gen_sinc( rolloff, int (width_ * filter + 1) & ~1, pos, filter,
 				double (0x7FFF * gain * filter),
-				(int) width_, impulses + i * width_ );
+				(int) width_, imp );
+
+		if ( paired )
+		{
+			// t0 t1 t2 t3 -> t0 t1 t0 t1 t2 t3 t2 t3, working backwards in place
+			for ( int n = width_ - 2; n >= 0; n -= 2 )
+			{
+				sample_t t0 = imp [n];
+				sample_t t1 = imp [n + 1];
+				imp [n * 2    ] = t0;
+				imp [n * 2 + 1] = t1;
+				imp [n * 2 + 2] = t0;
+				imp [n * 2 + 3] = t1;
+			}
+		}
 
 		pos += fstep;
 		input_per_cycle += step;
@@ -184,10 +201,58 @@ int Fir_Resampler_::avail_( blargg_long input_count ) const
 	return output_count;
 }
 
+void Fir_Resampler_::copy_state( Emu_State& s )
+{
+	int pos = write_pos - buf.begin();
+	s.copy( pos );
+	s.copy( imp_phase );
+	write_pos = &buf [pos];
+	s.copy( buf.begin(), pos * sizeof buf [0] );
+}
+
+int Fir_Resampler_::skip_output( blargg_long count )
+{
+	// same stepping as read(), minus the filter
+	const sample_t* in = buf.begin();
+	sample_t* end_pos = write_pos;
+	blargg_ulong skip = skip_bits >> imp_phase;
+	int remain = res - imp_phase;
+	int n = 0;
+
+	count >>= 1;
+	if ( end_pos - in >= width_ * stereo )
+	{
+		end_pos -= width_ * stereo;
+		while ( count-- > 0 && in <= end_pos )
+		{
+			remain--;
+			in += (skip * stereo) & stereo;
+			skip >>= 1;
+			in += step;
+			if ( !remain )
+			{
+				skip = skip_bits;
+				remain = res;
+			}
+			n += 2;
+		}
+	}
+
+	imp_phase = res - remain;
+
+	int left = write_pos - in;
+	write_pos = &buf [left];
+	memmove( buf.begin(), in, left * sizeof *in );
+
+	return n;
+}
+
 int Fir_Resampler_::skip_input( long count )
 {
 	int remain = write_pos - buf.begin();
 	int max_count = remain - width_ * stereo;
+	if ( max_count < 0 ) // less than one impulse's worth of input, as after clear()
+		max_count = 0;
 	if ( count > max_count )
 		count = max_count;
 
@@ -7,6 +7,18 @@
 #include "blargg_common.h"
 #include <string.h>
 
+// Vectorized FIR in read() for widths that are a multiple of 4. SSE2 and NEON
+// are baseline on x86-64 and AArch64. Output is identical to the scalar code.
+#ifndef FIR_RESAMPLER_NO_SIMD
+	#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define FIR_RESAMPLER_SSE2 1
+		#include <emmintrin.h>
+	#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+		#define FIR_RESAMPLER_NEON 1
+		#include <arm_neon.h>
+	#endif
+#endif
+
 class Fir_Resampler_ {
 public:
 
@@ -45,6 +57,13 @@ public:
 	// Skip 'count' input samples. Returns number of samples actually skipped.
 	int skip_input( long count );
 
+	// Consume input as read() would for at most 'count' output samples, without
+	// calculating them. Returns number of output samples skipped.
+	int skip_output( blargg_long count );
+
+	// Save or restore buffered input and phase
+	void copy_state( Emu_State& );
+
 // Output
 
 	// Number of extra input samples needed until 'count' output samples are available
@@ -69,8 +88,9 @@ protected:
 	int input_per_cycle;
 	double ratio_;
 	sample_t* impulses;
+	bool paired; // impulses stored as t0 t1 t0 t1 t2 t3 t2 t3 ... for SSE2
 
-	Fir_Resampler_( int width, sample_t* );
+	Fir_Resampler_( int width, sample_t*, bool paired = false );
 	int avail_( blargg_long input_count ) const;
 };
 
@@ -79,9 +99,19 @@ protected:
 template<int width>
 class Fir_Resampler : public Fir_Resampler_ {
 	BOOST_STATIC_ASSERT( width >= 4 && width % 2 == 0 );
-	short impulses [max_res] [width];
+#if FIR_RESAMPLER_SSE2 || FIR_RESAMPLER_NEON
+	enum { simd = width % 4 == 0 };
+#else
+	enum { simd = 0 };
+#endif
+#if FIR_RESAMPLER_SSE2
+	enum { imp_width = simd ? width * 2 : width };
+#else
+	enum { imp_width = width };
+#endif
+	short impulses [max_res] [imp_width];
 public:
-	Fir_Resampler() : Fir_Resampler_( width, impulses [0] ) { }
+	Fir_Resampler() : Fir_Resampler_( width, impulses [0], imp_width != width ) { }
 
 	// Read at most 'count' samples. Returns number of samples actually read.
 	typedef short sample_t;
@@ -124,6 +154,48 @@ int Fir_Resampler<width>::read( sample_t* out_begin, blargg_long count )
 			if ( count < 0 )
 				break;
 
+		#if FIR_RESAMPLER_SSE2
+			if ( simd )
+			{
+				__m128i sum = _mm_setzero_si128();
+				for ( int n = width / 4; n; --n )
+				{
+					// L0 R0 L1 R1 L2 R2 L3 R3 -> L0 L1 R0 R1 L2 L3 R2 R3, then
+					// multiply by t0 t1 t0 t1 t2 t3 t2 t3 and add pairs
+					__m128i x = _mm_loadu_si128( (__m128i const*) i );
+					x = _mm_shufflelo_epi16( x, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+					x = _mm_shufflehi_epi16( x, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+					x = _mm_madd_epi16( x, _mm_loadu_si128( (__m128i const*) imp ) );
+					sum = _mm_add_epi32( sum, x );
+					imp += 8;
+					i += 8;
+				}
+				sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				l = _mm_cvtsi128_si32( sum );
+				r = _mm_cvtsi128_si32( _mm_shuffle_epi32( sum, 1 ) );
+			}
+			else
+		#elif FIR_RESAMPLER_NEON
+			if ( simd )
+			{
+				int32x4_t sl = vdupq_n_s32( 0 );
+				int32x4_t sr = sl;
+				for ( int n = width / 4; n; --n )
+				{
+					int16x4x2_t x = vld2_s16( i ); // deinterleave left and right
+					int16x4_t t = vld1_s16( imp );
+					sl = vmlal_s16( sl, x.val [0], t );
+					sr = vmlal_s16( sr, x.val [1], t );
+					imp += 4;
+					i += 8;
+				}
+				int32x2_t sum = vpadd_s32( vadd_s32( vget_low_s32( sl ), vget_high_s32( sl ) ),
+						vadd_s32( vget_low_s32( sr ), vget_high_s32( sr ) ) );
+				l = vget_lane_s32( sum, 0 );
+				r = vget_lane_s32( sum, 1 );
+			}
+			else
+		#endif
 			for ( int n = width / 2; n; --n )
 			{
 				int pt0 = imp [0];
@@ -236,6 +236,20 @@ blargg_err_t Gbs_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Gbs_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buf_state( s ) );
+
+	// raw copies are valid since they are restored into the same emulator
+	s.copy( *static_cast<cpu*> (this) );
+	s.copy( apu );
+	s.copy( ram );
+	s.copy( cpu_time );
+	s.copy( play_period );
+	s.copy( next_play );
+	return 0;
+}
+
 blargg_err_t Gbs_Emu::run_clocks( blip_time_t& duration, int )
 {
 	cpu_time = 0;
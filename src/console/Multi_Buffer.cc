@@ -28,6 +28,21 @@ Multi_Buffer::Multi_Buffer( int spf ) : samples_per_frame_( spf )
 
 blargg_err_t Multi_Buffer::set_channel_count( int ) { return 0; }
 
+blargg_err_t Multi_Buffer::copy_state( Emu_State& ) { return "Buffer state can't be saved"; }
+
+void Multi_Buffer::remove_samples( long count )
+{
+	// read and discard for buffers that have no faster way
+	blip_sample_t buf [1024];
+	while ( count > 0 )
+	{
+		long n = read_samples( buf, min( count, (long) (sizeof buf / sizeof *buf) ) );
+		if ( !n )
+			break;
+		count -= n;
+	}
+}
+
 // Silent_Buffer
 
 Silent_Buffer::Silent_Buffer() : Multi_Buffer( 1 ) // 0 channels would probably confuse
@@ -93,6 +108,54 @@ void Stereo_Buffer::clear()
 		bufs [i].clear();
 }
 
+void Stereo_Buffer::remove_samples( long count )
+{
+	require( !(count & 1) ); // count must be even
+	count = (unsigned) count / 2;
+
+	long avail = bufs [0].samples_avail();
+	if ( count > avail )
+		count = avail;
+	if ( count )
+	{
+		// same buffers and state changes as read_samples()
+		int bufs_used = stereo_added | was_stereo;
+		if ( bufs_used <= 1 )
+		{
+			bufs [0].skip_samples( count );
+			bufs [1].remove_silence( count );
+			bufs [2].remove_silence( count );
+		}
+		else if ( bufs_used & 1 )
+		{
+			bufs [0].skip_samples( count );
+			bufs [1].skip_samples( count );
+			bufs [2].skip_samples( count );
+		}
+		else
+		{
+			bufs [0].remove_silence( count );
+			bufs [1].skip_samples( count );
+			bufs [2].skip_samples( count );
+		}
+
+		if ( !bufs [0].samples_avail() )
+		{
+			was_stereo   = stereo_added;
+			stereo_added = 0;
+		}
+	}
+}
+
+blargg_err_t Stereo_Buffer::copy_state( Emu_State& s )
+{
+	s.copy( stereo_added );
+	s.copy( was_stereo );
+	for ( int i = 0; i < buf_count; i++ )
+		bufs [i].copy_state( s );
+	return 0;
+}
+
 void Stereo_Buffer::end_frame( blip_time_t clock_count )
 {
 	stereo_added = 0;
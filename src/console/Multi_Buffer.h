@@ -51,6 +51,12 @@ public:
 	virtual long read_samples( blip_sample_t*, long ) = 0;
 	virtual long samples_avail() const = 0;
 
+	// Remove 'count' samples without reading them, for fast skipping
+	virtual void remove_samples( long count );
+
+	// Save or restore samples waiting in buffers. Returns error if not supported.
+	virtual blargg_err_t copy_state( Emu_State& );
+
 protected:
 	void channels_changed() { channels_changed_count_++; }
 private:
@@ -83,6 +89,8 @@ public:
 	long read_samples( blip_sample_t* p, long s ) { return buf.read_samples( p, s ); }
 	channel_t channel( int, int ) { return chan; }
 	void end_frame( blip_time_t t ) { buf.end_frame( t ); }
+	void remove_samples( long s ) { buf.skip_samples( s ); }
+	blargg_err_t copy_state( Emu_State& s ) { buf.copy_state( s ); return 0; }
 };
 
 // Uses three buffers (one for center) and outputs stereo sample pairs.
@@ -106,6 +114,8 @@ public:
 
 	long samples_avail() const { return bufs [0].samples_avail() * 2; }
 	long read_samples( blip_sample_t*, long );
+	void remove_samples( long );
+	blargg_err_t copy_state( Emu_State& );
 
 private:
 	enum { buf_count = 3 };
@@ -132,6 +142,8 @@ public:
 	void end_frame( blip_time_t ) { }
 	long samples_avail() const { return 0; }
 	long read_samples( blip_sample_t*, long ) { return 0; }
+	void remove_samples( long ) { }
+	blargg_err_t copy_state( Emu_State& ) { return 0; }
 };
 
 
@@ -39,6 +39,11 @@ void Music_Emu::clear_track_vars()
 	silence_count    = 0;
 	buf_remain       = 0;
 	warning(); // clear warning
+
+	clear_snapshots();
+	snapshot_interval = msec_to_samples( snapshot_msec );
+	snapshot_limit    = (snapshot_interval > 0 ? snapshot_max : 0);
+	next_snapshot     = 0;
 }
 
 void Music_Emu::unload()
@@ -52,6 +57,11 @@ Music_Emu::Music_Emu()
 {
 	effects_buffer = 0;
 
+	snapshot_count = 0;
+	snapshot_bytes = 0;
+	snapshot_max   = 0;
+	snapshot_msec  = 0;
+
 	sample_rate_ = 0;
 	mute_mask_   = 0;
 	tempo_       = 1.0;
@@ -72,7 +82,11 @@ Music_Emu::Music_Emu()
 	Music_Emu::unload(); // non-virtual
 }
 
-Music_Emu::~Music_Emu() { delete effects_buffer; }
+Music_Emu::~Music_Emu()
+{
+	clear_snapshots();
+	delete effects_buffer;
+}
 
 blargg_err_t Music_Emu::set_sample_rate( long rate )
 {
@@ -121,6 +135,10 @@ void Music_Emu::set_tempo( double t )
 	if ( t > max ) t = max;
 	tempo_ = t;
 	set_tempo_( t );
+
+	// saved states were made at old tempo
+	clear_snapshots();
+	next_snapshot = emu_time;
 }
 
 void Music_Emu::post_load_()
@@ -144,6 +162,7 @@ blargg_err_t Music_Emu::start_track( int track )
 	if ( !ignore_silence_ )
 	{
 		// play until non-silence or end of track
+		next_snapshot = INT_MAX;
 		for ( long end = max_initial_silence * stereo * sample_rate(); emu_time < end; )
 		{
 			fill_buf();
@@ -155,6 +174,7 @@ blargg_err_t Music_Emu::start_track( int track )
 		out_time      = 0;
 		silence_time  = 0;
 		silence_count = 0;
+		next_snapshot = emu_time;
 	}
 	return track_ended() ? warning() : 0;
 }
@@ -187,7 +207,7 @@ long Music_Emu::tell() const
 blargg_err_t Music_Emu::seek( long msec )
 {
 	blargg_long time = msec_to_samples( msec );
-	if ( time < out_time )
+	if ( !restore_snapshot( time ) && time < out_time )
 		RETURN_ERR( start_track( current_track_ ) );
 	return skip( time - out_time );
 }
@@ -208,11 +228,7 @@ blargg_err_t Music_Emu::skip( long count )
 		count -= n;
 	}
 
-	if ( count && !emu_track_ended_ )
-	{
-		emu_time += count;
-		end_track_if_error( skip_( count ) );
-	}
+	emu_skip( count );
 
 	if ( !(silence_count | buf_remain) ) // caught up to emulator, so update track ended
 		track_ended_ |= emu_track_ended_;
@@ -220,6 +236,22 @@ blargg_err_t Music_Emu::skip( long count )
 	return 0;
 }
 
+void Music_Emu::emu_skip( long count )
+{
+	while ( count && !emu_track_ended_ )
+	{
+		// stop at each snapshot time so long skips still leave snapshots behind
+		long n = count;
+		if ( snapshot_limit && emu_time >= next_snapshot )
+			take_snapshot();
+		if ( snapshot_limit && n > next_snapshot - emu_time )
+			n = next_snapshot - emu_time;
+		count -= n;
+		emu_time += n;
+		end_track_if_error( skip_( n ) );
+	}
+}
+
 blargg_err_t Music_Emu::skip_( long count )
 {
 	// for long skip, mute sound
@@ -229,15 +261,21 @@ blargg_err_t Music_Emu::skip_( long count )
 		int saved_mute = mute_mask_;
 		mute_voices( ~0 );
 
-		while ( count > threshold / 2 && !emu_track_ended_ )
-		{
-			RETURN_ERR( play_( buf_size, buf.begin() ) );
-			count -= buf_size;
-		}
+		// leave between threshold / 2 and that plus buf_size for unmuted play
+		long n = (count - threshold / 2 + buf_size - 1) / buf_size * buf_size;
+		count -= n;
+		RETURN_ERR( skip_muted_( n ) );
 
 		mute_voices( saved_mute );
 	}
 
+	return skip_played( count );
+}
+
+blargg_err_t Music_Emu::skip_muted_( long count ) { return skip_played( count ); }
+
+blargg_err_t Music_Emu::skip_played( long count )
+{
 	while ( count && !emu_track_ended_ )
 	{
 		long n = buf_size;
@@ -249,6 +287,107 @@ blargg_err_t Music_Emu::skip_( long count )
 	return 0;
 }
 
+// Snapshots
+
+void Music_Emu::set_snapshots( long interval_msec, long max_bytes )
+{
+	snapshot_msec = interval_msec;
+	snapshot_max  = (max_bytes > 0 ? max_bytes : 0);
+}
+
+void Music_Emu::clear_snapshots()
+{
+	for ( int i = 0; i < snapshot_count; i++ )
+		free( snapshots [i].data );
+	snapshot_count = 0;
+	snapshot_bytes = 0;
+}
+
+void Music_Emu::take_snapshot()
+{
+	Emu_State measure( Emu_State::measure );
+	size_t size = 0;
+	if ( !copy_state_( measure ) )
+		size = measure.size();
+
+	// unsupported, or too large to keep a useful number within budget
+	if ( !size || size > snapshot_limit / 4 )
+	{
+		snapshot_limit = 0;
+		clear_snapshots();
+		return;
+	}
+
+	while ( snapshot_count >= max_snapshots || snapshot_bytes + size > snapshot_limit )
+	{
+		// keep every other snapshot and save half as often from now on
+		int n = 0;
+		for ( int i = 0; i < snapshot_count; i++ )
+		{
+			if ( i & 1 )
+			{
+				snapshot_bytes -= snapshots [i].size;
+				free( snapshots [i].data );
+			}
+			else
+			{
+				snapshots [n++] = snapshots [i];
+			}
+		}
+		snapshot_count = n;
+		snapshot_interval *= 2;
+
+		next_snapshot = snapshots [n - 1].time + snapshot_interval;
+		if ( next_snapshot > emu_time )
+			return;
+	}
+	next_snapshot = emu_time + snapshot_interval;
+
+	unsigned char* data = (unsigned char*) malloc( size );
+	if ( !data )
+		return;
+
+	Emu_State save( Emu_State::save, data );
+	copy_state_( save );
+	assert( save.size() == size );
+
+	snapshot_t& snap = snapshots [snapshot_count++];
+	snap.time = emu_time;
+	snap.data = data;
+	snap.size = size;
+	snapshot_bytes += size;
+}
+
+bool Music_Emu::restore_snapshot( blargg_long time )
+{
+	// nearest snapshot at or before time
+	int i = snapshot_count;
+	while ( i && snapshots [i - 1].time > time )
+		i--;
+	if ( !i )
+		return false;
+	snapshot_t const& snap = snapshots [i - 1];
+
+	// no need if target is ahead and emulator is already past snapshot
+	if ( time >= out_time && snap.time <= emu_time )
+		return false;
+
+	Emu_State load( Emu_State::load, snap.data );
+	blargg_err_t err = copy_state_( load );
+	assert( !err && load.size() == snap.size );
+	(void) err;
+
+	emu_time         = snap.time;
+	out_time         = snap.time;
+	silence_time     = snap.time;
+	silence_count    = 0;
+	buf_remain       = 0;
+	emu_track_ended_ = false;
+	track_ended_     = false;
+	remute_voices();
+	return true;
+}
+
 // Fading
 
 void Music_Emu::set_fade( long start_msec, long length_msec )
@@ -290,6 +429,8 @@ void Music_Emu::handle_fade( long out_count, sample_t* out )
 void Music_Emu::emu_play( long count, sample_t* out )
 {
 	check( current_track_ >= 0 );
+	if ( snapshot_limit && emu_time >= next_snapshot && current_track_ >= 0 && !emu_track_ended_ )
+		take_snapshot();
 	emu_time += count;
 	if ( current_track_ >= 0 && !emu_track_ended_ )
 		end_track_if_error( play_( count, out ) );
@@ -41,9 +41,17 @@ public:
 	// Number of milliseconds (1000 msec = 1 second) played since beginning of track
 	long tell() const;
 
-	// Seek to new time in track. Seeking backwards or far forward can take a while.
+	// Seek to new time in track. Seeking backwards or far forward can take a while,
+	// unless snapshots are enabled (see below).
 	blargg_err_t seek( long msec );
 
+	// Save emulator state every 'interval_msec' during playback, using at most
+	// 'max_bytes' of memory, and seek from the nearest earlier snapshot rather than
+	// from the beginning of the track. When memory runs out, every other snapshot is
+	// dropped and the interval doubled. Only supported by some emulators; others
+	// ignore this. Takes effect at the next start_track().
+	void set_snapshots( long interval_msec, long max_bytes );
+
 	// Skip n samples
 	blargg_err_t skip( long n );
 
@@ -110,6 +118,7 @@ protected:
 	void set_voice_count( int n )               { voice_count_ = n; }
 	void set_voice_names( const char* const* names );
 	void set_track_ended()                      { emu_track_ended_ = true; }
+	bool emu_track_ended() const                { return emu_track_ended_; }
 	double gain() const                         { return gain_; }
 	double tempo() const                        { return tempo_; }
 	void remute_voices();
@@ -122,6 +131,15 @@ protected:
 	virtual blargg_err_t start_track_( int ) = 0; // tempo is set before this
 	virtual blargg_err_t play_( long count, sample_t* out ) = 0;
 	virtual blargg_err_t skip_( long count );
+
+	// Called by skip_() with all voices muted, for the bulk of a long skip.
+	// Output isn't needed, so an emulator can avoid synthesizing and mixing it.
+	// Default plays into a scratch buffer.
+	virtual blargg_err_t skip_muted_( long count );
+
+	// Save/restore all state that affects future output, for snapshots. Only called
+	// between calls to play_() and skip_().
+	virtual blargg_err_t copy_state_( Emu_State& );
 protected:
 	virtual void unload();
 	virtual void pre_load();
@@ -163,6 +181,27 @@ private:
 	blargg_vector<sample_t> buf;
 	void fill_buf();
 	void emu_play( long count, sample_t* out );
+	blargg_err_t skip_played( long count );
+
+	// snapshots
+	struct snapshot_t {
+		blargg_long time; // emu_time when saved
+		unsigned char* data;
+		size_t size;
+	};
+	enum { max_snapshots = 256 };
+	snapshot_t snapshots [max_snapshots];
+	int snapshot_count;
+	size_t snapshot_bytes;
+	size_t snapshot_limit;         // 0 if disabled for current track
+	size_t snapshot_max;
+	long snapshot_msec;
+	blargg_long snapshot_interval;
+	blargg_long next_snapshot;
+	void clear_snapshots();
+	void take_snapshot();
+	bool restore_snapshot( blargg_long time );
+	void emu_skip( long count );
 
 	Multi_Buffer* effects_buffer;
 	friend Music_Emu* gme_new_emu( gme_type_t, int );
@@ -200,6 +239,7 @@ inline void Music_Emu::set_tempo_( double t )       { tempo_ = t; }
 inline void Music_Emu::remute_voices()              { mute_voices( mute_mask_ ); }
 inline void Music_Emu::ignore_silence( bool b )     { ignore_silence_ = b; }
 inline blargg_err_t Music_Emu::start_track_( int )  { return 0; }
+inline blargg_err_t Music_Emu::copy_state_( Emu_State& ) { return "Snapshots not supported"; }
 
 inline void Music_Emu::set_voice_names( const char* const* names )
 {
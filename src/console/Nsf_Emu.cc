@@ -485,6 +485,29 @@ blargg_err_t Nsf_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Nsf_Emu::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buf_state( s ) );
+
+	// CPU and APUs hold only pointers to their own members, the ROM and the
+	// output buffers, so a raw copy restored into the same emulator is valid
+	s.copy( *static_cast<cpu*> (this) );
+	s.copy( apu );
+	#if !NSF_EMU_APU_ONLY
+	{
+		if ( namco ) s.copy( *namco );
+		if ( vrc6  ) s.copy( *vrc6 );
+		if ( fme7  ) s.copy( *fme7 );
+	}
+	#endif
+	s.copy( sram );
+	s.copy( saved_state );
+	s.copy( next_play );
+	s.copy( play_extra );
+	s.copy( play_ready );
+	return 0;
+}
+
 blargg_err_t Nsf_Emu::run_clocks( blip_time_t& duration, int )
 {
 	set_time( 0 );
@@ -302,6 +302,17 @@ blargg_err_t Spc_Emu::start_track_( int track )
 	return 0;
 }
 
+blargg_err_t Spc_Emu::copy_state_( Emu_State& s )
+{
+	// Snes_Spc's own copy_state() is compiled out, and a raw copy is smaller
+	// to write and valid when restored into the same emulator
+	s.copy( apu );
+	s.copy( filter );
+	if ( sample_rate() != native_sample_rate )
+		resampler.copy_state( s );
+	return 0;
+}
+
 blargg_err_t Spc_Emu::play_and_filter( long count, sample_t out [] )
 {
 	RETURN_ERR( apu.play( count, out ) );
@@ -311,23 +322,26 @@ blargg_err_t Spc_Emu::play_and_filter( long count, sample_t out [] )
 
 blargg_err_t Spc_Emu::skip_( long count )
 {
+	// last few samples are played to eliminate pop due to resampler, and are
+	// part of count so that skip is exact (snapshots depend on this)
+	const int resampler_latency = 64;
+	sample_t buf [resampler_latency];
+	if ( count <= resampler_latency )
+		return play_( count, buf );
+	count -= resampler_latency;
+
 	if ( sample_rate() != native_sample_rate )
 	{
 		count = long (count * resampler.ratio()) & ~1;
 		count -= resampler.skip_input( count );
 	}
 
-	// TODO: shouldn't skip be adjusted for the 64 samples read afterwards?
-
 	if ( count > 0 )
 	{
 		RETURN_ERR( apu.skip( count ) );
 		filter.clear();
 	}
 
-	// eliminate pop due to resampler
-	const int resampler_latency = 64;
-	sample_t buf [resampler_latency];
 	return play_( resampler_latency, buf );
 }
 
@@ -67,6 +67,7 @@ protected:
 	void mute_voices_( int );
 	void set_tempo_( double );
 	void enable_accuracy_( bool );
+	blargg_err_t copy_state_( Emu_State& );
 private:
 	byte const* file_data;
 	long        file_size;
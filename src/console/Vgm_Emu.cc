@@ -414,3 +414,12 @@ blargg_err_t Vgm_Emu::play_( long count, sample_t* out )
 	Dual_Resampler::dual_play( count, out, blip_buf );
 	return 0;
 }
+
+blargg_err_t Vgm_Emu::skip_muted_( long count )
+{
+	if ( !uses_fm )
+		return Classic_Emu::skip_muted_( count );
+
+	Dual_Resampler::dual_skip( count, blip_buf );
+	return 0;
+}
@@ -65,6 +65,7 @@ protected:
 	blargg_err_t set_sample_rate_( long sample_rate );
 	blargg_err_t start_track_( int );
 	blargg_err_t play_( long count, sample_t* );
+	blargg_err_t skip_muted_( long count );
 	blargg_err_t run_clocks( blip_time_t&, int );
 	void set_tempo_( double );
 	void mute_voices_( int mask );
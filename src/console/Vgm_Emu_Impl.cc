@@ -268,6 +268,27 @@ int Vgm_Emu_Impl::play_frame( blip_time_t blip_time, int sample_count, sample_t*
 	return pairs * stereo;
 }
 
+blargg_err_t Vgm_Emu_Impl::copy_state_( Emu_State& s )
+{
+	RETURN_ERR( copy_buf_state( s ) );
+	Dual_Resampler::copy_state( s );
+	blip_buf.copy_state( s );
+
+	// PSG and DAC synth only point to their own members and the output buffers
+	s.copy( psg );
+	s.copy( dac_synth );
+	ym2612.copy_state( s );
+	ym2413.copy_state( s );
+
+	s.copy( vgm_time );
+	s.copy( pos );
+	s.copy( pcm_pos );
+	s.copy( dac_amp );
+	s.copy( dac_disabled );
+	s.copy( fm_time_offset );
+	return 0;
+}
+
 // Update pre-1.10 header FM rates by scanning commands
 void Vgm_Emu_Impl::update_fm_rates( long* ym2413_rate, long* ym2612_rate ) const
 {
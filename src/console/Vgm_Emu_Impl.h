@@ -22,6 +22,12 @@ public:
 	bool enabled() const            { return last_time != disabled_time; }
 	void begin_frame( short* p );
 	int run_until( int time );
+	void copy_state( Emu_State& s )
+	{
+		s.copy( last_time );
+		if ( enabled() )
+			Emu::copy_state( s );
+	}
 };
 
 class Vgm_Emu_Impl : public Classic_Emu, private Dual_Resampler {
@@ -65,6 +71,8 @@ protected:
 	Sms_Apu psg;
 	Blip_Synth<blip_med_quality,1> dac_synth;
 
+	blargg_err_t copy_state_( Emu_State& );
+
 	friend class Vgm_Emu;
 };
 
@@ -2146,6 +2146,8 @@ OPLL_calc_stereo (OPLL * opll, e_int32 out[2])
 // Ym2413_Emu
 #include "Ym2413_Emu.h"
 
+#include "blargg_common.h"
+
 #include <assert.h>
 
 static int use_count = 0;
@@ -2214,3 +2216,7 @@ void Ym2413_Emu::run( int pair_count, sample_t* out )
 	}
 }
 
+void Ym2413_Emu::copy_state( Emu_State& s )
+{
+	s.copy( *opll );
+}
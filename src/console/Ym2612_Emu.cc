@@ -4,6 +4,8 @@
 
 #include "Ym2612_Emu.h"
 
+#include "blargg_common.h"
+
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -1317,3 +1319,11 @@ void Ym2612_Impl::run( int pair_count, Ym2612_Emu::sample_t* out )
 }
 
 void Ym2612_Emu::run( int pair_count, sample_t* out ) { impl->run( pair_count, out ); }
+
+void Ym2612_Emu::copy_state( Emu_State& s )
+{
+	// tables only depend on rates, except for LFO counter
+	s.copy( impl->YM2612 );
+	s.copy( impl->g.LFOcnt );
+	s.copy( impl->g.LFOinc );
+}
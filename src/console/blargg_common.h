@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <limits.h>
+#include <string.h>
 
 #include <new>
 
@@ -55,6 +56,33 @@ public:
 	}
 };
 
+// Emu_State - flat copy of emulator state, used by Music_Emu snapshots. Each
+// component copies its members in a fixed order with copy(); a measure pass
+// (no data) finds the size, a save pass writes the data and a load pass reads
+// it back into the same objects it was saved from.
+class Emu_State {
+public:
+	enum mode_t { measure, save, load };
+	Emu_State( mode_t mode, unsigned char* data = 0 ) :
+			data_( data ), size_( 0 ), mode_( mode ) { }
+	void copy( void* p, size_t n )
+	{
+		if ( mode_ == save )
+			memcpy( data_ + size_, p, n );
+		else if ( mode_ == load )
+			memcpy( p, data_ + size_, n );
+		size_ += n;
+	}
+	template<class T>
+	void copy( T& t ) { copy( &t, sizeof t ); }
+	bool loading() const { return mode_ == load; }
+	size_t size() const { return size_; }
+private:
+	unsigned char* data_;
+	size_t size_;
+	mode_t mode_;
+};
+
 // BLARGG_4CHAR('a','b','c','d') = 'abcd' (four character integer constant)
 #define BLARGG_4CHAR( a, b, c, d ) \
 	((a&0xFF)*0x1000000L + (b&0xFF)*0x10000L + (c&0xFF)*0x100L + (d&0xFF))
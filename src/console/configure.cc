@@ -26,6 +26,12 @@ const char * const ConsolePlugin::defaults[] = {
  "ignore_spc_length", "FALSE",
  "echo", "0",
  "inc_spc_reverb", "FALSE",
+ "snapshot_interval", "5",
+ "snapshot_memory", "32",
+ "detect_length", "FALSE",
+ "detect_length_max", "10",
+ "detect_length_threads", "0",
+ "image_cache", "16",
  nullptr};
 
 bool ConsolePlugin::init ()
@@ -40,12 +46,20 @@ bool ConsolePlugin::init ()
     audcfg.ignore_spc_length = aud_get_bool (CON_CFGID, "ignore_spc_length");
     audcfg.echo = aud_get_int (CON_CFGID, "echo");
     audcfg.inc_spc_reverb = aud_get_bool (CON_CFGID, "inc_spc_reverb");
+    audcfg.snapshot_interval = aud_get_int (CON_CFGID, "snapshot_interval");
+    audcfg.snapshot_memory = aud_get_int (CON_CFGID, "snapshot_memory");
+    audcfg.detect_length = aud_get_bool (CON_CFGID, "detect_length");
+    audcfg.detect_length_max = aud_get_int (CON_CFGID, "detect_length_max");
+    audcfg.detect_length_threads = aud_get_int (CON_CFGID, "detect_length_threads");
+    audcfg.image_cache = aud_get_int (CON_CFGID, "image_cache");
 
     return true;
 }
 
 void ConsolePlugin::cleanup ()
 {
+    console_driver_cleanup ();
+
     aud_set_int (CON_CFGID, "loop_length", audcfg.loop_length);
     aud_set_bool (CON_CFGID, "resample", audcfg.resample);
     aud_set_int (CON_CFGID, "resample_rate", audcfg.resample_rate);
@@ -54,4 +68,10 @@ void ConsolePlugin::cleanup ()
     aud_set_bool (CON_CFGID, "ignore_spc_length", audcfg.ignore_spc_length);
     aud_set_int (CON_CFGID, "echo", audcfg.echo);
     aud_set_bool (CON_CFGID, "inc_spc_reverb", audcfg.inc_spc_reverb);
+    aud_set_int (CON_CFGID, "snapshot_interval", audcfg.snapshot_interval);
+    aud_set_int (CON_CFGID, "snapshot_memory", audcfg.snapshot_memory);
+    aud_set_bool (CON_CFGID, "detect_length", audcfg.detect_length);
+    aud_set_int (CON_CFGID, "detect_length_max", audcfg.detect_length_max);
+    aud_set_int (CON_CFGID, "detect_length_threads", audcfg.detect_length_threads);
+    aud_set_int (CON_CFGID, "image_cache", audcfg.image_cache);
 }
@@ -18,6 +18,12 @@ typedef struct {
 	bool ignore_spc_length; /* if true, ignore length from SPC tags */
 	int echo;                  /* 0 to +100 */
 	bool inc_spc_reverb;    /* if true, increases the default reverb */
+	int snapshot_interval;     /* seconds between seek snapshots, 0 to disable */
+	int snapshot_memory;       /* memory for seek snapshots, in MB */
+	bool detect_length;        /* whether to detect length of untagged tracks */
+	int detect_length_max;     /* minutes to play before giving up */
+	int detect_length_threads; /* threads for length detection, 0 = one per CPU */
+	int image_cache;           /* memory for decompressed files, in MB */
 } AudaciousConsoleConfig;
 
 extern AudaciousConsoleConfig audcfg;
@@ -39,6 +39,16 @@ const PreferencesWidget ConsolePlugin::widgets[] = {
     WidgetSpin (N_("Default song length:"),
         WidgetInt (audcfg.loop_length),
         {1, 7200, 1, N_("seconds")}),
+    WidgetCheck (N_("Detect length of songs without length information"),
+        WidgetBool (audcfg.detect_length)),
+    WidgetSpin (N_("Give up after:"),
+        WidgetInt (audcfg.detect_length_max),
+        {1, 120, 1, N_("minutes")},
+        WIDGET_CHILD),
+    WidgetSpin (N_("Threads:"),
+        WidgetInt (audcfg.detect_length_threads),
+        {0, 64, 1, N_("(0 = one per CPU)")},
+        WIDGET_CHILD),
     WidgetLabel (N_("<b>Resampling</b>")),
     WidgetCheck (N_("Enable audio resampling"),
         WidgetBool (audcfg.resample)),
@@ -46,6 +56,17 @@ const PreferencesWidget ConsolePlugin::widgets[] = {
         WidgetInt (audcfg.resample_rate),
         {11025, 96000, 100, N_("Hz")},
         WIDGET_CHILD),
+    WidgetLabel (N_("<b>Seeking</b>")),
+    WidgetSpin (N_("Snapshot interval:"),
+        WidgetInt (audcfg.snapshot_interval),
+        {0, 60, 1, N_("seconds")}),
+    WidgetSpin (N_("Snapshot memory:"),
+        WidgetInt (audcfg.snapshot_memory),
+        {1, 1024, 1, N_("MB")}),
+    WidgetLabel (N_("<b>Caching</b>")),
+    WidgetSpin (N_("Memory for decompressed files:"),
+        WidgetInt (audcfg.image_cache),
+        {0, 1024, 1, N_("MB (0 = off)")}),
     WidgetLabel (N_("<b>SPC</b>")),
     WidgetCheck (N_("Ignore length from SPC tags"),
         WidgetBool (audcfg.ignore_spc_length)),
@@ -42,4 +42,7 @@ public:
     bool play (const char * filename, VFSFile & file);
 };
 
+// Stops background length detection and frees cached files (Audacious_Driver.cc)
+void console_driver_cleanup ();
+
 #endif // CONSOLE_PLUGIN_H
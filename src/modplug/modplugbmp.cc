@@ -6,6 +6,7 @@
 
 #include "modplugbmp.h"
 
+#include <algorithm>
 #include <fstream>
 #include <stdint.h>
 #include <sys/types.h>
@@ -147,7 +148,155 @@ bool ModplugXMMS::is_our_file (const char * filename, VFSFile & file)
     return false;
 }
 
-void ModplugXMMS::PlayLoop()
+// Walks through the song the way the player does, following speed and tempo
+// changes, pattern breaks, position jumps and pattern delays, and notes when
+// each row is reached. Stops at the end of the song or when it loops.
+Index<ModplugXMMS::RowTime> ModplugXMMS::BuildRowTimes()
+{
+    const CSoundFile & f = * mSoundFile;
+
+    unsigned orderPos[MAX_ORDERS];
+    unsigned pos = 0;
+
+    for (unsigned i = 0; i < MAX_ORDERS && f.Order[i] != 0xFF; i++)
+    {
+        orderPos[i] = pos;
+        if (f.Order[i] < MAX_PATTERNS)
+            pos += f.PatternSize[f.Order[i]];
+    }
+
+    Index<bool> visited;
+    visited.insert (0, MAX_ORDERS * 256);
+
+    unsigned order = 0, row = 0;
+    unsigned speed = f.m_nDefaultSpeed ? f.m_nDefaultSpeed : 6;
+    unsigned tempo = f.m_nDefaultTempo ? f.m_nDefaultTempo : 125;
+    double time = 0;
+
+    Index<RowTime> rowTimes;
+
+    while (order < MAX_ORDERS && f.Order[order] != 0xFF)
+    {
+        unsigned pattern = f.Order[order];
+
+        // skip markers, keeping the row a pattern break asked for
+        if (pattern >= MAX_PATTERNS || ! f.Patterns[pattern])
+        {
+            order++;
+            continue;
+        }
+
+        if (row >= f.PatternSize[pattern])
+        {
+            order++;
+            row = 0;
+            continue;
+        }
+
+        if (row < 256)
+        {
+            if (visited[order * 256 + row])
+                break;
+            visited[order * 256 + row] = true;
+        }
+
+        int nextOrder = -1, nextRow = 0;
+        unsigned delay = 0;
+        const MODCOMMAND * m = f.Patterns[pattern] + row * f.m_nChannels;
+
+        for (unsigned chn = 0; chn < f.m_nChannels; chn++, m++)
+        {
+            switch (m->command)
+            {
+            case CMD_SPEED:
+                if (m->param)
+                    speed = m->param;
+                break;
+            case CMD_TEMPO:
+                if (m->param >= 0x20) // lower values slide the tempo
+                    tempo = m->param;
+                break;
+            case CMD_POSITIONJUMP:
+                nextOrder = m->param;
+                break;
+            case CMD_PATTERNBREAK:
+                if (nextOrder < 0)
+                    nextOrder = order + 1;
+                nextRow = m->param;
+                break;
+            case CMD_MODCMDEX:
+            case CMD_S3MCMDEX:
+                if ((m->param & 0xF0) == 0xE0)
+                    delay = m->param & 0x0F;
+                break;
+            }
+        }
+
+        rowTimes.append (RowTime {(int) time, orderPos[order] + row, speed, tempo});
+
+        // a tick lasts 2.5 / tempo seconds
+        time += (delay + 1) * speed * 2500.0 / tempo;
+
+        if (nextOrder >= 0)
+        {
+            order = nextOrder;
+            row = nextRow;
+        }
+        else
+            row++;
+    }
+
+    return rowTimes;
+}
+
+void ModplugXMMS::Seek(int time, const Index<RowTime> & rowTimes)
+{
+    if (! rowTimes.len ())
+    {
+        mSoundFile->SetCurrentPos (time * (int64_t)
+         mSoundFile->GetMaxPosition () / (mSoundFile->GetSongTime () * 1000));
+        return;
+    }
+
+    // last row starting at or before the seek time
+    const RowTime * row = std::upper_bound (rowTimes.begin (), rowTimes.end (), time,
+     [] (int time, const RowTime & row) { return time < row.time; });
+
+    if (row != rowTimes.begin ())
+        row--;
+
+    // SetCurrentPos() leaves the speed and tempo as they were
+    mSoundFile->m_nMusicSpeed = row->speed;
+    mSoundFile->m_nMusicTempo = row->tempo;
+    mSoundFile->SetCurrentPos (row->pos);
+
+    // play up to the exact time
+    int64_t skip = (int64_t) (time - row->time) * mModProps.mFrequency / 1000;
+    uint32_t frames = mBufSize / mModProps.mChannels;
+
+    while (skip > 0)
+    {
+        uint32_t chunk = mSoundFile->Read (mBuffer,
+         aud::min (skip, (int64_t) frames) * mModProps.mChannels * sizeof (int32_t));
+
+        if (! chunk)
+            break;
+
+        skip -= chunk;
+    }
+}
+
+// The mixer's 32-bit output already uses the full range, so the preamp is
+// applied while converting to float and the result saturated, not wrapped.
+static void ConvertToFloat(const int32_t * in, float * out, uint32_t samples, float gain)
+{
+    gain *= 1.0f / 2147483648.0f;
+
+    for (uint32_t i = 0; i < samples; i++)
+        out[i] = aud::clamp (in[i] * gain, -1.0f, 1.0f);
+}
+
+void ModplugXMMS::PlayLoop(const Index<RowTime> & rowTimes)
 {
     uint32_t lLength;
 
@@ -155,29 +304,18 @@ void ModplugXMMS::PlayLoop()
     {
         int seek_time = check_seek ();
         if (seek_time != -1)
-            mSoundFile->SetCurrentPos (seek_time * (int64_t)
-             mSoundFile->GetMaxPosition () / (mSoundFile->GetSongTime () * 1000));
+            Seek (seek_time, rowTimes);
 
-        lLength = mSoundFile->Read (mBuffer, mBufSize);
+        lLength = mSoundFile->Read (mBuffer, mBufSize * sizeof (int32_t));
 
         if (! lLength)
             break;
 
-        if(mModProps.mPreamp)
-        {
-            unsigned n = mBufSize >> 1;
-
-            for(unsigned i = 0; i < n; i++) {
-                short old = ((short*)mBuffer)[i];
-                ((short*)mBuffer)[i] *= (short int)mPreampFactor;
+        uint32_t samples = lLength * mModProps.mChannels;
+        ConvertToFloat (mBuffer, mFloatBuffer, samples,
+         mModProps.mPreamp ? mPreampFactor : 1.0f);
 
-                // detect overflow and clip!
-                if ((old & 0x8000) != (((short*)mBuffer)[i] & 0x8000))
-                    ((short*)mBuffer)[i] = old | 0x7FFF;
-            }
-        }
-
-        write_audio (mBuffer, mBufSize);
+        write_audio (mFloatBuffer, samples * sizeof (float));
     }
 }
 
@@ -200,14 +338,14 @@ bool ModplugXMMS::play (const char * filename, VFSFile & file)
     mBufSize *= mModProps.mFrequency;
     mBufSize /= 1000;    //milliseconds
     mBufSize *= mModProps.mChannels;
-    mBufSize *= 2;
 
-    mBuffer = new unsigned char[mBufSize];
+    mBuffer = new int32_t[mBufSize];
+    mFloatBuffer = new float[mBufSize];
 
     CSoundFile::SetWaveConfig
     (
         mModProps.mFrequency,
-        16,
+        32,
         mModProps.mChannels
     );
     CSoundFile::SetWaveConfigEx
@@ -258,14 +396,18 @@ bool ModplugXMMS::play (const char * filename, VFSFile & file)
         mArchive->Size()
     );
 
+    Index<RowTime> rowTimes = BuildRowTimes();
+
     set_stream_bitrate(mSoundFile->GetNumChannels() * 1000);
 
-    open_audio(FMT_S16_NE, mModProps.mFrequency, mModProps.mChannels);
+    open_audio(FMT_FLOAT, mModProps.mFrequency, mModProps.mChannels);
 
-    PlayLoop();
+    PlayLoop(rowTimes);
 
     delete[] mBuffer;
     mBuffer = nullptr;
+    delete[] mFloatBuffer;
+    mFloatBuffer = nullptr;
     delete mSoundFile;
     mSoundFile = nullptr;
     delete mArchive;
@@ -71,8 +71,16 @@ public:
     bool play (const char * filename, VFSFile & file);
 
 private:
-    unsigned char * mBuffer = nullptr;
-    uint32_t mBufSize = 0;
+    // where each row starts, in the order the song plays them
+    struct RowTime {
+        int time;       // milliseconds
+        unsigned pos;   // for SetCurrentPos()
+        unsigned speed, tempo;
+    };
+
+    int32_t * mBuffer = nullptr;
+    float * mFloatBuffer = nullptr;
+    uint32_t mBufSize = 0; // samples
 
     ModplugSettings mModProps {};
 
@@ -86,7 +94,9 @@ private:
     void load_settings ();
     void apply_settings ();
 
-    void PlayLoop();
+    Index<RowTime> BuildRowTimes();
+    void Seek(int time, const Index<RowTime> & rowTimes);
+    void PlayLoop(const Index<RowTime> & rowTimes);
 };
 
 #endif //included
@@ -24,6 +24,13 @@
  * SUCH DAMAGE.
  */
 
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <memory>
+
+#include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
@@ -36,6 +43,263 @@ static bool force_apply = false;
 static constexpr const char *CFG_SECTION               = "openmpt";
 static constexpr const char *SETTING_STEREO_SEPARATION = "stereo_separation";
 static constexpr const char *SETTING_INTERPOLATOR      = "interpolator";
+static constexpr const char *SETTING_SUBSONGS          = "subsongs";
+
+static void apply_settings(MPTWrap &mpt)
+{
+    mpt.set_interpolator(aud_get_int(CFG_SECTION, SETTING_INTERPOLATOR));
+    mpt.set_stereo_separation(aud_get_int(CFG_SECTION, SETTING_STEREO_SEPARATION));
+}
+
+/* Module information is expensive to get (every subsong is played through to
+ * find its length) and is needed when the file is added to the playlist, then
+ * again for each of its subsongs.  It is cached for local files, keyed by
+ * path, modification time and size. */
+
+typedef std::shared_ptr<const MPTInfo> MPTInfoPtr;
+
+struct CachedInfo
+{
+    String path;
+    int64_t mtime, size;
+    MPTInfoPtr info;
+};
+
+static constexpr int INFO_CACHE_SIZE = 256;
+
+static pthread_mutex_t info_mutex = PTHREAD_MUTEX_INITIALIZER;
+static Index<CachedInfo> info_cache; // most recently used last
+
+static MPTInfoPtr lookup_info(const char *path, const struct stat &st)
+{
+    MPTInfoPtr info;
+    pthread_mutex_lock(&info_mutex);
+
+    for (int i = info_cache.len(); i--;)
+    {
+        if (info_cache[i].path != path)
+            continue;
+
+        CachedInfo entry = std::move(info_cache[i]);
+        info_cache.remove(i, 1);
+
+        if (entry.mtime == st.st_mtime && entry.size == st.st_size)
+        {
+            info = entry.info;
+            info_cache.append(std::move(entry));
+        }
+
+        break;
+    }
+
+    pthread_mutex_unlock(&info_mutex);
+    return info;
+}
+
+static void store_info(const char *path, const struct stat &st, const MPTInfoPtr &info)
+{
+    pthread_mutex_lock(&info_mutex);
+
+    if (info_cache.len() >= INFO_CACHE_SIZE)
+        info_cache.remove(0, info_cache.len() - INFO_CACHE_SIZE + 1);
+
+    info_cache.append(CachedInfo{String(path), (int64_t) st.st_mtime, (int64_t) st.st_size, info});
+
+    pthread_mutex_unlock(&info_mutex);
+}
+
+static MPTInfoPtr read_info(const char *filename, VFSFile &file)
+{
+    // all subsongs share one cache entry
+    const char *sub;
+    uri_parse(filename, nullptr, nullptr, &sub, nullptr);
+    StringBuf path = str_copy(filename, sub - filename);
+
+    struct stat st;
+    StringBuf local = uri_to_filename(path);
+    bool cache = local && !stat(local, &st);
+
+    if (cache)
+    {
+        MPTInfoPtr info = lookup_info(path, st);
+        if (info)
+            return info;
+    }
+
+    MPTWrap mpt;
+    if (!mpt.open(file))
+        return MPTInfoPtr();
+
+    auto info = std::make_shared<MPTInfo>();
+    mpt.get_info(*info);
+
+    if (cache)
+        store_info(path, st, info);
+
+    return info;
+}
+
+/* The module is rendered ahead of playback by a separate thread, into a ring
+ * buffer of two seconds.  A passage that takes longer to render than to play
+ * (an IT module with many channels using resonant filters, say) then only
+ * drains the buffer instead of causing an underrun.  While the thread runs,
+ * only it touches the module; seeks and setting changes are passed to it. */
+class RenderAhead
+{
+public:
+    RenderAhead(MPTWrap &mpt) :
+        m_mpt(mpt)
+    {
+        pthread_mutex_init(&m_mutex, nullptr);
+        pthread_cond_init(&m_cond, nullptr);
+        m_ring.insert(0, ring_samples);
+    }
+
+    ~RenderAhead()
+    {
+        pthread_mutex_destroy(&m_mutex);
+        pthread_cond_destroy(&m_cond);
+    }
+
+    bool start()
+    {
+        return !pthread_create(&m_thread, nullptr, run, this);
+    }
+
+    void finish()
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_stop = true;
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+
+        pthread_join(m_thread, nullptr);
+    }
+
+    void seek(int ms)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_seek = ms;
+        m_head = m_fill = 0;
+        m_ended = false;
+        m_generation++;
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    void apply_settings()
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_apply = true;
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    // waits for data; returns 0 at the end of the song
+    int read(float *buf, int max)
+    {
+        pthread_mutex_lock(&m_mutex);
+
+        while (!m_fill && !m_ended)
+            pthread_cond_wait(&m_cond, &m_mutex);
+
+        int n = aud::min(max, aud::min(m_fill, ring_samples - m_head));
+        memcpy(buf, &m_ring[m_head], n * sizeof(float));
+        m_head = (m_head + n) % ring_samples;
+        m_fill -= n;
+
+        pthread_cond_broadcast(&m_cond);
+        pthread_mutex_unlock(&m_mutex);
+
+        return n;
+    }
+
+private:
+    static constexpr int ring_samples = MPTWrap::rate() * MPTWrap::channels() * 2;
+    static constexpr int block_samples = 1024 * MPTWrap::channels();
+
+    static void *run(void *data)
+    {
+        static_cast<RenderAhead *>(data)->render_loop();
+        return nullptr;
+    }
+
+    void render_loop()
+    {
+        float buf[block_samples];
+
+        pthread_mutex_lock(&m_mutex);
+
+        while (!m_stop)
+        {
+            if (m_seek >= 0 || m_apply)
+            {
+                int seek = m_seek;
+                bool apply = m_apply;
+                m_seek = -1;
+                m_apply = false;
+
+                pthread_mutex_unlock(&m_mutex);
+
+                if (apply)
+                    ::apply_settings(m_mpt);
+                if (seek >= 0)
+                    m_mpt.seek(seek);
+
+                pthread_mutex_lock(&m_mutex);
+                continue;
+            }
+
+            if (m_ended || m_fill > ring_samples - block_samples)
+            {
+                pthread_cond_wait(&m_cond, &m_mutex);
+                continue;
+            }
+
+            int generation = m_generation;
+            pthread_mutex_unlock(&m_mutex);
+
+            int n = m_mpt.read(buf, block_samples);
+
+            pthread_mutex_lock(&m_mutex);
+
+            // discard the block if there was a seek meanwhile
+            if (generation != m_generation)
+                continue;
+
+            if (n)
+            {
+                int tail = (m_head + m_fill) % ring_samples;
+                int first = aud::min(n, ring_samples - tail);
+
+                memcpy(&m_ring[tail], buf, first * sizeof(float));
+                memcpy(&m_ring[0], buf + first, (n - first) * sizeof(float));
+                m_fill += n;
+            }
+            else
+                m_ended = true;
+
+            pthread_cond_broadcast(&m_cond);
+        }
+
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    MPTWrap &m_mpt;
+
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_cond;
+
+    bool m_stop = false;
+    bool m_ended = false;
+    bool m_apply = false;
+    int m_seek = -1;
+    int m_generation = 0;
+
+    Index<float> m_ring;
+    int m_head = 0, m_fill = 0;
+};
 
 class MPTPlugin : public InputPlugin
 {
@@ -53,7 +317,7 @@ public:
         &prefs,
     };
 
-    static constexpr auto iinfo = InputInfo(0)
+    static constexpr auto iinfo = InputInfo(FlagSubtunes)
         .with_exts(exts);
 
     constexpr MPTPlugin() : InputPlugin(info, iinfo) { }
@@ -64,6 +328,7 @@ public:
         {
             SETTING_STEREO_SEPARATION, aud::numeric_string<MPTWrap::default_stereo_separation>::str,
             SETTING_INTERPOLATOR, aud::numeric_string<MPTWrap::default_interpolator>::str,
+            SETTING_SUBSONGS, "TRUE",
             nullptr,
         };
 
@@ -74,21 +339,56 @@ public:
 
     bool is_our_file(const char *filename, VFSFile &file)
     {
-        MPTWrap mpt;
-        return mpt.open(file);
+        return MPTWrap::probe(file);
     }
 
     bool read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *)
     {
-        MPTWrap mpt;
-        if (!mpt.open(file))
+        MPTInfoPtr info = read_info(filename, file);
+        if (!info)
             return false;
 
         tuple.set_filename(filename);
-        tuple.set_format(mpt.format(), mpt.channels(), mpt.rate(), 0);
+        tuple.set_format(info->format, MPTWrap::channels(), MPTWrap::rate(), 0);
+        tuple.set_str(Tuple::Title, info->title);
+
+        int subsongs = info->durations.len();
+        int subsong = tuple.get_int(Tuple::Subtune);
+
+        if (subsongs > 1 && subsong >= 1 && subsong <= subsongs)
+        {
+            const String &name = info->names[subsong - 1];
+
+            tuple.set_int(Tuple::Length, info->durations[subsong - 1]);
+            tuple.set_int(Tuple::NumSubtunes, subsongs);
+            tuple.set_int(Tuple::Track, subsong);
+
+            if (name && name[0])
+            {
+                if (info->title && info->title[0])
+                    tuple.set_str(Tuple::Title, str_concat({info->title, " - ", name}));
+                else
+                    tuple.set_str(Tuple::Title, name);
+            }
+        }
+        else
+        {
+            // the whole module plays all subsongs one after another
+            int length = 0;
+            for (int duration : info->durations)
+                length += duration;
+
+            tuple.set_int(Tuple::Length, length);
 
-        tuple.set_int(Tuple::Length, mpt.duration());
-        tuple.set_str(Tuple::Title, mpt.title());
+            if (subsongs > 1 && aud_get_bool(CFG_SECTION, SETTING_SUBSONGS))
+            {
+                Index<short> list;
+                for (int i = 1; i <= subsongs; i++)
+                    list.append(i);
+
+                tuple.set_subtunes(list.len(), list.begin());
+            }
+        }
 
         return true;
     }
@@ -99,32 +399,44 @@ public:
         if (!mpt.open(file))
             return false;
 
-        force_apply = true;
+        int subsong = 0;
+        uri_parse(filename, nullptr, nullptr, nullptr, &subsong);
+
+        if (subsong >= 1 && !mpt.select_subsong(subsong - 1))
+            return false;
+
+        apply_settings(mpt);
+        force_apply = false;
 
         open_audio(FMT_FLOAT, mpt.rate(), mpt.channels());
 
+        RenderAhead ahead(mpt);
+        if (!ahead.start())
+            return false;
+
         while (!check_stop())
         {
             float buffer[16384];
             int seek_value = check_seek();
 
             if (seek_value >= 0)
-                mpt.seek(seek_value);
+                ahead.seek(seek_value);
 
             if (force_apply)
             {
-                mpt.set_interpolator(aud_get_int(CFG_SECTION, SETTING_INTERPOLATOR));
-                mpt.set_stereo_separation(aud_get_int(CFG_SECTION, SETTING_STEREO_SEPARATION));
+                ahead.apply_settings();
                 force_apply = false;
             }
 
-            auto n = mpt.read(buffer, aud::n_elems(buffer));
+            auto n = ahead.read(buffer, aud::n_elems(buffer));
             if (n == 0)
                 break;
 
             write_audio(buffer, n * sizeof buffer[0]);
         }
 
+        ahead.finish();
+
         return true;
     }
 };
@@ -157,6 +469,11 @@ const PreferencesWidget MPTPlugin::widgets[] =
             N_("Interpolation:"),
             WidgetInt(CFG_SECTION, SETTING_INTERPOLATOR, values_changed),
             { MPTWrap::interpolators }
+    ),
+
+    WidgetCheck(
+            N_("Add each subsong as a playlist entry"),
+            WidgetBool(CFG_SECTION, SETTING_SUBSONGS)
     )
 };
 
@@ -41,6 +41,19 @@ static String to_aud_str(const char * str)
     return aud_str;
 }
 
+// Checks only the first few hundred bytes of the file, without loading it.
+bool MPTWrap::probe(VFSFile &file)
+{
+#if OPENMPT_API_VERSION_MAJOR <= 0 && OPENMPT_API_VERSION_MINOR < 3
+    MPTWrap mpt;
+    return mpt.open(file);
+#else
+    return openmpt_probe_file_header_from_stream(OPENMPT_PROBE_FILE_HEADER_FLAGS_DEFAULT,
+     callbacks, &file, openmpt_log_func_silent, nullptr, nullptr, nullptr,
+     nullptr, nullptr) == OPENMPT_PROBE_FILE_HEADER_RESULT_SUCCESS;
+#endif
+}
+
 bool MPTWrap::open(VFSFile &file)
 {
 #if OPENMPT_API_VERSION_MAJOR <= 0 && OPENMPT_API_VERSION_MINOR < 3
@@ -58,13 +71,36 @@ bool MPTWrap::open(VFSFile &file)
 
     openmpt_module_select_subsong(mod.get(), -1);
 
-    m_duration = openmpt_module_get_duration_seconds(mod.get()) * 1000;
-    m_title = to_aud_str(openmpt_module_get_metadata(mod.get(), "title"));
-    m_format = to_aud_str(openmpt_module_get_metadata(mod.get(), "type_long"));
-
     return true;
 }
 
+// Finding the length of a subsong means playing through it (without mixing),
+// so this is by far the most expensive part of reading a module.  All
+// subsongs are selected in turn; select one of them again before playing.
+void MPTWrap::get_info(MPTInfo &info)
+{
+    info.title = to_aud_str(openmpt_module_get_metadata(mod.get(), "title"));
+    info.format = to_aud_str(openmpt_module_get_metadata(mod.get(), "type_long"));
+
+    int subsongs = openmpt_module_get_num_subsongs(mod.get());
+
+    info.durations.clear();
+    info.names.clear();
+
+    for (int i = 0; i < subsongs; i++)
+    {
+        openmpt_module_select_subsong(mod.get(), i);
+        info.durations.append(openmpt_module_get_duration_seconds(mod.get()) * 1000);
+        info.names.append(to_aud_str(openmpt_module_get_subsong_name(mod.get(), i)));
+    }
+}
+
+// Selects a subsong by index, or -1 to play all of them one after another.
+bool MPTWrap::select_subsong(int subsong)
+{
+    return openmpt_module_select_subsong(mod.get(), subsong);
+}
+
 size_t MPTWrap::stream_read(void *instance, void *buf, size_t n)
 {
     return VFS(instance)->fread(buf, 1, n);
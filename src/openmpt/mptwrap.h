@@ -28,12 +28,22 @@
 #define AUDACIOUS_MPT_MPTWRAP_H
 
 #include <libaudcore/i18n.h>
+#include <libaudcore/index.h>
+#include <libaudcore/objects.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/vfs.h>
 
 #include <libopenmpt/libopenmpt.h>
 #include <libopenmpt/libopenmpt_stream_callbacks_file.h>
 
+struct MPTInfo
+{
+    String title;
+    String format;
+    Index<int> durations;       // in milliseconds, one per subsong
+    Index<String> names;        // one per subsong, mostly empty
+};
+
 class MPTWrap
 {
 public:
@@ -59,17 +69,17 @@ public:
     static bool is_valid_stereo_separation(int);
     void set_stereo_separation(int);
 
+    static bool probe(VFSFile &);
+
     bool open(VFSFile &);
+    void get_info(MPTInfo &);
+    bool select_subsong(int);
     int64_t read(float *, int64_t);
     void seek(int pos);
 
     static constexpr int rate() { return 48000; }
     static constexpr int channels() { return 2; }
 
-    int duration() const { return m_duration; }
-    const String & title() const { return m_title; }
-    const String & format() const { return m_format; }
-
 private:
     static size_t stream_read(void *, void *, size_t);
     static int stream_seek(void *, int64_t, int);
@@ -79,10 +89,6 @@ private:
     static constexpr openmpt_stream_callbacks callbacks = { stream_read, stream_seek, stream_tell };
 
     SmartPtr<openmpt_module, openmpt_module_destroy> mod;
-
-    int m_duration = 0;
-    String m_title;
-    String m_format;
 };
 
 #endif
@@ -8,6 +8,7 @@
 #define __AO_H
 
 #include <stdint.h>
+#include <string.h>
 
 #define WANT_AUD_BSWAP
 #include <libaudcore/audio.h>
@@ -33,6 +34,95 @@ enum
 	COMMAND_JUMP
 };
 
-Index<char> ao_get_lib(char *filename);
+struct PSXCPUState;
+struct PSXHWState;
+struct PSXMemory;
+struct SPUState;
+struct SPU2State;
+struct PSF1State;
+struct PSF2State;
+struct SPXState;
+
+/* One playback of a PSF, PSF2 or SPX file.  The instance owns the state of
+ * every emulator module (CPU, hardware, SPU, SPU2 and the file format
+ * engines), each in a block of its own.  The engine functions take the
+ * instance and bind it to the calling thread, and the modules reach their
+ * block through psf_instance, so several instances can run at the same time
+ * on different threads. */
+class PSFInstance
+{
+public:
+	bool stop_flag = false;
+
+	PSXCPUState *cpu;
+	PSXHWState *hw;
+	PSXMemory *mem;
+	SPUState *spu;
+	SPU2State *spu2;
+	PSF1State *psf;
+	PSF2State *psf2;
+	SPXState *spx;
+
+	PSFInstance();
+	virtual ~PSFInstance();
+
+	/* called to load secondary files */
+	virtual Index<char> get_lib(const char *filename) = 0;
+	/* receives rendered audio; data is null once the song has ended */
+	virtual void update(const void *data, int bytes) = 0;
+
+	/* called between frames, where the engine state may be saved or restored */
+	virtual void checkpoint() {}
+
+	PSFInstance(const PSFInstance &) = delete;
+	PSFInstance &operator=(const PSFInstance &) = delete;
+};
+
+/* The instance bound to the calling thread.  The CPU core goes through it for
+ * almost every register and memory access, so it is a bare __thread pointer:
+ * that needs no initialisation guard, and with the initial-exec model, which
+ * a single pointer can use even in a dlopen()ed plugin, it costs one load
+ * relative to the thread pointer instead of a __tls_get_addr() call. */
+#if defined(__GNUC__)
+# define PSF_THREAD_LOCAL __thread
+#else
+# define PSF_THREAD_LOCAL thread_local
+#endif
+#if defined(__GLIBC__) && defined(__GNUC__)
+# define PSF_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+# define PSF_TLS_MODEL
+#endif
+
+extern PSF_THREAD_LOCAL PSFInstance *psf_instance PSF_TLS_MODEL;
+
+/* Saves or restores engine state for snapshots.  Each module hands every
+ * block of memory holding its state to io(); a loading PSFState walks the
+ * same sequence of calls and copies the blocks back.  Pointers are kept
+ * as-is, so a snapshot can only be restored into the instance that took
+ * it. */
+class PSFState
+{
+public:
+	PSFState(Index<char> &buf, bool loading) : m_buf(buf), m_loading(loading) {}
+
+	void io(void *ptr, int size)
+	{
+		if (m_loading)
+			memcpy(ptr, m_buf.begin() + m_pos, size);
+		else
+			m_buf.insert((const char *)ptr, m_pos, size);
+
+		m_pos += size;
+	}
+
+	template<class T>
+	void io(T &v) { io(&v, sizeof v); }
+
+private:
+	Index<char> &m_buf;
+	bool m_loading;
+	int m_pos = 0;
+};
 
 #endif // AO_H
@@ -45,13 +45,28 @@
 
 #define LE32(x) FROM_LE32(x)
 
-static corlett_t	*c = nullptr;
-static char 		psfby[256];
-int			psf_refresh  = -1;
+struct PSF1State
+{
+	corlett_t	*c;
+	char 		psfby[256];
+	int		psf_refresh = -1;
+
+	uint32_t initialPC, initialGP, initialSP;
+};
+
+#define PSF1 (*psf_instance->psf)
+
+PSF1State *psf_alloc_state(void)
+{
+	return new PSF1State();
+}
 
-static uint32_t initialPC, initialGP, initialSP;
+void psf_free_state(PSF1State *psf)
+{
+	delete psf;
+}
 
-int32_t psf_start(uint8_t *buffer, uint32_t length)
+int32_t psf_start(PSFInstance &inst, uint8_t *buffer, uint32_t length)
 {
 	uint8_t *file, *lib_decoded, *alib_decoded;
 	uint32_t offset, plength, PC, SP, GP, lengthMS, fadeMS;
@@ -60,13 +75,15 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	int i;
 	union cpuinfo mipsinfo;
 
+	psf_instance = &inst;
+
 	// clear PSX work RAM before we start scribbling in it
-	memset(psx_ram, 0, 2*1024*1024);
+	memset(PSXMEM.psx_ram, 0, 2*1024*1024);
 
 //	printf("Length = %d\n", length);
 
 	// Decode the current GSF
-	if (corlett_decode(buffer, length, &file, &file_len, &c) != AO_SUCCESS)
+	if (corlett_decode(buffer, length, &file, &file_len, &PSF1.c) != AO_SUCCESS)
 	{
 		return AO_FAIL;
 	}
@@ -85,16 +102,16 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	offset = file[0x1c] | file[0x1d]<<8 | file[0x1e]<<16 | file[0x1f]<<24;
 	printf("Text section size: %x\n", offset);
 	printf("Region: [%s]\n", &file[0x4c]);
-	printf("refresh: [%s]\n", c->inf_refresh);
+	printf("refresh: [%s]\n", PSF1.c->inf_refresh);
 	#endif
 
-	if (c->inf_refresh[0] == '5')
+	if (PSF1.c->inf_refresh[0] == '5')
 	{
-		psf_refresh = 50;
+		PSF1.psf_refresh = 50;
 	}
-	if (c->inf_refresh[0] == '6')
+	if (PSF1.c->inf_refresh[0] == '6')
 	{
-		psf_refresh = 60;
+		PSF1.psf_refresh = 60;
 	}
 
 	PC = file[0x10] | file[0x11]<<8 | file[0x12]<<16 | file[0x13]<<24;
@@ -106,13 +123,13 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	#endif
 
 	// Get the library file, if any
-	if (c->lib[0] != 0)
+	if (PSF1.c->lib[0] != 0)
 	{
 		#if DEBUG_LOADER
-		printf("Loading library: %s\n", c->lib);
+		printf("Loading library: %s\n", PSF1.c->lib);
 		#endif
 
-		Index<char> buf = ao_get_lib(c->lib);
+		Index<char> buf = inst.get_lib(PSF1.c->lib);
 
 		if (!buf.len())
 			return AO_FAIL;
@@ -137,15 +154,15 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 		#endif
 
 		// if the original file had no refresh tag, give the lib a shot
-		if (psf_refresh == -1)
+		if (PSF1.psf_refresh == -1)
 		{
 			if (lib->inf_refresh[0] == '5')
 			{
-				psf_refresh = 50;
+				PSF1.psf_refresh = 50;
 			}
 			if (lib->inf_refresh[0] == '6')
 			{
-				psf_refresh = 60;
+				PSF1.psf_refresh = 60;
 			}
 		}
 
@@ -171,7 +188,7 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 		#if DEBUG_LOADER
 		printf("library offset: %x plength: %d\n", offset, plength);
 		#endif
-		memcpy(&psx_ram[offset/4], lib_decoded + 2048, plength);
+		memcpy(&PSXMEM.psx_ram[offset/4], lib_decoded + 2048, plength);
 
 		// Dispose the corlett structure for the lib - we don't use it
 		free(lib);
@@ -186,18 +203,18 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	else
 		plength = file_len - 2048;
 
-	memcpy(&psx_ram[offset/4], file + 2048, plength);
+	memcpy(&PSXMEM.psx_ram[offset/4], file + 2048, plength);
 
 	// load any auxiliary libraries now
 	for (i = 0; i < 8; i++)
 	{
-		if (c->libaux[i][0] != 0)
+		if (PSF1.c->libaux[i][0] != 0)
 		{
 			#if DEBUG_LOADER
-			printf("Loading aux library: %s\n", c->libaux[i]);
+			printf("Loading aux library: %s\n", PSF1.c->libaux[i]);
 			#endif
 
-			Index<char> buf = ao_get_lib(c->libaux[i]);
+			Index<char> buf = inst.get_lib(PSF1.c->libaux[i]);
 
 			if (!buf.len())
 				return AO_FAIL;
@@ -229,7 +246,7 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 			else
 				plength = alib_len - 2048;
 
-			memcpy(&psx_ram[offset/4], alib_decoded + 2048, plength);
+			memcpy(&PSXMEM.psx_ram[offset/4], alib_decoded + 2048, plength);
 
 			// Dispose the corlett structure for the lib - we don't use it
 			free(lib);
@@ -240,14 +257,14 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 //	free(lib_decoded);
 
 	// Finally, set psfby tag
-	strcpy(psfby, "n/a");
-	if (c)
+	strcpy(PSF1.psfby, "n/a");
+	if (PSF1.c)
 	{
 		int i;
 		for (i = 0; i < MAX_UNKNOWN_TAGS; i++)
 		{
-			if (!strcmp_nocase(c->tag_name[i], "psfby"))
-				strcpy(psfby, c->tag_data[i]);
+			if (!strcmp_nocase(PSF1.c->tag_name[i], "psfby"))
+				strcpy(PSF1.psfby, PSF1.c->tag_data[i]);
 		}
 	}
 
@@ -257,7 +274,7 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	// set the initial PC, SP, GP
 	#if DEBUG_LOADER
 	printf("Initial PC %x, GP %x, SP %x\n", PC, GP, SP);
-	printf("Refresh = %d\n", psf_refresh);
+	printf("Refresh = %d\n", PSF1.psf_refresh);
 	#endif
 	mipsinfo.i = PC;
 	mips_set_info(CPUINFO_INT_PC, &mipsinfo);
@@ -280,7 +297,7 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 		FILE *f;
 
 		f = fopen("psxram.bin", "wb");
-		fwrite(psx_ram, 2*1024*1024, 1, f);
+		fwrite(PSXMEM.psx_ram, 2*1024*1024, 1, f);
 		fclose(f);
 	}
 	#endif
@@ -289,8 +306,8 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	SPUinit();
 	SPUopen();
 
-	lengthMS = psfTimeToMS(c->inf_length);
-	fadeMS = psfTimeToMS(c->inf_fade);
+	lengthMS = psfTimeToMS(PSF1.c->inf_length);
+	fadeMS = psfTimeToMS(PSF1.c->inf_fade);
 
 	#if DEBUG_LOADER
 	printf("length %d fade %d\n", lengthMS, fadeMS);
@@ -306,50 +323,66 @@ int32_t psf_start(uint8_t *buffer, uint32_t length)
 	// patch illegal Chocobo Dungeon 2 code - CaitSith2 put a jump in the delay slot from a BNE
 	// and rely on Highly Experimental's buggy-ass CPU to rescue them.  Verified on real hardware
 	// that the initial code is wrong.
-	if (!strcmp(c->inf_game, "Chocobo Dungeon 2"))
+	if (!strcmp(PSF1.c->inf_game, "Chocobo Dungeon 2"))
 	{
-		if (psx_ram[0xbc090/4] == LE32(0x0802f040))
+		if (PSXMEM.psx_ram[0xbc090/4] == LE32(0x0802f040))
 		{
-			psx_ram[0xbc090/4] = LE32(0);
-			psx_ram[0xbc094/4] = LE32(0x0802f040);
-			psx_ram[0xbc098/4] = LE32(0);
+			PSXMEM.psx_ram[0xbc090/4] = LE32(0);
+			PSXMEM.psx_ram[0xbc094/4] = LE32(0x0802f040);
+			PSXMEM.psx_ram[0xbc098/4] = LE32(0);
 		}
 	}
 
 //	psx_ram[0x118b8/4] = LE32(0);	// crash 2 hack
 
 	// backup the initial state for restart
-	memcpy(initial_ram, psx_ram, 2*1024*1024);
-	memcpy(initial_scratch, psx_scratch, 0x400);
-	initialPC = PC;
-	initialGP = GP;
-	initialSP = SP;
+	memcpy(PSXMEM.initial_ram, PSXMEM.psx_ram, 2*1024*1024);
+	memcpy(PSXMEM.initial_scratch, PSXMEM.psx_scratch, 0x400);
+	PSF1.initialPC = PC;
+	PSF1.initialGP = GP;
+	PSF1.initialSP = SP;
 
 	mips_execute(5000);
 
 	return AO_SUCCESS;
 }
 
-int32_t psf_execute(void (*update)(const void *, int))
+int32_t psf_execute(PSFInstance &inst)
 {
 	int i;
 
-	while (!stop_flag) {
+	psf_instance = &inst;
+
+	while (!inst.stop_flag) {
+		inst.checkpoint();
+
 		for (i = 0; i < 44100 / 60; i++) {
 			psx_hw_slice();
-			SPUasync(384, update);
+			SPUasync(384, inst);
 		}
 
-		psx_hw_frame();
+		psx_hw_frame(PSF1.psf_refresh);
 	}
 
 	return AO_SUCCESS;
 }
 
-int32_t psf_stop(void)
+void psf_state(PSFInstance &inst, PSFState &state)
+{
+	psf_instance = &inst;
+
+	mips_state(state);
+	psx_hw_state(state);
+	SPUstate(state);
+}
+
+int32_t psf_stop(PSFInstance &inst)
 {
+	psf_instance = &inst;
+
 	SPUclose();
-	free(c);
+	mips_exit();
+	free(PSF1.c);
 
 	return AO_SUCCESS;
 }
@@ -70,16 +70,34 @@
 
 #define LE32(x) FROM_LE32(x)
 
-static corlett_t	*c = nullptr;
+struct PSF2State
+{
+	corlett_t	*c;
+
+	// main RAM
+	uint32_t initialPC, initialSP;
+	uint32_t loadAddr, lengthMS, fadeMS;
+
+	uint8_t *filesys[MAX_FS];
+	Index<char> lib_raw_file;
+	uint32_t fssize[MAX_FS];
+	int num_fs;
 
-// main RAM
-static uint32_t initialPC, initialSP;
-static uint32_t loadAddr, lengthMS, fadeMS;
+	// pending R_MIPS_HI16 relocation in psf2_load_elf()
+	uint32_t hi16offs, hi16target;
+};
 
-static uint8_t *filesys[MAX_FS];
-static Index<char> lib_raw_file;
-static uint32_t fssize[MAX_FS];
-static int num_fs;
+#define PSF2 (*psf_instance->psf2)
+
+PSF2State *psf2_alloc_state(void)
+{
+	return new PSF2State();
+}
+
+void psf2_free_state(PSF2State *psf2)
+{
+	delete psf2;
+}
 
 static void do_iopmod(uint8_t *start, uint32_t offset)
 {
@@ -110,14 +128,14 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 	uint32_t rec;
 //	FILE *f;
 
-	if (loadAddr & 3)
+	if (PSF2.loadAddr & 3)
 	{
-		loadAddr &= ~3;
-		loadAddr += 4;
+		PSF2.loadAddr &= ~3;
+		PSF2.loadAddr += 4;
 	}
 
 	#if DEBUG_LOADER
-	printf("psf2_load_elf: starting at %08x\n", loadAddr | 0x80000000);
+	printf("psf2_load_elf: starting at %08x\n", PSF2.loadAddr | 0x80000000);
 	#endif
 
 	if ((start[0] != 0x7f) || (start[1] != 'E') || (start[2] != 'L') || (start[3] != 'F'))
@@ -160,7 +178,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 				break;
 
 			case 1:			// PROGBITS: copy data to destination
-				memcpy(&psx_ram[(loadAddr + addr)/4], &start[offset], size);
+				memcpy(&PSXMEM.psx_ram[(PSF2.loadAddr + addr)/4], &start[offset], size);
 				totallen += size;
 				break;
 
@@ -171,7 +189,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 				break;
 
 			case 8:			// NOBITS: BSS region, zero out destination
-				memset(&psx_ram[(loadAddr + addr)/4], 0, size);
+				memset(&PSXMEM.psx_ram[(PSF2.loadAddr + addr)/4], 0, size);
 				totallen += size;
 				break;
 
@@ -179,50 +197,49 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 		  		for (rec = 0; rec < (size/8); rec++)
 				{
 					uint32_t offs, info, target, temp, val, vallo;
-					static uint32_t hi16offs = 0, hi16target = 0;
 
 					offs = start[offset+(rec*8)] | start[offset+1+(rec*8)]<<8 | start[offset+2+(rec*8)]<<16 | start[offset+3+(rec*8)]<<24;
 					info = start[offset+4+(rec*8)] | start[offset+5+(rec*8)]<<8 | start[offset+6+(rec*8)]<<16 | start[offset+7+(rec*8)]<<24;
-					target = LE32(psx_ram[(loadAddr+offs)/4]);
+					target = LE32(PSXMEM.psx_ram[(PSF2.loadAddr+offs)/4]);
 
 //					printf("[%04d] offs %08x type %02x info %08x => %08x\n", rec, offs, ELF32_R_TYPE(info), ELF32_R_SYM(info), target);
 
 					switch (ELF32_R_TYPE(info))
 					{
 						case 2:	      	// R_MIPS_32
-							target += loadAddr;
+							target += PSF2.loadAddr;
 //							target |= 0x80000000;
 							break;
 
 						case 4:		// R_MIPS_26
 							temp = (target & 0x03ffffff);
 							target &= 0xfc000000;
-							temp += (loadAddr>>2);
+							temp += (PSF2.loadAddr>>2);
 							target |= temp;
 							break;
 
 						case 5:		// R_MIPS_HI16
-							hi16offs = offs;
-							hi16target = target;
+							PSF2.hi16offs = offs;
+							PSF2.hi16target = target;
 							break;
 
 						case 6:		// R_MIPS_LO16
 							vallo = ((target & 0xffff) ^ 0x8000) - 0x8000;
 
-							val = ((hi16target & 0xffff) << 16) +	vallo;
-							val += loadAddr;
+							val = ((PSF2.hi16target & 0xffff) << 16) +	vallo;
+							val += PSF2.loadAddr;
 //							val |= 0x80000000;
 
 							/* Account for the sign extension that will happen in the low bits.  */
 							val = ((val >> 16) + ((val & 0x8000) != 0)) & 0xffff;
 
-							hi16target = (hi16target & ~0xffff) | val;
+							PSF2.hi16target = (PSF2.hi16target & ~0xffff) | val;
 
 							/* Ok, we're done with the HI16 relocs.  Now deal with the LO16.  */
-							val = loadAddr + vallo;
+							val = PSF2.loadAddr + vallo;
 							target = (target & ~0xffff) | (val & 0xffff);
 
-							psx_ram[(loadAddr+hi16offs)/4] = LE32(hi16target);
+							PSXMEM.psx_ram[(PSF2.loadAddr+PSF2.hi16offs)/4] = LE32(PSF2.hi16target);
 							break;
 
 						default:
@@ -231,7 +248,7 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 							break;
 					}
 
-					psx_ram[(loadAddr+offs)/4] = LE32(target);
+					PSXMEM.psx_ram[(PSF2.loadAddr+offs)/4] = LE32(target);
 				}
 				break;
 
@@ -249,9 +266,9 @@ uint32_t psf2_load_elf(uint8_t *start, uint32_t len)
 		shent += shentsize;
 	}
 
-	entry += loadAddr;
+	entry += PSF2.loadAddr;
 	entry |= 0x80000000;
-	loadAddr += totallen;
+	PSF2.loadAddr += totallen;
 
 	#if DEBUG_LOADER
 	printf("psf2_load_elf: entry PC %08x\n", entry);
@@ -340,7 +357,7 @@ static uint32_t load_file_ex(uint8_t *top, uint8_t *start, uint32_t len, const c
 
 static uint32_t load_file(int fs, const char *file, uint8_t *buf, uint32_t buflen)
 {
-	return load_file_ex(filesys[fs], filesys[fs], fssize[fs], file, buf, buflen);
+	return load_file_ex(PSF2.filesys[fs], PSF2.filesys[fs], PSF2.fssize[fs], file, buf, buflen);
 }
 
 #if 0
@@ -359,8 +376,8 @@ static dump_files(int fs, uint8_t *buf, uint32_t buflen)
 
 	printf("Dumping FS %d\n", fs);
 
-	start = filesys[fs];
-	len = fssize[fs];
+	start = PSF2.filesys[fs];
+	len = PSF2.fssize[fs];
 
 	cptr = start + 4;
 
@@ -422,7 +439,7 @@ uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen)
 	int i;
 	uint32_t flen;
 
-	for (i = 0; i < num_fs; i++)
+	for (i = 0; i < PSF2.num_fs; i++)
 	{
 		flen = load_file(i, file, buf, buflen);
 		if (flen != 0xffffffff)
@@ -434,7 +451,7 @@ uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen)
 	return 0xffffffff;
 }
 
-int32_t psf2_start(uint8_t *buffer, uint32_t length)
+int32_t psf2_start(PSFInstance &inst, uint8_t *buffer, uint32_t length)
 {
 	uint8_t *file, *lib_decoded;
 	uint32_t irx_len;
@@ -443,14 +460,16 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 	union cpuinfo mipsinfo;
 	corlett_t *lib;
 
-	loadAddr = 0x23f00;	// this value makes allocations work out similarly to how they would
+	psf_instance = &inst;
+
+	PSF2.loadAddr = 0x23f00;	// this value makes allocations work out similarly to how they would
 				// in Highly Experimental (as per Shadow Hearts' hard-coded assumptions)
 
 	// clear IOP work RAM before we start scribbling in it
-	memset(psx_ram, 0, 2*1024*1024);
+	memset(PSXMEM.psx_ram, 0, 2*1024*1024);
 
 	// Decode the current PSF2
-	if (corlett_decode(buffer, length, &file, &file_len, &c) != AO_SUCCESS)
+	if (corlett_decode(buffer, length, &file, &file_len, &PSF2.c) != AO_SUCCESS)
 	{
 		return AO_FAIL;
 	}
@@ -459,26 +478,26 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 		printf ("ERROR: PSF2 can't have a program section!  ps %lx\n", (unsigned long) file_len);
 
 	#if DEBUG_LOADER
-	printf("FS section: size %x\n", c->res_size);
+	printf("FS section: size %x\n", PSF2.c->res_size);
 	#endif
 
-	num_fs = 1;
-	filesys[0] = (uint8_t *)c->res_section;
-	fssize[0] = c->res_size;
+	PSF2.num_fs = 1;
+	PSF2.filesys[0] = (uint8_t *)PSF2.c->res_section;
+	PSF2.fssize[0] = PSF2.c->res_size;
 
 	// Get the library file, if any
-	if (c->lib[0] != 0)
+	if (PSF2.c->lib[0] != 0)
 	{
 		#if DEBUG_LOADER
-		printf("Loading library: %s\n", c->lib);
+		printf("Loading library: %s\n", PSF2.c->lib);
 		#endif
 
-		lib_raw_file = ao_get_lib(c->lib);
+		PSF2.lib_raw_file = inst.get_lib(PSF2.c->lib);
 
-		if (!lib_raw_file.len())
+		if (!PSF2.lib_raw_file.len())
 			return AO_FAIL;
 
-		if (corlett_decode((uint8_t *)lib_raw_file.begin(), lib_raw_file.len(),
+		if (corlett_decode((uint8_t *)PSF2.lib_raw_file.begin(), PSF2.lib_raw_file.len(),
 		 &lib_decoded, &lib_len, &lib) != AO_SUCCESS)
 			return AO_FAIL;
 
@@ -486,16 +505,16 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 		printf("Lib FS section: size %x bytes\n", lib->res_size);
 		#endif
 
-		num_fs++;
-		filesys[1] = (uint8_t *)lib->res_section;
- 		fssize[1] = lib->res_size;
+		PSF2.num_fs++;
+		PSF2.filesys[1] = (uint8_t *)lib->res_section;
+ 		PSF2.fssize[1] = lib->res_size;
 	}
 
 	// dump all files
 	#if 0
 	buf = (uint8_t *)malloc(16*1024*1024);
 	dump_files(0, buf, 16*1024*1024);
-	if (c->lib[0] != 0)
+	if (PSF2.c->lib[0] != 0)
 		dump_files(1, buf, 16*1024*1024);
 	free(buf);
 	#endif
@@ -506,31 +525,31 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 
 	if (irx_len != 0xffffffff)
 	{
-		initialPC = psf2_load_elf(buf, irx_len);
-		initialSP = 0x801ffff0;
+		PSF2.initialPC = psf2_load_elf(buf, irx_len);
+		PSF2.initialSP = 0x801ffff0;
 	}
 	free(buf);
 
-	if (initialPC == 0xffffffff)
+	if (PSF2.initialPC == 0xffffffff)
 	{
 		return AO_FAIL;
 	}
 
-	lengthMS = psfTimeToMS(c->inf_length);
-	fadeMS = psfTimeToMS(c->inf_fade);
-	if (lengthMS == 0)
+	PSF2.lengthMS = psfTimeToMS(PSF2.c->inf_length);
+	PSF2.fadeMS = psfTimeToMS(PSF2.c->inf_fade);
+	if (PSF2.lengthMS == 0)
 	{
-		lengthMS = ~0;
+		PSF2.lengthMS = ~0;
 	}
-	setlength2(lengthMS, fadeMS);
+	setlength2(PSF2.lengthMS, PSF2.fadeMS);
 
 	mips_init();
 	mips_reset(nullptr);
 
-	mipsinfo.i = initialPC;
+	mipsinfo.i = PSF2.initialPC;
 	mips_set_info(CPUINFO_INT_PC, &mipsinfo);
 
-	mipsinfo.i = initialSP;
+	mipsinfo.i = PSF2.initialSP;
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_R29, &mipsinfo);
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_R30, &mipsinfo);
 
@@ -544,15 +563,15 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 
 	mipsinfo.i = 0x80000004;	// argv
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_R5, &mipsinfo);
-	psx_ram[1] = LE32(0x80000008);
+	PSXMEM.psx_ram[1] = LE32(0x80000008);
 
-	buf = (uint8_t *)&psx_ram[2];
+	buf = (uint8_t *)&PSXMEM.psx_ram[2];
 	strcpy((char *)buf, "aofile:/");
 
-	psx_ram[0] = LE32(FUNCT_HLECALL);
+	PSXMEM.psx_ram[0] = LE32(FUNCT_HLECALL);
 
 	// back up initial RAM image to quickly restart songs
-	memcpy(initial_ram, psx_ram, 2*1024*1024);
+	memcpy(PSXMEM.initial_ram, PSXMEM.psx_ram, 2*1024*1024);
 
 	psx_hw_init();
 	SPU2init();
@@ -561,15 +580,19 @@ int32_t psf2_start(uint8_t *buffer, uint32_t length)
 	return AO_SUCCESS;
 }
 
-int32_t psf2_execute(void (*update)(const void *, int))
+int32_t psf2_execute(PSFInstance &inst)
 {
 	int i;
 
-	while (!stop_flag)
+	psf_instance = &inst;
+
+	while (!inst.stop_flag)
 	{
+		inst.checkpoint();
+
 		for (i = 0; i < 44100 / 60; i++)
 		{
-			SPU2async(update);
+			SPU2async(inst);
 			ps2_hw_slice();
 		}
 
@@ -579,11 +602,23 @@ int32_t psf2_execute(void (*update)(const void *, int))
 	return AO_SUCCESS;
 }
 
-int32_t psf2_stop(void)
+void psf2_state(PSFInstance &inst, PSFState &state)
+{
+	psf_instance = &inst;
+
+	mips_state(state);
+	psx_hw_state(state);
+	SPU2state(state);
+}
+
+int32_t psf2_stop(PSFInstance &inst)
 {
+	psf_instance = &inst;
+
 	SPU2close();
-	lib_raw_file.clear();
-	free(c);
+	mips_exit();
+	PSF2.lib_raw_file.clear();
+	free(PSF2.c);
 
 	return AO_SUCCESS;
 }
@@ -598,7 +633,7 @@ int32_t psf2_command(int32_t command, int32_t parameter)
 		case COMMAND_RESTART:
 			SPU2close();
 
-			memcpy(psx_ram, initial_ram, 2*1024*1024);
+			memcpy(PSXMEM.psx_ram, PSXMEM.initial_ram, 2*1024*1024);
 
 			mips_init();
 			mips_reset(nullptr);
@@ -606,10 +641,10 @@ int32_t psf2_command(int32_t command, int32_t parameter)
 			SPU2init();
 			SPU2open(nullptr);
 
-			mipsinfo.i = initialPC;
+			mipsinfo.i = PSF2.initialPC;
 			mips_set_info(CPUINFO_INT_PC, &mipsinfo);
 
-			mipsinfo.i = initialSP;
+			mipsinfo.i = PSF2.initialSP;
 			mips_set_info(CPUINFO_INT_REGISTER + MIPS_R29, &mipsinfo);
 			mips_set_info(CPUINFO_INT_REGISTER + MIPS_R30, &mipsinfo);
 
@@ -626,8 +661,8 @@ int32_t psf2_command(int32_t command, int32_t parameter)
 
 			psx_hw_init();
 
-			lengthMS = psfTimeToMS(c->inf_length);
-			fadeMS = psfTimeToMS(c->inf_fade);
+			lengthMS = psfTimeToMS(PSF2.c->inf_length);
+			fadeMS = psfTimeToMS(PSF2.c->inf_fade);
 			if (lengthMS == 0)
 			{
 				lengthMS = ~0;
@@ -642,10 +677,10 @@ int32_t psf2_command(int32_t command, int32_t parameter)
 
 uint32_t psf2_get_loadaddr(void)
 {
-	return loadAddr;
+	return PSF2.loadAddr;
 }
 
 void psf2_set_loadaddr(uint32_t addr)
 {
-	loadAddr = addr;
+	PSF2.loadAddr = addr;
 }
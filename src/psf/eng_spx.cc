@@ -44,22 +44,39 @@
 #include "peops/registers.h"
 #include "peops/spu.h"
 
-static uint8_t *start_of_file, *song_ptr;
-static uint32_t cur_tick, cur_event, num_events, next_tick, end_tick;
-static int old_fmt;
-static char name[128], song[128], company[128];
+struct SPXState
+{
+	uint8_t *start_of_file, *song_ptr;
+	uint32_t cur_tick, cur_event, num_events, next_tick, end_tick;
+	int old_fmt;
+	char name[128], song[128], company[128];
+};
+
+#define SPX (*psf_instance->spx)
+
+SPXState *spx_alloc_state(void)
+{
+	return new SPXState();
+}
+
+void spx_free_state(SPXState *spx)
+{
+	delete spx;
+}
 
-int32_t spx_start(uint8_t *buffer, uint32_t length)
+int32_t spx_start(PSFInstance &inst, uint8_t *buffer, uint32_t length)
 {
 	int i;
 	uint16_t reg;
 
+	psf_instance = &inst;
+
 	if (strncmp((char *)buffer, "SPU", 3) && strncmp((char *)buffer, "SPX", 3))
 	{
 		return AO_FAIL;
 	}
 
-	start_of_file = buffer;
+	SPX.start_of_file = buffer;
 
 	SPUinit();
 	SPUopen();
@@ -76,40 +93,40 @@ int32_t spx_start(uint8_t *buffer, uint32_t length)
 		SPUwriteRegister((i/2)+0x1f801c00, reg);
 	}
 
-	old_fmt = 1;
+	SPX.old_fmt = 1;
 
 	if ((buffer[0x80200] != 0x44) || (buffer[0x80201] != 0xac) || (buffer[0x80202] != 0x00) || (buffer[0x80203] != 0x00))
 	{
-		old_fmt = 0;
+		SPX.old_fmt = 0;
 	}
 
-	if (old_fmt)
+	if (SPX.old_fmt)
 	{
-		num_events = buffer[0x80204] | buffer[0x80205]<<8 | buffer[0x80206]<<16 | buffer[0x80207]<<24;
+		SPX.num_events = buffer[0x80204] | buffer[0x80205]<<8 | buffer[0x80206]<<16 | buffer[0x80207]<<24;
 
-		if (((num_events * 12) + 0x80208) > length)
+		if (((SPX.num_events * 12) + 0x80208) > length)
 		{
-			old_fmt = 0;
+			SPX.old_fmt = 0;
 		}
 		else
 		{
-			cur_tick = 0;
+			SPX.cur_tick = 0;
 		}
 	}
 
-	if (!old_fmt)
+	if (!SPX.old_fmt)
 	{
-		end_tick = buffer[0x80200] | buffer[0x80201]<<8 | buffer[0x80202]<<16 | buffer[0x80203]<<24;
-		cur_tick = buffer[0x80204] | buffer[0x80205]<<8 | buffer[0x80206]<<16 | buffer[0x80207]<<24;
-		next_tick = cur_tick;
+		SPX.end_tick = buffer[0x80200] | buffer[0x80201]<<8 | buffer[0x80202]<<16 | buffer[0x80203]<<24;
+		SPX.cur_tick = buffer[0x80204] | buffer[0x80205]<<8 | buffer[0x80206]<<16 | buffer[0x80207]<<24;
+		SPX.next_tick = SPX.cur_tick;
 	}
 
-	song_ptr = &buffer[0x80208];
-	cur_event = 0;
+	SPX.song_ptr = &buffer[0x80208];
+	SPX.cur_event = 0;
 
-	strncpy((char *)&buffer[4], name, 128);
-	strncpy((char *)&buffer[0x44], song, 128);
-	strncpy((char *)&buffer[0x84], company, 128);
+	strncpy((char *)&buffer[4], SPX.name, 128);
+	strncpy((char *)&buffer[0x44], SPX.song, 128);
+	strncpy((char *)&buffer[0x84], SPX.company, 128);
 
 	return AO_SUCCESS;
 }
@@ -120,74 +137,74 @@ static void spx_tick(void)
 	uint16_t rdata;
 	uint8_t opcode;
 
-	if (old_fmt)
+	if (SPX.old_fmt)
 	{
-		time = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
+		time = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
 
-		while ((time == cur_tick) && (cur_event < num_events))
+		while ((time == SPX.cur_tick) && (SPX.cur_event < SPX.num_events))
 		{
-			reg = song_ptr[4] | song_ptr[5]<<8 | song_ptr[6]<<16 | song_ptr[7]<<24;
-			rdata = song_ptr[8] | song_ptr[9]<<8;
+			reg = SPX.song_ptr[4] | SPX.song_ptr[5]<<8 | SPX.song_ptr[6]<<16 | SPX.song_ptr[7]<<24;
+			rdata = SPX.song_ptr[8] | SPX.song_ptr[9]<<8;
 
 			SPUwriteRegister(reg, rdata);
 
-			cur_event++;
-			song_ptr += 12;
+			SPX.cur_event++;
+			SPX.song_ptr += 12;
 
-			time = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
+			time = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
 		}
 	}
 	else
 	{
-		if (cur_tick < end_tick)
+		if (SPX.cur_tick < SPX.end_tick)
 		{
-			while (cur_tick == next_tick)
+			while (SPX.cur_tick == SPX.next_tick)
 			{
-				opcode = song_ptr[0];
-				song_ptr++;
+				opcode = SPX.song_ptr[0];
+				SPX.song_ptr++;
 
 				switch (opcode)
 				{
 					case 0:	// write register
-						reg = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
-						rdata = song_ptr[4] | song_ptr[5]<<8;
+						reg = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
+						rdata = SPX.song_ptr[4] | SPX.song_ptr[5]<<8;
 
 						SPUwriteRegister(reg, rdata);
 
-						next_tick = song_ptr[6] | song_ptr[7]<<8 | song_ptr[8]<<16 | song_ptr[9]<<24;
-						song_ptr += 10;
+						SPX.next_tick = SPX.song_ptr[6] | SPX.song_ptr[7]<<8 | SPX.song_ptr[8]<<16 | SPX.song_ptr[9]<<24;
+						SPX.song_ptr += 10;
 						break;
 
 					case 1:	// read register
-				 		reg = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
+				 		reg = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
 						SPUreadRegister(reg);
-						next_tick = song_ptr[4] | song_ptr[5]<<8 | song_ptr[6]<<16 | song_ptr[7]<<24;
-						song_ptr += 8;
+						SPX.next_tick = SPX.song_ptr[4] | SPX.song_ptr[5]<<8 | SPX.song_ptr[6]<<16 | SPX.song_ptr[7]<<24;
+						SPX.song_ptr += 8;
 						break;
 
 					case 2: // dma write
-						size = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
-						song_ptr += (4 + size);
-						next_tick = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
-						song_ptr += 4;
+						size = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
+						SPX.song_ptr += (4 + size);
+						SPX.next_tick = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
+						SPX.song_ptr += 4;
 						break;
 
 					case 3: // dma read
-						next_tick = song_ptr[4] | song_ptr[5]<<8 | song_ptr[6]<<16 | song_ptr[7]<<24;
-						song_ptr += 8;
+						SPX.next_tick = SPX.song_ptr[4] | SPX.song_ptr[5]<<8 | SPX.song_ptr[6]<<16 | SPX.song_ptr[7]<<24;
+						SPX.song_ptr += 8;
 						break;
 
 					case 4: // xa play
-						song_ptr += (32 + 16384);
-						next_tick = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
-						song_ptr += 4;
+						SPX.song_ptr += (32 + 16384);
+						SPX.next_tick = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
+						SPX.song_ptr += 4;
 						break;
 
 					case 5: // cdda play
-						size = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
-						song_ptr += (4 + size);
-						next_tick = song_ptr[0] | song_ptr[1]<<8 | song_ptr[2]<<16 | song_ptr[3]<<24;
-						song_ptr += 4;
+						size = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
+						SPX.song_ptr += (4 + size);
+						SPX.next_tick = SPX.song_ptr[0] | SPX.song_ptr[1]<<8 | SPX.song_ptr[2]<<16 | SPX.song_ptr[3]<<24;
+						SPX.song_ptr += 4;
 						break;
 
 					default:
@@ -199,18 +216,23 @@ static void spx_tick(void)
 		}
 	}
 
-	cur_tick++;
+	SPX.cur_tick++;
 }
 
-int32_t spx_execute(void (*update)(const void *, int))
+int32_t spx_execute(PSFInstance &inst)
 {
-	int i, run = 1;
+	int i, run;
+
+	psf_instance = &inst;
 
-	while (!stop_flag)
+	while (!inst.stop_flag)
 	{
-		if (old_fmt && (cur_event >= num_events))
+		inst.checkpoint();
+
+		run = 1;
+		if (SPX.old_fmt && (SPX.cur_event >= SPX.num_events))
 			run = 0;
-		else if (cur_tick >= end_tick)
+		else if (SPX.cur_tick >= SPX.end_tick)
 			run = 0;
 
 		if (run)
@@ -218,7 +240,7 @@ int32_t spx_execute(void (*update)(const void *, int))
 			for (i = 0; i < 44100 / 60; i++)
 			{
 			  	spx_tick();
-				SPUasync(384, update);
+				SPUasync(384, inst);
 			}
 		}
 	}
@@ -226,8 +248,21 @@ int32_t spx_execute(void (*update)(const void *, int))
 	return AO_SUCCESS;
 }
 
-int32_t spx_stop(void)
+void spx_state(PSFInstance &inst, PSFState &state)
+{
+	psf_instance = &inst;
+
+	SPUstate(state);
+	state.io(SPX.song_ptr);
+	state.io(SPX.cur_tick);
+	state.io(SPX.cur_event);
+	state.io(SPX.next_tick);
+}
+
+int32_t spx_stop(PSFInstance &inst)
 {
+	psf_instance = &inst;
+
 	SPUclose();
 
 	return AO_SUCCESS;
@@ -127,10 +127,8 @@ typedef struct
  int               bStop;                              // is channel stopped (sample _can_ still be playing, ADSR Release phase)
  int               iActFreq;                           // current psx pitch
  int               iUsedFreq;                          // current pc pitch
- int               iLeftVolume;                        // left volume
  int               iLeftVolRaw;                        // left psx volume value
  int               bIgnoreLoop;                        // ignore loop bit, if an external loop address is used
- int               iRightVolume;                       // right volume
  int               iRightVolRaw;                       // right psx volume value
  int               iRawPitch;                          // raw pitch (0...3fff)
  int               iIrqDone;                           // debug irq done flag
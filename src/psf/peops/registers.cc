@@ -59,7 +59,7 @@ static void SetPitch(int ch,u16 val);
 void SPUwriteRegister(u32 reg, u16 val)
 {
  const u32 r=reg&0xfff;
- regArea[(r-0xc00)>>1] = val;
+ SPU.regArea[(r-0xc00)>>1] = val;
 
 // printf("SPUwrite: r %x val %x\n", r, val);
 
@@ -85,17 +85,17 @@ void SPUwriteRegister(u32 reg, u16 val)
        break;
      //------------------------------------------------// start
      case 6:
-       s_chan[ch].pStart=spuMemC+((u32) val<<3);
+       SPU.s_chan[ch].pStart=SPU.spuMemC+((u32) val<<3);
        break;
      //------------------------------------------------// level with pre-calcs
      case 8:
        {
         const u32 lval=val; // DEBUG CHECK
         //---------------------------------------------//
-        s_chan[ch].ADSRX.AttackModeExp=(lval&0x8000)?1:0;
-        s_chan[ch].ADSRX.AttackRate=(lval>>8) & 0x007f;
-        s_chan[ch].ADSRX.DecayRate=(lval>>4) & 0x000f;
-        s_chan[ch].ADSRX.SustainLevel=lval & 0x000f;
+        SPU.s_chan[ch].ADSRX.AttackModeExp=(lval&0x8000)?1:0;
+        SPU.s_chan[ch].ADSRX.AttackRate=(lval>>8) & 0x007f;
+        SPU.s_chan[ch].ADSRX.DecayRate=(lval>>4) & 0x000f;
+        SPU.s_chan[ch].ADSRX.SustainLevel=lval & 0x000f;
         //---------------------------------------------//
       }
       break;
@@ -105,11 +105,11 @@ void SPUwriteRegister(u32 reg, u16 val)
        const u32 lval=val; // DEBUG CHECK
 
        //----------------------------------------------//
-       s_chan[ch].ADSRX.SustainModeExp = (lval&0x8000)?1:0;
-       s_chan[ch].ADSRX.SustainIncrease= (lval&0x4000)?0:1;
-       s_chan[ch].ADSRX.SustainRate = (lval>>6) & 0x007f;
-       s_chan[ch].ADSRX.ReleaseModeExp = (lval&0x0020)?1:0;
-       s_chan[ch].ADSRX.ReleaseRate = lval & 0x001f;
+       SPU.s_chan[ch].ADSRX.SustainModeExp = (lval&0x8000)?1:0;
+       SPU.s_chan[ch].ADSRX.SustainIncrease= (lval&0x4000)?0:1;
+       SPU.s_chan[ch].ADSRX.SustainRate = (lval>>6) & 0x007f;
+       SPU.s_chan[ch].ADSRX.ReleaseModeExp = (lval&0x0020)?1:0;
+       SPU.s_chan[ch].ADSRX.ReleaseRate = lval & 0x001f;
        //----------------------------------------------//
       }
      break;
@@ -118,8 +118,8 @@ void SPUwriteRegister(u32 reg, u16 val)
      //  break;
      //------------------------------------------------//
      case 0xE:                                          // loop?
-       s_chan[ch].pLoop=spuMemC+((u32) val<<3);
-       s_chan[ch].bIgnoreLoop=1;
+       SPU.s_chan[ch].pLoop=SPU.spuMemC+((u32) val<<3);
+       SPU.s_chan[ch].bIgnoreLoop=1;
        break;
      //------------------------------------------------//
     }
@@ -130,40 +130,40 @@ void SPUwriteRegister(u32 reg, u16 val)
    {
     //-------------------------------------------------//
     case H_SPUaddr:
-      spuAddr = (u32) val<<3;
+      SPU.spuAddr = (u32) val<<3;
       break;
     //-------------------------------------------------//
     case H_SPUdata:
-      spuMem[spuAddr>>1] = BFLIP16(val);
-      spuAddr+=2;
-      if(spuAddr>0x7ffff) spuAddr=0;
+      SPU.spuMem[SPU.spuAddr>>1] = BFLIP16(val);
+      SPU.spuAddr+=2;
+      if(SPU.spuAddr>0x7ffff) SPU.spuAddr=0;
       break;
     //-------------------------------------------------//
     case H_SPUctrl:
-      spuCtrl=val;
+      SPU.spuCtrl=val;
       break;
     //-------------------------------------------------//
     case H_SPUstat:
-      spuStat=val & 0xf800;
+      SPU.spuStat=val & 0xf800;
       break;
     //-------------------------------------------------//
     case H_SPUReverbAddr:
       if(val==0xFFFF || val<=0x200)
-       {rvb.StartAddr=rvb.CurrAddr=0;}
+       {SPU.rvb.StartAddr=SPU.rvb.CurrAddr=0;}
       else
        {
         const s32 iv=(u32)val<<2;
-        if(rvb.StartAddr!=iv)
+        if(SPU.rvb.StartAddr!=iv)
          {
-          rvb.StartAddr=(u32)val<<2;
-          rvb.CurrAddr=rvb.StartAddr;
+          SPU.rvb.StartAddr=(u32)val<<2;
+          SPU.rvb.CurrAddr=SPU.rvb.StartAddr;
          }
        }
       break;
     //-------------------------------------------------//
     case H_SPUirqAddr:
-      spuIrq = val;
-      pSpuIrq=spuMemC+((u32) val<<3);
+      SPU.spuIrq = val;
+      SPU.pSpuIrq=SPU.spuMemC+((u32) val<<3);
       break;
     //-------------------------------------------------//
     /* Volume settings appear to be at least 15-bit unsigned in this case.
@@ -171,12 +171,12 @@ void SPUwriteRegister(u32 reg, u16 val)
        Check out "Chrono Cross:  Shadow's End Forest"
     */
     case H_SPUrvolL:
-      rvb.VolLeft=(s16)val;
+      SPU.rvb.VolLeft=(s16)val;
       //printf("%d\n",val);
       break;
     //-------------------------------------------------//
     case H_SPUrvolR:
-      rvb.VolRight=(s16)val;
+      SPU.rvb.VolRight=(s16)val;
       //printf("%d\n",val);
       break;
     //-------------------------------------------------//
@@ -242,52 +242,52 @@ void SPUwriteRegister(u32 reg, u16 val)
       break;
     //-------------------------------------------------//
     case H_RVBon1:
-      rvb.Enabled&=~0xFFFF;
-      rvb.Enabled|=val;
+      SPU.rvb.Enabled&=~0xFFFF;
+      SPU.rvb.Enabled|=val;
       break;
 
     //-------------------------------------------------//
     case H_RVBon2:
-      rvb.Enabled&=0xFFFF;
-      rvb.Enabled|=val<<16;
+      SPU.rvb.Enabled&=0xFFFF;
+      SPU.rvb.Enabled|=val<<16;
       break;
 
     //-------------------------------------------------//
     case H_Reverb+0:
-      rvb.FB_SRC_A=val;
+      SPU.rvb.FB_SRC_A=val;
       break;
 
-    case H_Reverb+2   : rvb.FB_SRC_B=(s16)val;       break;
-    case H_Reverb+4   : rvb.IIR_ALPHA=(s16)val;      break;
-    case H_Reverb+6   : rvb.ACC_COEF_A=(s16)val;     break;
-    case H_Reverb+8   : rvb.ACC_COEF_B=(s16)val;     break;
-    case H_Reverb+10  : rvb.ACC_COEF_C=(s16)val;     break;
-    case H_Reverb+12  : rvb.ACC_COEF_D=(s16)val;     break;
-    case H_Reverb+14  : rvb.IIR_COEF=(s16)val;       break;
-    case H_Reverb+16  : rvb.FB_ALPHA=(s16)val;       break;
-    case H_Reverb+18  : rvb.FB_X=(s16)val;           break;
-    case H_Reverb+20  : rvb.IIR_DEST_A0=(s16)val;    break;
-    case H_Reverb+22  : rvb.IIR_DEST_A1=(s16)val;    break;
-    case H_Reverb+24  : rvb.ACC_SRC_A0=(s16)val;     break;
-    case H_Reverb+26  : rvb.ACC_SRC_A1=(s16)val;     break;
-    case H_Reverb+28  : rvb.ACC_SRC_B0=(s16)val;     break;
-    case H_Reverb+30  : rvb.ACC_SRC_B1=(s16)val;     break;
-    case H_Reverb+32  : rvb.IIR_SRC_A0=(s16)val;     break;
-    case H_Reverb+34  : rvb.IIR_SRC_A1=(s16)val;     break;
-    case H_Reverb+36  : rvb.IIR_DEST_B0=(s16)val;    break;
-    case H_Reverb+38  : rvb.IIR_DEST_B1=(s16)val;    break;
-    case H_Reverb+40  : rvb.ACC_SRC_C0=(s16)val;     break;
-    case H_Reverb+42  : rvb.ACC_SRC_C1=(s16)val;     break;
-    case H_Reverb+44  : rvb.ACC_SRC_D0=(s16)val;     break;
-    case H_Reverb+46  : rvb.ACC_SRC_D1=(s16)val;     break;
-    case H_Reverb+48  : rvb.IIR_SRC_B1=(s16)val;     break;
-    case H_Reverb+50  : rvb.IIR_SRC_B0=(s16)val;     break;
-    case H_Reverb+52  : rvb.MIX_DEST_A0=(s16)val;    break;
-    case H_Reverb+54  : rvb.MIX_DEST_A1=(s16)val;    break;
-    case H_Reverb+56  : rvb.MIX_DEST_B0=(s16)val;    break;
-    case H_Reverb+58  : rvb.MIX_DEST_B1=(s16)val;    break;
-    case H_Reverb+60  : rvb.IN_COEF_L=(s16)val;      break;
-    case H_Reverb+62  : rvb.IN_COEF_R=(s16)val;      break;
+    case H_Reverb+2   : SPU.rvb.FB_SRC_B=(s16)val;       break;
+    case H_Reverb+4   : SPU.rvb.IIR_ALPHA=(s16)val;      break;
+    case H_Reverb+6   : SPU.rvb.ACC_COEF_A=(s16)val;     break;
+    case H_Reverb+8   : SPU.rvb.ACC_COEF_B=(s16)val;     break;
+    case H_Reverb+10  : SPU.rvb.ACC_COEF_C=(s16)val;     break;
+    case H_Reverb+12  : SPU.rvb.ACC_COEF_D=(s16)val;     break;
+    case H_Reverb+14  : SPU.rvb.IIR_COEF=(s16)val;       break;
+    case H_Reverb+16  : SPU.rvb.FB_ALPHA=(s16)val;       break;
+    case H_Reverb+18  : SPU.rvb.FB_X=(s16)val;           break;
+    case H_Reverb+20  : SPU.rvb.IIR_DEST_A0=(s16)val;    break;
+    case H_Reverb+22  : SPU.rvb.IIR_DEST_A1=(s16)val;    break;
+    case H_Reverb+24  : SPU.rvb.ACC_SRC_A0=(s16)val;     break;
+    case H_Reverb+26  : SPU.rvb.ACC_SRC_A1=(s16)val;     break;
+    case H_Reverb+28  : SPU.rvb.ACC_SRC_B0=(s16)val;     break;
+    case H_Reverb+30  : SPU.rvb.ACC_SRC_B1=(s16)val;     break;
+    case H_Reverb+32  : SPU.rvb.IIR_SRC_A0=(s16)val;     break;
+    case H_Reverb+34  : SPU.rvb.IIR_SRC_A1=(s16)val;     break;
+    case H_Reverb+36  : SPU.rvb.IIR_DEST_B0=(s16)val;    break;
+    case H_Reverb+38  : SPU.rvb.IIR_DEST_B1=(s16)val;    break;
+    case H_Reverb+40  : SPU.rvb.ACC_SRC_C0=(s16)val;     break;
+    case H_Reverb+42  : SPU.rvb.ACC_SRC_C1=(s16)val;     break;
+    case H_Reverb+44  : SPU.rvb.ACC_SRC_D0=(s16)val;     break;
+    case H_Reverb+46  : SPU.rvb.ACC_SRC_D1=(s16)val;     break;
+    case H_Reverb+48  : SPU.rvb.IIR_SRC_B1=(s16)val;     break;
+    case H_Reverb+50  : SPU.rvb.IIR_SRC_B0=(s16)val;     break;
+    case H_Reverb+52  : SPU.rvb.MIX_DEST_A0=(s16)val;    break;
+    case H_Reverb+54  : SPU.rvb.MIX_DEST_A1=(s16)val;    break;
+    case H_Reverb+56  : SPU.rvb.MIX_DEST_B0=(s16)val;    break;
+    case H_Reverb+58  : SPU.rvb.MIX_DEST_B1=(s16)val;    break;
+    case H_Reverb+60  : SPU.rvb.IN_COEF_L=(s16)val;      break;
+    case H_Reverb+62  : SPU.rvb.IN_COEF_R=(s16)val;      break;
    }
 
 }
@@ -307,18 +307,18 @@ u16 SPUreadRegister(u32 reg)
      case 0xC:                                          // get adsr vol
       {
        const int ch=(r>>4)-0xc0;
-       if(s_chan[ch].bNew) return 1;                   // we are started, but not processed? return 1
-       if(s_chan[ch].ADSRX.lVolume &&                  // same here... we haven't decoded one sample yet, so no envelope yet. return 1 as well
-          !s_chan[ch].ADSRX.EnvelopeVol)
+       if(SPU.s_chan[ch].bNew) return 1;                   // we are started, but not processed? return 1
+       if(SPU.s_chan[ch].ADSRX.lVolume &&                  // same here... we haven't decoded one sample yet, so no envelope yet. return 1 as well
+          !SPU.s_chan[ch].ADSRX.EnvelopeVol)
         return 1;
-       return (u16)(s_chan[ch].ADSRX.EnvelopeVol>>16);
+       return (u16)(SPU.s_chan[ch].ADSRX.EnvelopeVol>>16);
       }
 
      case 0xE:                                          // get loop address
       {
        const int ch=(r>>4)-0xc0;
-       if(s_chan[ch].pLoop==nullptr) return 0;
-       return (u16)((s_chan[ch].pLoop-spuMemC)>>3);
+       if(SPU.s_chan[ch].pLoop==nullptr) return 0;
+       return (u16)((SPU.s_chan[ch].pLoop-SPU.spuMemC)>>3);
       }
     }
   }
@@ -326,24 +326,24 @@ u16 SPUreadRegister(u32 reg)
  switch(r)
   {
     case H_SPUctrl:
-     return spuCtrl;
+     return SPU.spuCtrl;
 
     case H_SPUstat:
-     return spuStat;
+     return SPU.spuStat;
 
     case H_SPUaddr:
-     return (u16)(spuAddr>>3);
+     return (u16)(SPU.spuAddr>>3);
 
     case H_SPUdata:
      {
-      u16 s=BFLIP16(spuMem[spuAddr>>1]);
-      spuAddr+=2;
-      if(spuAddr>0x7ffff) spuAddr=0;
+      u16 s=BFLIP16(SPU.spuMem[SPU.spuAddr>>1]);
+      SPU.spuAddr+=2;
+      if(SPU.spuAddr>0x7ffff) SPU.spuAddr=0;
       return s;
      }
 
     case H_SPUirqAddr:
-     return spuIrq;
+     return SPU.spuIrq;
 
     //case H_SPUIsOn1:
     // return IsSoundOn(0,16);
@@ -353,7 +353,7 @@ u16 SPUreadRegister(u32 reg)
 
   }
 
- return regArea[(r-0xc00)>>1];
+ return SPU.regArea[(r-0xc00)>>1];
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -366,10 +366,10 @@ static void SoundOn(int start,int end,u16 val)     // SOUND ON PSX COMAND
 
  for(ch=start;ch<end;ch++,val>>=1)                     // loop channels
   {
-   if((val&1) && s_chan[ch].pStart)                    // mmm... start has to be set before key on !?!
+   if((val&1) && SPU.s_chan[ch].pStart)                    // mmm... start has to be set before key on !?!
     {
-     s_chan[ch].bIgnoreLoop=0;
-     s_chan[ch].bNew=1;
+     SPU.s_chan[ch].bIgnoreLoop=0;
+     SPU.s_chan[ch].bNew=1;
     }
   }
 }
@@ -385,7 +385,7 @@ static void SoundOff(int start,int end,u16 val)    // SOUND OFF PSX COMMAND
   {
    if(val&1)                                           // && s_chan[i].bOn)  mmm...
     {
-     s_chan[ch].bStop=1;
+     SPU.s_chan[ch].bStop=1;
     }
   }
 }
@@ -404,13 +404,13 @@ static void FModOn(int start,int end,u16 val)      // FMOD ON PSX COMMAND
     {
      if(ch>0)
       {
-       s_chan[ch].bFMod=1;                             // --> sound channel
-       s_chan[ch-1].bFMod=2;                           // --> freq channel
+       SPU.s_chan[ch].bFMod=1;                             // --> sound channel
+       SPU.s_chan[ch-1].bFMod=2;                           // --> freq channel
       }
     }
    else
     {
-     s_chan[ch].bFMod=0;                               // --> turn off fmod
+     SPU.s_chan[ch].bFMod=0;                               // --> turn off fmod
     }
   }
 }
@@ -427,11 +427,11 @@ static void NoiseOn(int start,int end,u16 val)     // NOISE ON PSX COMMAND
   {
    if(val&1)                                           // -> noise on/off
     {
-     s_chan[ch].bNoise=1;
+     SPU.s_chan[ch].bNoise=1;
     }
    else
     {
-     s_chan[ch].bNoise=0;
+     SPU.s_chan[ch].bNoise=0;
     }
   }
 }
@@ -447,9 +447,9 @@ static void SetVolumeLR(int right, u8 ch,s16 vol)            // LEFT VOLUME
  //if(vol&0xc000)
  //printf("%d %08x\n",right,vol);
  if(right)
-  s_chan[ch].iRightVolRaw=vol;
+  SPU.s_chan[ch].iRightVolRaw=vol;
  else
-  s_chan[ch].iLeftVolRaw=vol;
+  SPU.s_chan[ch].iLeftVolRaw=vol;
 
  if(vol&0x8000)                                        // sweep?
   {
@@ -475,9 +475,9 @@ static void SetVolumeLR(int right, u8 ch,s16 vol)            // LEFT VOLUME
    // vol&=0x3fff;
   }
  if(right)
-  s_chan[ch].iRightVolume=vol;
+  SPU.voiceVolR[ch]=vol;
  else
-  s_chan[ch].iLeftVolume=vol;                           // store volume
+  SPU.voiceVolL[ch]=vol;                                    // store volume
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -490,9 +490,9 @@ static void SetPitch(int ch,u16 val)               // SET PITCH
  if(val>0x3fff) NP=0x3fff;                             // get pitch val
  else           NP=val;
 
- s_chan[ch].iRawPitch=NP;
+ SPU.s_chan[ch].iRawPitch=NP;
 
  NP=(44100L*NP)/4096L;                                 // calc frequency
  if(NP<1) NP=1;                                        // some security
- s_chan[ch].iActFreq=NP;                               // store frequency
+ SPU.s_chan[ch].iActFreq=NP;                               // store frequency
 }
@@ -83,6 +83,7 @@
 #include "../peops/externals.h"
 #include "../peops/registers.h"
 #include "../peops/spu.h"
+#include "../spumix.h"
 
 // Enable experimental silence skipping
 // Currently it is too aggressive, destroying the rhythm of some songs
@@ -96,29 +97,71 @@
 // globals
 ////////////////////////////////////////////////////////////////////////
 
+// everything one PSFInstance's SPU works on, including the state of the
+// reverb and ADSR code included below
+
+struct SPUState
+{
 // psx buffer / addresses
 
-static u16  regArea[0x200];
-static u16  spuMem[256*1024];
-static u8 * spuMemC;
-static u8 * pSpuIrq=0;
-static u8 * pSpuBuffer;
+ u16  regArea[0x200];
+ u16  spuMem[256*1024];
+ u8 * spuMemC;
+ u8 * pSpuIrq;
+ u8 * pSpuBuffer;
 
 // user settings
-static int             iVolume;
+ int             iVolume;
 
 // MAIN infos struct for each channel
 
-static SPUCHAN         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
-static REVERBInfo      rvb;
+ SPUCHAN         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
+ REVERBInfo      rvb;
+
+// voice volumes and the per-sample inputs of the voice mixer (spumix.h),
+// kept apart from s_chan so they can be processed across voices
+ s32   voiceVolL[MAXCHAN];
+ s32   voiceVolR[MAXCHAN];
+ s32   mixDry[MAXCHAN];                         // sample of each voice for the main mix
+ s32   mixRvb[MAXCHAN];                         // ... and for the reverb send
+
+ u32   dwNoiseVal=1;                          // global noise generator
+
+ u16  spuCtrl;                                  // some vars to store psx reg infos
+ u16  spuStat;
+ u16  spuIrq;
+ u32  spuAddr=0xffffffff;                    // address into spu mem
+ int  bSPUIsOpen;
+
+ s16 * pS;
+ s32 ttemp;
+
+ u32 sampcount;
+ u32 decaybegin;
+ u32 decayend;
+ u32 seektime;
+ int endless;
+
+// reverb.cc
+ s32 downbuf[2][8];
+ s32 upbuf[2][8];
+ int dbpos,ubpos;
 
-static u32   dwNoiseVal=1;                          // global noise generator
+// adsr.cc
+ u32 RateTable[160];
+};
 
-static u16  spuCtrl=0;                             // some vars to store psx reg infos
-static u16  spuStat=0;
-static u16  spuIrq=0;
-static u32  spuAddr=0xffffffff;                    // address into spu mem
-static int  bSPUIsOpen=0;
+#define SPU (*psf_instance->spu)
+
+SPUState *SPUalloc_state(void)
+{
+ return new SPUState();
+}
+
+void SPUfree_state(SPUState *spu)
+{
+ delete spu;
+}
 
 static const int f[5][2] = {
 			{    0,  0  },
@@ -126,8 +169,6 @@ static const int f[5][2] = {
                         {  115, -52 },
                         {   98, -55 },
                         {  122, -60 } };
-static s16 * pS;
-static s32 ttemp;
 
 ////////////////////////////////////////////////////////////////////////
 // CODE AREA
@@ -145,8 +186,8 @@ static s32 ttemp;
 ////////////////////////////////////////////////////////////////////////
 // helpers for so-called "gauss interpolation"
 
-#define gval0 (((int *)(&s_chan[ch].SB[29]))[gpos])
-#define gval(x) (((int *)(&s_chan[ch].SB[29]))[(gpos+x)&3])
+#define gval0 (((int *)(&spu.s_chan[ch].SB[29]))[gpos])
+#define gval(x) (((int *)(&spu.s_chan[ch].SB[29]))[(gpos+x)&3])
 
 #include "gauss_i.h"
 
@@ -156,24 +197,24 @@ static s32 ttemp;
 // START SOUND... called by main thread to setup a new sound on a channel
 ////////////////////////////////////////////////////////////////////////
 
-static inline void StartSound(int ch)
+static inline void StartSound(SPUState &spu,int ch)
 {
- StartADSR(ch);
+ StartADSR(spu,ch);
 
- s_chan[ch].pCurr=s_chan[ch].pStart;                   // set sample start
+ spu.s_chan[ch].pCurr=spu.s_chan[ch].pStart;                   // set sample start
 
- s_chan[ch].s_1=0;                                     // init mixing vars
- s_chan[ch].s_2=0;
- s_chan[ch].iSBPos=28;
+ spu.s_chan[ch].s_1=0;                                     // init mixing vars
+ spu.s_chan[ch].s_2=0;
+ spu.s_chan[ch].iSBPos=28;
 
- s_chan[ch].bNew=0;                                    // init channel flags
- s_chan[ch].bStop=0;
- s_chan[ch].bOn=1;
+ spu.s_chan[ch].bNew=0;                                    // init channel flags
+ spu.s_chan[ch].bStop=0;
+ spu.s_chan[ch].bOn=1;
 
- s_chan[ch].SB[29]=0;                                  // init our interpolation helpers
- s_chan[ch].SB[30]=0;
+ spu.s_chan[ch].SB[29]=0;                                  // init our interpolation helpers
+ spu.s_chan[ch].SB[30]=0;
 
- s_chan[ch].spos=0x40000L;s_chan[ch].SB[28]=0;  // -> start with more decoding
+ spu.s_chan[ch].spos=0x40000L;spu.s_chan[ch].SB[28]=0;  // -> start with more decoding
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -182,58 +223,59 @@ static inline void StartSound(int ch)
 // basically the whole sound processing is done in this fat func!
 ////////////////////////////////////////////////////////////////////////
 
-static u32 sampcount;
-static u32 decaybegin;
-static u32 decayend;
-
-static u32 seektime;
-int psf_seek(u32 t)
+int psf_seek(PSFInstance &inst, u32 t)
 {
- seektime=t*441/10;
- if(seektime>=sampcount) return(1);
+ SPUState &spu=*inst.spu;
+ spu.seektime=t*441/10;
+ if(spu.seektime>=spu.sampcount) return(1);
  return(0);
 }
 
-static int endless;
-void setendless(int e)
+u32 psf_tell(PSFInstance &inst)
 {
- endless=e;
+ return (u64)inst.spu->sampcount*10/441;
+}
+
+void setendless(PSFInstance &inst, int e)
+{
+ inst.spu->endless=e;
 }
 
 // Counting to 65536 results in full volume offage.
 void setlength(s32 stop, s32 fade)
 {
- if(stop==~0 || endless)
+ if(stop==~0 || SPU.endless)
  {
-  decaybegin=~0;
+  SPU.decaybegin=~0;
  }
  else
  {
   stop=(stop*441)/10;
   fade=(fade*441)/10;
 
-  decaybegin=stop;
-  decayend=stop+fade;
+  SPU.decaybegin=stop;
+  SPU.decayend=stop+fade;
  }
 }
 
 #define CLIP(_x) {if(_x>32767) _x=32767; if(_x<-32767) _x=-32767;}
-int SPUasync(u32 cycles, void (*update)(const void *, int))
+int SPUasync(u32 cycles, PSFInstance &inst)
 {
- int volmul=iVolume;
- static s32 dosampies;
+ SPUState &spu=*inst.spu;
+ int volmul=spu.iVolume;
+ s32 dosampies;
  s32 temp;
 
- ttemp+=cycles;
- dosampies=ttemp/384;
+ spu.ttemp+=cycles;
+ dosampies=spu.ttemp/384;
  if(!dosampies) return(1);
- ttemp-=dosampies*384;
+ spu.ttemp-=dosampies*384;
  temp=dosampies;
 
  while(temp)
  {
-   s32 revLeft=0, revRight=0;
-   s32 sl=0, sr=0;
+   s32 revLeft, revRight;
+   s32 sl, sr;
    int ch,fa;
 
    temp--;
@@ -243,41 +285,41 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
     {
      for(ch=0;ch<MAXCHAN;ch++)                         // loop em all.
       {
-       if(s_chan[ch].bNew) StartSound(ch);             // start new sound
-       if(!s_chan[ch].bOn) continue;                   // channel not playing? next
+       if(spu.s_chan[ch].bNew) StartSound(spu,ch);         // start new sound
+       if(!spu.s_chan[ch].bOn) continue;                   // channel not playing? next
 
 
-       if(s_chan[ch].iActFreq!=s_chan[ch].iUsedFreq)   // new psx frequency?
+       if(spu.s_chan[ch].iActFreq!=spu.s_chan[ch].iUsedFreq)   // new psx frequency?
         {
-         s_chan[ch].iUsedFreq=s_chan[ch].iActFreq;     // -> take it and calc steps
-         s_chan[ch].sinc=s_chan[ch].iRawPitch<<4;
-         if(!s_chan[ch].sinc) s_chan[ch].sinc=1;
+         spu.s_chan[ch].iUsedFreq=spu.s_chan[ch].iActFreq;     // -> take it and calc steps
+         spu.s_chan[ch].sinc=spu.s_chan[ch].iRawPitch<<4;
+         if(!spu.s_chan[ch].sinc) spu.s_chan[ch].sinc=1;
         }
 
-         while(s_chan[ch].spos>=0x10000L)
+         while(spu.s_chan[ch].spos>=0x10000L)
           {
-           if(s_chan[ch].iSBPos==28)                   // 28 reached?
+           if(spu.s_chan[ch].iSBPos==28)                   // 28 reached?
             {
 	     int predict_nr,shift_factor,flags,d,s;
 	     u8* start;unsigned int nSample;
 	     int s_1,s_2;
 
-             start=s_chan[ch].pCurr;                   // set up the current pos
+             start=spu.s_chan[ch].pCurr;                   // set up the current pos
 
              if (start == (u8*)-1)          // special "stop" sign
               {
-               s_chan[ch].bOn=0;                       // -> turn everything off
-               s_chan[ch].ADSRX.lVolume=0;
-               s_chan[ch].ADSRX.EnvelopeVol=0;
+               spu.s_chan[ch].bOn=0;                       // -> turn everything off
+               spu.s_chan[ch].ADSRX.lVolume=0;
+               spu.s_chan[ch].ADSRX.EnvelopeVol=0;
                goto ENDX;                              // -> and done for this channel
               }
 
-             s_chan[ch].iSBPos=0;	// Reset buffer play index.
+             spu.s_chan[ch].iSBPos=0;	// Reset buffer play index.
 
              //////////////////////////////////////////// spu irq handler here? mmm... do it later
 
-             s_1=s_chan[ch].s_1;
-             s_2=s_chan[ch].s_2;
+             s_1=spu.s_chan[ch].s_1;
+             s_2=spu.s_chan[ch].s_2;
 
              predict_nr=(int)*start;start++;
              shift_factor=predict_nr&0xf;
@@ -297,28 +339,28 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
                s_2=s_1;s_1=fa;
                s=((d & 0xf0) << 8);
 
-               s_chan[ch].SB[nSample++]=fa;
+               spu.s_chan[ch].SB[nSample++]=fa;
 
                if(s&0x8000) s|=0xffff0000;
                fa=(s>>shift_factor);
                fa=fa + ((s_1 * f[predict_nr][0])>>6) + ((s_2 * f[predict_nr][1])>>6);
                s_2=s_1;s_1=fa;
 
-               s_chan[ch].SB[nSample++]=fa;
+               spu.s_chan[ch].SB[nSample++]=fa;
               }
 
              //////////////////////////////////////////// irq check
 
-             if(spuCtrl&0x40)         			// irq active?
+             if(spu.spuCtrl&0x40)         			// irq active?
               {
-               if((pSpuIrq >  start-16 &&              // irq address reached?
-                   pSpuIrq <= start) ||
+               if((spu.pSpuIrq >  start-16 &&              // irq address reached?
+                   spu.pSpuIrq <= start) ||
                   ((flags&1) &&                        // special: irq on looping addr, when stop/loop flag is set
-                   (pSpuIrq >  s_chan[ch].pLoop-16 &&
-                    pSpuIrq <= s_chan[ch].pLoop)))
+                   (spu.pSpuIrq >  spu.s_chan[ch].pLoop-16 &&
+                    spu.pSpuIrq <= spu.s_chan[ch].pLoop)))
                {
 		 //extern s32 spuirqvoodoo;
-                 s_chan[ch].iIrqDone=1;                // -> debug flag
+                 spu.s_chan[ch].iIrqDone=1;                // -> debug flag
 		 SPUirq();
 		//puts("IRQ");
 		 //if(spuirqvoodoo!=-1)
@@ -331,43 +373,43 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
 
              //////////////////////////////////////////// flag handler
 
-             if((flags&4) && (!s_chan[ch].bIgnoreLoop))
-              s_chan[ch].pLoop=start-16;               // loop adress
+             if((flags&4) && (!spu.s_chan[ch].bIgnoreLoop))
+              spu.s_chan[ch].pLoop=start-16;               // loop adress
 
              if(flags&1)                               // 1: stop/loop
               {
                // We play this block out first...
                //if(!(flags&2))                          // 1+2: do loop... otherwise: stop
-               if(flags!=3 || s_chan[ch].pLoop==nullptr)  // PETE: if we don't check exactly for 3, loop hang ups will happen (DQ4, for example)
+               if(flags!=3 || spu.s_chan[ch].pLoop==nullptr)  // PETE: if we don't check exactly for 3, loop hang ups will happen (DQ4, for example)
                 {                                      // and checking if pLoop is set avoids crashes, yeah
                  start = (u8*)-1;
                 }
                else
                 {
-                 start = s_chan[ch].pLoop;
+                 start = spu.s_chan[ch].pLoop;
                 }
               }
 
-             s_chan[ch].pCurr=start;                   // store values for next cycle
-             s_chan[ch].s_1=s_1;
-             s_chan[ch].s_2=s_2;
+             spu.s_chan[ch].pCurr=start;                   // store values for next cycle
+             spu.s_chan[ch].s_1=s_1;
+             spu.s_chan[ch].s_2=s_2;
 
              ////////////////////////////////////////////
             }
 
-           fa=s_chan[ch].SB[s_chan[ch].iSBPos++];      // get sample data
+           fa=spu.s_chan[ch].SB[spu.s_chan[ch].iSBPos++];      // get sample data
 
-           if((spuCtrl&0x4000)==0) fa=0;               // muted?
+           if((spu.spuCtrl&0x4000)==0) fa=0;               // muted?
 	   else CLIP(fa);
 
 	    {
 	     int gpos;
-             gpos = s_chan[ch].SB[28];
+             gpos = spu.s_chan[ch].SB[28];
              gval0 = fa;
              gpos = (gpos+1) & 3;
-             s_chan[ch].SB[28] = gpos;
+             spu.s_chan[ch].SB[28] = gpos;
 	    }
-           s_chan[ch].spos -= 0x10000L;
+           spu.s_chan[ch].spos -= 0x10000L;
           }
 
          ////////////////////////////////////////////////
@@ -375,29 +417,29 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
          // surely wrong... and no noise frequency (spuCtrl&0x3f00) will be used...
          // and sometimes the noise will be used as fmod modulation... pfff
 
-         if(s_chan[ch].bNoise)
+         if(spu.s_chan[ch].bNoise)
           {
 	   //puts("Noise");
-           if((dwNoiseVal<<=1)&0x80000000L)
+           if((spu.dwNoiseVal<<=1)&0x80000000L)
             {
-             dwNoiseVal^=0x0040001L;
-             fa=((dwNoiseVal>>2)&0x7fff);
+             spu.dwNoiseVal^=0x0040001L;
+             fa=((spu.dwNoiseVal>>2)&0x7fff);
              fa=-fa;
             }
-           else fa=(dwNoiseVal>>2)&0x7fff;
+           else fa=(spu.dwNoiseVal>>2)&0x7fff;
 
            // mmm... depending on the noise freq we allow bigger/smaller changes to the previous val
-           fa=s_chan[ch].iOldNoise+((fa-s_chan[ch].iOldNoise)/((0x001f-((spuCtrl&0x3f00)>>9))+1));
+           fa=spu.s_chan[ch].iOldNoise+((fa-spu.s_chan[ch].iOldNoise)/((0x001f-((spu.spuCtrl&0x3f00)>>9))+1));
            if(fa>32767L)  fa=32767L;
            if(fa<-32767L) fa=-32767L;
-           s_chan[ch].iOldNoise=fa;
+           spu.s_chan[ch].iOldNoise=fa;
 
           }                                            //----------------------------------------
          else                                         // NO NOISE (NORMAL SAMPLE DATA) HERE
           {
              int vl, vr, gpos;
-             vl = (s_chan[ch].spos >> 6) & ~3;
-             gpos = s_chan[ch].SB[28];
+             vl = (spu.s_chan[ch].spos >> 6) & ~3;
+             gpos = spu.s_chan[ch].SB[28];
              vr=(gauss[vl]*gval0)>>9;
              vr+=(gauss[vl+1]*gval(1))>>9;
              vr+=(gauss[vl+2]*gval(2))>>9;
@@ -405,11 +447,11 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
              fa = vr>>2;
           }
 
-         s_chan[ch].sval = (MixADSR(ch) * fa)>>10;     // / 1023;  // add adsr
-         if(s_chan[ch].bFMod==2)                       // fmod freq channel
+         spu.s_chan[ch].sval = (MixADSR(spu,ch) * fa)>>10; // / 1023;  // add adsr
+         if(spu.s_chan[ch].bFMod==2)                       // fmod freq channel
          {
-           int NP=s_chan[ch+1].iRawPitch;
-           NP=((32768L+s_chan[ch].sval)*NP)>>15; ///32768L;
+           int NP=spu.s_chan[ch+1].iRawPitch;
+           NP=((32768L+spu.s_chan[ch].sval)*NP)>>15; ///32768L;
 
            if(NP>0x3fff) NP=0x3fff;
            if(NP<0x1)    NP=0x1;
@@ -419,10 +461,10 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
 
            NP=(44100L*NP)/(4096L);                     // calc frequency
 
-           s_chan[ch+1].iActFreq=NP;
-           s_chan[ch+1].iUsedFreq=NP;
-           s_chan[ch+1].sinc=(((NP/10)<<16)/4410);
-           if(!s_chan[ch+1].sinc) s_chan[ch+1].sinc=1;
+           spu.s_chan[ch+1].iActFreq=NP;
+           spu.s_chan[ch+1].iUsedFreq=NP;
+           spu.s_chan[ch+1].sinc=(((NP/10)<<16)/4410);
+           if(!spu.s_chan[ch+1].sinc) spu.s_chan[ch+1].sinc=1;
 
 		// mmmm... set up freq decoding positions?
 		//           s_chan[ch+1].iSBPos=28;
@@ -431,54 +473,51 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
          else
           {
            //////////////////////////////////////////////
-           // ok, left/right sound volume (psx volume goes from 0 ... 0x3fff)
-	   int tmpl,tmpr;
-
-		if (1) //ao_channel_enable[ch+PSF_1]) {
-		{
-			tmpl=(s_chan[ch].sval*s_chan[ch].iLeftVolume)>>14;
-			tmpr=(s_chan[ch].sval*s_chan[ch].iRightVolume)>>14;
-		} else {
-			tmpl = 0;
-			tmpr = 0;
-		}
-	   sl+=tmpl;
-	   sr+=tmpr;
-
-	   if(((rvb.Enabled>>ch)&1) && (spuCtrl&0x80))
-	   {
-	    revLeft+=tmpl;
-	    revRight+=tmpr;
-	   }
+           // hand the sample to the mixer, which applies the left/right
+           // volume (psx volume goes from 0 ... 0x3fff) below
+           spu.mixDry[ch]=spu.s_chan[ch].sval;
+
+	   if(((spu.rvb.Enabled>>ch)&1) && (spu.spuCtrl&0x80))
+	    spu.mixRvb[ch]=spu.s_chan[ch].sval;
           }
 
-         s_chan[ch].spos += s_chan[ch].sinc;
+         spu.s_chan[ch].spos += spu.s_chan[ch].sinc;
  ENDX:   ;
       }
     }
 
+  ///////////////////////////////////////////////////////
+  // apply the voice volumes, summing across voices
+
+  sl=spu_mix<false>(spu.mixDry,spu.voiceVolL,MAXCHAN);
+  sr=spu_mix<false>(spu.mixDry,spu.voiceVolR,MAXCHAN);
+  revLeft=spu_mix<false>(spu.mixRvb,spu.voiceVolL,MAXCHAN);
+  revRight=spu_mix<false>(spu.mixRvb,spu.voiceVolR,MAXCHAN);
+  memset(spu.mixDry,0,sizeof(spu.mixDry));
+  memset(spu.mixRvb,0,sizeof(spu.mixRvb));
+
   ///////////////////////////////////////////////////////
   // mix all channels (including reverb) into one buffer
-  MixREVERBLeftRight(&sl,&sr,revLeft,revRight);
+  MixREVERBLeftRight(spu,&sl,&sr,revLeft,revRight);
 //  printf("sampcount %d decaybegin %d decayend %d\n", sampcount, decaybegin, decayend);
-  if(sampcount>=decaybegin)
+  if(spu.sampcount>=spu.decaybegin)
   {
    s32 dmul;
-   if(decaybegin!=~0U) // Is anyone REALLY going to be playing a song
+   if(spu.decaybegin!=~0U) // Is anyone REALLY going to be playing a song
 		      // for 13 hours?
    {
-    if(sampcount>=decayend)
+    if(spu.sampcount>=spu.decayend)
     {
-      update(nullptr, 0);
+      inst.update(nullptr, 0);
       return(0);
     }
-    dmul=256-(256*(sampcount-decaybegin)/(decayend-decaybegin));
+    dmul=256-(256*(spu.sampcount-spu.decaybegin)/(spu.decayend-spu.decaybegin));
     sl=(sl*dmul)>>8;
     sr=(sr*dmul)>>8;
    }
   }
 
-  sampcount++;
+  spu.sampcount++;
   sl=(sl*volmul)>>8;
   sr=(sr*volmul)>>8;
 
@@ -501,21 +540,21 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
   if(sr>32767) sr=32767;
   if(sr<-32767) sr=-32767;
 
-  *pS++=sl;
-  *pS++=sr;
+  *spu.pS++=sl;
+  *spu.pS++=sr;
  }
 
- if (seektime != 0 && sampcount < seektime)
+ if (spu.seektime != 0 && spu.sampcount < spu.seektime)
  {
-   pS=(short *)pSpuBuffer;
+   spu.pS=(short *)spu.pSpuBuffer;
  }
- else if ((((unsigned char *)pS)-((unsigned char *)pSpuBuffer)) == (735*4))
+ else if ((((unsigned char *)spu.pS)-((unsigned char *)spu.pSpuBuffer)) == (735*4))
  {
 #ifdef ENABLE_SILENCE_SKIPPING
-   short *pSilenceIter = (short *)pSpuBuffer;
+   short *pSilenceIter = (short *)spu.pSpuBuffer;
    int iSilenceCount = 0;
 
-   for (; pSilenceIter < pS; pSilenceIter++)
+   for (; pSilenceIter < spu.pS; pSilenceIter++)
    {
       if (*pSilenceIter == 0)
         iSilenceCount++;
@@ -526,9 +565,9 @@ int SPUasync(u32 cycles, void (*update)(const void *, int))
 
    if (iSilenceCount < 20)
 #endif
-     update((u8*)pSpuBuffer,(u8*)pS-(u8*)pSpuBuffer);
+     inst.update((u8*)spu.pSpuBuffer,(u8*)spu.pS-(u8*)spu.pSpuBuffer);
 
-   pS=(short *)pSpuBuffer;
+   spu.pS=(short *)spu.pSpuBuffer;
  }
 
  return(1);
@@ -558,14 +597,14 @@ static u64 gettime64(void)
 
 int SPUinit(void)
 {
- spuMemC=(u8*)spuMem;                      // just small setup
- memset((void *)s_chan,0,MAXCHAN*sizeof(SPUCHAN));
- memset((void *)&rvb,0,sizeof(REVERBInfo));
- memset(regArea,0,sizeof(regArea));
- memset(spuMem,0,sizeof(spuMem));
+ SPU.spuMemC=(u8*)SPU.spuMem;                      // just small setup
+ memset((void *)SPU.s_chan,0,MAXCHAN*sizeof(SPUCHAN));
+ memset((void *)&SPU.rvb,0,sizeof(REVERBInfo));
+ memset(SPU.regArea,0,sizeof(SPU.regArea));
+ memset(SPU.spuMem,0,sizeof(SPU.spuMem));
  InitADSR();
- sampcount=ttemp=0;
- seektime=0;
+ SPU.sampcount=SPU.ttemp=0;
+ SPU.seektime=0;
  #ifdef TIMEO
  begintime=gettime64();
  #endif
@@ -580,16 +619,16 @@ static void SetupStreams(void)
 {
  int i;
 
- pSpuBuffer=(u8*)malloc(32768);            // alloc mixing buffer
- pS=(s16 *)pSpuBuffer;
+ SPU.pSpuBuffer=(u8*)malloc(32768);            // alloc mixing buffer
+ SPU.pS=(s16 *)SPU.pSpuBuffer;
 
  for(i=0;i<MAXCHAN;i++)                                // loop sound channels
   {
-   s_chan[i].ADSRX.SustainLevel = 1024;                // -> init sustain
-   s_chan[i].iIrqDone=0;
-   s_chan[i].pLoop=spuMemC;
-   s_chan[i].pStart=spuMemC;
-   s_chan[i].pCurr=spuMemC;
+   SPU.s_chan[i].ADSRX.SustainLevel = 1024;                // -> init sustain
+   SPU.s_chan[i].iIrqDone=0;
+   SPU.s_chan[i].pLoop=SPU.spuMemC;
+   SPU.s_chan[i].pStart=SPU.spuMemC;
+   SPU.s_chan[i].pCurr=SPU.spuMemC;
   }
 }
 
@@ -599,8 +638,8 @@ static void SetupStreams(void)
 
 static void RemoveStreams(void)
 {
- free(pSpuBuffer);                                     // free mixing buffer
- pSpuBuffer=nullptr;
+ free(SPU.pSpuBuffer);                                     // free mixing buffer
+ SPU.pSpuBuffer=nullptr;
 
  #ifdef TIMEO
  {
@@ -608,7 +647,7 @@ static void RemoveStreams(void)
   tmp=gettime64();
   tmp-=begintime;
   if(tmp)
-   tmp=(u64)sampcount*1000000/tmp;
+   tmp=(u64)SPU.sampcount*1000000/tmp;
   printf("%lld samples per second\n",tmp);
  }
  #endif
@@ -621,21 +660,25 @@ static void RemoveStreams(void)
 
 int SPUopen(void)
 {
- if(bSPUIsOpen) return 0;                              // security for some stupid main emus
- spuIrq=0;
-
- spuStat=spuCtrl=0;
- spuAddr=0xffffffff;
- dwNoiseVal=1;
-
- spuMemC=(u8*)spuMem;
- memset((void *)s_chan,0,(MAXCHAN+1)*sizeof(SPUCHAN));
- pSpuIrq=0;
-
- iVolume=255; //85;
+ if(SPU.bSPUIsOpen) return 0;                              // security for some stupid main emus
+ SPU.spuIrq=0;
+
+ SPU.spuStat=SPU.spuCtrl=0;
+ SPU.spuAddr=0xffffffff;
+ SPU.dwNoiseVal=1;
+
+ SPU.spuMemC=(u8*)SPU.spuMem;
+ memset((void *)SPU.s_chan,0,(MAXCHAN+1)*sizeof(SPUCHAN));
+ memset(SPU.voiceVolL,0,sizeof(SPU.voiceVolL));
+ memset(SPU.voiceVolR,0,sizeof(SPU.voiceVolR));
+ memset(SPU.mixDry,0,sizeof(SPU.mixDry));
+ memset(SPU.mixRvb,0,sizeof(SPU.mixRvb));
+ SPU.pSpuIrq=0;
+
+ SPU.iVolume=255; //85;
  SetupStreams();                                       // prepare streaming
 
- bSPUIsOpen=1;
+ SPU.bSPUIsOpen=1;
 
  return 1;
 }
@@ -648,9 +691,9 @@ int SPUopen(void)
 
 int SPUclose(void)
 {
- if(!bSPUIsOpen) return 0;                             // some security
+ if(!SPU.bSPUIsOpen) return 0;                             // some security
 
- bSPUIsOpen=0;                                         // no more open
+ SPU.bSPUIsOpen=0;                                         // no more open
 
  RemoveStreams();                                      // no more streaming
 
@@ -666,12 +709,42 @@ int SPUshutdown(void)
  return 0;
 }
 
+////////////////////////////////////////////////////////////////////////
+// SPUSTATE: save/restore for seek snapshots (seektime is left alone,
+// it belongs to the seek being served)
+////////////////////////////////////////////////////////////////////////
+
+void SPUstate(PSFState &state)
+{
+ state.io(SPU.regArea);
+ state.io(SPU.spuMem);
+ state.io(SPU.pSpuIrq);
+ state.io(SPU.iVolume);
+ state.io(SPU.s_chan);
+ state.io(SPU.voiceVolL);
+ state.io(SPU.voiceVolR);
+ state.io(SPU.rvb);
+ state.io(SPU.dwNoiseVal);
+ state.io(SPU.spuCtrl);
+ state.io(SPU.spuStat);
+ state.io(SPU.spuIrq);
+ state.io(SPU.spuAddr);
+ state.io(SPU.sampcount);
+ state.io(SPU.ttemp);
+ state.io(SPU.pS);
+ state.io(SPU.pSpuBuffer,(u8*)SPU.pS-SPU.pSpuBuffer);              // partly filled output
+ state.io(SPU.downbuf);
+ state.io(SPU.upbuf);
+ state.io(SPU.dbpos);
+ state.io(SPU.ubpos);
+}
+
 void SPUinjectRAMImage(u16 *pIncoming)
 {
 	int i;
 
 	for (i = 0; i < (256*1024); i++)
 	{
-		spuMem[i] = pIncoming[i];
+		SPU.spuMem[i] = pIncoming[i];
 	}
 }
@@ -24,18 +24,27 @@
 //
 //*************************************************************************//
 
+class PSFInstance;
+class PSFState;
+struct SPUState;
+
+SPUState *SPUalloc_state(void);
+void SPUfree_state(SPUState *spu);
+
 void SPUirq(void);
 
-int psf_seek(uint32_t t);
-void setendless(int e);
+int psf_seek(PSFInstance &inst, uint32_t t);
+uint32_t psf_tell(PSFInstance &inst);
+void setendless(PSFInstance &inst, int e);
 void setlength(int32_t stop, int32_t fade);
 
-int SPUasync(uint32_t cycles, void (*update)(const void *, int));
+int SPUasync(uint32_t cycles, PSFInstance &inst);
 void SPU_flushboot(void);
 int SPUinit(void);
 int SPUopen(void);
 int SPUclose(void);
 int SPUshutdown(void);
+void SPUstate(PSFState &state);
 void SPUinjectRAMImage(uint16_t *pIncoming);
 void SPUreadDMAMem(uint32_t usPSXMem, int iSize);
 void SPUwriteDMAMem(uint32_t usPSXMem, int iSize);
@@ -34,10 +34,9 @@
 #include "../peops2/dma.h"
 #include "../peops2/externals.h"
 #include "../peops2/registers.h"
+#include "../psx.h"
 //#include "debug.h"
 
-extern uint32_t psx_ram[(2*1024*1024)/4+4];
-
 ////////////////////////////////////////////////////////////////////////
 // READ DMA (many values)
 ////////////////////////////////////////////////////////////////////////
@@ -45,46 +44,46 @@ extern uint32_t psx_ram[(2*1024*1024)/4+4];
 EXPORT_GCC void CALLBACK SPU2readDMA4Mem(u32 usPSXMem,int iSize)
 {
  int i;
- u16 *ram16 = (u16 *)&psx_ram[0];
+ u16 *ram16 = (u16 *)&PSXMEM.psx_ram[0];
 
  for(i=0;i<iSize;i++)
   {
-   ram16[usPSXMem>>1]=spuMem[spuAddr2[0]];                  // spu addr 0 got by writeregister
+   ram16[usPSXMem>>1]=SPU2.spuMem[SPU2.spuAddr2[0]];                  // spu addr 0 got by writeregister
    usPSXMem+=2;
-   spuAddr2[0]++;                                     // inc spu addr
-   if(spuAddr2[0]>0xfffff) spuAddr2[0]=0;             // wrap
+   SPU2.spuAddr2[0]++;                                     // inc spu addr
+   if(SPU2.spuAddr2[0]>0xfffff) SPU2.spuAddr2[0]=0;             // wrap
   }
 
- spuAddr2[0]+=0x20; //?????
+ SPU2.spuAddr2[0]+=0x20; //?????
 
 
- iSpuAsyncWait=0;
+ SPU2.iSpuAsyncWait=0;
 
  // got from J.F. and Kanodin... is it needed?
- regArea[(PS2_C0_ADMAS)>>1]=0;                         // Auto DMA complete
- spuStat2[0]=0x80;                                     // DMA complete
+ SPU2.regArea[(PS2_C0_ADMAS)>>1]=0;                         // Auto DMA complete
+ SPU2.spuStat2[0]=0x80;                                     // DMA complete
 }
 
 EXPORT_GCC void CALLBACK SPU2readDMA7Mem(u32 usPSXMem,int iSize)
 {
  int i;
- u16 *ram16 = (u16 *)&psx_ram[0];
+ u16 *ram16 = (u16 *)&PSXMEM.psx_ram[0];
 
  for(i=0;i<iSize;i++)
   {
-   ram16[usPSXMem>>1]=spuMem[spuAddr2[1]];             // spu addr 1 got by writeregister
+   ram16[usPSXMem>>1]=SPU2.spuMem[SPU2.spuAddr2[1]];             // spu addr 1 got by writeregister
    usPSXMem+=2;
-   spuAddr2[1]++;                                      // inc spu addr
-   if(spuAddr2[1]>0xfffff) spuAddr2[1]=0;              // wrap
+   SPU2.spuAddr2[1]++;                                      // inc spu addr
+   if(SPU2.spuAddr2[1]>0xfffff) SPU2.spuAddr2[1]=0;              // wrap
   }
 
- spuAddr2[1]+=0x20; //?????
+ SPU2.spuAddr2[1]+=0x20; //?????
 
- iSpuAsyncWait=0;
+ SPU2.iSpuAsyncWait=0;
 
  // got from J.F. and Kanodin... is it needed?
- regArea[(PS2_C1_ADMAS)>>1]=0;                         // Auto DMA complete
- spuStat2[1]=0x80;                                     // DMA complete
+ SPU2.regArea[(PS2_C1_ADMAS)>>1]=0;                         // Auto DMA complete
+ SPU2.spuStat2[1]=0x80;                                     // DMA complete
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -102,38 +101,38 @@ EXPORT_GCC void CALLBACK SPU2readDMA7Mem(u32 usPSXMem,int iSize)
 EXPORT_GCC void CALLBACK SPU2writeDMA4Mem(u32 usPSXMem,int iSize)
 {
  int i;
- u16 *ram16 = (u16 *)&psx_ram[0];
+ u16 *ram16 = (u16 *)&PSXMEM.psx_ram[0];
 
  for(i=0;i<iSize;i++)
   {
-   spuMem[spuAddr2[0]] = ram16[usPSXMem>>1];                 // spu addr 0 got by writeregister
+   SPU2.spuMem[SPU2.spuAddr2[0]] = ram16[usPSXMem>>1];                 // spu addr 0 got by writeregister
    usPSXMem+=2;
-   spuAddr2[0]++;                                      // inc spu addr
-   if(spuAddr2[0]>0xfffff) spuAddr2[0]=0;              // wrap
+   SPU2.spuAddr2[0]++;                                      // inc spu addr
+   if(SPU2.spuAddr2[0]>0xfffff) SPU2.spuAddr2[0]=0;              // wrap
   }
 
- iSpuAsyncWait=0;
+ SPU2.iSpuAsyncWait=0;
 
  // got from J.F. and Kanodin... is it needed?
- spuStat2[0]=0x80;                                     // DMA complete
+ SPU2.spuStat2[0]=0x80;                                     // DMA complete
 }
 
 EXPORT_GCC void CALLBACK SPU2writeDMA7Mem(u32 usPSXMem,int iSize)
 {
  int i;
- u16 *ram16 = (u16 *)&psx_ram[0];
+ u16 *ram16 = (u16 *)&PSXMEM.psx_ram[0];
 
  for(i=0;i<iSize;i++)
   {
-   spuMem[spuAddr2[1]] = ram16[usPSXMem>>1];           // spu addr 1 got by writeregister
-   spuAddr2[1]++;                                      // inc spu addr
-   if(spuAddr2[1]>0xfffff) spuAddr2[1]=0;              // wrap
+   SPU2.spuMem[SPU2.spuAddr2[1]] = ram16[usPSXMem>>1];           // spu addr 1 got by writeregister
+   SPU2.spuAddr2[1]++;                                      // inc spu addr
+   if(SPU2.spuAddr2[1]>0xfffff) SPU2.spuAddr2[1]=0;              // wrap
   }
 
- iSpuAsyncWait=0;
+ SPU2.iSpuAsyncWait=0;
 
  // got from J.F. and Kanodin... is it needed?
- spuStat2[1]=0x80;                                     // DMA complete
+ SPU2.spuStat2[1]=0x80;                                     // DMA complete
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -147,9 +146,9 @@ void InterruptDMA4(void)
 //	spu2Rs16(REG__1B0) = 0;
 //	spu2Rs16(SPU2_STATX_WRDY_M)|= 0x80;
 
- spuCtrl2[0]&=~0x30;
- regArea[(PS2_C0_ADMAS)>>1]=0;
- spuStat2[0]|=0x80;
+ SPU2.spuCtrl2[0]&=~0x30;
+ SPU2.regArea[(PS2_C0_ADMAS)>>1]=0;
+ SPU2.spuStat2[0]|=0x80;
 }
 
 EXPORT_GCC void CALLBACK SPU2interruptDMA4(void)
@@ -164,9 +163,9 @@ void InterruptDMA7(void)
 //	spu2Rs16(REG__5B0) = 0;
 //	spu2Rs16(SPU2_STATX_DREQ)|= 0x80;
 
- spuCtrl2[1]&=~0x30;
- regArea[(PS2_C1_ADMAS)>>1]=0;
- spuStat2[1]|=0x80;
+ SPU2.spuCtrl2[1]&=~0x30;
+ SPU2.regArea[(PS2_C1_ADMAS)>>1]=0;
+ SPU2.spuStat2[1]|=0x80;
 }
 
 EXPORT_GCC void CALLBACK SPU2interruptDMA7(void)
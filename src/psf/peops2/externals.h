@@ -172,11 +172,9 @@ typedef struct
 
  int               iActFreq;                           // current psx pitch
  int               iUsedFreq;                          // current pc pitch
- int               iLeftVolume;                        // left volume
  int               iLeftVolRaw;                        // left psx volume value
  int               bIgnoreLoop;                        // ignore loop bit, if an external loop address is used
  int               iMute;                              // mute mode
- int               iRightVolume;                       // right volume
  int               iRightVolRaw;                       // right psx volume value
  int               iRawPitch;                          // raw pitch (0...3fff)
  int               iIrqDone;                           // debug irq done flag
@@ -247,18 +245,85 @@ typedef struct
 #endif
 
 ///////////////////////////////////////////////////////////
-// SPU.C globals
+// per-instance state of SPU.C, REVERB.C and ADSR.C
 ///////////////////////////////////////////////////////////
 
-#ifndef _IN_SPU
-
+struct SPU2State
+{
 // psx buffers / addresses
 
-extern unsigned short  regArea[];
-extern unsigned short  spuMem[];
-extern unsigned char * spuMemC;
-extern unsigned char * pSpuIrq[];
-extern unsigned char * pSpuBuffer;
+ unsigned short  regArea[32*1024];
+ unsigned short  spuMem[1*1024*1024];
+ unsigned char * spuMemC;
+ unsigned char * pSpuIrq[2];
+ unsigned char * pSpuBuffer;
+
+// MAIN infos struct for each channel
+
+ SPUCHAN2        s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
+ REVERBInfo2     rvb[2];
+
+ unsigned long   dwNoiseVal=1;                          // global noise generator
+
+ unsigned short  spuCtrl2[2];                           // some vars to store psx reg infos
+ unsigned short  spuStat2[2];
+ unsigned long   spuIrq2[2];
+ unsigned long   spuAddr2[2];                           // address into spu mem
+ unsigned long   spuRvbAddr2[2];
+ unsigned long   spuRvbAEnd2[2];
+ int             bEndThread;                            // thread handlers
+ int             bThreadEnded;
+ int             bSpuInit;
+ int             bSPUIsOpen;
+
+ unsigned long dwNewChannel2[2];                        // flags for faster testing, if new channel starts
+ unsigned long dwEndChannel2[2];
+
+ void (CALLBACK *irqCallback)(void);                    // func of main emu, called on spu irq
+
+ int SSumR[NSSIZE];
+ int SSumL[NSSIZE];
+
+// voice volumes and the per-sample inputs of the voice mixer (spumix.h),
+// kept apart from s_chan so they can be processed across voices
+ int voiceVolL[MAXCHAN];
+ int voiceVolR[MAXCHAN];
+ int mixDryL[MAXCHAN];                                  // sample of each voice for the main mix
+ int mixDryR[MAXCHAN];
+ int mixRvbL[MAXCHAN];                                  // ... and for the reverb send of its core
+ int mixRvbR[MAXCHAN];
+ int iCycle;
+ short * pS;
+
+ int lastch=-1;                                         // last channel processed on spu irq in timer mode
+ int iSecureStart;                                      // secure start counter
+
+ u32 sampcount;
+ u32 decaybegin;
+ u32 decayend;
+ u32 seektime;
+ int endless;
+
+ int iSpuAsyncWait;
+
+// REVERB info and timing vars...
+
+ int *          sRVBPlay[2];
+ int *          sRVBEnd[2];
+ int *          sRVBStart[2];
+
+// ADSR rate table
+
+ unsigned long RateTable[160];
+};
+
+#define SPU2 (*psf_instance->spu2)
+
+///////////////////////////////////////////////////////////
+// SPU.C globals
+///////////////////////////////////////////////////////////
+
+#ifndef _IN_SPU
 
 // user settings
 
@@ -272,32 +337,6 @@ extern int        iRecordMode;
 extern int        iUseReverb;
 extern int        iUseInterpolation;
 extern int        iDisStereo;
-// MISC
-
-extern SPUCHAN2 s_chan[];
-extern REVERBInfo2 rvb[];
-
-extern unsigned long dwNoiseVal;
-extern unsigned short spuCtrl2[];
-extern unsigned short spuStat2[];
-extern unsigned long  spuIrq2[];
-extern unsigned long  spuAddr2[];
-extern unsigned long   spuRvbAddr2[];
-extern unsigned long   spuRvbAEnd2[];
-
-extern int      bEndThread;
-extern int      bThreadEnded;
-extern int      bSpuInit;
-
-extern int      SSumR[];
-extern int      SSumL[];
-extern int      iCycle;
-extern short *  pS;
-extern unsigned long dwNewChannel2[];
-extern unsigned long dwEndChannel2[];
-
-extern int iSpuAsyncWait;
-
 #ifdef _WINDOWS
 //extern HWND    hWMain;                               // window handle
 //extern HWND    hWDebug;
@@ -365,16 +404,4 @@ extern int           iRightXAVol;
 
 #endif
 
-///////////////////////////////////////////////////////////
-// REVERB.C globals
-///////////////////////////////////////////////////////////
-
-#ifndef _IN_REVERB
-
-extern int *          sRVBPlay[];
-extern int *          sRVBEnd[];
-extern int *          sRVBStart[];
-
-#endif
-
 #endif // PEOPS2_EXTERNALS
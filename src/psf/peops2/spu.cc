@@ -103,19 +103,12 @@
 #include "../peops2/regs.h"
 #include "../peops2/dma.h"
 #include "../peops2/spu.h"
+#include "../spumix.h"
 
 ////////////////////////////////////////////////////////////////////////
 // globals
 ////////////////////////////////////////////////////////////////////////
 
-// psx buffer / addresses
-
-unsigned short  regArea[32*1024];
-unsigned short  spuMem[1*1024*1024];
-unsigned char * spuMemC;
-unsigned char * pSpuIrq[2];
-unsigned char * pSpuBuffer;
-
 // user settings
 
 int             iUseXA=0;
@@ -127,29 +120,7 @@ int             iRecordMode=0;
 int             iUseReverb=1;
 int             iUseInterpolation=2;
 
-// MAIN infos struct for each channel
-
-SPUCHAN2         s_chan[MAXCHAN+1];                     // channel + 1 infos (1 is security for fmod handling)
-REVERBInfo2      rvb[2];
-
-unsigned long   dwNoiseVal=1;                          // global noise generator
-
-unsigned short  spuCtrl2[2];                           // some vars to store psx reg infos
-unsigned short  spuStat2[2];
-unsigned long   spuIrq2[2];
-unsigned long   spuAddr2[2];                           // address into spu mem
-unsigned long   spuRvbAddr2[2];
-unsigned long   spuRvbAEnd2[2];
-int             bEndThread=0;                          // thread handlers
-int             bThreadEnded=0;
-int             bSpuInit=0;
-int             bSPUIsOpen=0;
-
-unsigned long dwNewChannel2[2];                        // flags for faster testing, if new channel starts
-unsigned long dwEndChannel2[2];
-
 // UNUSED IN PS2 YET
-void (CALLBACK *irqCallback)(void)=0;                  // func of main emu, called on spu irq
 void (CALLBACK *cddavCallback)(unsigned short,unsigned short)=0;
 
 // certain globals (were local before, but with the new timeproc I need em global)
@@ -159,13 +130,16 @@ const int f[5][2] = {   {    0,  0  },
                         {  115, -52 },
                         {   98, -55 },
                         {  122, -60 } };
-int SSumR[NSSIZE];
-int SSumL[NSSIZE];
-int iCycle=0;
-short * pS;
 
-static int lastch=-1;      // last channel processed on spu irq in timer mode
-static int iSecureStart=0; // secure start counter
+SPU2State *SPU2alloc_state(void)
+{
+ return new SPU2State();
+}
+
+void SPU2free_state(SPU2State *spu2)
+{
+ delete spu2;
+}
 
 ////////////////////////////////////////////////////////////////////////
 // CODE AREA
@@ -219,69 +193,69 @@ static int iSecureStart=0; // secure start counter
 //
 
 
-static inline void InterpolateUp(int ch)
+static inline void InterpolateUp(SPU2State &spu2,int ch)
 {
- if(s_chan[ch].SB[32]==1)                              // flag == 1? calc step and set flag... and don't change the value in this pass
+ if(spu2.s_chan[ch].SB[32]==1)                              // flag == 1? calc step and set flag... and don't change the value in this pass
   {
-   const int id1=s_chan[ch].SB[30]-s_chan[ch].SB[29];  // curr delta to next val
-   const int id2=s_chan[ch].SB[31]-s_chan[ch].SB[30];  // and next delta to next-next val :)
+   const int id1=spu2.s_chan[ch].SB[30]-spu2.s_chan[ch].SB[29];  // curr delta to next val
+   const int id2=spu2.s_chan[ch].SB[31]-spu2.s_chan[ch].SB[30];  // and next delta to next-next val :)
 
-   s_chan[ch].SB[32]=0;
+   spu2.s_chan[ch].SB[32]=0;
 
    if(id1>0)                                           // curr delta positive
     {
      if(id2<id1)
-      {s_chan[ch].SB[28]=id1;s_chan[ch].SB[32]=2;}
+      {spu2.s_chan[ch].SB[28]=id1;spu2.s_chan[ch].SB[32]=2;}
      else
      if(id2<(id1<<1))
-      s_chan[ch].SB[28]=(id1*s_chan[ch].sinc)/0x10000L;
+      spu2.s_chan[ch].SB[28]=(id1*spu2.s_chan[ch].sinc)/0x10000L;
      else
-      s_chan[ch].SB[28]=(id1*s_chan[ch].sinc)/0x20000L;
+      spu2.s_chan[ch].SB[28]=(id1*spu2.s_chan[ch].sinc)/0x20000L;
     }
    else                                                // curr delta negative
     {
      if(id2>id1)
-      {s_chan[ch].SB[28]=id1;s_chan[ch].SB[32]=2;}
+      {spu2.s_chan[ch].SB[28]=id1;spu2.s_chan[ch].SB[32]=2;}
      else
      if(id2>(id1<<1))
-      s_chan[ch].SB[28]=(id1*s_chan[ch].sinc)/0x10000L;
+      spu2.s_chan[ch].SB[28]=(id1*spu2.s_chan[ch].sinc)/0x10000L;
      else
-      s_chan[ch].SB[28]=(id1*s_chan[ch].sinc)/0x20000L;
+      spu2.s_chan[ch].SB[28]=(id1*spu2.s_chan[ch].sinc)/0x20000L;
     }
   }
  else
- if(s_chan[ch].SB[32]==2)                              // flag 1: calc step and set flag... and don't change the value in this pass
+ if(spu2.s_chan[ch].SB[32]==2)                              // flag 1: calc step and set flag... and don't change the value in this pass
   {
-   s_chan[ch].SB[32]=0;
+   spu2.s_chan[ch].SB[32]=0;
 
-   s_chan[ch].SB[28]=(s_chan[ch].SB[28]*s_chan[ch].sinc)/0x20000L;
-   if(s_chan[ch].sinc<=0x8000)
-        s_chan[ch].SB[29]=s_chan[ch].SB[30]-(s_chan[ch].SB[28]*((0x10000/s_chan[ch].sinc)-1));
-   else s_chan[ch].SB[29]+=s_chan[ch].SB[28];
+   spu2.s_chan[ch].SB[28]=(spu2.s_chan[ch].SB[28]*spu2.s_chan[ch].sinc)/0x20000L;
+   if(spu2.s_chan[ch].sinc<=0x8000)
+        spu2.s_chan[ch].SB[29]=spu2.s_chan[ch].SB[30]-(spu2.s_chan[ch].SB[28]*((0x10000/spu2.s_chan[ch].sinc)-1));
+   else spu2.s_chan[ch].SB[29]+=spu2.s_chan[ch].SB[28];
   }
  else                                                  // no flags? add bigger val (if possible), calc smaller step, set flag1
-  s_chan[ch].SB[29]+=s_chan[ch].SB[28];
+  spu2.s_chan[ch].SB[29]+=spu2.s_chan[ch].SB[28];
 }
 
 //
 // even easier interpolation on downsampling, also no special filter, again just "Pete's common sense" tm
 //
 
-static inline void InterpolateDown(int ch)
+static inline void InterpolateDown(SPU2State &spu2,int ch)
 {
- if(s_chan[ch].sinc>=0x20000L)                                 // we would skip at least one val?
+ if(spu2.s_chan[ch].sinc>=0x20000L)                                 // we would skip at least one val?
   {
-   s_chan[ch].SB[29]+=(s_chan[ch].SB[30]-s_chan[ch].SB[29])/2; // add easy weight
-   if(s_chan[ch].sinc>=0x30000L)                               // we would skip even more vals?
-    s_chan[ch].SB[29]+=(s_chan[ch].SB[31]-s_chan[ch].SB[30])/2;// add additional next weight
+   spu2.s_chan[ch].SB[29]+=(spu2.s_chan[ch].SB[30]-spu2.s_chan[ch].SB[29])/2; // add easy weight
+   if(spu2.s_chan[ch].sinc>=0x30000L)                               // we would skip even more vals?
+    spu2.s_chan[ch].SB[29]+=(spu2.s_chan[ch].SB[31]-spu2.s_chan[ch].SB[30])/2;// add additional next weight
   }
 }
 
 ////////////////////////////////////////////////////////////////////////
 // helpers for gauss interpolation
 
-#define gval0 (((short*)(&s_chan[ch].SB[29]))[gpos])
-#define gval(x) (((short*)(&s_chan[ch].SB[29]))[(gpos+x)&3])
+#define gval0 (((short*)(&spu2.s_chan[ch].SB[29]))[gpos])
+#define gval(x) (((short*)(&spu2.s_chan[ch].SB[29]))[(gpos+x)&3])
 
 #include "gauss_i.h"
 
@@ -293,30 +267,30 @@ static inline void InterpolateDown(int ch)
 // START SOUND... called by main thread to setup a new sound on a channel
 ////////////////////////////////////////////////////////////////////////
 
-static inline void StartSound(int ch)
+static inline void StartSound(SPU2State &spu2,int ch)
 {
- dwNewChannel2[ch/24]&=~(1<<(ch%24));                  // clear new channel bit
- dwEndChannel2[ch/24]&=~(1<<(ch%24));                  // clear end channel bit
+ spu2.dwNewChannel2[ch/24]&=~(1<<(ch%24));                  // clear new channel bit
+ spu2.dwEndChannel2[ch/24]&=~(1<<(ch%24));                  // clear end channel bit
 
- StartADSR(ch);
- StartREVERB(ch);
+ StartADSR(spu2,ch);
+ StartREVERB(spu2,ch);
 
- s_chan[ch].pCurr=s_chan[ch].pStart;                   // set sample start
+ spu2.s_chan[ch].pCurr=spu2.s_chan[ch].pStart;                   // set sample start
 
- s_chan[ch].s_1=0;                                     // init mixing vars
- s_chan[ch].s_2=0;
- s_chan[ch].iSBPos=28;
+ spu2.s_chan[ch].s_1=0;                                     // init mixing vars
+ spu2.s_chan[ch].s_2=0;
+ spu2.s_chan[ch].iSBPos=28;
 
- s_chan[ch].bNew=0;                                    // init channel flags
- s_chan[ch].bStop=0;
- s_chan[ch].bOn=1;
+ spu2.s_chan[ch].bNew=0;                                    // init channel flags
+ spu2.s_chan[ch].bStop=0;
+ spu2.s_chan[ch].bOn=1;
 
- s_chan[ch].SB[29]=0;                                  // init our interpolation helpers
- s_chan[ch].SB[30]=0;
+ spu2.s_chan[ch].SB[29]=0;                                  // init our interpolation helpers
+ spu2.s_chan[ch].SB[30]=0;
 
  if(iUseInterpolation>=2)                              // gauss interpolation?
-      {s_chan[ch].spos=0x30000L;s_chan[ch].SB[28]=0;}  // -> start with more decoding
- else {s_chan[ch].spos=0x10000L;s_chan[ch].SB[31]=0;}  // -> no/simple interpolation starts with one 44100 decoding
+      {spu2.s_chan[ch].spos=0x30000L;spu2.s_chan[ch].SB[28]=0;}  // -> start with more decoding
+ else {spu2.s_chan[ch].spos=0x10000L;spu2.s_chan[ch].SB[31]=0;}  // -> no/simple interpolation starts with one 44100 decoding
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -325,38 +299,38 @@ static inline void StartSound(int ch)
 // basically the whole sound processing is done in this fat func!
 ////////////////////////////////////////////////////////////////////////
 
-static u32 sampcount;
-static u32 decaybegin;
-static u32 decayend;
-
-static u32 seektime;
-int psf2_seek(u32 t)
+int psf2_seek(PSFInstance &inst, u32 t)
 {
- seektime=t*441/10;
- if(seektime>=sampcount) return(1);
+ SPU2State &spu2=*inst.spu2;
+ spu2.seektime=t*441/10;
+ if(spu2.seektime>=spu2.sampcount) return(1);
  return(0);
 }
 
-static int endless;
-void setendless2(int e)
+u32 psf2_tell(PSFInstance &inst)
 {
- endless=e;
+ return (u64)inst.spu2->sampcount*10/441;
+}
+
+void setendless2(PSFInstance &inst, int e)
+{
+ inst.spu2->endless=e;
 }
 
 // Counting to 65536 results in full volume offage.
 void setlength2(s32 stop, s32 fade)
 {
- if(stop==~0 || endless)
+ if(stop==~0 || SPU2.endless)
  {
-  decaybegin=~0;
+  SPU2.decaybegin=~0;
  }
  else
  {
   stop=(stop*441)/10;
   fade=(fade*441)/10;
 
-  decaybegin=stop;
-  decayend=stop+fade;
+  SPU2.decaybegin=stop;
+  SPU2.decayend=stop+fade;
  }
 }
 // 5 ms waiting phase, if buffer is full and no new sound has to get started
@@ -368,10 +342,9 @@ void setlength2(s32 stop, s32 fade)
 
 ////////////////////////////////////////////////////////////////////////
 
-int iSpuAsyncWait=0;
-
-static void *MAINThread(void (*update)(const void *, int))
+static void *MAINThread(PSFInstance &inst)
 {
+ SPU2State &spu2=*inst.spu2;
  int s_1,s_2,fa;
  unsigned char * start;unsigned int nSample;
  int ch,predict_nr,shift_factor,flags,d,d2,s;
@@ -387,12 +360,12 @@ static void *MAINThread(void (*update)(const void *, int))
    // until enuff free place is available/a new channel gets
    // started
 
-   if(dwNewChannel2[0] || dwNewChannel2[1])            // new channel should start immedately?
+   if(spu2.dwNewChannel2[0] || spu2.dwNewChannel2[1])            // new channel should start immedately?
     {                                                  // (at least one bit 0 ... MAXCHANNEL is set?)
-     iSecureStart++;                                   // -> set iSecure
-     if(iSecureStart>5) iSecureStart=0;                //    (if it is set 5 times - that means on 5 tries a new samples has been started - in a row, we will reset it, to give the sound update a chance)
+     spu2.iSecureStart++;                                   // -> set iSecure
+     if(spu2.iSecureStart>5) spu2.iSecureStart=0;                //    (if it is set 5 times - that means on 5 tries a new samples has been started - in a row, we will reset it, to give the sound update a chance)
     }
-   else iSecureStart=0;                                // 0: no new channel should start
+   else spu2.iSecureStart=0;                                // 0: no new channel should start
 
 /* if (!iSecureStart)
     {
@@ -401,23 +374,23 @@ static void *MAINThread(void (*update)(const void *, int))
     }*/
 
 #if 0
-   while(!iSecureStart && !bEndThread) // &&               // no new start? no thread end?
+   while(!spu2.iSecureStart && !spu2.bEndThread) // &&               // no new start? no thread end?
 //         (SoundGetBytesBuffered()>TESTSIZE))           // and still enuff data in sound buffer?
     {
-     iSecureStart=0;                                   // reset secure
+     spu2.iSecureStart=0;                                   // reset secure
 
      if(iUseTimer) return 0;                           // linux no-thread mode? bye
 
-     if(dwNewChannel2[0] || dwNewChannel2[1])
-      iSecureStart=1;                                  // if a new channel kicks in (or, of course, sound buffer runs low), we will leave the loop
+     if(spu2.dwNewChannel2[0] || spu2.dwNewChannel2[1])
+      spu2.iSecureStart=1;                                  // if a new channel kicks in (or, of course, sound buffer runs low), we will leave the loop
     }
 #endif
 
    //--------------------------------------------------// continue from irq handling in timer mode?
 
-   if(lastch>=0)                                       // will be -1 if no continue is pending
+   if(spu2.lastch>=0)                                       // will be -1 if no continue is pending
     {
-     ch=lastch; lastch=-1;                  // -> setup all kind of vars to continue
+     ch=spu2.lastch; spu2.lastch=-1;                  // -> setup all kind of vars to continue
      goto GOON;                                        // -> directly jump to the continue point
     }
 
@@ -427,39 +400,39 @@ static void *MAINThread(void (*update)(const void *, int))
     {
      for(ch=0;ch<MAXCHAN;ch++)                         // loop em all... we will collect 1 ms of sound of each playing channel
       {
-       if(s_chan[ch].bNew) StartSound(ch);             // start new sound
-       if(!s_chan[ch].bOn) continue;                   // channel not playing? next
+       if(spu2.s_chan[ch].bNew) StartSound(spu2,ch);        // start new sound
+       if(!spu2.s_chan[ch].bOn) continue;                   // channel not playing? next
 
-       if(s_chan[ch].iActFreq!=s_chan[ch].iUsedFreq)   // new psx frequency?
+       if(spu2.s_chan[ch].iActFreq!=spu2.s_chan[ch].iUsedFreq)   // new psx frequency?
         {
-         s_chan[ch].iUsedFreq=s_chan[ch].iActFreq;     // -> take it and calc steps
-         s_chan[ch].sinc=s_chan[ch].iRawPitch<<4;
-         if(!s_chan[ch].sinc) s_chan[ch].sinc=1;
-         if(iUseInterpolation==1) s_chan[ch].SB[32]=1; // -> freq change in simle imterpolation mode: set flag
+         spu2.s_chan[ch].iUsedFreq=spu2.s_chan[ch].iActFreq;     // -> take it and calc steps
+         spu2.s_chan[ch].sinc=spu2.s_chan[ch].iRawPitch<<4;
+         if(!spu2.s_chan[ch].sinc) spu2.s_chan[ch].sinc=1;
+         if(iUseInterpolation==1) spu2.s_chan[ch].SB[32]=1; // -> freq change in simle imterpolation mode: set flag
         }
 //       ns=0;
 //       while(ns<NSSIZE)                                // loop until 1 ms of data is reached
         {
-         while(s_chan[ch].spos>=0x10000L)
+         while(spu2.s_chan[ch].spos>=0x10000L)
           {
-           if(s_chan[ch].iSBPos==28)                   // 28 reached?
+           if(spu2.s_chan[ch].iSBPos==28)                   // 28 reached?
             {
-             start=s_chan[ch].pCurr;                   // set up the current pos
+             start=spu2.s_chan[ch].pCurr;                   // set up the current pos
 
              if (start == (unsigned char*)-1)          // special "stop" sign
               {
-               s_chan[ch].bOn=0;                       // -> turn everything off
-               s_chan[ch].ADSRX.lVolume=0;
-               s_chan[ch].ADSRX.EnvelopeVol=0;
+               spu2.s_chan[ch].bOn=0;                       // -> turn everything off
+               spu2.s_chan[ch].ADSRX.lVolume=0;
+               spu2.s_chan[ch].ADSRX.EnvelopeVol=0;
                goto ENDX;                              // -> and done for this channel
               }
 
-             s_chan[ch].iSBPos=0;
+             spu2.s_chan[ch].iSBPos=0;
 
              //////////////////////////////////////////// spu irq handler here? mmm... do it later
 
-             s_1=s_chan[ch].s_1;
-             s_2=s_chan[ch].s_2;
+             s_1=spu2.s_chan[ch].s_1;
+             s_2=spu2.s_chan[ch].s_2;
 
              predict_nr=(int)*start;start++;
              shift_factor=predict_nr&0xf;
@@ -479,29 +452,29 @@ static void *MAINThread(void (*update)(const void *, int))
                s_2=s_1;s_1=fa;
                s=((d & 0xf0) << 8);
 
-               s_chan[ch].SB[nSample++]=fa;
+               spu2.s_chan[ch].SB[nSample++]=fa;
 
                if(s&0x8000) s|=0xffff0000;
                fa=(s>>shift_factor);
                fa=fa + ((s_1 * f[predict_nr][0])>>6) + ((s_2 * f[predict_nr][1])>>6);
                s_2=s_1;s_1=fa;
 
-               s_chan[ch].SB[nSample++]=fa;
+               spu2.s_chan[ch].SB[nSample++]=fa;
               }
 
              //////////////////////////////////////////// irq check
 
-             if(spuCtrl2[ch/24]&0x40)                  // some irq active?
+             if(spu2.spuCtrl2[ch/24]&0x40)                  // some irq active?
               {
-               if((pSpuIrq[ch/24] >  start-16 &&       // irq address reached?
-                   pSpuIrq[ch/24] <= start) ||
+               if((spu2.pSpuIrq[ch/24] >  start-16 &&       // irq address reached?
+                   spu2.pSpuIrq[ch/24] <= start) ||
                   ((flags&1) &&                        // special: irq on looping addr, when stop/loop flag is set
-                   (pSpuIrq[ch/24] >  s_chan[ch].pLoop-16 &&
-                    pSpuIrq[ch/24] <= s_chan[ch].pLoop)))
+                   (spu2.pSpuIrq[ch/24] >  spu2.s_chan[ch].pLoop-16 &&
+                    spu2.pSpuIrq[ch/24] <= spu2.s_chan[ch].pLoop)))
                 {
-                 s_chan[ch].iIrqDone=1;                // -> debug flag
+                 spu2.s_chan[ch].iIrqDone=1;                // -> debug flag
 
-                 if(irqCallback) irqCallback();        // -> call main emu (not supported in SPU2 right now)
+                 if(spu2.irqCallback) spu2.irqCallback();        // -> call main emu (not supported in SPU2 right now)
                  else
                   {
                    if(ch<24) InterruptDMA4();            // -> let's see what is happening if we call our irqs instead ;)
@@ -510,7 +483,7 @@ static void *MAINThread(void (*update)(const void *, int))
 
                  if(iSPUIRQWait)                       // -> option: wait after irq for main emu
                   {
-                   iSpuAsyncWait=1;
+                   spu2.iSpuAsyncWait=1;
                    bIRQReturn=1;
                   }
                 }
@@ -518,29 +491,29 @@ static void *MAINThread(void (*update)(const void *, int))
 
              //////////////////////////////////////////// flag handler
 
-             if((flags&4) && (!s_chan[ch].bIgnoreLoop))
-              s_chan[ch].pLoop=start-16;               // loop adress
+             if((flags&4) && (!spu2.s_chan[ch].bIgnoreLoop))
+              spu2.s_chan[ch].pLoop=start-16;               // loop adress
 
              if(flags&1)                               // 1: stop/loop
               {
-               dwEndChannel2[ch/24]|=(1<<(ch%24));
+               spu2.dwEndChannel2[ch/24]|=(1<<(ch%24));
 
                // We play this block out first...
                //if(!(flags&2)|| s_chan[ch].pLoop==nullptr)
                                                        // 1+2: do loop... otherwise: stop
-               if(flags!=3 || s_chan[ch].pLoop==nullptr)  // PETE: if we don't check exactly for 3, loop hang ups will happen (DQ4, for example)
+               if(flags!=3 || spu2.s_chan[ch].pLoop==nullptr)  // PETE: if we don't check exactly for 3, loop hang ups will happen (DQ4, for example)
                 {                                      // and checking if pLoop is set avoids crashes, yeah
                  start = (unsigned char*)-1;
                 }
                else
                 {
-                 start = s_chan[ch].pLoop;
+                 start = spu2.s_chan[ch].pLoop;
                 }
               }
 
-             s_chan[ch].pCurr=start;                   // store values for next cycle
-             s_chan[ch].s_1=s_1;
-             s_chan[ch].s_2=s_2;
+             spu2.s_chan[ch].pCurr=start;                   // store values for next cycle
+             spu2.s_chan[ch].s_1=s_1;
+             spu2.s_chan[ch].s_2=s_2;
 
              ////////////////////////////////////////////
 
@@ -548,7 +521,7 @@ static void *MAINThread(void (*update)(const void *, int))
               {
                bIRQReturn=0;
                 {
-                 lastch=ch;
+                 spu2.lastch=ch;
 //                 lastns=ns;   // changemeback
 
                  return nullptr;
@@ -561,7 +534,7 @@ GOON: ;
 
             }
 
-           fa=s_chan[ch].SB[s_chan[ch].iSBPos++];      // get sample data
+           fa=spu2.s_chan[ch].SB[spu2.s_chan[ch].iSBPos++];      // get sample data
 
 //           if((spuCtrl2[ch/24]&0x4000)==0) fa=0;       // muted?
 //           else                                        // else adjust
@@ -572,23 +545,23 @@ GOON: ;
 
            if(iUseInterpolation>=2)                    // gauss/cubic interpolation
             {
-             gpos = s_chan[ch].SB[28];
+             gpos = spu2.s_chan[ch].SB[28];
              gval0 = fa;
              gpos = (gpos+1) & 3;
-             s_chan[ch].SB[28] = gpos;
+             spu2.s_chan[ch].SB[28] = gpos;
             }
            else
            if(iUseInterpolation==1)                    // simple interpolation
             {
-             s_chan[ch].SB[28] = 0;
-             s_chan[ch].SB[29] = s_chan[ch].SB[30];    // -> helpers for simple linear interpolation: delay real val for two slots, and calc the two deltas, for a 'look at the future behaviour'
-             s_chan[ch].SB[30] = s_chan[ch].SB[31];
-             s_chan[ch].SB[31] = fa;
-             s_chan[ch].SB[32] = 1;                    // -> flag: calc new interolation
+             spu2.s_chan[ch].SB[28] = 0;
+             spu2.s_chan[ch].SB[29] = spu2.s_chan[ch].SB[30];    // -> helpers for simple linear interpolation: delay real val for two slots, and calc the two deltas, for a 'look at the future behaviour'
+             spu2.s_chan[ch].SB[30] = spu2.s_chan[ch].SB[31];
+             spu2.s_chan[ch].SB[31] = fa;
+             spu2.s_chan[ch].SB[32] = 1;                    // -> flag: calc new interolation
             }
-           else s_chan[ch].SB[29]=fa;                  // no interpolation
+           else spu2.s_chan[ch].SB[29]=fa;                  // no interpolation
 
-           s_chan[ch].spos -= 0x10000L;
+           spu2.s_chan[ch].spos -= 0x10000L;
           }
 
          ////////////////////////////////////////////////
@@ -596,32 +569,32 @@ GOON: ;
          // surely wrong... and no noise frequency (spuCtrl&0x3f00) will be used...
          // and sometimes the noise will be used as fmod modulation... pfff
 
-         if(s_chan[ch].bNoise)
+         if(spu2.s_chan[ch].bNoise)
           {
-           if((dwNoiseVal<<=1)&0x80000000L)
+           if((spu2.dwNoiseVal<<=1)&0x80000000L)
             {
-             dwNoiseVal^=0x0040001L;
-             fa=((dwNoiseVal>>2)&0x7fff);
+             spu2.dwNoiseVal^=0x0040001L;
+             fa=((spu2.dwNoiseVal>>2)&0x7fff);
              fa=-fa;
             }
-           else fa=(dwNoiseVal>>2)&0x7fff;
+           else fa=(spu2.dwNoiseVal>>2)&0x7fff;
 
            // mmm... depending on the noise freq we allow bigger/smaller changes to the previous val
-           fa=s_chan[ch].iOldNoise+((fa-s_chan[ch].iOldNoise)/((0x001f-((spuCtrl2[ch/24]&0x3f00)>>9))+1));
+           fa=spu2.s_chan[ch].iOldNoise+((fa-spu2.s_chan[ch].iOldNoise)/((0x001f-((spu2.spuCtrl2[ch/24]&0x3f00)>>9))+1));
            if(fa>32767L)  fa=32767L;
            if(fa<-32767L) fa=-32767L;
-           s_chan[ch].iOldNoise=fa;
+           spu2.s_chan[ch].iOldNoise=fa;
 
            if(iUseInterpolation<2)                     // no gauss/cubic interpolation?
-            s_chan[ch].SB[29] = fa;                    // -> store noise val in "current sample" slot
+            spu2.s_chan[ch].SB[29] = fa;                    // -> store noise val in "current sample" slot
           }                                            //----------------------------------------
          else                                          // NO NOISE (NORMAL SAMPLE DATA) HERE
           {//------------------------------------------//
            if(iUseInterpolation==3)                    // cubic interpolation
             {
              long xd;
-             xd = ((s_chan[ch].spos) >> 1)+1;
-             gpos = s_chan[ch].SB[28];
+             xd = ((spu2.s_chan[ch].spos) >> 1)+1;
+             gpos = spu2.s_chan[ch].SB[28];
 
              fa  = gval(3) - 3*gval(2) + 3*gval(1) - gval0;
              fa *= (xd - (2<<15)) / 6;
@@ -639,8 +612,8 @@ GOON: ;
            if(iUseInterpolation==2)                    // gauss interpolation
             {
              int vl, vr;
-             vl = (s_chan[ch].spos >> 6) & ~3;
-             gpos = s_chan[ch].SB[28];
+             vl = (spu2.s_chan[ch].spos >> 6) & ~3;
+             gpos = spu2.s_chan[ch].SB[28];
              vr=(gauss[vl]*gval0)&~2047;
              vr+=(gauss[vl+1]*gval(1))&~2047;
              vr+=(gauss[vl+2]*gval(2))&~2047;
@@ -658,23 +631,23 @@ GOON: ;
            else
            if(iUseInterpolation==1)                    // simple interpolation
             {
-             if(s_chan[ch].sinc<0x10000L)              // -> upsampling?
-                  InterpolateUp(ch);                   // --> interpolate up
-             else InterpolateDown(ch);                 // --> else down
-             fa=s_chan[ch].SB[29];
+             if(spu2.s_chan[ch].sinc<0x10000L)              // -> upsampling?
+                  InterpolateUp(spu2,ch);              // --> interpolate up
+             else InterpolateDown(spu2,ch);            // --> else down
+             fa=spu2.s_chan[ch].SB[29];
             }
            //------------------------------------------//
-           else fa=s_chan[ch].SB[29];                  // no interpolation
+           else fa=spu2.s_chan[ch].SB[29];                  // no interpolation
           }
 
-         s_chan[ch].sval = (MixADSR(ch) * fa) / 1023;  // add adsr
+         spu2.s_chan[ch].sval = (MixADSR(spu2,ch) * fa) / 1023;  // add adsr
 
-         if(s_chan[ch].bFMod==2)                       // fmod freq channel
+         if(spu2.s_chan[ch].bFMod==2)                       // fmod freq channel
           {
-           int NP=s_chan[ch+1].iRawPitch;
+           int NP=spu2.s_chan[ch+1].iRawPitch;
            double intr;
 
-           NP=((32768L+s_chan[ch].sval)*NP)/32768L;    // mmm... I still need to adjust that to 1/48 khz... we will wait for the first game/demo using it to decide how to do it :)
+           NP=((32768L+spu2.s_chan[ch].sval)*NP)/32768L;    // mmm... I still need to adjust that to 1/48 khz... we will wait for the first game/demo using it to decide how to do it :)
 
            if(NP>0x3fff) NP=0x3fff;
            if(NP<0x1)    NP=0x1;
@@ -684,12 +657,12 @@ GOON: ;
 
            NP=(44100L*NP)/(4096L);                     // calc frequency
 
-           s_chan[ch+1].iActFreq=NP;
-           s_chan[ch+1].iUsedFreq=NP;
-           s_chan[ch+1].sinc=(((NP/10)<<16)/4410);
-           if(!s_chan[ch+1].sinc) s_chan[ch+1].sinc=1;
+           spu2.s_chan[ch+1].iActFreq=NP;
+           spu2.s_chan[ch+1].iUsedFreq=NP;
+           spu2.s_chan[ch+1].sinc=(((NP/10)<<16)/4410);
+           if(!spu2.s_chan[ch+1].sinc) spu2.s_chan[ch+1].sinc=1;
            if(iUseInterpolation==1)                    // freq change in sipmle interpolation mode
-            s_chan[ch+1].SB[32]=1;
+            spu2.s_chan[ch+1].SB[32]=1;
 
 // mmmm... set up freq decoding positions?
 //           s_chan[ch+1].iSBPos=28;
@@ -700,26 +673,26 @@ GOON: ;
            //////////////////////////////////////////////
            // ok, left/right sound volume (psx volume goes from 0 ... 0x3fff)
 
-           if(s_chan[ch].iMute)
-            s_chan[ch].sval=0;                         // debug mute
+           if(spu2.s_chan[ch].iMute)
+            spu2.s_chan[ch].sval=0;                         // debug mute
            else
             {
-             if(s_chan[ch].bVolumeL)
-              SSumL[0]+=(s_chan[ch].sval*s_chan[ch].iLeftVolume)/0x4000L;
-             if(s_chan[ch].bVolumeR)
-              SSumR[0]+=(s_chan[ch].sval*s_chan[ch].iRightVolume)/0x4000L;
+             if(spu2.s_chan[ch].bVolumeL)
+              spu2.mixDryL[ch]=spu2.s_chan[ch].sval;             // volume gets applied by the mixer below
+             if(spu2.s_chan[ch].bVolumeR)
+              spu2.mixDryR[ch]=spu2.s_chan[ch].sval;
             }
 
            //////////////////////////////////////////////
            // now let us store sound data for reverb
 
-           if(s_chan[ch].bRVBActive) StoreREVERB(ch,0);
+           if(spu2.s_chan[ch].bRVBActive) StoreREVERB(spu2,ch,0);
           }
 
          ////////////////////////////////////////////////
          // ok, go on until 1 ms data of this channel is collected
 
-         s_chan[ch].spos += s_chan[ch].sinc;
+         spu2.s_chan[ch].spos += spu2.s_chan[ch].sinc;
 
         }
 ENDX:   ;
@@ -730,59 +703,73 @@ ENDX:   ;
   //- here we have another 1 ms of sound data
   //---------------------------------------------------//
 
+  ///////////////////////////////////////////////////////
+  // apply the voice volumes, summing across voices
+
+    spu2.SSumL[0]+=spu_mix<true>(spu2.mixDryL,spu2.voiceVolL,MAXCHAN);
+    spu2.SSumR[0]+=spu_mix<true>(spu2.mixDryR,spu2.voiceVolR,MAXCHAN);
+    spu2.sRVBStart[0][0]+=spu_mix<true>(spu2.mixRvbL,spu2.voiceVolL,24);   // reverb send of each core
+    spu2.sRVBStart[0][1]+=spu_mix<true>(spu2.mixRvbR,spu2.voiceVolR,24);
+    spu2.sRVBStart[1][0]+=spu_mix<true>(spu2.mixRvbL+24,spu2.voiceVolL+24,24);
+    spu2.sRVBStart[1][1]+=spu_mix<true>(spu2.mixRvbR+24,spu2.voiceVolR+24,24);
+    memset(spu2.mixDryL,0,sizeof(spu2.mixDryL));
+    memset(spu2.mixDryR,0,sizeof(spu2.mixDryR));
+    memset(spu2.mixRvbL,0,sizeof(spu2.mixRvbL));
+    memset(spu2.mixRvbR,0,sizeof(spu2.mixRvbR));
+
   ///////////////////////////////////////////////////////
   // mix all channels (including reverb) into one buffer
 
-    SSumL[0]+=MixREVERBLeft(0,0);
-    SSumL[0]+=MixREVERBLeft(0,1);
-    SSumR[0]+=MixREVERBRight(0);
-    SSumR[0]+=MixREVERBRight(1);
+    spu2.SSumL[0]+=MixREVERBLeft(spu2,0,0);
+    spu2.SSumL[0]+=MixREVERBLeft(spu2,0,1);
+    spu2.SSumR[0]+=MixREVERBRight(spu2,0);
+    spu2.SSumR[0]+=MixREVERBRight(spu2,1);
 
-    d=SSumL[0];SSumL[0]=0;
-    d2=SSumR[0];SSumR[0]=0;
+    d=spu2.SSumL[0];spu2.SSumL[0]=0;
+    d2=spu2.SSumR[0];spu2.SSumR[0]=0;
 
     if(d<-32767) d=-32767;
     if(d>32767) d=32767;
     if(d2<-32767) d2=-32767;
     if(d2>32767) d2=32767;
 
-    if(sampcount>=decaybegin)
+    if(spu2.sampcount>=spu2.decaybegin)
      {
       s32 dmul;
-      if(decaybegin!=~0U) // Is anyone REALLY going to be playing a song
+      if(spu2.decaybegin!=~0U) // Is anyone REALLY going to be playing a song
                          // for 13 hours?
        {
-        if(sampcount>=decayend)
+        if(spu2.sampcount>=spu2.decayend)
          {
-          update(nullptr, 0);
+          inst.update(nullptr, 0);
           return(0);
          }
 
-        dmul=256-(256*(sampcount-decaybegin)/(decayend-decaybegin));
+        dmul=256-(256*(spu2.sampcount-spu2.decaybegin)/(spu2.decayend-spu2.decaybegin));
         d=(d*dmul)>>8;
         d2=(d2*dmul)>>8;
        }
      }
-    sampcount++;
+    spu2.sampcount++;
 
-    *pS++=d;
-    *pS++=d2;
+    *spu2.pS++=d;
+    *spu2.pS++=d2;
 
     InitREVERB();
 
   //////////////////////////////////////////////////////
   // feed the sound
   // wanna have around 1/60 sec (16.666 ms) updates
-  if(seektime != 0 && sampcount < seektime)
+  if(spu2.seektime != 0 && spu2.sampcount < spu2.seektime)
    {
-    pS=(short *)pSpuBuffer;
+    spu2.pS=(short *)spu2.pSpuBuffer;
    }
-  else if((((u8*)pS)-((u8*)pSpuBuffer)) == (735*4))
+  else if((((u8*)spu2.pS)-((u8*)spu2.pSpuBuffer)) == (735*4))
    {
-    short *pSilenceIter = (short *)pSpuBuffer;
+    short *pSilenceIter = (short *)spu2.pSpuBuffer;
     int iSilenceCount = 0;
 
-    for(; pSilenceIter < pS; pSilenceIter++)
+    for(; pSilenceIter < spu2.pS; pSilenceIter++)
      {
       if(*pSilenceIter == 0)
        iSilenceCount++;
@@ -792,15 +779,15 @@ ENDX:   ;
      }
 
     if(iSilenceCount < 20)
-     update((u8*)pSpuBuffer,(u8*)pS-(u8*)pSpuBuffer);
+     inst.update((u8*)spu2.pSpuBuffer,(u8*)spu2.pS-(u8*)spu2.pSpuBuffer);
 
-    pS=(short *)pSpuBuffer;
+    spu2.pS=(short *)spu2.pSpuBuffer;
    }
  }
 
  // end of big main loop...
 
- bThreadEnded=1;
+ spu2.bThreadEnded=1;
 
  return 0;
 }
@@ -814,15 +801,15 @@ ENDX:   ;
 //  1 time every 'cycle' cycles... harhar
 ////////////////////////////////////////////////////////////////////////
 
-EXPORT_GCC void CALLBACK SPU2async(void (*update)(const void *, int))
+EXPORT_GCC void CALLBACK SPU2async(PSFInstance &inst)
 {
- if(iSpuAsyncWait)
+ if(SPU2.iSpuAsyncWait)
   {
-   iSpuAsyncWait++;
-   if(iSpuAsyncWait<=64) return;
-   iSpuAsyncWait=0;
+   SPU2.iSpuAsyncWait++;
+   if(SPU2.iSpuAsyncWait<=64) return;
+   SPU2.iSpuAsyncWait=0;
   }
- MAINThread(update);                                      // -> linux high-compat mode
+ MAINThread(inst);                                      // -> linux high-compat mode
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -836,12 +823,12 @@ EXPORT_GCC void CALLBACK SPU2async(void (*update)(const void *, int))
 
 EXPORT_GCC long CALLBACK SPU2init(void)
 {
- spuMemC=(unsigned char *)spuMem;                      // just small setup
- memset((void *)s_chan,0,MAXCHAN*sizeof(SPUCHAN2));
- memset(rvb,0,2*sizeof(REVERBInfo2));
+ SPU2.spuMemC=(unsigned char *)SPU2.spuMem;                      // just small setup
+ memset((void *)SPU2.s_chan,0,MAXCHAN*sizeof(SPUCHAN2));
+ memset(SPU2.rvb,0,2*sizeof(REVERBInfo2));
 
- sampcount = 0;
- seektime = 0;
+ SPU2.sampcount = 0;
+ SPU2.seektime = 0;
 
  InitADSR();
 
@@ -854,13 +841,13 @@ EXPORT_GCC long CALLBACK SPU2init(void)
 
 static void SetupTimer(void)
 {
- memset(SSumR,0,NSSIZE*sizeof(int));                   // init some mixing buffers
- memset(SSumL,0,NSSIZE*sizeof(int));
- pS=(short *)pSpuBuffer;                               // setup soundbuffer pointer
+ memset(SPU2.SSumR,0,NSSIZE*sizeof(int));                   // init some mixing buffers
+ memset(SPU2.SSumL,0,NSSIZE*sizeof(int));
+ SPU2.pS=(short *)SPU2.pSpuBuffer;                               // setup soundbuffer pointer
 
- bEndThread=0;                                         // init thread vars
- bThreadEnded=0;
- bSpuInit=1;                                           // flag: we are inited
+ SPU2.bEndThread=0;                                         // init thread vars
+ SPU2.bThreadEnded=0;
+ SPU2.bSpuInit=1;                                           // flag: we are inited
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -869,9 +856,9 @@ static void SetupTimer(void)
 
 static void RemoveTimer(void)
 {
- bEndThread=1;                                         // raise flag to end thread
- bThreadEnded=0;                                       // no more spu is running
- bSpuInit=0;
+ SPU2.bEndThread=1;                                         // raise flag to end thread
+ SPU2.bThreadEnded=0;                                       // no more spu is running
+ SPU2.bSpuInit=0;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -882,30 +869,30 @@ static void SetupStreams(void)
 {
  int i;
 
- pSpuBuffer=(unsigned char *)malloc(32768);            // alloc mixing buffer
+ SPU2.pSpuBuffer=(unsigned char *)malloc(32768);            // alloc mixing buffer
 
  i=NSSIZE*2;
 
- sRVBStart[0] = (int *)malloc(i*4);                    // alloc reverb buffer
- memset(sRVBStart[0],0,i*4);
- sRVBEnd[0]  = sRVBStart[0] + i;
- sRVBPlay[0] = sRVBStart[0];
- sRVBStart[1] = (int *)malloc(i*4);                    // alloc reverb buffer
- memset(sRVBStart[1],0,i*4);
- sRVBEnd[1]  = sRVBStart[1] + i;
- sRVBPlay[1] = sRVBStart[1];
+ SPU2.sRVBStart[0] = (int *)malloc(i*4);                    // alloc reverb buffer
+ memset(SPU2.sRVBStart[0],0,i*4);
+ SPU2.sRVBEnd[0]  = SPU2.sRVBStart[0] + i;
+ SPU2.sRVBPlay[0] = SPU2.sRVBStart[0];
+ SPU2.sRVBStart[1] = (int *)malloc(i*4);                    // alloc reverb buffer
+ memset(SPU2.sRVBStart[1],0,i*4);
+ SPU2.sRVBEnd[1]  = SPU2.sRVBStart[1] + i;
+ SPU2.sRVBPlay[1] = SPU2.sRVBStart[1];
 
  for(i=0;i<MAXCHAN;i++)                                // loop sound channels
   {
 // we don't use mutex sync... not needed, would only
 // slow us down:
 //   s_chan[i].hMutex=CreateMutex(nullptr,false,nullptr);
-   s_chan[i].ADSRX.SustainLevel = 1024;                // -> init sustain
-   s_chan[i].iMute=0;
-   s_chan[i].iIrqDone=0;
-   s_chan[i].pLoop=spuMemC;
-   s_chan[i].pStart=spuMemC;
-   s_chan[i].pCurr=spuMemC;
+   SPU2.s_chan[i].ADSRX.SustainLevel = 1024;                // -> init sustain
+   SPU2.s_chan[i].iMute=0;
+   SPU2.s_chan[i].iIrqDone=0;
+   SPU2.s_chan[i].pLoop=SPU2.spuMemC;
+   SPU2.s_chan[i].pStart=SPU2.spuMemC;
+   SPU2.s_chan[i].pCurr=SPU2.spuMemC;
   }
 }
 
@@ -915,12 +902,12 @@ static void SetupStreams(void)
 
 static void RemoveStreams(void)
 {
- free(pSpuBuffer);                                     // free mixing buffer
- pSpuBuffer=nullptr;
- free(sRVBStart[0]);                                   // free reverb buffer
- sRVBStart[0]=0;
- free(sRVBStart[1]);                                   // free reverb buffer
- sRVBStart[1]=0;
+ free(SPU2.pSpuBuffer);                                     // free mixing buffer
+ SPU2.pSpuBuffer=nullptr;
+ free(SPU2.sRVBStart[0]);                                   // free reverb buffer
+ SPU2.sRVBStart[0]=0;
+ free(SPU2.sRVBStart[1]);                                   // free reverb buffer
+ SPU2.sRVBStart[1]=0;
 
 /*
  int i;
@@ -941,32 +928,38 @@ static void RemoveStreams(void)
 
 EXPORT_GCC long CALLBACK SPU2open(void *pDsp)
 {
- if(bSPUIsOpen) return 0;                              // security for some stupid main emus
+ if(SPU2.bSPUIsOpen) return 0;                              // security for some stupid main emus
 
  iUseXA=0;                                             // just small setup
- bEndThread=0;
- bThreadEnded=0;
- spuMemC=(unsigned char *)spuMem;
- memset((void *)s_chan,0,(MAXCHAN+1)*sizeof(SPUCHAN2));
- pSpuIrq[0]=0;
- pSpuIrq[1]=0;
+ SPU2.bEndThread=0;
+ SPU2.bThreadEnded=0;
+ SPU2.spuMemC=(unsigned char *)SPU2.spuMem;
+ memset((void *)SPU2.s_chan,0,(MAXCHAN+1)*sizeof(SPUCHAN2));
+ memset(SPU2.voiceVolL,0,sizeof(SPU2.voiceVolL));
+ memset(SPU2.voiceVolR,0,sizeof(SPU2.voiceVolR));
+ memset(SPU2.mixDryL,0,sizeof(SPU2.mixDryL));
+ memset(SPU2.mixDryR,0,sizeof(SPU2.mixDryR));
+ memset(SPU2.mixRvbL,0,sizeof(SPU2.mixRvbL));
+ memset(SPU2.mixRvbR,0,sizeof(SPU2.mixRvbR));
+ SPU2.pSpuIrq[0]=0;
+ SPU2.pSpuIrq[1]=0;
  iSPUIRQWait=1;
- dwNewChannel2[0]=0;
- dwNewChannel2[1]=0;
- dwEndChannel2[0]=0;
- dwEndChannel2[1]=0;
- spuCtrl2[0]=0;
- spuCtrl2[1]=0;
- spuStat2[0]=0;
- spuStat2[1]=0;
- spuIrq2[0]=0;
- spuIrq2[1]=0;
- spuAddr2[0]=0xffffffff;
- spuAddr2[1]=0xffffffff;
- spuRvbAddr2[0]=0;
- spuRvbAddr2[1]=0;
- spuRvbAEnd2[0]=0;
- spuRvbAEnd2[1]=0;
+ SPU2.dwNewChannel2[0]=0;
+ SPU2.dwNewChannel2[1]=0;
+ SPU2.dwEndChannel2[0]=0;
+ SPU2.dwEndChannel2[1]=0;
+ SPU2.spuCtrl2[0]=0;
+ SPU2.spuCtrl2[1]=0;
+ SPU2.spuStat2[0]=0;
+ SPU2.spuStat2[1]=0;
+ SPU2.spuIrq2[0]=0;
+ SPU2.spuIrq2[1]=0;
+ SPU2.spuAddr2[0]=0xffffffff;
+ SPU2.spuAddr2[1]=0xffffffff;
+ SPU2.spuRvbAddr2[0]=0;
+ SPU2.spuRvbAddr2[1]=0;
+ SPU2.spuRvbAEnd2[0]=0;
+ SPU2.spuRvbAEnd2[1]=0;
 
 // ReadConfig();                                         // read user stuff
 
@@ -976,7 +969,7 @@ EXPORT_GCC long CALLBACK SPU2open(void *pDsp)
 
  SetupTimer();                                         // timer for feeding data
 
- bSPUIsOpen=1;
+ SPU2.bSPUIsOpen=1;
 
  return 0;
 }
@@ -989,9 +982,9 @@ EXPORT_GCC long CALLBACK SPU2open(void *pDsp)
 
 EXPORT_GCC void CALLBACK SPU2close(void)
 {
- if(!bSPUIsOpen) return;                               // some security
+ if(!SPU2.bSPUIsOpen) return;                               // some security
 
- bSPUIsOpen=0;                                         // no more open
+ SPU2.bSPUIsOpen=0;                                         // no more open
 
  RemoveTimer();                                        // no more feeding
 
@@ -1000,6 +993,47 @@ EXPORT_GCC void CALLBACK SPU2close(void)
  RemoveStreams();                                      // no more streaming
 }
 
+////////////////////////////////////////////////////////////////////////
+// SPU2STATE: save/restore for seek snapshots (seektime is left alone,
+// it belongs to the seek being served)
+////////////////////////////////////////////////////////////////////////
+
+void SPU2state(PSFState &state)
+{
+ state.io(SPU2.regArea);
+ state.io(SPU2.spuMem);
+ state.io(SPU2.pSpuIrq);
+ state.io(SPU2.s_chan);
+ state.io(SPU2.rvb);
+ state.io(SPU2.dwNoiseVal);
+ state.io(SPU2.spuCtrl2);
+ state.io(SPU2.spuStat2);
+ state.io(SPU2.spuIrq2);
+ state.io(SPU2.spuAddr2);
+ state.io(SPU2.spuRvbAddr2);
+ state.io(SPU2.spuRvbAEnd2);
+ state.io(SPU2.dwNewChannel2);
+ state.io(SPU2.dwEndChannel2);
+ state.io(SPU2.SSumR);
+ state.io(SPU2.SSumL);
+ state.io(SPU2.voiceVolL);
+ state.io(SPU2.voiceVolR);
+ state.io(SPU2.mixDryL);
+ state.io(SPU2.mixDryR);
+ state.io(SPU2.mixRvbL);
+ state.io(SPU2.mixRvbR);
+ state.io(SPU2.iCycle);
+ state.io(SPU2.lastch);
+ state.io(SPU2.iSecureStart);
+ state.io(SPU2.sampcount);
+ state.io(SPU2.iSpuAsyncWait);
+ state.io(SPU2.sRVBPlay);
+ state.io(SPU2.sRVBStart[0],NSSIZE*2*4);
+ state.io(SPU2.sRVBStart[1],NSSIZE*2*4);
+ state.io(SPU2.pS);
+ state.io(SPU2.pSpuBuffer,(u8*)SPU2.pS-SPU2.pSpuBuffer);              // partly filled output
+}
+
 #if 0
 ////////////////////////////////////////////////////////////////////////
 // SPUSHUTDOWN: called by main emu on final exit
@@ -1028,13 +1062,13 @@ EXPORT_GCC long CALLBACK SPU2test(void)
 // not used yet
 EXPORT_GCC void CALLBACK SPU2irqCallback(void (CALLBACK *callback)(void))
 {
- irqCallback = callback;
+ SPU2.irqCallback = callback;
 }
 
 // not used yet
 EXPORT_GCC void CALLBACK SPU2registerCallback(void (CALLBACK *callback)(void))
 {
- irqCallback = callback;
+ SPU2.irqCallback = callback;
 }
 
 // not used yet
@@ -27,12 +27,21 @@
 //
 //*************************************************************************//
 
-void setendless2(int e);
+class PSFInstance;
+class PSFState;
+struct SPU2State;
+
+SPU2State *SPU2alloc_state(void);
+void SPU2free_state(SPU2State *spu2);
+
+void setendless2(PSFInstance &inst, int e);
 void setlength2(int32_t stop, int32_t fade);
 
 long SPU2init(void);
 long SPU2open(void *pDsp);
-void SPU2async(void (*update)(const void *, int));
+void SPU2async(PSFInstance &inst);
 void SPU2close(void);
+void SPU2state(PSFState &state);
 
-int psf2_seek(uint32_t t);
+int psf2_seek(PSFInstance &inst, uint32_t t);
+uint32_t psf2_tell(PSFInstance &inst);
@@ -66,8 +66,8 @@ public:
     bool read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image);
     bool play(const char *filename, VFSFile &file);
 
-protected:
-    static void update(const void *data, int bytes);
+private:
+    class Playback;
 };
 
 EXPORT PSFPlugin aud_plugin_instance;
@@ -81,22 +81,25 @@ typedef enum {
 } PSFEngine;
 
 typedef struct {
-    int32_t (*start)(uint8_t *buffer, uint32_t length);
-    int32_t (*stop)(void);
-    int32_t (*seek)(uint32_t);
-    int32_t (*execute)(void (*update)(const void *, int));
+    int32_t (*start)(PSFInstance &inst, uint8_t *buffer, uint32_t length);
+    int32_t (*stop)(PSFInstance &inst);
+    int32_t (*seek)(PSFInstance &inst, uint32_t);
+    uint32_t (*tell)(PSFInstance &inst);
+    void (*state)(PSFInstance &inst, PSFState &state);
+    int32_t (*execute)(PSFInstance &inst);
 } PSFEngineFunctors;
 
 static PSFEngineFunctors psf_functor_map[ENG_COUNT] = {
-    {nullptr, nullptr, nullptr, nullptr},
-    {psf_start, psf_stop, psf_seek, psf_execute},
-    {psf2_start, psf2_stop, psf2_seek, psf2_execute},
-    {spx_start, spx_stop, psf_seek, spx_execute},
+    {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
+    {psf_start, psf_stop, psf_seek, psf_tell, psf_state, psf_execute},
+    {psf2_start, psf2_stop, psf2_seek, psf2_tell, psf2_state, psf2_execute},
+    {spx_start, spx_stop, psf_seek, psf_tell, spx_state, spx_execute},
 };
 
 const char* const PSFPlugin::defaults[] =
 {
     "ignore_length", "FALSE",
+    "snapshot_budget", "64",
     nullptr
 };
 
@@ -106,15 +109,41 @@ bool PSFPlugin::init()
     return true;
 }
 
-static PSFEngineFunctors *f;
-static String dirpath;
+class PSFPlugin::Playback : public PSFInstance
+{
+public:
+    PSFEngineFunctors *f = nullptr;
+    String dirpath;
+
+    /* The emulation engine can only seek forward, not back.  This variable is
+     * set a non-negative time (milliseconds) when the song is to be restarted
+     * in order to seek backward. */
+    int reverse_seek = -1;
+
+    /* To avoid most restarts, the engine state is saved every so often as the
+     * song plays.  A seek is then served by restoring the last snapshot before
+     * the target and running forward from there.  When the snapshots outgrow
+     * the memory budget, every other one is dropped and the interval doubled. */
+    struct Snapshot {
+        int time;
+        Index<char> data;
+    };
 
-bool stop_flag = false;
+    Index<Snapshot> snapshots;
+    int64_t snapshot_budget = 0;
+    int snapshot_interval = 5000;
 
-/* The emulation engine can only seek forward, not back.  This variable is set
- * a non-negative time (milliseconds) when the song is to be restarted in order
- * to seek backward. */
-static int reverse_seek;
+    /* seek target (milliseconds) to restore a snapshot for at the next
+     * checkpoint; audio rendered until then is dropped */
+    int pending_seek = -1;
+
+    Index<char> get_lib(const char *filename);
+    void update(const void *data, int bytes);
+    void checkpoint();
+
+private:
+    int find_snapshot(int time);
+};
 
 static PSFEngine psf_probe(const char *buf, int len)
 {
@@ -136,8 +165,7 @@ static PSFEngine psf_probe(const char *buf, int len)
     return ENG_NONE;
 }
 
-/* ao_get_lib: called to load secondary files */
-Index<char> ao_get_lib(char *filename)
+Index<char> PSFPlugin::Playback::get_lib(const char *filename)
 {
     VFSFile file(filename_build({dirpath, filename}), "r");
     return file ? file.read_all() : Index<char>();
@@ -170,16 +198,18 @@ bool PSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Inde
 bool PSFPlugin::play(const char *filename, VFSFile &file)
 {
     bool error = false;
+    Playback playback;
 
     const char * slash = strrchr (filename, '/');
     if (! slash)
         return false;
 
-    dirpath = String (str_copy (filename, slash + 1 - filename));
+    playback.dirpath = String (str_copy (filename, slash + 1 - filename));
 
     Index<char> buf = file.read_all ();
 
     bool ignore_len = aud_get_bool("psf", "ignore_length");
+    playback.snapshot_budget = (int64_t)aud_get_int("psf", "snapshot_budget") << 20;
 
     PSFEngine eng = psf_probe(buf.begin(), buf.len());
     if (eng == ENG_NONE || eng == ENG_COUNT)
@@ -189,49 +219,47 @@ bool PSFPlugin::play(const char *filename, VFSFile &file)
     }
 
     if(eng == ENG_PSF1 || eng == ENG_SPX)
-        setendless(ignore_len);
+        setendless(playback, ignore_len);
 
     if(eng == ENG_PSF2)
-        setendless2(ignore_len);
+        setendless2(playback, ignore_len);
 
-    f = &psf_functor_map[eng];
+    playback.f = &psf_functor_map[eng];
 
     set_stream_bitrate(44100*2*2*8);
     open_audio(FMT_S16_NE, 44100, 2);
 
-    reverse_seek = -1;
-
     /* This loop will restart playback from the beginning when necessary to seek
      * backwards in the file (reverse_seek >= 0). */
     do
     {
-        if (f->start((uint8_t *)buf.begin(), buf.len()) != AO_SUCCESS)
+        if (playback.f->start(playback, (uint8_t *)buf.begin(), buf.len()) != AO_SUCCESS)
         {
             error = true;
             goto cleanup;
         }
 
-        if (reverse_seek >= 0)
+        /* snapshots refer to buffers of the previous run */
+        playback.snapshots.clear();
+
+        if (playback.reverse_seek >= 0)
         {
-            f->seek(reverse_seek); /* should never fail here */
-            reverse_seek = -1;
+            playback.f->seek(playback, playback.reverse_seek); /* should never fail here */
+            playback.reverse_seek = -1;
         }
 
-        stop_flag = false;
+        playback.stop_flag = false;
 
-        f->execute(update);
-        f->stop();
+        playback.f->execute(playback);
+        playback.f->stop(playback);
     }
-    while (reverse_seek >= 0);
+    while (playback.reverse_seek >= 0);
 
 cleanup:
-    f = nullptr;
-    dirpath = String ();
-
     return ! error;
 }
 
-void PSFPlugin::update(const void *data, int bytes)
+void PSFPlugin::Playback::update(const void *data, int bytes)
 {
     if (!data || check_stop())
     {
@@ -243,18 +271,77 @@ void PSFPlugin::update(const void *data, int bytes)
 
     if (seek >= 0)
     {
-        if (!f->seek(seek))
+        /* use a snapshot if it is closer to the target than we are */
+        int now = f->tell(*this);
+        int snap = find_snapshot(seek);
+
+        if (snap >= 0 && (seek < now || snapshots[snap].time > now))
+            pending_seek = seek;
+        else
         {
-            reverse_seek = seek;
-            stop_flag = true;
+            pending_seek = -1;
+
+            if (!f->seek(*this, seek))
+            {
+                reverse_seek = seek;
+                stop_flag = true;
+            }
         }
 
         return;
     }
 
+    if (pending_seek >= 0)
+        return;
+
     write_audio(data, bytes);
 }
 
+/* returns the index of the last snapshot at or before <time>, or -1 */
+int PSFPlugin::Playback::find_snapshot(int time)
+{
+    int found = -1;
+
+    for (int i = 0; i < snapshots.len() && snapshots[i].time <= time; i++)
+        found = i;
+
+    return found;
+}
+
+void PSFPlugin::Playback::checkpoint()
+{
+    if (pending_seek >= 0)
+    {
+        PSFState state(snapshots[find_snapshot(pending_seek)].data, true);
+        f->state(*this, state);
+        f->seek(*this, pending_seek); /* always forward from the snapshot */
+        pending_seek = -1;
+        return;
+    }
+
+    if (!snapshot_budget)
+        return;
+
+    int time = f->tell(*this);
+    if (snapshots.len() && time < snapshots[snapshots.len() - 1].time + snapshot_interval)
+        return;
+
+    Snapshot &snap = snapshots.append();
+    snap.time = time;
+
+    PSFState state(snap.data, false);
+    f->state(*this, state);
+
+    if ((int64_t)snap.data.len() * snapshots.len() > snapshot_budget)
+    {
+        /* keep the first snapshot so that seeking to the start never restarts */
+        for (int i = 1; i < snapshots.len(); i++)
+            snapshots.remove(i, 1);
+
+        snapshot_interval *= 2;
+    }
+}
+
 bool PSFPlugin::is_our_file(const char *filename, VFSFile &file)
 {
     char magic[4];
@@ -269,6 +356,8 @@ const char *const PSFPlugin::exts[] = { "psf", "minipsf", "psf2", "minipsf2", "s
 const PreferencesWidget PSFPlugin::widgets[] = {
     WidgetLabel(N_("<b>OpenPSF Configuration</b>")),
     WidgetCheck(N_("Ignore length from file"), WidgetBool("psf", "ignore_length")),
+    WidgetSpin(N_("Memory for seek snapshots:"), WidgetInt("psf", "snapshot_budget"),
+        {0, 1024, 16, N_("MiB")}),
 };
 
 const PluginPreferences PSFPlugin::prefs = {{widgets}};
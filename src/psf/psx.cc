@@ -14,11 +14,14 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include "ao.h"
 #include "cpuintrf.h"
 #include "psx.h"
 
+#define LE32(x) FROM_LE32(x)
+
 #define EXC_INT ( 0 )
 #define EXC_ADEL ( 4 )
 #define EXC_ADES ( 5 )
@@ -163,9 +166,35 @@ typedef struct
 	int (*irq_callback)(int irqline);
 } mips_cpu_context;
 
-static mips_cpu_context mipscpu;
+typedef struct
+{
+	uint32_t op;
+	uint8_t handler;
+	uint8_t rs;
+	uint8_t rt;
+	uint8_t rd;
+	uint32_t imm;
+} mips_decoded;
+
+#define MIPS_ICACHE_PAGE_SHIFT ( 10 )
+#define MIPS_ICACHE_PAGE_WORDS ( 1 << MIPS_ICACHE_PAGE_SHIFT )
+#define MIPS_ICACHE_PAGES ( ( ( 2 * 1024 * 1024 ) / 4 ) >> MIPS_ICACHE_PAGE_SHIFT )
+
+struct PSXCPUState
+{
+	mips_cpu_context regs;
+	int icount;
+	mips_decoded *icache[ MIPS_ICACHE_PAGES ];
+	mips_decoded uncached;
+};
 
-static int mips_ICount = 0;
+/* the CPU of the running instance.  mips_execute() loads psf_instance->cpu
+   once and hands it down to everything it calls as cpu, so that the
+   interpreter doesn't go through thread-local storage on every access; the
+   entry points below bind cpu the same way */
+#define MIPSCPU ( cpu.regs )
+#define MIPS_ICOUNT ( cpu.icount )
+#define MIPS_ICACHE ( cpu.icache )
 
 static uint32_t mips_mtc0_writemask[]=
 {
@@ -204,25 +233,25 @@ static uint32_t mips_mtc0_writemask[]=
 };
 
 #if 1
-static void GTELOG(const char *a,...)
+static void GTELOG(PSXCPUState &cpu, const char *a,...)
 {
 	va_list va;
 	char s_text[ 1024 ];
 	va_start( va, a );
 	vsnprintf( s_text, sizeof s_text, a, va );
 	va_end( va );
-	logerror( "%08x: GTE: %08x %s\n", mipscpu.pc, INS_COFUN( mipscpu.op ), s_text );
+	logerror( "%08x: GTE: %08x %s\n", MIPSCPU.pc, INS_COFUN( MIPSCPU.op ), s_text );
 }
 #else
-static inline void GTELOG(const char *a, ...) {}
+static inline void GTELOG(PSXCPUState &cpu, const char *a, ...) {}
 #endif
 
-static uint32_t getcp2dr( int n_reg );
-static void setcp2dr( int n_reg, uint32_t n_value );
-static uint32_t getcp2cr( int n_reg );
-static void setcp2cr( int n_reg, uint32_t n_value );
-static void docop2( int gteop );
-static void mips_exception( int exception );
+static uint32_t getcp2dr( PSXCPUState &cpu, int n_reg );
+static void setcp2dr( PSXCPUState &cpu, int n_reg, uint32_t n_value );
+static uint32_t getcp2cr( PSXCPUState &cpu, int n_reg );
+static void setcp2cr( PSXCPUState &cpu, int n_reg, uint32_t n_value );
+static void docop2( PSXCPUState &cpu, int gteop );
+static void mips_exception( PSXCPUState &cpu, int exception );
 
 static void mips_stop( void )
 {
@@ -233,119 +262,119 @@ static void mips_stop( void )
 #endif
 }
 
-static inline void mips_set_cp0r( int reg, uint32_t value )
+static inline void mips_set_cp0r( PSXCPUState &cpu, int reg, uint32_t value )
 {
-	mipscpu.cp0r[ reg ] = value;
+	MIPSCPU.cp0r[ reg ] = value;
 	if( reg == CP0_SR || reg == CP0_CAUSE )
 	{
-		if( ( mipscpu.cp0r[ CP0_SR ] & SR_IEC ) != 0 && ( mipscpu.cp0r[ CP0_SR ] & mipscpu.cp0r[ CP0_CAUSE ] & CAUSE_IP ) != 0 )
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_IEC ) != 0 && ( MIPSCPU.cp0r[ CP0_SR ] & MIPSCPU.cp0r[ CP0_CAUSE ] & CAUSE_IP ) != 0 )
 		{
-			mips_exception( EXC_INT );
+			mips_exception( cpu, EXC_INT );
 		}
-		else if( mipscpu.delayr != REGPC && ( mipscpu.pc & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+		else if( MIPSCPU.delayr != REGPC && ( MIPSCPU.pc & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
 		{
-			mips_exception( EXC_ADEL );
-			mips_set_cp0r( CP0_BADVADDR, mipscpu.pc );
+			mips_exception( cpu, EXC_ADEL );
+			mips_set_cp0r( cpu, CP0_BADVADDR, MIPSCPU.pc );
 		}
 	}
 }
 
-static inline void mips_commit_delayed_load( void )
+static inline void mips_commit_delayed_load( PSXCPUState &cpu )
 {
-	if( mipscpu.delayr != 0 )
+	if( MIPSCPU.delayr != 0 )
 	{
-		mipscpu.r[ mipscpu.delayr ] = mipscpu.delayv;
-		mipscpu.delayr = 0;
-		mipscpu.delayv = 0;
+		MIPSCPU.r[ MIPSCPU.delayr ] = MIPSCPU.delayv;
+		MIPSCPU.delayr = 0;
+		MIPSCPU.delayv = 0;
 	}
 }
 
-static inline void mips_delayed_branch( uint32_t n_adr )
+static inline void mips_delayed_branch( PSXCPUState &cpu, uint32_t n_adr )
 {
-	if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+	if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
 	{
-		mips_exception( EXC_ADEL );
-		mips_set_cp0r( CP0_BADVADDR, n_adr );
+		mips_exception( cpu, EXC_ADEL );
+		mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mipscpu.delayr = REGPC;
-		mipscpu.delayv = n_adr;
-		mipscpu.pc += 4;
+		mips_commit_delayed_load( cpu );
+		MIPSCPU.delayr = REGPC;
+		MIPSCPU.delayv = n_adr;
+		MIPSCPU.pc += 4;
 	}
 }
 
-static inline void mips_set_pc( unsigned val )
+static inline void mips_set_pc( PSXCPUState &cpu, unsigned val )
 {
-	mipscpu.pc = val;
+	MIPSCPU.pc = val;
 	change_pc( val );
-	mipscpu.delayr = 0;
-	mipscpu.delayv = 0;
+	MIPSCPU.delayr = 0;
+	MIPSCPU.delayv = 0;
 }
 
-static inline void mips_advance_pc( void )
+static inline void mips_advance_pc( PSXCPUState &cpu )
 {
-	if( mipscpu.delayr == REGPC )
+	if( MIPSCPU.delayr == REGPC )
 	{
-		mips_set_pc( mipscpu.delayv );
+		mips_set_pc( cpu, MIPSCPU.delayv );
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mipscpu.pc += 4;
+		mips_commit_delayed_load( cpu );
+		MIPSCPU.pc += 4;
 	}
 }
 
-static inline void mips_load( uint32_t n_r, uint32_t n_v )
+static inline void mips_load( PSXCPUState &cpu, uint32_t n_r, uint32_t n_v )
 {
-	mips_advance_pc();
+	mips_advance_pc( cpu );
 	if( n_r != 0 )
 	{
-		mipscpu.r[ n_r ] = n_v;
+		MIPSCPU.r[ n_r ] = n_v;
 	}
 }
 
-static inline void mips_delayed_load( uint32_t n_r, uint32_t n_v )
+static inline void mips_delayed_load( PSXCPUState &cpu, uint32_t n_r, uint32_t n_v )
 {
-	if( mipscpu.delayr == REGPC )
+	if( MIPSCPU.delayr == REGPC )
 	{
-		mips_set_pc( mipscpu.delayv );
-		mipscpu.delayr = n_r;
-		mipscpu.delayv = n_v;
+		mips_set_pc( cpu, MIPSCPU.delayv );
+		MIPSCPU.delayr = n_r;
+		MIPSCPU.delayv = n_v;
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mipscpu.pc += 4;
+		mips_commit_delayed_load( cpu );
+		MIPSCPU.pc += 4;
 		if( n_r != 0 )
 		{
-			mipscpu.r[ n_r ] = n_v;
+			MIPSCPU.r[ n_r ] = n_v;
 		}
 	}
 }
 
-static void mips_exception( int exception )
+static void mips_exception( PSXCPUState &cpu, int exception )
 {
-	mips_set_cp0r( CP0_SR, ( mipscpu.cp0r[ CP0_SR ] & ~0x3f ) | ( ( mipscpu.cp0r[ CP0_SR ] << 2 ) & 0x3f ) );
-	if( mipscpu.delayr == REGPC )
+	mips_set_cp0r( cpu, CP0_SR, ( MIPSCPU.cp0r[ CP0_SR ] & ~0x3f ) | ( ( MIPSCPU.cp0r[ CP0_SR ] << 2 ) & 0x3f ) );
+	if( MIPSCPU.delayr == REGPC )
 	{
-		mips_set_cp0r( CP0_EPC, mipscpu.pc - 4 );
-		mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~CAUSE_EXC ) | CAUSE_BD | ( exception << 2 ) );
+		mips_set_cp0r( cpu, CP0_EPC, MIPSCPU.pc - 4 );
+		mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~CAUSE_EXC ) | CAUSE_BD | ( exception << 2 ) );
 	}
 	else
 	{
-		mips_commit_delayed_load();
-		mips_set_cp0r( CP0_EPC, mipscpu.pc );
-		mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~( CAUSE_EXC | CAUSE_BD ) ) | ( exception << 2 ) );
+		mips_commit_delayed_load( cpu );
+		mips_set_cp0r( cpu, CP0_EPC, MIPSCPU.pc );
+		mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~( CAUSE_EXC | CAUSE_BD ) ) | ( exception << 2 ) );
 	}
-	if( mipscpu.cp0r[ CP0_SR ] & SR_BEV )
+	if( MIPSCPU.cp0r[ CP0_SR ] & SR_BEV )
 	{
-		mips_set_pc( 0xbfc00180 );
+		mips_set_pc( cpu, 0xbfc00180 );
 	}
 	else
 	{
-		mips_set_pc( 0x80000080 );
+		mips_set_pc( cpu, 0x80000080 );
 	}
 }
 
@@ -354,1315 +383,2037 @@ void mips_init( void )
 #if 0
 	int cpu = cpu_getactivecpu();
 
-	state_save_register_UINT32( "psxcpu", cpu, "op", &mipscpu.op, 1 );
-	state_save_register_UINT32( "psxcpu", cpu, "pc", &mipscpu.pc, 1 );
-	state_save_register_UINT32( "psxcpu", cpu, "delayv", &mipscpu.delayv, 1 );
-	state_save_register_UINT32( "psxcpu", cpu, "delayr", &mipscpu.delayr, 1 );
-	state_save_register_UINT32( "psxcpu", cpu, "hi", &mipscpu.hi, 1 );
-	state_save_register_UINT32( "psxcpu", cpu, "lo", &mipscpu.lo, 1 );
-	state_save_register_UINT32( "psxcpu", cpu, "r", &mipscpu.r[ 0 ], 32 );
-	state_save_register_UINT32( "psxcpu", cpu, "cp0r", &mipscpu.cp0r[ 0 ], 32 );
-	state_save_register_UINT32( "psxcpu", cpu, "cp2cr", &mipscpu.cp2cr[ 0 ].d, 32 );
-	state_save_register_UINT32( "psxcpu", cpu, "cp2dr", &mipscpu.cp2dr[ 0 ].d, 32 );
+	state_save_register_UINT32( "psxcpu", cpu, "op", &MIPSCPU.op, 1 );
+	state_save_register_UINT32( "psxcpu", cpu, "pc", &MIPSCPU.pc, 1 );
+	state_save_register_UINT32( "psxcpu", cpu, "delayv", &MIPSCPU.delayv, 1 );
+	state_save_register_UINT32( "psxcpu", cpu, "delayr", &MIPSCPU.delayr, 1 );
+	state_save_register_UINT32( "psxcpu", cpu, "hi", &MIPSCPU.hi, 1 );
+	state_save_register_UINT32( "psxcpu", cpu, "lo", &MIPSCPU.lo, 1 );
+	state_save_register_UINT32( "psxcpu", cpu, "r", &MIPSCPU.r[ 0 ], 32 );
+	state_save_register_UINT32( "psxcpu", cpu, "cp0r", &MIPSCPU.cp0r[ 0 ], 32 );
+	state_save_register_UINT32( "psxcpu", cpu, "cp2cr", &MIPSCPU.cp2cr[ 0 ].d, 32 );
+	state_save_register_UINT32( "psxcpu", cpu, "cp2dr", &MIPSCPU.cp2dr[ 0 ].d, 32 );
 #endif
 }
 
+#ifndef PSX_NO_ICACHE
+static void mips_icache_flush( PSXCPUState &cpu );
+#endif
+
 void mips_reset( void *param )
 {
-	mips_set_cp0r( CP0_SR, ( mipscpu.cp0r[ CP0_SR ] & ~( SR_TS | SR_SWC | SR_KUC | SR_IEC ) ) | SR_BEV );
-	mips_set_cp0r( CP0_RANDOM, 63 ); /* todo: */
-	mips_set_cp0r( CP0_PRID, 0x00000200 ); /* todo: */
-	mips_set_pc( 0xbfc00000 );
-	mipscpu.prevpc = 0xffffffff;
+	PSXCPUState &cpu = *psf_instance->cpu;
+
+#ifndef PSX_NO_ICACHE
+	mips_icache_flush( cpu );
+#endif
+	mips_set_cp0r( cpu, CP0_SR, ( MIPSCPU.cp0r[ CP0_SR ] & ~( SR_TS | SR_SWC | SR_KUC | SR_IEC ) ) | SR_BEV );
+	mips_set_cp0r( cpu, CP0_RANDOM, 63 ); /* todo: */
+	mips_set_cp0r( cpu, CP0_PRID, 0x00000200 ); /* todo: */
+	mips_set_pc( cpu, 0xbfc00000 );
+	MIPSCPU.prevpc = 0xffffffff;
 }
 
-static void mips_exit( void )
+void mips_exit( void )
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
+
+#ifndef PSX_NO_ICACHE
+	mips_icache_flush( cpu );
+#endif
 }
 
-void mips_shorten_frame(void)
+PSXCPUState *mips_alloc_state( void )
 {
-	mips_ICount = 0;
+	return new PSXCPUState();
 }
 
-void psx_hw_runcounters(void);
+void mips_free_state( PSXCPUState *cpu )
+{
+	int n_page;
 
-int psxcpu_verbose = 0;
+	for( n_page = 0; n_page < MIPS_ICACHE_PAGES; n_page++ )
+	{
+		free( cpu->icache[ n_page ] );
+	}
+	delete cpu;
+}
 
-int mips_execute( int cycles )
+/* the decoded instruction cache is checked against RAM on every fetch, so it
+   needs no saving and stays valid when RAM is restored */
+void mips_state( PSFState &state )
 {
-	uint32_t n_res;
+	PSXCPUState &cpu = *psf_instance->cpu;
+	state.io( MIPSCPU );
+	state.io( MIPS_ICOUNT );
+}
 
-	mips_ICount = cycles;
-	do
-	{
-//		CALL_MAME_DEBUG;
+void mips_shorten_frame(void)
+{
+	PSXCPUState &cpu = *psf_instance->cpu;
+	MIPS_ICOUNT = 0;
+}
 
-//		psx_hw_runcounters();
+void psx_hw_runcounters(void);
 
-		mipscpu.op = cpu_readop32( mipscpu.pc );
+int psxcpu_verbose = 0;
 
-#if 0
-		while (mipscpu.prevpc == mipscpu.pc)
-		{
-			psx_hw_runcounters();
-			mips_ICount--;
+// if we're not in a delay slot, update
+// if we're in a delay slot and the delay instruction is not NOP, update
+static inline void mips_update_prevpc( PSXCPUState &cpu )
+{
+	if (( MIPSCPU.delayr == 0 ) || ((MIPSCPU.delayr != 0) && (MIPSCPU.op != 0)))
+	{
+		MIPSCPU.prevpc = MIPSCPU.pc;
+	}
+}
 
-			if (mips_ICount == 0) return cycles;
-		}
-#endif
+/* executes MIPSCPU.op, this is the reference interpreter */
+static void mips_execute_op( PSXCPUState &cpu )
+{
+	uint32_t n_res;
 
-		// if we're not in a delay slot, update
-		// if we're in a delay slot and the delay instruction is not NOP, update
-		if (( mipscpu.delayr == 0 ) || ((mipscpu.delayr != 0) && (mipscpu.op != 0)))
-		{
-			mipscpu.prevpc = mipscpu.pc;
-		}
-#if 0
-		if (1) //psxcpu_verbose)
-		{
-			printf("[%08x: %08x] [SP %08x RA %08x V0 %08x V1 %08x A0 %08x S0 %08x S1 %08x]\n", mipscpu.pc, mipscpu.op, mipscpu.r[29], mipscpu.r[31], mipscpu.r[2], mipscpu.r[3], mipscpu.r[4], mipscpu.r[ 16 ], mipscpu.r[ 17 ]);
-//			psxcpu_verbose--;
-		}
-#endif
-		switch( INS_OP( mipscpu.op ) )
+	switch( INS_OP( MIPSCPU.op ) )
+	{
+	case OP_SPECIAL:
+		switch( INS_FUNCT( MIPSCPU.op ) )
 		{
-		case OP_SPECIAL:
-			switch( INS_FUNCT( mipscpu.op ) )
+		case FUNCT_HLECALL:
+//				printf("HLECALL, PC = %08x\n", MIPSCPU.pc);
+			psx_bios_hle(MIPSCPU.pc);
+			break;
+		case FUNCT_SLL:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] << INS_SHAMT( MIPSCPU.op ) );
+			break;
+		case FUNCT_SRL:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> INS_SHAMT( MIPSCPU.op ) );
+			break;
+		case FUNCT_SRA:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), (int32_t)MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> INS_SHAMT( MIPSCPU.op ) );
+			break;
+		case FUNCT_SLLV:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] << ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] & 31 ) );
+			break;
+		case FUNCT_SRLV:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] & 31 ) );
+			break;
+		case FUNCT_SRAV:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), (int32_t)MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] & 31 ) );
+			break;
+		case FUNCT_JR:
+			if( INS_RD( MIPSCPU.op ) != 0 )
 			{
-			case FUNCT_HLECALL:
-//				printf("HLECALL, PC = %08x\n", mipscpu.pc);
-				psx_bios_hle(mipscpu.pc);
-				break;
-			case FUNCT_SLL:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RT( mipscpu.op ) ] << INS_SHAMT( mipscpu.op ) );
-				break;
-			case FUNCT_SRL:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RT( mipscpu.op ) ] >> INS_SHAMT( mipscpu.op ) );
-				break;
-			case FUNCT_SRA:
-				mips_load( INS_RD( mipscpu.op ), (int32_t)mipscpu.r[ INS_RT( mipscpu.op ) ] >> INS_SHAMT( mipscpu.op ) );
-				break;
-			case FUNCT_SLLV:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RT( mipscpu.op ) ] << ( mipscpu.r[ INS_RS( mipscpu.op ) ] & 31 ) );
-				break;
-			case FUNCT_SRLV:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RT( mipscpu.op ) ] >> ( mipscpu.r[ INS_RS( mipscpu.op ) ] & 31 ) );
-				break;
-			case FUNCT_SRAV:
-				mips_load( INS_RD( mipscpu.op ), (int32_t)mipscpu.r[ INS_RT( mipscpu.op ) ] >> ( mipscpu.r[ INS_RS( mipscpu.op ) ] & 31 ) );
-				break;
-			case FUNCT_JR:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					mips_delayed_branch( mipscpu.r[ INS_RS( mipscpu.op ) ] );
-				}
-				break;
-			case FUNCT_JALR:
-				n_res = mipscpu.pc + 8;
-				mips_delayed_branch( mipscpu.r[ INS_RS( mipscpu.op ) ] );
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mipscpu.r[ INS_RD( mipscpu.op ) ] = n_res;
-				}
-				break;
-			case FUNCT_SYSCALL:
-				mips_exception( EXC_SYS );
-				break;
-			case FUNCT_BREAK:
-				printf("BREAK!\n");
-				exit(-1);
-//				mips_exception( EXC_BP );
-				mips_advance_pc();
-				break;
-			case FUNCT_MFHI:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.hi );
-				break;
-			case FUNCT_MTHI:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					mips_advance_pc();
-					mipscpu.hi = mipscpu.r[ INS_RS( mipscpu.op ) ];
-				}
-				break;
-			case FUNCT_MFLO:
-				mips_load( INS_RD( mipscpu.op ),  mipscpu.lo );
-				break;
-			case FUNCT_MTLO:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					mips_advance_pc();
-					mipscpu.lo = mipscpu.r[ INS_RS( mipscpu.op ) ];
-				}
-				break;
-			case FUNCT_MULT:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					int64_t n_res64;
-					n_res64 = MUL_64_32_32( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ], (int32_t)mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-					mipscpu.lo = LO32_32_64( n_res64 );
-					mipscpu.hi = HI32_32_64( n_res64 );
-				}
-				break;
-			case FUNCT_MULTU:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					uint64_t n_res64;
-					n_res64 = MUL_U64_U32_U32( mipscpu.r[ INS_RS( mipscpu.op ) ], mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-					mipscpu.lo = LO32_U32_U64( n_res64 );
-					mipscpu.hi = HI32_U32_U64( n_res64 );
-				}
-				break;
-			case FUNCT_DIV:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					uint32_t n_div;
-					uint32_t n_mod;
-					if( mipscpu.r[ INS_RT( mipscpu.op ) ] != 0 )
-					{
-						n_div = (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] / (int32_t)mipscpu.r[ INS_RT( mipscpu.op ) ];
-						n_mod = (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] % (int32_t)mipscpu.r[ INS_RT( mipscpu.op ) ];
-						mips_advance_pc();
-						mipscpu.lo = n_div;
-						mipscpu.hi = n_mod;
-					}
-					else
-					{
-						mips_advance_pc();
-					}
-				}
-				break;
-			case FUNCT_DIVU:
-				if( INS_RD( mipscpu.op ) != 0 )
-				{
-					mips_exception( EXC_RI );
-				}
-				else
-				{
-					uint32_t n_div;
-					uint32_t n_mod;
-					if( mipscpu.r[ INS_RT( mipscpu.op ) ] != 0 )
-					{
-						n_div = mipscpu.r[ INS_RS( mipscpu.op ) ] / mipscpu.r[ INS_RT( mipscpu.op ) ];
-						n_mod = mipscpu.r[ INS_RS( mipscpu.op ) ] % mipscpu.r[ INS_RT( mipscpu.op ) ];
-						mips_advance_pc();
-						mipscpu.lo = n_div;
-						mipscpu.hi = n_mod;
-					}
-					else
-					{
-						mips_advance_pc();
-					}
-				}
-				break;
-			case FUNCT_ADD:
-				{
-					n_res = mipscpu.r[ INS_RS( mipscpu.op ) ] + mipscpu.r[ INS_RT( mipscpu.op ) ];
-					if( (int32_t)( ~( mipscpu.r[ INS_RS( mipscpu.op ) ] ^ mipscpu.r[ INS_RT( mipscpu.op ) ] ) & ( mipscpu.r[ INS_RS( mipscpu.op ) ] ^ n_res ) ) < 0 )
-					{
-						mips_exception( EXC_OVF );
-					}
-					else
-					{
-						mips_load( INS_RD( mipscpu.op ), n_res );
-					}
-				}
-				break;
-			case FUNCT_ADDU:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] + mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			case FUNCT_SUB:
-				n_res = mipscpu.r[ INS_RS( mipscpu.op ) ] - mipscpu.r[ INS_RT( mipscpu.op ) ];
-				if( (int32_t)( ( mipscpu.r[ INS_RS( mipscpu.op ) ] ^ mipscpu.r[ INS_RT( mipscpu.op ) ] ) & ( mipscpu.r[ INS_RS( mipscpu.op ) ] ^ n_res ) ) < 0 )
-				{
-					mips_exception( EXC_OVF );
-				}
-				else
-				{
-					mips_load( INS_RD( mipscpu.op ), n_res );
-				}
-				break;
-			case FUNCT_SUBU:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] - mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			case FUNCT_AND:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] & mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			case FUNCT_OR:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] | mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			case FUNCT_XOR:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] ^ mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			case FUNCT_NOR:
-				mips_load( INS_RD( mipscpu.op ), ~( mipscpu.r[ INS_RS( mipscpu.op ) ] | mipscpu.r[ INS_RT( mipscpu.op ) ] ) );
-				break;
-			case FUNCT_SLT:
-				mips_load( INS_RD( mipscpu.op ), (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] < (int32_t)mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			case FUNCT_SLTU:
-				mips_load( INS_RD( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] < mipscpu.r[ INS_RT( mipscpu.op ) ] );
-				break;
-			default:
-				mips_exception( EXC_RI );
-				break;
+				mips_exception( cpu, EXC_RI );
+			}
+			else
+			{
+				mips_delayed_branch( cpu, MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] );
 			}
 			break;
-		case OP_REGIMM:
-			switch( INS_RT( mipscpu.op ) )
+		case FUNCT_JALR:
+			n_res = MIPSCPU.pc + 8;
+			mips_delayed_branch( cpu, MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] );
+			if( INS_RD( MIPSCPU.op ) != 0 )
 			{
-			case RT_BLTZ:
-				if( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] < 0 )
-				{
-					mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
-				}
-				else
-				{
-					mips_advance_pc();
-				}
-				break;
-			case RT_BGEZ:
-				if( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] >= 0 )
-				{
-					mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
-				}
-				else
-				{
-					mips_advance_pc();
-				}
-				break;
-			case RT_BLTZAL:
-				n_res = mipscpu.pc + 8;
-				if( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] < 0 )
-				{
-					mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
-				}
-				else
-				{
-					mips_advance_pc();
-				}
-				mipscpu.r[ 31 ] = n_res;
-				break;
-			case RT_BGEZAL:
-				n_res = mipscpu.pc + 8;
-				if( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] >= 0 )
-				{
-					mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
-				}
-				else
-				{
-					mips_advance_pc();
-				}
-				mipscpu.r[ 31 ] = n_res;
-				break;
+				MIPSCPU.r[ INS_RD( MIPSCPU.op ) ] = n_res;
 			}
 			break;
-		case OP_J:
-			mips_delayed_branch( ( ( mipscpu.pc + 4 ) & 0xf0000000 ) + ( INS_TARGET( mipscpu.op ) << 2 ) );
+		case FUNCT_SYSCALL:
+			mips_exception( cpu, EXC_SYS );
 			break;
-		case OP_JAL:
-			n_res = mipscpu.pc + 8;
-			mips_delayed_branch( ( ( mipscpu.pc + 4 ) & 0xf0000000 ) + ( INS_TARGET( mipscpu.op ) << 2 ) );
-			mipscpu.r[ 31 ] = n_res;
+		case FUNCT_BREAK:
+			printf("BREAK!\n");
+			exit(-1);
+//				mips_exception( cpu, EXC_BP );
+			mips_advance_pc( cpu );
 			break;
-		case OP_BEQ:
-			if( mipscpu.r[ INS_RS( mipscpu.op ) ] == mipscpu.r[ INS_RT( mipscpu.op ) ] )
+		case FUNCT_MFHI:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.hi );
+			break;
+		case FUNCT_MTHI:
+			if( INS_RD( MIPSCPU.op ) != 0 )
 			{
-				mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
+				mips_exception( cpu, EXC_RI );
 			}
 			else
 			{
-				mips_advance_pc();
+				mips_advance_pc( cpu );
+				MIPSCPU.hi = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ];
 			}
 			break;
-		case OP_BNE:
-			if( mipscpu.r[ INS_RS( mipscpu.op ) ] != mipscpu.r[ INS_RT( mipscpu.op ) ] )
+		case FUNCT_MFLO:
+			mips_load( cpu, INS_RD( MIPSCPU.op ),  MIPSCPU.lo );
+			break;
+		case FUNCT_MTLO:
+			if( INS_RD( MIPSCPU.op ) != 0 )
 			{
-				mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
+				mips_exception( cpu, EXC_RI );
 			}
 			else
 			{
-				mips_advance_pc();
+				mips_advance_pc( cpu );
+				MIPSCPU.lo = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ];
 			}
 			break;
-		case OP_BLEZ:
-			if( INS_RT( mipscpu.op ) != 0 )
+		case FUNCT_MULT:
+			if( INS_RD( MIPSCPU.op ) != 0 )
+			{
+				mips_exception( cpu, EXC_RI );
+			}
+			else
 			{
-				mips_exception( EXC_RI );
+				int64_t n_res64;
+				n_res64 = MUL_64_32_32( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ], (int32_t)MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+				MIPSCPU.lo = LO32_32_64( n_res64 );
+				MIPSCPU.hi = HI32_32_64( n_res64 );
 			}
-			else if( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] <= 0 )
+			break;
+		case FUNCT_MULTU:
+			if( INS_RD( MIPSCPU.op ) != 0 )
 			{
-				mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
+				mips_exception( cpu, EXC_RI );
 			}
 			else
 			{
-				mips_advance_pc();
+				uint64_t n_res64;
+				n_res64 = MUL_U64_U32_U32( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ], MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+				MIPSCPU.lo = LO32_U32_U64( n_res64 );
+				MIPSCPU.hi = HI32_U32_U64( n_res64 );
 			}
 			break;
-		case OP_BGTZ:
-			if( INS_RT( mipscpu.op ) != 0 )
+		case FUNCT_DIV:
+			if( INS_RD( MIPSCPU.op ) != 0 )
+			{
+				mips_exception( cpu, EXC_RI );
+			}
+			else
 			{
-				mips_exception( EXC_RI );
+				uint32_t n_div;
+				uint32_t n_mod;
+				if( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] != 0 )
+				{
+					n_div = (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] / (int32_t)MIPSCPU.r[ INS_RT( MIPSCPU.op ) ];
+					n_mod = (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] % (int32_t)MIPSCPU.r[ INS_RT( MIPSCPU.op ) ];
+					mips_advance_pc( cpu );
+					MIPSCPU.lo = n_div;
+					MIPSCPU.hi = n_mod;
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
 			}
-			else if( (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] > 0 )
+			break;
+		case FUNCT_DIVU:
+			if( INS_RD( MIPSCPU.op ) != 0 )
 			{
-				mips_delayed_branch( mipscpu.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) << 2 ) );
+				mips_exception( cpu, EXC_RI );
 			}
 			else
 			{
-				mips_advance_pc();
+				uint32_t n_div;
+				uint32_t n_mod;
+				if( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] != 0 )
+				{
+					n_div = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] / MIPSCPU.r[ INS_RT( MIPSCPU.op ) ];
+					n_mod = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] % MIPSCPU.r[ INS_RT( MIPSCPU.op ) ];
+					mips_advance_pc( cpu );
+					MIPSCPU.lo = n_div;
+					MIPSCPU.hi = n_mod;
+				}
+				else
+				{
+					mips_advance_pc( cpu );
+				}
 			}
 			break;
-		case OP_ADDI:
+		case FUNCT_ADD:
 			{
-				uint32_t n_imm;
-				n_imm = MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				n_res = mipscpu.r[ INS_RS( mipscpu.op ) ] + n_imm;
-				if( (int32_t)( ~( mipscpu.r[ INS_RS( mipscpu.op ) ] ^ n_imm ) & ( mipscpu.r[ INS_RS( mipscpu.op ) ] ^ n_res ) ) < 0 )
+				n_res = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPSCPU.r[ INS_RT( MIPSCPU.op ) ];
+				if( (int32_t)( ~( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] ) & ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ n_res ) ) < 0 )
 				{
-					mips_exception( EXC_OVF );
+					mips_exception( cpu, EXC_OVF );
 				}
 				else
 				{
-					mips_load( INS_RT( mipscpu.op ), n_res );
+					mips_load( cpu, INS_RD( MIPSCPU.op ), n_res );
 				}
 			}
 			break;
-		case OP_ADDIU:
-			if (INS_RT( mipscpu.op ) == 0)
+		case FUNCT_ADDU:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+			break;
+		case FUNCT_SUB:
+			n_res = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] - MIPSCPU.r[ INS_RT( MIPSCPU.op ) ];
+			if( (int32_t)( ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] ) & ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ n_res ) ) < 0 )
 			{
-				psx_iop_call(mipscpu.pc, INS_IMMEDIATE(mipscpu.op));
-				mips_advance_pc();
+				mips_exception( cpu, EXC_OVF );
 			}
 			else
 			{
-				mips_load( INS_RT( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) );
+				mips_load( cpu, INS_RD( MIPSCPU.op ), n_res );
 			}
 			break;
-		case OP_SLTI:
-			mips_load( INS_RT( mipscpu.op ), (int32_t)mipscpu.r[ INS_RS( mipscpu.op ) ] < MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) );
+		case FUNCT_SUBU:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] - MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+			break;
+		case FUNCT_AND:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] & MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
 			break;
-		case OP_SLTIU:
-			mips_load( INS_RT( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] < (uint32_t)MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) ) );
+		case FUNCT_OR:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] | MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
 			break;
-		case OP_ANDI:
-			mips_load( INS_RT( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] & INS_IMMEDIATE( mipscpu.op ) );
+		case FUNCT_XOR:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
 			break;
-		case OP_ORI:
-			mips_load( INS_RT( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] | INS_IMMEDIATE( mipscpu.op ) );
+		case FUNCT_NOR:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), ~( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] | MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] ) );
 			break;
-		case OP_XORI:
-			mips_load( INS_RT( mipscpu.op ), mipscpu.r[ INS_RS( mipscpu.op ) ] ^ INS_IMMEDIATE( mipscpu.op ) );
+		case FUNCT_SLT:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] < (int32_t)MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
 			break;
-		case OP_LUI:
-			mips_load( INS_RT( mipscpu.op ), INS_IMMEDIATE( mipscpu.op ) << 16 );
+		case FUNCT_SLTU:
+			mips_load( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] < MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+			break;
+		default:
+			mips_exception( cpu, EXC_RI );
 			break;
-		case OP_COP0:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) != 0 && ( mipscpu.cp0r[ CP0_SR ] & SR_CU0 ) == 0 )
+		}
+		break;
+	case OP_REGIMM:
+		switch( INS_RT( MIPSCPU.op ) )
+		{
+		case RT_BLTZ:
+			if( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] < 0 )
 			{
-				mips_exception( EXC_CPU );
-				mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE0 );
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
 			}
 			else
 			{
-				switch( INS_RS( mipscpu.op ) )
-				{
-				case RS_MFC:
-					mips_delayed_load( INS_RT( mipscpu.op ), mipscpu.cp0r[ INS_RD( mipscpu.op ) ] );
-					break;
-				case RS_CFC:
-					/* todo: */
-					logerror( "%08x: COP0 CFC not supported\n", mipscpu.pc );
-					mips_stop();
-					mips_advance_pc();
-					break;
-				case RS_MTC:
-					n_res = ( mipscpu.cp0r[ INS_RD( mipscpu.op ) ] & ~mips_mtc0_writemask[ INS_RD( mipscpu.op ) ] ) |
-						( mipscpu.r[ INS_RT( mipscpu.op ) ] & mips_mtc0_writemask[ INS_RD( mipscpu.op ) ] );
-					mips_advance_pc();
-					mips_set_cp0r( INS_RD( mipscpu.op ), n_res );
-					break;
-				case RS_CTC:
-					/* todo: */
-					logerror( "%08x: COP0 CTC not supported\n", mipscpu.pc );
-					mips_stop();
-					mips_advance_pc();
-					break;
-				case RS_BC:
-					switch( INS_RT( mipscpu.op ) )
-					{
-					case RT_BCF:
-						/* todo: */
-						logerror( "%08x: COP0 BCF not supported\n", mipscpu.pc );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					case RT_BCT:
-						/* todo: */
-						logerror( "%08x: COP0 BCT not supported\n", mipscpu.pc );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					default:
-						/* todo: */
-						logerror( "%08x: COP0 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					}
-					break;
-				default:
-					switch( INS_CO( mipscpu.op ) )
-					{
-					case 1:
-						switch( INS_CF( mipscpu.op ) )
-						{
-						case CF_RFE:
-							mips_advance_pc();
-							mips_set_cp0r( CP0_SR, ( mipscpu.cp0r[ CP0_SR ] & ~0xf ) | ( ( mipscpu.cp0r[ CP0_SR ] >> 2 ) & 0xf ) );
-							break;
-						default:
-							/* todo: */
-							logerror( "%08x: COP0 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-							mips_stop();
-							mips_advance_pc();
-							break;
-						}
-						break;
-					default:
-						/* todo: */
-						logerror( "%08x: COP0 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					}
-					break;
-				}
+				mips_advance_pc( cpu );
 			}
 			break;
-		case OP_COP1:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_CU1 ) == 0 )
+		case RT_BGEZ:
+			if( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] >= 0 )
 			{
-				mips_exception( EXC_CPU );
-				mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE1 );
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
 			}
 			else
 			{
-				switch( INS_RS( mipscpu.op ) )
-				{
-				case RS_MFC:
-					/* todo: */
-					logerror( "%08x: COP1 BCT not supported\n", mipscpu.pc );
-					mips_stop();
-					mips_advance_pc();
-					break;
-				case RS_CFC:
-					/* todo: */
-					logerror( "%08x: COP1 CFC not supported\n", mipscpu.pc );
-					mips_stop();
-					mips_advance_pc();
-					break;
-				case RS_MTC:
-					/* todo: */
-					logerror( "%08x: COP1 MTC not supported\n", mipscpu.pc );
-					mips_stop();
-					mips_advance_pc();
-					break;
-				case RS_CTC:
-					/* todo: */
-					logerror( "%08x: COP1 CTC not supported\n", mipscpu.pc );
-					mips_stop();
-					mips_advance_pc();
-					break;
-				case RS_BC:
-					switch( INS_RT( mipscpu.op ) )
-					{
-					case RT_BCF:
-						/* todo: */
-						logerror( "%08x: COP1 BCF not supported\n", mipscpu.pc );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					case RT_BCT:
-						/* todo: */
-						logerror( "%08x: COP1 BCT not supported\n", mipscpu.pc );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					default:
-						/* todo: */
-						logerror( "%08x: COP1 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					}
-					break;
-				default:
-					switch( INS_CO( mipscpu.op ) )
-					{
-					case 1:
-						/* todo: */
-						logerror( "%08x: COP1 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					default:
-						/* todo: */
-						logerror( "%08x: COP1 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					}
-					break;
-				}
+				mips_advance_pc( cpu );
+			}
+			break;
+		case RT_BLTZAL:
+			n_res = MIPSCPU.pc + 8;
+			if( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] < 0 )
+			{
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
 			}
+			else
+			{
+				mips_advance_pc( cpu );
+			}
+			MIPSCPU.r[ 31 ] = n_res;
+			break;
+		case RT_BGEZAL:
+			n_res = MIPSCPU.pc + 8;
+			if( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] >= 0 )
+			{
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
+			}
+			else
+			{
+				mips_advance_pc( cpu );
+			}
+			MIPSCPU.r[ 31 ] = n_res;
 			break;
-		case OP_COP2:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_CU2 ) == 0 )
+		}
+		break;
+	case OP_J:
+		mips_delayed_branch( cpu, ( ( MIPSCPU.pc + 4 ) & 0xf0000000 ) + ( INS_TARGET( MIPSCPU.op ) << 2 ) );
+		break;
+	case OP_JAL:
+		n_res = MIPSCPU.pc + 8;
+		mips_delayed_branch( cpu, ( ( MIPSCPU.pc + 4 ) & 0xf0000000 ) + ( INS_TARGET( MIPSCPU.op ) << 2 ) );
+		MIPSCPU.r[ 31 ] = n_res;
+		break;
+	case OP_BEQ:
+		if( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] == MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] )
+		{
+			mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
+		}
+		else
+		{
+			mips_advance_pc( cpu );
+		}
+		break;
+	case OP_BNE:
+		if( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] != MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] )
+		{
+			mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
+		}
+		else
+		{
+			mips_advance_pc( cpu );
+		}
+		break;
+	case OP_BLEZ:
+		if( INS_RT( MIPSCPU.op ) != 0 )
+		{
+			mips_exception( cpu, EXC_RI );
+		}
+		else if( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] <= 0 )
+		{
+			mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
+		}
+		else
+		{
+			mips_advance_pc( cpu );
+		}
+		break;
+	case OP_BGTZ:
+		if( INS_RT( MIPSCPU.op ) != 0 )
+		{
+			mips_exception( cpu, EXC_RI );
+		}
+		else if( (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] > 0 )
+		{
+			mips_delayed_branch( cpu, MIPSCPU.pc + 4 + ( MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) << 2 ) );
+		}
+		else
+		{
+			mips_advance_pc( cpu );
+		}
+		break;
+	case OP_ADDI:
+		{
+			uint32_t n_imm;
+			n_imm = MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			n_res = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + n_imm;
+			if( (int32_t)( ~( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ n_imm ) & ( MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ n_res ) ) < 0 )
 			{
-				mips_exception( EXC_CPU );
-				mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE2 );
+				mips_exception( cpu, EXC_OVF );
 			}
 			else
 			{
-				switch( INS_RS( mipscpu.op ) )
+				mips_load( cpu, INS_RT( MIPSCPU.op ), n_res );
+			}
+		}
+		break;
+	case OP_ADDIU:
+		if (INS_RT( MIPSCPU.op ) == 0)
+		{
+			psx_iop_call(MIPSCPU.pc, INS_IMMEDIATE(MIPSCPU.op));
+			mips_advance_pc( cpu );
+		}
+		else
+		{
+			mips_load( cpu, INS_RT( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) );
+		}
+		break;
+	case OP_SLTI:
+		mips_load( cpu, INS_RT( MIPSCPU.op ), (int32_t)MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] < MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) );
+		break;
+	case OP_SLTIU:
+		mips_load( cpu, INS_RT( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] < (uint32_t)MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) ) );
+		break;
+	case OP_ANDI:
+		mips_load( cpu, INS_RT( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] & INS_IMMEDIATE( MIPSCPU.op ) );
+		break;
+	case OP_ORI:
+		mips_load( cpu, INS_RT( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] | INS_IMMEDIATE( MIPSCPU.op ) );
+		break;
+	case OP_XORI:
+		mips_load( cpu, INS_RT( MIPSCPU.op ), MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] ^ INS_IMMEDIATE( MIPSCPU.op ) );
+		break;
+	case OP_LUI:
+		mips_load( cpu, INS_RT( MIPSCPU.op ), INS_IMMEDIATE( MIPSCPU.op ) << 16 );
+		break;
+	case OP_COP0:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) != 0 && ( MIPSCPU.cp0r[ CP0_SR ] & SR_CU0 ) == 0 )
+		{
+			mips_exception( cpu, EXC_CPU );
+			mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE0 );
+		}
+		else
+		{
+			switch( INS_RS( MIPSCPU.op ) )
+			{
+			case RS_MFC:
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), MIPSCPU.cp0r[ INS_RD( MIPSCPU.op ) ] );
+				break;
+			case RS_CFC:
+				/* todo: */
+				logerror( "%08x: COP0 CFC not supported\n", MIPSCPU.pc );
+				mips_stop();
+				mips_advance_pc( cpu );
+				break;
+			case RS_MTC:
+				n_res = ( MIPSCPU.cp0r[ INS_RD( MIPSCPU.op ) ] & ~mips_mtc0_writemask[ INS_RD( MIPSCPU.op ) ] ) |
+					( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & mips_mtc0_writemask[ INS_RD( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+				mips_set_cp0r( cpu, INS_RD( MIPSCPU.op ), n_res );
+				break;
+			case RS_CTC:
+				/* todo: */
+				logerror( "%08x: COP0 CTC not supported\n", MIPSCPU.pc );
+				mips_stop();
+				mips_advance_pc( cpu );
+				break;
+			case RS_BC:
+				switch( INS_RT( MIPSCPU.op ) )
 				{
-				case RS_MFC:
-					mips_delayed_load( INS_RT( mipscpu.op ), getcp2dr( INS_RD( mipscpu.op ) ) );
-					break;
-				case RS_CFC:
-					mips_delayed_load( INS_RT( mipscpu.op ), getcp2cr( INS_RD( mipscpu.op ) ) );
+				case RT_BCF:
+					/* todo: */
+					logerror( "%08x: COP0 BCF not supported\n", MIPSCPU.pc );
+					mips_stop();
+					mips_advance_pc( cpu );
 					break;
-				case RS_MTC:
-					setcp2dr( INS_RD( mipscpu.op ), mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
+				case RT_BCT:
+					/* todo: */
+					logerror( "%08x: COP0 BCT not supported\n", MIPSCPU.pc );
+					mips_stop();
+					mips_advance_pc( cpu );
 					break;
-				case RS_CTC:
-					setcp2cr( INS_RD( mipscpu.op ), mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
+				default:
+					/* todo: */
+					logerror( "%08x: COP0 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
 					break;
-				case RS_BC:
-					switch( INS_RT( mipscpu.op ) )
+				}
+				break;
+			default:
+				switch( INS_CO( MIPSCPU.op ) )
+				{
+				case 1:
+					switch( INS_CF( MIPSCPU.op ) )
 					{
-					case RT_BCF:
-						/* todo: */
-						logerror( "%08x: COP2 BCF not supported\n", mipscpu.pc );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					case RT_BCT:
-						/* todo: */
-						logerror( "%08x: COP2 BCT not supported\n", mipscpu.pc );
-						mips_stop();
-						mips_advance_pc();
+					case CF_RFE:
+						mips_advance_pc( cpu );
+						mips_set_cp0r( cpu, CP0_SR, ( MIPSCPU.cp0r[ CP0_SR ] & ~0xf ) | ( ( MIPSCPU.cp0r[ CP0_SR ] >> 2 ) & 0xf ) );
 						break;
 					default:
 						/* todo: */
-						logerror( "%08x: COP2 unknown command %08x\n", mipscpu.pc, mipscpu.op );
+						logerror( "%08x: COP0 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
 						mips_stop();
-						mips_advance_pc();
+						mips_advance_pc( cpu );
 						break;
 					}
 					break;
 				default:
-					switch( INS_CO( mipscpu.op ) )
-					{
-					case 1:
-						docop2( INS_COFUN( mipscpu.op ) );
-						mips_advance_pc();
-						break;
-					default:
-						/* todo: */
-						logerror( "%08x: COP2 unknown command %08x\n", mipscpu.pc, mipscpu.op );
-						mips_stop();
-						mips_advance_pc();
-						break;
-					}
+					/* todo: */
+					logerror( "%08x: COP0 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
 					break;
 				}
+				break;
 			}
-			break;
-		case OP_LB:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		}
+		break;
+	case OP_COP1:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_CU1 ) == 0 )
+		{
+			mips_exception( cpu, EXC_CPU );
+			mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE1 );
+		}
+		else
+		{
+			switch( INS_RS( MIPSCPU.op ) )
 			{
+			case RS_MFC:
 				/* todo: */
-				logerror( "%08x: LB SR_ISC not supported\n", mipscpu.pc );
+				logerror( "%08x: COP1 BCT not supported\n", MIPSCPU.pc );
 				mips_stop();
-				mips_advance_pc();
-			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
-			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+				mips_advance_pc( cpu );
+				break;
+			case RS_CFC:
+				/* todo: */
+				logerror( "%08x: COP1 CFC not supported\n", MIPSCPU.pc );
+				mips_stop();
+				mips_advance_pc( cpu );
+				break;
+			case RS_MTC:
+				/* todo: */
+				logerror( "%08x: COP1 MTC not supported\n", MIPSCPU.pc );
+				mips_stop();
+				mips_advance_pc( cpu );
+				break;
+			case RS_CTC:
+				/* todo: */
+				logerror( "%08x: COP1 CTC not supported\n", MIPSCPU.pc );
+				mips_stop();
+				mips_advance_pc( cpu );
+				break;
+			case RS_BC:
+				switch( INS_RT( MIPSCPU.op ) )
 				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
+				case RT_BCF:
+					/* todo: */
+					logerror( "%08x: COP1 BCF not supported\n", MIPSCPU.pc );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
+				case RT_BCT:
+					/* todo: */
+					logerror( "%08x: COP1 BCT not supported\n", MIPSCPU.pc );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
+				default:
+					/* todo: */
+					logerror( "%08x: COP1 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
 				}
-				else
+				break;
+			default:
+				switch( INS_CO( MIPSCPU.op ) )
 				{
-					mips_delayed_load( INS_RT( mipscpu.op ), MIPS_BYTE_EXTEND( program_read_byte_32le( n_adr ^ 3 ) ) );
+				case 1:
+					/* todo: */
+					logerror( "%08x: COP1 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
+				default:
+					/* todo: */
+					logerror( "%08x: COP1 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
 				}
+				break;
 			}
-			else
+		}
+		break;
+	case OP_COP2:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_CU2 ) == 0 )
+		{
+			mips_exception( cpu, EXC_CPU );
+			mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE2 );
+		}
+		else
+		{
+			switch( INS_RS( MIPSCPU.op ) )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			case RS_MFC:
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), getcp2dr( cpu, INS_RD( MIPSCPU.op ) ) );
+				break;
+			case RS_CFC:
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), getcp2cr( cpu, INS_RD( MIPSCPU.op ) ) );
+				break;
+			case RS_MTC:
+				setcp2dr( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+				break;
+			case RS_CTC:
+				setcp2cr( cpu, INS_RD( MIPSCPU.op ), MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+				break;
+			case RS_BC:
+				switch( INS_RT( MIPSCPU.op ) )
 				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
+				case RT_BCF:
+					/* todo: */
+					logerror( "%08x: COP2 BCF not supported\n", MIPSCPU.pc );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
+				case RT_BCT:
+					/* todo: */
+					logerror( "%08x: COP2 BCT not supported\n", MIPSCPU.pc );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
+				default:
+					/* todo: */
+					logerror( "%08x: COP2 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
 				}
-				else
+				break;
+			default:
+				switch( INS_CO( MIPSCPU.op ) )
 				{
-					mips_delayed_load( INS_RT( mipscpu.op ), MIPS_BYTE_EXTEND( program_read_byte_32le( n_adr ) ) );
+				case 1:
+					docop2( cpu, INS_COFUN( MIPSCPU.op ) );
+					mips_advance_pc( cpu );
+					break;
+				default:
+					/* todo: */
+					logerror( "%08x: COP2 unknown command %08x\n", MIPSCPU.pc, MIPSCPU.op );
+					mips_stop();
+					mips_advance_pc( cpu );
+					break;
 				}
+				break;
 			}
-			break;
-		case OP_LH:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		}
+		break;
+	case OP_LB:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LB SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
 			{
-				/* todo: */
-				logerror( "%08x: LH SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					mips_delayed_load( INS_RT( mipscpu.op ), MIPS_WORD_EXTEND( program_read_word_32le( n_adr ^ 2 ) ) );
-				}
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), MIPS_BYTE_EXTEND( program_read_byte_32le( n_adr ^ 3 ) ) );
 			}
-			else
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					mips_delayed_load( INS_RT( mipscpu.op ), MIPS_WORD_EXTEND( program_read_word_32le( n_adr ) ) );
-				}
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 			}
-			break;
-		case OP_LWL:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			else
 			{
-				/* todo: */
-				logerror( "%08x: LWL SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), MIPS_BYTE_EXTEND( program_read_byte_32le( n_adr ) ) );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		}
+		break;
+	case OP_LH:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LH SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 0:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0x00ffffff ) | ( (uint32_t)program_read_byte_32le( n_adr + 3 ) << 24 );
-						break;
-					case 1:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0x0000ffff ) | ( (uint32_t)program_read_word_32le( n_adr + 1 ) << 16 );
-						break;
-					case 2:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0x000000ff ) | ( (uint32_t)program_read_byte_32le( n_adr - 1 ) << 8 ) | ( (uint32_t)program_read_word_32le( n_adr ) << 16 );
-						break;
-					default:
-						n_res = program_read_dword_32le( n_adr - 3 );
-						break;
-					}
-					mips_delayed_load( INS_RT( mipscpu.op ), n_res );
-				}
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 0:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0x00ffffff ) | ( (uint32_t)program_read_byte_32le( n_adr ) << 24 );
-						break;
-					case 1:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0x0000ffff ) | ( (uint32_t)program_read_word_32le( n_adr - 1 ) << 16 );
-						break;
-					case 2:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0x000000ff ) | ( (uint32_t)program_read_word_32le( n_adr - 2 ) << 8 ) | ( (uint32_t)program_read_byte_32le( n_adr ) << 24 );
-						break;
-					default:
-						n_res = program_read_dword_32le( n_adr - 3 );
-						break;
-					}
-					mips_delayed_load( INS_RT( mipscpu.op ), n_res );
-				}
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), MIPS_WORD_EXTEND( program_read_word_32le( n_adr ^ 2 ) ) );
 			}
-			break;
-		case OP_LW:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
 			{
-				/* todo: */
-				logerror( "%08x: LW SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-#if 0
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
-				{
-					printf("ADEL\n");
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-#endif
-				{
-					mips_delayed_load( INS_RT( mipscpu.op ), program_read_dword_32le( n_adr ) );
-				}
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), MIPS_WORD_EXTEND( program_read_word_32le( n_adr ) ) );
 			}
-			break;
-		case OP_LBU:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		}
+		break;
+	case OP_LWL:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LWL SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
 			{
-				/* todo: */
-				logerror( "%08x: LBU SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+				switch( n_adr & 3 )
 				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
+				case 0:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0x00ffffff ) | ( (uint32_t)program_read_byte_32le( n_adr + 3 ) << 24 );
+					break;
+				case 1:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0x0000ffff ) | ( (uint32_t)program_read_word_32le( n_adr + 1 ) << 16 );
+					break;
+				case 2:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0x000000ff ) | ( (uint32_t)program_read_byte_32le( n_adr - 1 ) << 8 ) | ( (uint32_t)program_read_word_32le( n_adr ) << 16 );
+					break;
+				default:
+					n_res = program_read_dword_32le( n_adr - 3 );
+					break;
 				}
-				else
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), n_res );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				switch( n_adr & 3 )
+				{
+				case 0:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0x00ffffff ) | ( (uint32_t)program_read_byte_32le( n_adr ) << 24 );
+					break;
+				case 1:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0x0000ffff ) | ( (uint32_t)program_read_word_32le( n_adr - 1 ) << 16 );
+					break;
+				case 2:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0x000000ff ) | ( (uint32_t)program_read_word_32le( n_adr - 2 ) << 8 ) | ( (uint32_t)program_read_byte_32le( n_adr ) << 24 );
+					break;
+				default:
+					n_res = program_read_dword_32le( n_adr - 3 );
+					break;
+				}
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), n_res );
+			}
+		}
+		break;
+	case OP_LW:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LW SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+#if 0
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+			{
+				printf("ADEL\n");
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+#endif
+			{
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), program_read_dword_32le( n_adr ) );
+			}
+		}
+		break;
+	case OP_LBU:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LBU SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), program_read_byte_32le( n_adr ^ 3 ) );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), program_read_byte_32le( n_adr ) );
+			}
+		}
+		break;
+	case OP_LHU:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LHU SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), program_read_word_32le( n_adr ^ 2 ) );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), program_read_word_32le( n_adr ) );
+			}
+		}
+		break;
+	case OP_LWR:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LWR SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				switch( n_adr & 3 )
 				{
-					mips_delayed_load( INS_RT( mipscpu.op ), program_read_byte_32le( n_adr ^ 3 ) );
+				case 3:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0xffffff00 ) | program_read_byte_32le( n_adr - 3 );
+					break;
+				case 2:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0xffff0000 ) | program_read_word_32le( n_adr - 2 );
+					break;
+				case 1:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0xff000000 ) | program_read_word_32le( n_adr - 1 ) | ( (uint32_t)program_read_byte_32le( n_adr + 1 ) << 16 );
+					break;
+				default:
+					n_res = program_read_dword_32le( n_adr );
+					break;
 				}
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), n_res );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+				switch( n_adr & 3 )
 				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
+				case 3:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0xffffff00 ) | program_read_byte_32le( n_adr );
+					break;
+				case 2:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0xffff0000 ) | program_read_word_32le( n_adr );
+					break;
+				case 1:
+					n_res = ( MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] & 0xff000000 ) | program_read_byte_32le( n_adr ) | ( (uint32_t)program_read_word_32le( n_adr + 1 ) << 8 );
+					break;
+				default:
+					n_res = program_read_dword_32le( n_adr );
+					break;
 				}
-				else
+				mips_delayed_load( cpu, INS_RT( MIPSCPU.op ), n_res );
+			}
+		}
+		break;
+	case OP_SB:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: SB SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				program_write_byte_32le( n_adr ^ 3, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				program_write_byte_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	case OP_SH:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: SH SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				program_write_word_32le( n_adr ^ 2, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				program_write_word_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	case OP_SWL:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			printf("SR_ISC not supported\n");
+			logerror( "%08x: SWL SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				printf("permission violation?\n");
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				switch( n_adr & 3 )
 				{
-					mips_delayed_load( INS_RT( mipscpu.op ), program_read_byte_32le( n_adr ) );
+				case 0:
+					program_write_byte_32le( n_adr + 3, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 24 );
+					break;
+				case 1:
+					program_write_word_32le( n_adr + 1, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 16 );
+					break;
+				case 2:
+					program_write_byte_32le( n_adr - 1, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 8 );
+					program_write_word_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 16 );
+					break;
+				case 3:
+					program_write_dword_32le( n_adr - 3, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
 				}
+				mips_advance_pc( cpu );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				printf("permission violation 2\n");
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				switch( n_adr & 3 )
+				{
+				case 0:
+					program_write_byte_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 24 );
+					break;
+				case 1:
+					program_write_word_32le( n_adr - 1, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 16 );
+					break;
+				case 2:
+					program_write_word_32le( n_adr - 2, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 8 );
+					program_write_byte_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 24 );
+					break;
+				case 3:
+					program_write_dword_32le( n_adr - 3, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				}
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	case OP_SW:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+/* used by bootstrap
+			logerror( "%08x: SW SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+*/
+			mips_advance_pc( cpu );
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if(0) // ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				program_write_dword_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	case OP_SWR:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: SWR SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				switch( n_adr & 3 )
+				{
+				case 0:
+					program_write_dword_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				case 1:
+					program_write_word_32le( n_adr - 1, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					program_write_byte_32le( n_adr + 1, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 16 );
+					break;
+				case 2:
+					program_write_word_32le( n_adr - 2, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				case 3:
+					program_write_byte_32le( n_adr - 3, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				}
+				mips_advance_pc( cpu );
+			}
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				switch( n_adr & 3 )
+				{
+				case 0:
+					program_write_dword_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				case 1:
+					program_write_byte_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					program_write_word_32le( n_adr + 1, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] >> 8 );
+					break;
+				case 2:
+					program_write_word_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				case 3:
+					program_write_byte_32le( n_adr, MIPSCPU.r[ INS_RT( MIPSCPU.op ) ] );
+					break;
+				}
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	case OP_LWC1:
+		/* todo: */
+		logerror( "%08x: COP1 LWC not supported\n", MIPSCPU.pc );
+		mips_stop();
+		mips_advance_pc( cpu );
+		break;
+	case OP_LWC2:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_CU2 ) == 0 )
+		{
+			mips_exception( cpu, EXC_CPU );
+			mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE2 );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: LWC2 SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADEL );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				/* todo: delay? */
+				setcp2dr( cpu, INS_RT( MIPSCPU.op ), program_read_dword_32le( n_adr ) );
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	case OP_SWC1:
+		/* todo: */
+		logerror( "%08x: COP1 SWC not supported\n", MIPSCPU.pc );
+		mips_stop();
+		mips_advance_pc( cpu );
+		break;
+	case OP_SWC2:
+		if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_CU2 ) == 0 )
+		{
+			mips_exception( cpu, EXC_CPU );
+			mips_set_cp0r( cpu, CP0_CAUSE, ( MIPSCPU.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE2 );
+		}
+		else if( ( MIPSCPU.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		{
+			/* todo: */
+			logerror( "%08x: SWC2 SR_ISC not supported\n", MIPSCPU.pc );
+			mips_stop();
+			mips_advance_pc( cpu );
+		}
+		else
+		{
+			uint32_t n_adr;
+			n_adr = MIPSCPU.r[ INS_RS( MIPSCPU.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( MIPSCPU.op ) );
+			if( ( n_adr & ( ( ( MIPSCPU.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
+			{
+				mips_exception( cpu, EXC_ADES );
+				mips_set_cp0r( cpu, CP0_BADVADDR, n_adr );
+			}
+			else
+			{
+				program_write_dword_32le( n_adr, getcp2dr( cpu, INS_RT( MIPSCPU.op ) ) );
+				mips_advance_pc( cpu );
+			}
+		}
+		break;
+	default:
+		printf( "%08x: unknown opcode %08x (prev %08x, RA %08x)\n", MIPSCPU.pc, MIPSCPU.op, MIPSCPU.prevpc,  MIPSCPU.r[31] );
+		mips_stop();
+		mips_exception( cpu, EXC_RI );
+  			break;
+	}
+}
+
+#ifdef PSX_NO_ICACHE
+
+int mips_execute( int cycles )
+{
+	PSXCPUState &cpu = *psf_instance->cpu;
+
+	MIPS_ICOUNT = cycles;
+	do
+	{
+//		CALL_MAME_DEBUG;
+
+//		psx_hw_runcounters();
+
+		MIPSCPU.op = cpu_readop32( MIPSCPU.pc );
+
+#if 0
+		while (MIPSCPU.prevpc == MIPSCPU.pc)
+		{
+			psx_hw_runcounters();
+			MIPS_ICOUNT--;
+
+			if (MIPS_ICOUNT == 0) return cycles;
+		}
+#endif
+
+		mips_update_prevpc( cpu );
+#if 0
+		if (1) //psxcpu_verbose)
+		{
+			printf("[%08x: %08x] [SP %08x RA %08x V0 %08x V1 %08x A0 %08x S0 %08x S1 %08x]\n", MIPSCPU.pc, MIPSCPU.op, MIPSCPU.r[29], MIPSCPU.r[31], MIPSCPU.r[2], MIPSCPU.r[3], MIPSCPU.r[4], MIPSCPU.r[ 16 ], MIPSCPU.r[ 17 ]);
+//			psxcpu_verbose--;
+		}
+#endif
+		mips_execute_op( cpu );
+		MIPS_ICOUNT--;
+	} while( MIPS_ICOUNT > 0 );
+
+	return cycles - MIPS_ICOUNT;
+}
+
+#else
+
+/*
+ * Decoded instruction cache
+ *
+ * Each word of RAM that gets executed is decoded once into a handler number
+ * and pre-extracted operands, kept in 4KB pages that are allocated the first
+ * time code runs from them.  The BIOS HLE, the loaders and the DMA code all
+ * write psx_ram directly, so instead of trapping stores every entry keeps the
+ * opcode it was decoded from and is decoded again once RAM no longer matches.
+ *
+ * The common ALU, branch, load and store forms get their own handler and are
+ * dispatched with computed gotos where the compiler supports them.  Anything
+ * else, and any form that could raise an exception, goes to mips_execute_op()
+ * which stays the reference implementation; define PSX_NO_ICACHE to run it
+ * alone.
+ */
+
+#define MIPS_HANDLERS \
+	H( GENERIC ) \
+	H( SLL ) H( SRL ) H( SRA ) H( SLLV ) H( SRLV ) H( SRAV ) \
+	H( JR ) H( JALR ) H( MFHI ) H( MFLO ) \
+	H( MULT ) H( MULTU ) H( DIV ) H( DIVU ) \
+	H( ADDU ) H( SUBU ) H( AND ) H( OR ) H( XOR ) H( NOR ) H( SLT ) H( SLTU ) \
+	H( BLTZ ) H( BGEZ ) H( J ) H( JAL ) H( BEQ ) H( BNE ) H( BLEZ ) H( BGTZ ) \
+	H( ADDIU ) H( SLTI ) H( SLTIU ) H( ANDI ) H( ORI ) H( XORI ) H( LUI ) \
+	H( LB ) H( LBU ) H( LH ) H( LHU ) H( LW ) H( SB ) H( SH ) H( SW )
+
+enum
+{
+#define H( name ) MIPS_H_##name,
+	MIPS_HANDLERS
+#undef H
+	MIPS_H_COUNT
+};
+
+static void mips_icache_flush( PSXCPUState &cpu )
+{
+	int n_page;
+
+	for( n_page = 0; n_page < MIPS_ICACHE_PAGES; n_page++ )
+	{
+		free( MIPS_ICACHE[ n_page ] );
+		MIPS_ICACHE[ n_page ] = NULL;
+	}
+}
+
+/* returns the word of ram (the instance's psx_ram) behind n_adr, or NULL if
+   it isn't RAM */
+static inline uint32_t *mips_ram_word( uint32_t *ram, uint32_t n_adr )
+{
+	if( ( n_adr & 0x7fffffff ) <= 0x007fffff )
+	{
+		return &ram[ ( n_adr & 0x1fffff ) >> 2 ];
+	}
+	return NULL;
+}
+
+static void mips_decode( mips_decoded *d, uint32_t op )
+{
+	int handler = MIPS_H_GENERIC;
+	uint32_t imm = MIPS_WORD_EXTEND( INS_IMMEDIATE( op ) );
+
+	switch( INS_OP( op ) )
+	{
+	case OP_SPECIAL:
+		switch( INS_FUNCT( op ) )
+		{
+		case FUNCT_SLL:
+			handler = MIPS_H_SLL;
+			imm = INS_SHAMT( op );
+			break;
+		case FUNCT_SRL:
+			handler = MIPS_H_SRL;
+			imm = INS_SHAMT( op );
+			break;
+		case FUNCT_SRA:
+			handler = MIPS_H_SRA;
+			imm = INS_SHAMT( op );
+			break;
+		case FUNCT_SLLV:
+			handler = MIPS_H_SLLV;
+			break;
+		case FUNCT_SRLV:
+			handler = MIPS_H_SRLV;
+			break;
+		case FUNCT_SRAV:
+			handler = MIPS_H_SRAV;
+			break;
+		case FUNCT_JR:
+			if( INS_RD( op ) == 0 )
+			{
+				handler = MIPS_H_JR;
+			}
+			break;
+		case FUNCT_JALR:
+			handler = MIPS_H_JALR;
+			break;
+		case FUNCT_MFHI:
+			handler = MIPS_H_MFHI;
+			break;
+		case FUNCT_MFLO:
+			handler = MIPS_H_MFLO;
+			break;
+		case FUNCT_MULT:
+			if( INS_RD( op ) == 0 )
+			{
+				handler = MIPS_H_MULT;
 			}
 			break;
-		case OP_LHU:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		case FUNCT_MULTU:
+			if( INS_RD( op ) == 0 )
 			{
-				/* todo: */
-				logerror( "%08x: LHU SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				handler = MIPS_H_MULTU;
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			break;
+		case FUNCT_DIV:
+			if( INS_RD( op ) == 0 )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					mips_delayed_load( INS_RT( mipscpu.op ), program_read_word_32le( n_adr ^ 2 ) );
-				}
+				handler = MIPS_H_DIV;
 			}
-			else
+			break;
+		case FUNCT_DIVU:
+			if( INS_RD( op ) == 0 )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					mips_delayed_load( INS_RT( mipscpu.op ), program_read_word_32le( n_adr ) );
-				}
+				handler = MIPS_H_DIVU;
 			}
 			break;
-		case OP_LWR:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+		case FUNCT_ADDU:
+			handler = MIPS_H_ADDU;
+			break;
+		case FUNCT_SUBU:
+			handler = MIPS_H_SUBU;
+			break;
+		case FUNCT_AND:
+			handler = MIPS_H_AND;
+			break;
+		case FUNCT_OR:
+			handler = MIPS_H_OR;
+			break;
+		case FUNCT_XOR:
+			handler = MIPS_H_XOR;
+			break;
+		case FUNCT_NOR:
+			handler = MIPS_H_NOR;
+			break;
+		case FUNCT_SLT:
+			handler = MIPS_H_SLT;
+			break;
+		case FUNCT_SLTU:
+			handler = MIPS_H_SLTU;
+			break;
+		}
+		break;
+	case OP_REGIMM:
+		switch( INS_RT( op ) )
+		{
+		case RT_BLTZ:
+			handler = MIPS_H_BLTZ;
+			imm <<= 2;
+			break;
+		case RT_BGEZ:
+			handler = MIPS_H_BGEZ;
+			imm <<= 2;
+			break;
+		}
+		break;
+	case OP_J:
+		handler = MIPS_H_J;
+		imm = INS_TARGET( op ) << 2;
+		break;
+	case OP_JAL:
+		handler = MIPS_H_JAL;
+		imm = INS_TARGET( op ) << 2;
+		break;
+	case OP_BEQ:
+		handler = MIPS_H_BEQ;
+		imm <<= 2;
+		break;
+	case OP_BNE:
+		handler = MIPS_H_BNE;
+		imm <<= 2;
+		break;
+	case OP_BLEZ:
+		if( INS_RT( op ) == 0 )
+		{
+			handler = MIPS_H_BLEZ;
+			imm <<= 2;
+		}
+		break;
+	case OP_BGTZ:
+		if( INS_RT( op ) == 0 )
+		{
+			handler = MIPS_H_BGTZ;
+			imm <<= 2;
+		}
+		break;
+	case OP_ADDIU:
+		/* rt == 0 is the IOP import call */
+		if( INS_RT( op ) != 0 )
+		{
+			handler = MIPS_H_ADDIU;
+		}
+		break;
+	case OP_SLTI:
+		handler = MIPS_H_SLTI;
+		break;
+	case OP_SLTIU:
+		handler = MIPS_H_SLTIU;
+		break;
+	case OP_ANDI:
+		handler = MIPS_H_ANDI;
+		imm = INS_IMMEDIATE( op );
+		break;
+	case OP_ORI:
+		handler = MIPS_H_ORI;
+		imm = INS_IMMEDIATE( op );
+		break;
+	case OP_XORI:
+		handler = MIPS_H_XORI;
+		imm = INS_IMMEDIATE( op );
+		break;
+	case OP_LUI:
+		handler = MIPS_H_LUI;
+		imm = INS_IMMEDIATE( op ) << 16;
+		break;
+	case OP_LB:
+		handler = MIPS_H_LB;
+		break;
+	case OP_LBU:
+		handler = MIPS_H_LBU;
+		break;
+	case OP_LH:
+		handler = MIPS_H_LH;
+		break;
+	case OP_LHU:
+		handler = MIPS_H_LHU;
+		break;
+	case OP_LW:
+		handler = MIPS_H_LW;
+		break;
+	case OP_SB:
+		handler = MIPS_H_SB;
+		break;
+	case OP_SH:
+		handler = MIPS_H_SH;
+		break;
+	case OP_SW:
+		handler = MIPS_H_SW;
+		break;
+	}
+
+	d->op = op;
+	d->handler = handler;
+	d->rs = INS_RS( op );
+	d->rt = INS_RT( op );
+	d->rd = INS_RD( op );
+	d->imm = imm;
+}
+
+static mips_decoded *mips_icache_page( PSXCPUState &cpu, uint32_t n_page )
+{
+	mips_decoded *page;
+	uint32_t n_word;
+	int i;
+
+	page = (mips_decoded *)malloc( sizeof( mips_decoded ) * MIPS_ICACHE_PAGE_WORDS );
+	if( page == NULL )
+	{
+		return NULL;
+	}
+
+	n_word = n_page << MIPS_ICACHE_PAGE_SHIFT;
+	for( i = 0; i < MIPS_ICACHE_PAGE_WORDS; i++ )
+	{
+		mips_decode( &page[ i ], LE32( PSXMEM.psx_ram[ n_word + i ] ) );
+	}
+
+	MIPS_ICACHE[ n_page ] = page;
+	return page;
+}
+
+static inline const mips_decoded *mips_fetch( PSXCPUState &cpu, uint32_t *ram )
+{
+	mips_decoded &uncached = cpu.uncached;
+	const mips_decoded *d = &uncached;
+	uint32_t *p_word = mips_ram_word( ram, MIPSCPU.pc );
+
+	if( p_word != NULL )
+	{
+		uint32_t n_word = p_word - ram;
+		uint32_t op = LE32( *p_word );
+		mips_decoded *page = MIPS_ICACHE[ n_word >> MIPS_ICACHE_PAGE_SHIFT ];
+
+		if( page == NULL )
+		{
+			page = mips_icache_page( cpu, n_word >> MIPS_ICACHE_PAGE_SHIFT );
+		}
+
+		if( page != NULL )
+		{
+			mips_decoded *e = &page[ n_word & ( MIPS_ICACHE_PAGE_WORDS - 1 ) ];
+			if( e->op != op )
 			{
-				/* todo: */
-				logerror( "%08x: LWR SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_decode( e, op );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
-			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 3:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0xffffff00 ) | program_read_byte_32le( n_adr - 3 );
-						break;
-					case 2:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0xffff0000 ) | program_read_word_32le( n_adr - 2 );
-						break;
-					case 1:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0xff000000 ) | program_read_word_32le( n_adr - 1 ) | ( (uint32_t)program_read_byte_32le( n_adr + 1 ) << 16 );
-						break;
-					default:
-						n_res = program_read_dword_32le( n_adr );
-						break;
-					}
-					mips_delayed_load( INS_RT( mipscpu.op ), n_res );
-				}
+			d = e;
+		}
+		else
+		{
+			mips_decode( &uncached, op );
+		}
+	}
+	else
+	{
+		mips_decode( &uncached, cpu_readop32( MIPSCPU.pc ) );
+	}
+
+	MIPSCPU.op = d->op;
+	mips_update_prevpc( cpu );
+	return d;
+}
+
+/* loads and stores only take the fast path when they can't fault */
+#define MIPS_PLAIN_ACCESS ( ( MIPSCPU.cp0r[ CP0_SR ] & ( SR_ISC | SR_KUC ) ) == 0 )
+
+#ifdef __GNUC__
+#define MIPS_THREADED
+#endif
+
+/* memory accesses may re-enter mips_execute() from an HLE callback, so
+   handlers must not look at d once they've made one */
+int mips_execute( int cycles )
+{
+	PSXCPUState &cpu = *psf_instance->cpu;
+	uint32_t *ram = PSXMEM.psx_ram;
+	const mips_decoded *d;
+	uint32_t n_res;
+	uint32_t n_adr;
+	uint32_t n_div;
+	uint32_t n_mod;
+	uint32_t *p_word;
+	int64_t n_res64;
+	uint64_t n_ures64;
+
+#ifdef MIPS_THREADED
+	static void * const handlers[ MIPS_H_COUNT ] =
+	{
+#define H( name ) &&h_##name,
+		MIPS_HANDLERS
+#undef H
+	};
+#define MIPS_DISPATCH( handler ) goto *handlers[ handler ];
+#define MIPS_HANDLER( name ) h_##name
+#define MIPS_NEXT \
+	if( --MIPS_ICOUNT <= 0 ) \
+	{ \
+		return cycles - MIPS_ICOUNT; \
+	} \
+	d = mips_fetch( cpu, ram ); \
+	goto *handlers[ d->handler ]
+#else
+#define MIPS_DISPATCH( handler ) switch( handler )
+#define MIPS_HANDLER( name ) case MIPS_H_##name
+#define MIPS_NEXT break
+#endif
+
+	MIPS_ICOUNT = cycles;
+	for( ;; )
+	{
+		d = mips_fetch( cpu, ram );
+		MIPS_DISPATCH( d->handler )
+		{
+		MIPS_HANDLER( GENERIC ):
+		generic:
+			mips_execute_op( cpu );
+			MIPS_NEXT;
+		MIPS_HANDLER( SLL ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rt ] << d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( SRL ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rt ] >> d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( SRA ):
+			mips_load( cpu, d->rd, (int32_t)MIPSCPU.r[ d->rt ] >> d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( SLLV ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rt ] << ( MIPSCPU.r[ d->rs ] & 31 ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( SRLV ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rt ] >> ( MIPSCPU.r[ d->rs ] & 31 ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( SRAV ):
+			mips_load( cpu, d->rd, (int32_t)MIPSCPU.r[ d->rt ] >> ( MIPSCPU.r[ d->rs ] & 31 ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( JR ):
+			mips_delayed_branch( cpu, MIPSCPU.r[ d->rs ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( JALR ):
+			n_res = MIPSCPU.pc + 8;
+			mips_delayed_branch( cpu, MIPSCPU.r[ d->rs ] );
+			if( d->rd != 0 )
+			{
+				MIPSCPU.r[ d->rd ] = n_res;
+			}
+			MIPS_NEXT;
+		MIPS_HANDLER( MFHI ):
+			mips_load( cpu, d->rd, MIPSCPU.hi );
+			MIPS_NEXT;
+		MIPS_HANDLER( MFLO ):
+			mips_load( cpu, d->rd, MIPSCPU.lo );
+			MIPS_NEXT;
+		MIPS_HANDLER( MULT ):
+			n_res64 = MUL_64_32_32( (int32_t)MIPSCPU.r[ d->rs ], (int32_t)MIPSCPU.r[ d->rt ] );
+			mips_advance_pc( cpu );
+			MIPSCPU.lo = LO32_32_64( n_res64 );
+			MIPSCPU.hi = HI32_32_64( n_res64 );
+			MIPS_NEXT;
+		MIPS_HANDLER( MULTU ):
+			n_ures64 = MUL_U64_U32_U32( MIPSCPU.r[ d->rs ], MIPSCPU.r[ d->rt ] );
+			mips_advance_pc( cpu );
+			MIPSCPU.lo = LO32_U32_U64( n_ures64 );
+			MIPSCPU.hi = HI32_U32_U64( n_ures64 );
+			MIPS_NEXT;
+		MIPS_HANDLER( DIV ):
+			if( MIPSCPU.r[ d->rt ] != 0 )
+			{
+				n_div = (int32_t)MIPSCPU.r[ d->rs ] / (int32_t)MIPSCPU.r[ d->rt ];
+				n_mod = (int32_t)MIPSCPU.r[ d->rs ] % (int32_t)MIPSCPU.r[ d->rt ];
+				mips_advance_pc( cpu );
+				MIPSCPU.lo = n_div;
+				MIPSCPU.hi = n_mod;
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 3:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0xffffff00 ) | program_read_byte_32le( n_adr );
-						break;
-					case 2:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0xffff0000 ) | program_read_word_32le( n_adr );
-						break;
-					case 1:
-						n_res = ( mipscpu.r[ INS_RT( mipscpu.op ) ] & 0xff000000 ) | program_read_byte_32le( n_adr ) | ( (uint32_t)program_read_word_32le( n_adr + 1 ) << 8 );
-						break;
-					default:
-						n_res = program_read_dword_32le( n_adr );
-						break;
-					}
-					mips_delayed_load( INS_RT( mipscpu.op ), n_res );
-				}
+				mips_advance_pc( cpu );
 			}
-			break;
-		case OP_SB:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			MIPS_NEXT;
+		MIPS_HANDLER( DIVU ):
+			if( MIPSCPU.r[ d->rt ] != 0 )
 			{
-				/* todo: */
-				logerror( "%08x: SB SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				n_div = MIPSCPU.r[ d->rs ] / MIPSCPU.r[ d->rt ];
+				n_mod = MIPSCPU.r[ d->rs ] % MIPSCPU.r[ d->rt ];
+				mips_advance_pc( cpu );
+				MIPSCPU.lo = n_div;
+				MIPSCPU.hi = n_mod;
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					program_write_byte_32le( n_adr ^ 3, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-				}
+				mips_advance_pc( cpu );
+			}
+			MIPS_NEXT;
+		MIPS_HANDLER( ADDU ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rs ] + MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( SUBU ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rs ] - MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( AND ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rs ] & MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( OR ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rs ] | MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( XOR ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rs ] ^ MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( NOR ):
+			mips_load( cpu, d->rd, ~( MIPSCPU.r[ d->rs ] | MIPSCPU.r[ d->rt ] ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( SLT ):
+			mips_load( cpu, d->rd, (int32_t)MIPSCPU.r[ d->rs ] < (int32_t)MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( SLTU ):
+			mips_load( cpu, d->rd, MIPSCPU.r[ d->rs ] < MIPSCPU.r[ d->rt ] );
+			MIPS_NEXT;
+		MIPS_HANDLER( BLTZ ):
+			if( (int32_t)MIPSCPU.r[ d->rs ] < 0 )
+			{
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + d->imm );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					program_write_byte_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-				}
+				mips_advance_pc( cpu );
 			}
-			break;
-		case OP_SH:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			MIPS_NEXT;
+		MIPS_HANDLER( BGEZ ):
+			if( (int32_t)MIPSCPU.r[ d->rs ] >= 0 )
 			{
-				/* todo: */
-				logerror( "%08x: SH SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + d->imm );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					program_write_word_32le( n_adr ^ 2, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-				}
+				mips_advance_pc( cpu );
 			}
-			else
+			MIPS_NEXT;
+		MIPS_HANDLER( J ):
+			mips_delayed_branch( cpu, ( ( MIPSCPU.pc + 4 ) & 0xf0000000 ) + d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( JAL ):
+			n_res = MIPSCPU.pc + 8;
+			mips_delayed_branch( cpu, ( ( MIPSCPU.pc + 4 ) & 0xf0000000 ) + d->imm );
+			MIPSCPU.r[ 31 ] = n_res;
+			MIPS_NEXT;
+		MIPS_HANDLER( BEQ ):
+			if( MIPSCPU.r[ d->rs ] == MIPSCPU.r[ d->rt ] )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 1 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					program_write_word_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-				}
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + d->imm );
 			}
-			break;
-		case OP_SWL:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			else
 			{
-				/* todo: */
-				printf("SR_ISC not supported\n");
-				logerror( "%08x: SWL SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_advance_pc( cpu );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			MIPS_NEXT;
+		MIPS_HANDLER( BNE ):
+			if( MIPSCPU.r[ d->rs ] != MIPSCPU.r[ d->rt ] )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					printf("permission violation?\n");
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 0:
-						program_write_byte_32le( n_adr + 3, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 24 );
-						break;
-					case 1:
-						program_write_word_32le( n_adr + 1, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 16 );
-						break;
-					case 2:
-						program_write_byte_32le( n_adr - 1, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 8 );
-						program_write_word_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 16 );
-						break;
-					case 3:
-						program_write_dword_32le( n_adr - 3, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					}
-					mips_advance_pc();
-				}
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + d->imm );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					printf("permission violation 2\n");
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 0:
-						program_write_byte_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 24 );
-						break;
-					case 1:
-						program_write_word_32le( n_adr - 1, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 16 );
-						break;
-					case 2:
-						program_write_word_32le( n_adr - 2, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 8 );
-						program_write_byte_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 24 );
-						break;
-					case 3:
-						program_write_dword_32le( n_adr - 3, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					}
-					mips_advance_pc();
-				}
+				mips_advance_pc( cpu );
 			}
-			break;
-		case OP_SW:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			MIPS_NEXT;
+		MIPS_HANDLER( BLEZ ):
+			if( (int32_t)MIPSCPU.r[ d->rs ] <= 0 )
 			{
-				/* todo: */
-/* used by bootstrap
-				logerror( "%08x: SW SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-*/
-				mips_advance_pc();
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + d->imm );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if(0) // ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					program_write_dword_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-					mips_advance_pc();
-				}
-			}
-			break;
-		case OP_SWR:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
-			{
-				/* todo: */
-				logerror( "%08x: SWR SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				mips_advance_pc( cpu );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & ( SR_RE | SR_KUC ) ) == ( SR_RE | SR_KUC ) )
+			MIPS_NEXT;
+		MIPS_HANDLER( BGTZ ):
+			if( (int32_t)MIPSCPU.r[ d->rs ] > 0 )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 0:
-						program_write_dword_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					case 1:
-						program_write_word_32le( n_adr - 1, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						program_write_byte_32le( n_adr + 1, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 16 );
-						break;
-					case 2:
-						program_write_word_32le( n_adr - 2, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					case 3:
-						program_write_byte_32le( n_adr - 3, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					}
-					mips_advance_pc();
-				}
+				mips_delayed_branch( cpu, MIPSCPU.pc + 4 + d->imm );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					switch( n_adr & 3 )
-					{
-					case 0:
-						program_write_dword_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					case 1:
-						program_write_byte_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						program_write_word_32le( n_adr + 1, mipscpu.r[ INS_RT( mipscpu.op ) ] >> 8 );
-						break;
-					case 2:
-						program_write_word_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					case 3:
-						program_write_byte_32le( n_adr, mipscpu.r[ INS_RT( mipscpu.op ) ] );
-						break;
-					}
-					mips_advance_pc();
-				}
+				mips_advance_pc( cpu );
+			}
+			MIPS_NEXT;
+		MIPS_HANDLER( ADDIU ):
+			mips_load( cpu, d->rt, MIPSCPU.r[ d->rs ] + d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( SLTI ):
+			mips_load( cpu, d->rt, (int32_t)MIPSCPU.r[ d->rs ] < (int32_t)d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( SLTIU ):
+			mips_load( cpu, d->rt, MIPSCPU.r[ d->rs ] < d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( ANDI ):
+			mips_load( cpu, d->rt, MIPSCPU.r[ d->rs ] & d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( ORI ):
+			mips_load( cpu, d->rt, MIPSCPU.r[ d->rs ] | d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( XORI ):
+			mips_load( cpu, d->rt, MIPSCPU.r[ d->rs ] ^ d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( LUI ):
+			mips_load( cpu, d->rt, d->imm );
+			MIPS_NEXT;
+		MIPS_HANDLER( LB ):
+			if( !MIPS_PLAIN_ACCESS )
+			{
+				goto generic;
+			}
+			n_res = d->rt;
+			mips_delayed_load( cpu, n_res, MIPS_BYTE_EXTEND( program_read_byte_32le( MIPSCPU.r[ d->rs ] + d->imm ) ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( LBU ):
+			if( !MIPS_PLAIN_ACCESS )
+			{
+				goto generic;
+			}
+			n_res = d->rt;
+			mips_delayed_load( cpu, n_res, program_read_byte_32le( MIPSCPU.r[ d->rs ] + d->imm ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( LH ):
+			n_adr = MIPSCPU.r[ d->rs ] + d->imm;
+			if( !MIPS_PLAIN_ACCESS || ( n_adr & 1 ) != 0 )
+			{
+				goto generic;
+			}
+			n_res = d->rt;
+			mips_delayed_load( cpu, n_res, MIPS_WORD_EXTEND( program_read_word_32le( n_adr ) ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( LHU ):
+			n_adr = MIPSCPU.r[ d->rs ] + d->imm;
+			if( !MIPS_PLAIN_ACCESS || ( n_adr & 1 ) != 0 )
+			{
+				goto generic;
+			}
+			n_res = d->rt;
+			mips_delayed_load( cpu, n_res, program_read_word_32le( n_adr ) );
+			MIPS_NEXT;
+		MIPS_HANDLER( LW ):
+			if( !MIPS_PLAIN_ACCESS )
+			{
+				goto generic;
+			}
+			n_adr = MIPSCPU.r[ d->rs ] + d->imm;
+			p_word = mips_ram_word( ram, n_adr );
+			if( p_word != NULL )
+			{
+				mips_delayed_load( cpu, d->rt, LE32( *p_word ) );
 			}
-			break;
-		case OP_LWC1:
-			/* todo: */
-			logerror( "%08x: COP1 LWC not supported\n", mipscpu.pc );
-			mips_stop();
-			mips_advance_pc();
-			break;
-		case OP_LWC2:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_CU2 ) == 0 )
+			else
 			{
-				mips_exception( EXC_CPU );
-				mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE2 );
+				n_res = d->rt;
+				mips_delayed_load( cpu, n_res, program_read_dword_32le( n_adr ) );
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			MIPS_NEXT;
+		MIPS_HANDLER( SB ):
+			if( !MIPS_PLAIN_ACCESS )
 			{
-				/* todo: */
-				logerror( "%08x: LWC2 SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				goto generic;
 			}
-			else
+			program_write_byte_32le( MIPSCPU.r[ d->rs ] + d->imm, MIPSCPU.r[ d->rt ] );
+			mips_advance_pc( cpu );
+			MIPS_NEXT;
+		MIPS_HANDLER( SH ):
+			n_adr = MIPSCPU.r[ d->rs ] + d->imm;
+			if( !MIPS_PLAIN_ACCESS || ( n_adr & 1 ) != 0 )
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
-				{
-					mips_exception( EXC_ADEL );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					/* todo: delay? */
-					setcp2dr( INS_RT( mipscpu.op ), program_read_dword_32le( n_adr ) );
-					mips_advance_pc();
-				}
+				goto generic;
 			}
-			break;
-		case OP_SWC1:
-			/* todo: */
-			logerror( "%08x: COP1 SWC not supported\n", mipscpu.pc );
-			mips_stop();
-			mips_advance_pc();
-			break;
-		case OP_SWC2:
-			if( ( mipscpu.cp0r[ CP0_SR ] & SR_CU2 ) == 0 )
+			program_write_word_32le( n_adr, MIPSCPU.r[ d->rt ] );
+			mips_advance_pc( cpu );
+			MIPS_NEXT;
+		MIPS_HANDLER( SW ):
+			if( !MIPS_PLAIN_ACCESS )
 			{
-				mips_exception( EXC_CPU );
-				mips_set_cp0r( CP0_CAUSE, ( mipscpu.cp0r[ CP0_CAUSE ] & ~CAUSE_CE ) | CAUSE_CE2 );
+				goto generic;
 			}
-			else if( ( mipscpu.cp0r[ CP0_SR ] & SR_ISC ) != 0 )
+			n_adr = MIPSCPU.r[ d->rs ] + d->imm;
+			p_word = mips_ram_word( ram, n_adr );
+			if( p_word != NULL )
 			{
-				/* todo: */
-				logerror( "%08x: SWC2 SR_ISC not supported\n", mipscpu.pc );
-				mips_stop();
-				mips_advance_pc();
+				*p_word = LE32( MIPSCPU.r[ d->rt ] );
 			}
 			else
 			{
-				uint32_t n_adr;
-				n_adr = mipscpu.r[ INS_RS( mipscpu.op ) ] + MIPS_WORD_EXTEND( INS_IMMEDIATE( mipscpu.op ) );
-				if( ( n_adr & ( ( ( mipscpu.cp0r[ CP0_SR ] & SR_KUC ) << 30 ) | 3 ) ) != 0 )
-				{
-					mips_exception( EXC_ADES );
-					mips_set_cp0r( CP0_BADVADDR, n_adr );
-				}
-				else
-				{
-					program_write_dword_32le( n_adr, getcp2dr( INS_RT( mipscpu.op ) ) );
-					mips_advance_pc();
-				}
+				program_write_dword_32le( n_adr, MIPSCPU.r[ d->rt ] );
 			}
+			mips_advance_pc( cpu );
+			MIPS_NEXT;
+		}
+		if( --MIPS_ICOUNT <= 0 )
+		{
 			break;
-		default:
-			printf( "%08x: unknown opcode %08x (prev %08x, RA %08x)\n", mipscpu.pc, mipscpu.op, mipscpu.prevpc,  mipscpu.r[31] );
-			mips_stop();
-			mips_exception( EXC_RI );
-  			break;
 		}
-		mips_ICount--;
-	} while( mips_ICount > 0 );
+	}
 
-	return cycles - mips_ICount;
+	return cycles - MIPS_ICOUNT;
 }
 
+#endif
+
 static void mips_get_context( void *dst )
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
+
 	if( dst )
 	{
-		*(mips_cpu_context *)dst = mipscpu;
+		*(mips_cpu_context *)dst = MIPSCPU;
 	}
 }
 
 static void mips_set_context( void *src )
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
+
 	if( src )
 	{
-		mipscpu = *(mips_cpu_context *)src;
-		change_pc( mipscpu.pc );
+		MIPSCPU = *(mips_cpu_context *)src;
+		change_pc( MIPSCPU.pc );
 	}
 }
 
 static void set_irq_line( int irqline, int state )
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
 	uint32_t ip;
 
 	switch( irqline )
@@ -1692,11 +2443,11 @@ static void set_irq_line( int irqline, int state )
 	switch( state )
 	{
 	case CLEAR_LINE:
-		mips_set_cp0r( CP0_CAUSE, mipscpu.cp0r[ CP0_CAUSE ] & ~ip );
+		mips_set_cp0r( cpu, CP0_CAUSE, MIPSCPU.cp0r[ CP0_CAUSE ] & ~ip );
 		break;
 	case ASSERT_LINE:
-		mips_set_cp0r( CP0_CAUSE, mipscpu.cp0r[ CP0_CAUSE ] |= ip );
-		if( mipscpu.irq_callback )
+		mips_set_cp0r( cpu, CP0_CAUSE, MIPSCPU.cp0r[ CP0_CAUSE ] |= ip );
+		if( MIPSCPU.irq_callback )
 		{
 			/* HOLD_LINE interrupts are not supported by the architecture.
 			By acknowledging the interupt here they are treated like PULSE_LINE
@@ -1704,7 +2455,7 @@ static void set_irq_line( int irqline, int state )
 			There is also a problem with PULSE_LINE interrupts as the interrupt
 			pending bits aren't latched the emulated code won't know what caused
 			the interrupt. */
-			(*mipscpu.irq_callback)( irqline );
+			(*MIPSCPU.irq_callback)( irqline );
 		}
 		break;
 	}
@@ -1716,6 +2467,7 @@ static void set_irq_line( int irqline, int state )
 
 static offs_t mips_dasm( char *buffer, offs_t pc )
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
 	offs_t ret;
 	change_pc( pc );
 #ifdef MAME_DEBUG
@@ -1724,145 +2476,145 @@ static offs_t mips_dasm( char *buffer, offs_t pc )
 	snprintf( buffer, 10, "$%08x", cpu_readop32( pc ) );
 	ret = 4;
 #endif
-	change_pc( mipscpu.pc );
+	change_pc( MIPSCPU.pc );
 	return ret;
 }
 
 /* preliminary gte code */
 
-#define VXY0 ( mipscpu.cp2dr[ 0 ].d )
-#define VX0  ( mipscpu.cp2dr[ 0 ].w.l )
-#define VY0  ( mipscpu.cp2dr[ 0 ].w.h )
-#define VZ0  ( mipscpu.cp2dr[ 1 ].w.l )
-#define VXY1 ( mipscpu.cp2dr[ 2 ].d )
-#define VX1  ( mipscpu.cp2dr[ 2 ].w.l )
-#define VY1  ( mipscpu.cp2dr[ 2 ].w.h )
-#define VZ1  ( mipscpu.cp2dr[ 3 ].w.l )
-#define VXY2 ( mipscpu.cp2dr[ 4 ].d )
-#define VX2  ( mipscpu.cp2dr[ 4 ].w.l )
-#define VY2  ( mipscpu.cp2dr[ 4 ].w.h )
-#define VZ2  ( mipscpu.cp2dr[ 5 ].w.l )
-#define RGB  ( mipscpu.cp2dr[ 6 ].d )
-#define R    ( mipscpu.cp2dr[ 6 ].b.l )
-#define G    ( mipscpu.cp2dr[ 6 ].b.h )
-#define B    ( mipscpu.cp2dr[ 6 ].b.h2 )
-#define CODE ( mipscpu.cp2dr[ 6 ].b.h3 )
-#define OTZ  ( mipscpu.cp2dr[ 7 ].w.l )
-#define IR0  ( mipscpu.cp2dr[ 8 ].d )
-#define IR1  ( mipscpu.cp2dr[ 9 ].d )
-#define IR2  ( mipscpu.cp2dr[ 10 ].d )
-#define IR3  ( mipscpu.cp2dr[ 11 ].d )
-#define SXY0 ( mipscpu.cp2dr[ 12 ].d )
-#define SX0  ( mipscpu.cp2dr[ 12 ].w.l )
-#define SY0  ( mipscpu.cp2dr[ 12 ].w.h )
-#define SXY1 ( mipscpu.cp2dr[ 13 ].d )
-#define SX1  ( mipscpu.cp2dr[ 13 ].w.l )
-#define SY1  ( mipscpu.cp2dr[ 13 ].w.h )
-#define SXY2 ( mipscpu.cp2dr[ 14 ].d )
-#define SX2  ( mipscpu.cp2dr[ 14 ].w.l )
-#define SY2  ( mipscpu.cp2dr[ 14 ].w.h )
-#define SXYP ( mipscpu.cp2dr[ 15 ].d )
-#define SXP  ( mipscpu.cp2dr[ 15 ].w.l )
-#define SYP  ( mipscpu.cp2dr[ 15 ].w.h )
-#define SZ0  ( mipscpu.cp2dr[ 16 ].w.l )
-#define SZ1  ( mipscpu.cp2dr[ 17 ].w.l )
-#define SZ2  ( mipscpu.cp2dr[ 18 ].w.l )
-#define SZ3  ( mipscpu.cp2dr[ 19 ].w.l )
-#define RGB0 ( mipscpu.cp2dr[ 20 ].d )
-#define R0   ( mipscpu.cp2dr[ 20 ].b.l )
-#define G0   ( mipscpu.cp2dr[ 20 ].b.h )
-#define B0   ( mipscpu.cp2dr[ 20 ].b.h2 )
-#define CD0  ( mipscpu.cp2dr[ 20 ].b.h3 )
-#define RGB1 ( mipscpu.cp2dr[ 21 ].d )
-#define R1   ( mipscpu.cp2dr[ 21 ].b.l )
-#define G1   ( mipscpu.cp2dr[ 21 ].b.h )
-#define B1   ( mipscpu.cp2dr[ 21 ].b.h2 )
-#define CD1  ( mipscpu.cp2dr[ 21 ].b.h3 )
-#define RGB2 ( mipscpu.cp2dr[ 22 ].d )
-#define R2   ( mipscpu.cp2dr[ 22 ].b.l )
-#define G2   ( mipscpu.cp2dr[ 22 ].b.h )
-#define B2   ( mipscpu.cp2dr[ 22 ].b.h2 )
-#define CD2  ( mipscpu.cp2dr[ 22 ].b.h3 )
-#define RES1 ( mipscpu.cp2dr[ 23 ].d )
-#define MAC0 ( mipscpu.cp2dr[ 24 ].d )
-#define MAC1 ( mipscpu.cp2dr[ 25 ].d )
-#define MAC2 ( mipscpu.cp2dr[ 26 ].d )
-#define MAC3 ( mipscpu.cp2dr[ 27 ].d )
-#define IRGB ( mipscpu.cp2dr[ 28 ].d )
-#define ORGB ( mipscpu.cp2dr[ 29 ].d )
-#define LZCS ( mipscpu.cp2dr[ 30 ].d )
-#define LZCR ( mipscpu.cp2dr[ 31 ].d )
-
-#define D1  ( mipscpu.cp2cr[ 0 ].d )
-#define R11 ( mipscpu.cp2cr[ 0 ].w.l )
-#define R12 ( mipscpu.cp2cr[ 0 ].w.h )
-#define R13 ( mipscpu.cp2cr[ 1 ].w.l )
-#define R21 ( mipscpu.cp2cr[ 1 ].w.h )
-#define D2  ( mipscpu.cp2cr[ 2 ].d )
-#define R22 ( mipscpu.cp2cr[ 2 ].w.l )
-#define R23 ( mipscpu.cp2cr[ 2 ].w.h )
-#define R31 ( mipscpu.cp2cr[ 3 ].w.l )
-#define R32 ( mipscpu.cp2cr[ 3 ].w.h )
-#define D3  ( mipscpu.cp2cr[ 4 ].d )
-#define R33 ( mipscpu.cp2cr[ 4 ].w.l )
-#define TRX ( mipscpu.cp2cr[ 5 ].d )
-#define TRY ( mipscpu.cp2cr[ 6 ].d )
-#define TRZ ( mipscpu.cp2cr[ 7 ].d )
-#define L11 ( mipscpu.cp2cr[ 8 ].w.l )
-#define L12 ( mipscpu.cp2cr[ 8 ].w.h )
-#define L13 ( mipscpu.cp2cr[ 9 ].w.l )
-#define L21 ( mipscpu.cp2cr[ 9 ].w.h )
-#define L22 ( mipscpu.cp2cr[ 10 ].w.l )
-#define L23 ( mipscpu.cp2cr[ 10 ].w.h )
-#define L31 ( mipscpu.cp2cr[ 11 ].w.l )
-#define L32 ( mipscpu.cp2cr[ 11 ].w.h )
-#define L33 ( mipscpu.cp2cr[ 12 ].w.l )
-#define RBK ( mipscpu.cp2cr[ 13 ].d )
-#define GBK ( mipscpu.cp2cr[ 14 ].d )
-#define BBK ( mipscpu.cp2cr[ 15 ].d )
-#define LR1 ( mipscpu.cp2cr[ 16 ].w.l )
-#define LR2 ( mipscpu.cp2cr[ 16 ].w.h )
-#define LR3 ( mipscpu.cp2cr[ 17 ].w.l )
-#define LG1 ( mipscpu.cp2cr[ 17 ].w.h )
-#define LG2 ( mipscpu.cp2cr[ 18 ].w.l )
-#define LG3 ( mipscpu.cp2cr[ 18 ].w.h )
-#define LB1 ( mipscpu.cp2cr[ 19 ].w.l )
-#define LB2 ( mipscpu.cp2cr[ 19 ].w.h )
-#define LB3 ( mipscpu.cp2cr[ 20 ].w.l )
-#define RFC ( mipscpu.cp2cr[ 21 ].d )
-#define GFC ( mipscpu.cp2cr[ 22 ].d )
-#define BFC ( mipscpu.cp2cr[ 23 ].d )
-#define OFX ( mipscpu.cp2cr[ 24 ].d )
-#define OFY ( mipscpu.cp2cr[ 25 ].d )
-#define H   ( mipscpu.cp2cr[ 26 ].w.l )
-#define DQA ( mipscpu.cp2cr[ 27 ].w.l )
-#define DQB ( mipscpu.cp2cr[ 28 ].d )
-#define ZSF3 ( mipscpu.cp2cr[ 29 ].w.l )
-#define ZSF4 ( mipscpu.cp2cr[ 30 ].w.l )
-#define FLAG ( mipscpu.cp2cr[ 31 ].d )
-
-static uint32_t getcp2dr( int n_reg )
+#define VXY0 ( MIPSCPU.cp2dr[ 0 ].d )
+#define VX0  ( MIPSCPU.cp2dr[ 0 ].w.l )
+#define VY0  ( MIPSCPU.cp2dr[ 0 ].w.h )
+#define VZ0  ( MIPSCPU.cp2dr[ 1 ].w.l )
+#define VXY1 ( MIPSCPU.cp2dr[ 2 ].d )
+#define VX1  ( MIPSCPU.cp2dr[ 2 ].w.l )
+#define VY1  ( MIPSCPU.cp2dr[ 2 ].w.h )
+#define VZ1  ( MIPSCPU.cp2dr[ 3 ].w.l )
+#define VXY2 ( MIPSCPU.cp2dr[ 4 ].d )
+#define VX2  ( MIPSCPU.cp2dr[ 4 ].w.l )
+#define VY2  ( MIPSCPU.cp2dr[ 4 ].w.h )
+#define VZ2  ( MIPSCPU.cp2dr[ 5 ].w.l )
+#define RGB  ( MIPSCPU.cp2dr[ 6 ].d )
+#define R    ( MIPSCPU.cp2dr[ 6 ].b.l )
+#define G    ( MIPSCPU.cp2dr[ 6 ].b.h )
+#define B    ( MIPSCPU.cp2dr[ 6 ].b.h2 )
+#define CODE ( MIPSCPU.cp2dr[ 6 ].b.h3 )
+#define OTZ  ( MIPSCPU.cp2dr[ 7 ].w.l )
+#define IR0  ( MIPSCPU.cp2dr[ 8 ].d )
+#define IR1  ( MIPSCPU.cp2dr[ 9 ].d )
+#define IR2  ( MIPSCPU.cp2dr[ 10 ].d )
+#define IR3  ( MIPSCPU.cp2dr[ 11 ].d )
+#define SXY0 ( MIPSCPU.cp2dr[ 12 ].d )
+#define SX0  ( MIPSCPU.cp2dr[ 12 ].w.l )
+#define SY0  ( MIPSCPU.cp2dr[ 12 ].w.h )
+#define SXY1 ( MIPSCPU.cp2dr[ 13 ].d )
+#define SX1  ( MIPSCPU.cp2dr[ 13 ].w.l )
+#define SY1  ( MIPSCPU.cp2dr[ 13 ].w.h )
+#define SXY2 ( MIPSCPU.cp2dr[ 14 ].d )
+#define SX2  ( MIPSCPU.cp2dr[ 14 ].w.l )
+#define SY2  ( MIPSCPU.cp2dr[ 14 ].w.h )
+#define SXYP ( MIPSCPU.cp2dr[ 15 ].d )
+#define SXP  ( MIPSCPU.cp2dr[ 15 ].w.l )
+#define SYP  ( MIPSCPU.cp2dr[ 15 ].w.h )
+#define SZ0  ( MIPSCPU.cp2dr[ 16 ].w.l )
+#define SZ1  ( MIPSCPU.cp2dr[ 17 ].w.l )
+#define SZ2  ( MIPSCPU.cp2dr[ 18 ].w.l )
+#define SZ3  ( MIPSCPU.cp2dr[ 19 ].w.l )
+#define RGB0 ( MIPSCPU.cp2dr[ 20 ].d )
+#define R0   ( MIPSCPU.cp2dr[ 20 ].b.l )
+#define G0   ( MIPSCPU.cp2dr[ 20 ].b.h )
+#define B0   ( MIPSCPU.cp2dr[ 20 ].b.h2 )
+#define CD0  ( MIPSCPU.cp2dr[ 20 ].b.h3 )
+#define RGB1 ( MIPSCPU.cp2dr[ 21 ].d )
+#define R1   ( MIPSCPU.cp2dr[ 21 ].b.l )
+#define G1   ( MIPSCPU.cp2dr[ 21 ].b.h )
+#define B1   ( MIPSCPU.cp2dr[ 21 ].b.h2 )
+#define CD1  ( MIPSCPU.cp2dr[ 21 ].b.h3 )
+#define RGB2 ( MIPSCPU.cp2dr[ 22 ].d )
+#define R2   ( MIPSCPU.cp2dr[ 22 ].b.l )
+#define G2   ( MIPSCPU.cp2dr[ 22 ].b.h )
+#define B2   ( MIPSCPU.cp2dr[ 22 ].b.h2 )
+#define CD2  ( MIPSCPU.cp2dr[ 22 ].b.h3 )
+#define RES1 ( MIPSCPU.cp2dr[ 23 ].d )
+#define MAC0 ( MIPSCPU.cp2dr[ 24 ].d )
+#define MAC1 ( MIPSCPU.cp2dr[ 25 ].d )
+#define MAC2 ( MIPSCPU.cp2dr[ 26 ].d )
+#define MAC3 ( MIPSCPU.cp2dr[ 27 ].d )
+#define IRGB ( MIPSCPU.cp2dr[ 28 ].d )
+#define ORGB ( MIPSCPU.cp2dr[ 29 ].d )
+#define LZCS ( MIPSCPU.cp2dr[ 30 ].d )
+#define LZCR ( MIPSCPU.cp2dr[ 31 ].d )
+
+#define D1  ( MIPSCPU.cp2cr[ 0 ].d )
+#define R11 ( MIPSCPU.cp2cr[ 0 ].w.l )
+#define R12 ( MIPSCPU.cp2cr[ 0 ].w.h )
+#define R13 ( MIPSCPU.cp2cr[ 1 ].w.l )
+#define R21 ( MIPSCPU.cp2cr[ 1 ].w.h )
+#define D2  ( MIPSCPU.cp2cr[ 2 ].d )
+#define R22 ( MIPSCPU.cp2cr[ 2 ].w.l )
+#define R23 ( MIPSCPU.cp2cr[ 2 ].w.h )
+#define R31 ( MIPSCPU.cp2cr[ 3 ].w.l )
+#define R32 ( MIPSCPU.cp2cr[ 3 ].w.h )
+#define D3  ( MIPSCPU.cp2cr[ 4 ].d )
+#define R33 ( MIPSCPU.cp2cr[ 4 ].w.l )
+#define TRX ( MIPSCPU.cp2cr[ 5 ].d )
+#define TRY ( MIPSCPU.cp2cr[ 6 ].d )
+#define TRZ ( MIPSCPU.cp2cr[ 7 ].d )
+#define L11 ( MIPSCPU.cp2cr[ 8 ].w.l )
+#define L12 ( MIPSCPU.cp2cr[ 8 ].w.h )
+#define L13 ( MIPSCPU.cp2cr[ 9 ].w.l )
+#define L21 ( MIPSCPU.cp2cr[ 9 ].w.h )
+#define L22 ( MIPSCPU.cp2cr[ 10 ].w.l )
+#define L23 ( MIPSCPU.cp2cr[ 10 ].w.h )
+#define L31 ( MIPSCPU.cp2cr[ 11 ].w.l )
+#define L32 ( MIPSCPU.cp2cr[ 11 ].w.h )
+#define L33 ( MIPSCPU.cp2cr[ 12 ].w.l )
+#define RBK ( MIPSCPU.cp2cr[ 13 ].d )
+#define GBK ( MIPSCPU.cp2cr[ 14 ].d )
+#define BBK ( MIPSCPU.cp2cr[ 15 ].d )
+#define LR1 ( MIPSCPU.cp2cr[ 16 ].w.l )
+#define LR2 ( MIPSCPU.cp2cr[ 16 ].w.h )
+#define LR3 ( MIPSCPU.cp2cr[ 17 ].w.l )
+#define LG1 ( MIPSCPU.cp2cr[ 17 ].w.h )
+#define LG2 ( MIPSCPU.cp2cr[ 18 ].w.l )
+#define LG3 ( MIPSCPU.cp2cr[ 18 ].w.h )
+#define LB1 ( MIPSCPU.cp2cr[ 19 ].w.l )
+#define LB2 ( MIPSCPU.cp2cr[ 19 ].w.h )
+#define LB3 ( MIPSCPU.cp2cr[ 20 ].w.l )
+#define RFC ( MIPSCPU.cp2cr[ 21 ].d )
+#define GFC ( MIPSCPU.cp2cr[ 22 ].d )
+#define BFC ( MIPSCPU.cp2cr[ 23 ].d )
+#define OFX ( MIPSCPU.cp2cr[ 24 ].d )
+#define OFY ( MIPSCPU.cp2cr[ 25 ].d )
+#define H   ( MIPSCPU.cp2cr[ 26 ].w.l )
+#define DQA ( MIPSCPU.cp2cr[ 27 ].w.l )
+#define DQB ( MIPSCPU.cp2cr[ 28 ].d )
+#define ZSF3 ( MIPSCPU.cp2cr[ 29 ].w.l )
+#define ZSF4 ( MIPSCPU.cp2cr[ 30 ].w.l )
+#define FLAG ( MIPSCPU.cp2cr[ 31 ].d )
+
+static uint32_t getcp2dr( PSXCPUState &cpu, int n_reg )
 {
 	if( n_reg == 1 || n_reg == 3 || n_reg == 5 || n_reg == 8 || n_reg == 9 || n_reg == 10 || n_reg == 11 )
 	{
-		mipscpu.cp2dr[ n_reg ].d = (int32_t)(int16_t)mipscpu.cp2dr[ n_reg ].d;
+		MIPSCPU.cp2dr[ n_reg ].d = (int32_t)(int16_t)MIPSCPU.cp2dr[ n_reg ].d;
 	}
 	else if( n_reg == 17 || n_reg == 18 || n_reg == 19 )
 	{
-		mipscpu.cp2dr[ n_reg ].d = (uint32_t)(uint16_t)mipscpu.cp2dr[ n_reg ].d;
+		MIPSCPU.cp2dr[ n_reg ].d = (uint32_t)(uint16_t)MIPSCPU.cp2dr[ n_reg ].d;
 	}
 	else if( n_reg == 29 )
 	{
 		ORGB = ( ( IR1 >> 7 ) & 0x1f ) | ( ( IR2 >> 2 ) & 0x3e0 ) | ( ( IR3 << 3 ) & 0x7c00 );
 	}
-	GTELOG( "get CP2DR%u=%08x", n_reg, mipscpu.cp2dr[ n_reg ].d );
-	return mipscpu.cp2dr[ n_reg ].d;
+	GTELOG( cpu, "get CP2DR%u=%08x", n_reg, MIPSCPU.cp2dr[ n_reg ].d );
+	return MIPSCPU.cp2dr[ n_reg ].d;
 }
 
-static void setcp2dr( int n_reg, uint32_t n_value )
+static void setcp2dr( PSXCPUState &cpu, int n_reg, uint32_t n_value )
 {
-	GTELOG( "set CP2DR%u=%08x", n_reg, n_value );
-	mipscpu.cp2dr[ n_reg ].d = n_value;
+	GTELOG( cpu, "set CP2DR%u=%08x", n_reg, n_value );
+	MIPSCPU.cp2dr[ n_reg ].d = n_value;
 
 	if( n_reg == 15 )
 	{
@@ -1894,19 +2646,19 @@ static void setcp2dr( int n_reg, uint32_t n_value )
 	}
 }
 
-static uint32_t getcp2cr( int n_reg )
+static uint32_t getcp2cr( PSXCPUState &cpu, int n_reg )
 {
-	GTELOG( "get CP2CR%u=%08x", n_reg, mipscpu.cp2cr[ n_reg ].d );
-	return mipscpu.cp2cr[ n_reg ].d;
+	GTELOG( cpu, "get CP2CR%u=%08x", n_reg, MIPSCPU.cp2cr[ n_reg ].d );
+	return MIPSCPU.cp2cr[ n_reg ].d;
 }
 
-static void setcp2cr( int n_reg, uint32_t n_value )
+static void setcp2cr( PSXCPUState &cpu, int n_reg, uint32_t n_value )
 {
-	GTELOG( "set CP2CR%u=%08x", n_reg, n_value );
-	mipscpu.cp2cr[ n_reg ].d = n_value;
+	GTELOG( cpu, "set CP2CR%u=%08x", n_reg, n_value );
+	MIPSCPU.cp2cr[ n_reg ].d = n_value;
 }
 
-static inline int32_t LIM( int32_t n_value, int32_t n_max, int32_t n_min, uint32_t n_flag )
+static inline int32_t LIM( PSXCPUState &cpu, int32_t n_value, int32_t n_max, int32_t n_min, uint32_t n_flag )
 {
 	if( n_value > n_max )
 	{
@@ -1921,7 +2673,7 @@ static inline int32_t LIM( int32_t n_value, int32_t n_max, int32_t n_min, uint32
 	return n_value;
 }
 
-static inline int64_t BOUNDS( int64_t n_value, int64_t n_max, int n_maxflag, int64_t n_min, int n_minflag )
+static inline int64_t BOUNDS( PSXCPUState &cpu, int64_t n_value, int64_t n_max, int n_maxflag, int64_t n_min, int n_minflag )
 {
 	if( n_value > n_max )
 	{
@@ -1934,18 +2686,18 @@ static inline int64_t BOUNDS( int64_t n_value, int64_t n_max, int n_maxflag, int
 	return n_value;
 }
 
-#define A1( a ) BOUNDS( ( a ), 0x7fffffff, 30, -(int64_t)0x80000000, ( 1 << 27 ) )
-#define A2( a ) BOUNDS( ( a ), 0x7fffffff, 29, -(int64_t)0x80000000, ( 1 << 26 ) )
-#define A3( a ) BOUNDS( ( a ), 0x7fffffff, 28, -(int64_t)0x80000000, ( 1 << 25 ) )
-#define Lm_B1( a, l ) LIM( ( a ), 0x7fff, -0x8000 * !l, ( 1 << 31 ) | ( 1 << 24 ) )
-#define Lm_B2( a, l ) LIM( ( a ), 0x7fff, -0x8000 * !l, ( 1 << 31 ) | ( 1 << 23 ) )
-#define Lm_B3( a, l ) LIM( ( a ), 0x7fff, -0x8000 * !l, ( 1 << 22 ) )
-#define Lm_C1( a ) LIM( ( a ), 0x00ff, 0x0000, ( 1 << 21 ) )
-#define Lm_C2( a ) LIM( ( a ), 0x00ff, 0x0000, ( 1 << 20 ) )
-#define Lm_C3( a ) LIM( ( a ), 0x00ff, 0x0000, ( 1 << 19 ) )
-#define Lm_D( a ) LIM( ( a ), 0xffff, 0x0000, ( 1 << 31 ) | ( 1 << 18 ) )
-
-static inline uint32_t Lm_E( uint32_t n_z )
+#define A1( a ) BOUNDS( cpu, ( a ), 0x7fffffff, 30, -(int64_t)0x80000000, ( 1 << 27 ) )
+#define A2( a ) BOUNDS( cpu, ( a ), 0x7fffffff, 29, -(int64_t)0x80000000, ( 1 << 26 ) )
+#define A3( a ) BOUNDS( cpu, ( a ), 0x7fffffff, 28, -(int64_t)0x80000000, ( 1 << 25 ) )
+#define Lm_B1( a, l ) LIM( cpu, ( a ), 0x7fff, -0x8000 * !l, ( 1 << 31 ) | ( 1 << 24 ) )
+#define Lm_B2( a, l ) LIM( cpu, ( a ), 0x7fff, -0x8000 * !l, ( 1 << 31 ) | ( 1 << 23 ) )
+#define Lm_B3( a, l ) LIM( cpu, ( a ), 0x7fff, -0x8000 * !l, ( 1 << 22 ) )
+#define Lm_C1( a ) LIM( cpu, ( a ), 0x00ff, 0x0000, ( 1 << 21 ) )
+#define Lm_C2( a ) LIM( cpu, ( a ), 0x00ff, 0x0000, ( 1 << 20 ) )
+#define Lm_C3( a ) LIM( cpu, ( a ), 0x00ff, 0x0000, ( 1 << 19 ) )
+#define Lm_D( a ) LIM( cpu, ( a ), 0xffff, 0x0000, ( 1 << 31 ) | ( 1 << 18 ) )
+
+static inline uint32_t Lm_E( PSXCPUState &cpu, uint32_t n_z )
 {
 	if( n_z <= H / 2 )
 	{
@@ -1959,12 +2711,12 @@ static inline uint32_t Lm_E( uint32_t n_z )
 	return n_z;
 }
 
-#define F( a ) BOUNDS( ( a ), 0x7fffffff, ( 1 << 31 ) | ( 1 << 16 ), -(int64_t)0x80000000, ( 1 << 31 ) | ( 1 << 15 ) )
-#define Lm_G1( a ) LIM( ( a ), 0x3ff, -0x400, ( 1 << 31 ) | ( 1 << 14 ) )
-#define Lm_G2( a ) LIM( ( a ), 0x3ff, -0x400, ( 1 << 31 ) | ( 1 << 13 ) )
-#define Lm_H( a ) LIM( ( a ), 0xfff, 0x000, ( 1 << 12 ) )
+#define F( a ) BOUNDS( cpu, ( a ), 0x7fffffff, ( 1 << 31 ) | ( 1 << 16 ), -(int64_t)0x80000000, ( 1 << 31 ) | ( 1 << 15 ) )
+#define Lm_G1( a ) LIM( cpu, ( a ), 0x3ff, -0x400, ( 1 << 31 ) | ( 1 << 14 ) )
+#define Lm_G2( a ) LIM( cpu, ( a ), 0x3ff, -0x400, ( 1 << 31 ) | ( 1 << 13 ) )
+#define Lm_H( a ) LIM( cpu, ( a ), 0xfff, 0x000, ( 1 << 12 ) )
 
-static void docop2( int gteop )
+static void docop2( PSXCPUState &cpu, int gteop )
 {
 	int n_sf;
 	int n_v;
@@ -1977,26 +2729,26 @@ static void docop2( int gteop )
 	const uint32_t **p_n_cv;
 	static const uint16_t n_zm = 0;
 	static const uint32_t n_zc = 0;
-	static const uint16_t *p_n_vx[] = { &VX0, &VX1, &VX2 };
-	static const uint16_t *p_n_vy[] = { &VY0, &VY1, &VY2 };
-	static const uint16_t *p_n_vz[] = { &VZ0, &VZ1, &VZ2 };
-	static const uint16_t *p_n_rm[] = { &R11, &R12, &R13, &R21, &R22, &R23, &R31, &R32, &R33 };
-	static const uint16_t *p_n_lm[] = { &L11, &L12, &L13, &L21, &L22, &L23, &L31, &L32, &L33 };
-	static const uint16_t *p_n_cm[] = { &LR1, &LR2, &LR3, &LG1, &LG2, &LG3, &LB1, &LB2, &LB3 };
-	static const uint16_t *p_n_zm[] = { &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm };
-	static const uint16_t **p_p_n_mx[] = { p_n_rm, p_n_lm, p_n_cm, p_n_zm };
-	static const uint32_t *p_n_tr[] = { &TRX, &TRY, &TRZ };
-	static const uint32_t *p_n_bk[] = { &RBK, &GBK, &BBK };
-	static const uint32_t *p_n_fc[] = { &RFC, &GFC, &BFC };
-	static const uint32_t *p_n_zc[] = { &n_zc, &n_zc, &n_zc };
-	static const uint32_t **p_p_n_cv[] = { p_n_tr, p_n_bk, p_n_fc, p_n_zc };
+	const uint16_t *p_n_vx[] = { &VX0, &VX1, &VX2 };
+	const uint16_t *p_n_vy[] = { &VY0, &VY1, &VY2 };
+	const uint16_t *p_n_vz[] = { &VZ0, &VZ1, &VZ2 };
+	const uint16_t *p_n_rm[] = { &R11, &R12, &R13, &R21, &R22, &R23, &R31, &R32, &R33 };
+	const uint16_t *p_n_lm[] = { &L11, &L12, &L13, &L21, &L22, &L23, &L31, &L32, &L33 };
+	const uint16_t *p_n_cm[] = { &LR1, &LR2, &LR3, &LG1, &LG2, &LG3, &LB1, &LB2, &LB3 };
+	const uint16_t *p_n_zm[] = { &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm, &n_zm };
+	const uint16_t **p_p_n_mx[] = { p_n_rm, p_n_lm, p_n_cm, p_n_zm };
+	const uint32_t *p_n_tr[] = { &TRX, &TRY, &TRZ };
+	const uint32_t *p_n_bk[] = { &RBK, &GBK, &BBK };
+	const uint32_t *p_n_fc[] = { &RFC, &GFC, &BFC };
+	const uint32_t *p_n_zc[] = { &n_zc, &n_zc, &n_zc };
+	const uint32_t **p_p_n_cv[] = { p_n_tr, p_n_bk, p_n_fc, p_n_zc };
 
 	switch( GTE_FUNCT( gteop ) )
 	{
 	case 0x01:
 		if( gteop == 0x0180001 )
 		{
-			GTELOG( "RTPS" );
+			GTELOG( cpu, "RTPS" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)(int32_t)TRX << 12 ) + ( (int16_t)R11 * (int16_t)VX0 ) + ( (int16_t)R12 * (int16_t)VY0 ) + ( (int16_t)R13 * (int16_t)VZ0 ) ) >> 12 );
@@ -2011,9 +2763,9 @@ static void docop2( int gteop )
 			SZ3 = Lm_D( (int32_t)MAC3 );
 			SXY0 = SXY1;
 			SXY1 = SXY2;
-			SX2 = Lm_G1( F( (int64_t)(int32_t)OFX + ( (int64_t)(int16_t)IR1 * ( ( (uint32_t)H << 16 ) / Lm_E( SZ3 ) ) ) ) >> 16 );
-			SY2 = Lm_G2( F( (int64_t)(int32_t)OFY + ( (int64_t)(int16_t)IR2 * ( ( (uint32_t)H << 16 ) / Lm_E( SZ3 ) ) ) ) >> 16 );
-			MAC0 = F( (int64_t)(int32_t)DQB + ( (int64_t)(int16_t)DQA * ( ( (uint32_t)H << 16 ) / Lm_E( SZ3 ) ) ) );
+			SX2 = Lm_G1( F( (int64_t)(int32_t)OFX + ( (int64_t)(int16_t)IR1 * ( ( (uint32_t)H << 16 ) / Lm_E( cpu, SZ3 ) ) ) ) >> 16 );
+			SY2 = Lm_G2( F( (int64_t)(int32_t)OFY + ( (int64_t)(int16_t)IR2 * ( ( (uint32_t)H << 16 ) / Lm_E( cpu, SZ3 ) ) ) ) >> 16 );
+			MAC0 = F( (int64_t)(int32_t)DQB + ( (int64_t)(int16_t)DQA * ( ( (uint32_t)H << 16 ) / Lm_E( cpu, SZ3 ) ) ) );
 			IR0 = Lm_H( (int32_t)MAC0 >> 12 );
 			return;
 		}
@@ -2023,7 +2775,7 @@ static void docop2( int gteop )
 			gteop == 0x1400006 ||
 			gteop == 0x0155cc6 )
 		{
-			GTELOG( "NCLIP" );
+			GTELOG( cpu, "NCLIP" );
 			FLAG = 0;
 
 			MAC0 = F( ( (int64_t)(int16_t)SX0 * (int16_t)SY1 ) + ( (int16_t)SX1 * (int16_t)SY2 ) + ( (int16_t)SX2 * (int16_t)SY0 ) - ( (int16_t)SX0 * (int16_t)SY2 ) - ( (int16_t)SX1 * (int16_t)SY0 ) - ( (int16_t)SX2 * (int16_t)SY1 ) );
@@ -2033,7 +2785,7 @@ static void docop2( int gteop )
 	case 0x0c:
 		if( GTE_OP( gteop ) == 0x17 )
 		{
-			GTELOG( "OP" );
+			GTELOG( cpu, "OP" );
 			n_sf = 12 * GTE_SF( gteop );
 			FLAG = 0;
 
@@ -2049,7 +2801,7 @@ static void docop2( int gteop )
 	case 0x10:
 		if( gteop == 0x0780010 )
 		{
-			GTELOG( "DPCS" );
+			GTELOG( cpu, "DPCS" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)R << 16 ) + ( (int64_t)(int16_t)IR0 * ( Lm_B1( (int32_t)RFC - ( R << 4 ), 0 ) ) ) ) >> 12 );
@@ -2076,7 +2828,7 @@ static void docop2( int gteop )
 	case 0x11:
 		if( gteop == 0x0980011 )
 		{
-			GTELOG( "INTPL" );
+			GTELOG( cpu, "INTPL" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)(int16_t)IR1 << 12 ) + ( (int64_t)(int16_t)IR0 * ( Lm_B1( (int32_t)RFC - (int16_t)IR1, 0 ) ) ) ) >> 12 );
@@ -2103,7 +2855,7 @@ static void docop2( int gteop )
 	case 0x12:
 		if( GTE_OP( gteop ) == 0x04 )
 		{
-			GTELOG( "MVMVA" );
+			GTELOG( cpu, "MVMVA" );
 			n_sf = 12 * GTE_SF( gteop );
 			p_n_mx = p_p_n_mx[ GTE_MX( gteop ) ];
 			n_v = GTE_V( gteop );
@@ -2136,7 +2888,7 @@ static void docop2( int gteop )
 	case 0x13:
 		if( gteop == 0x0e80413 )
 		{
-			GTELOG( "NCDS" );
+			GTELOG( cpu, "NCDS" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)(int16_t)L11 * (int16_t)VX0 ) + ( (int16_t)L12 * (int16_t)VY0 ) + ( (int16_t)L13 * (int16_t)VZ0 ) ) >> 12 );
@@ -2175,7 +2927,7 @@ static void docop2( int gteop )
 	case 0x14:
 		if( gteop == 0x1280414 )
 		{
-			GTELOG( "CDP" );
+			GTELOG( cpu, "CDP" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)RBK << 12 ) + ( (int16_t)LR1 * (int16_t)IR1 ) + ( (int16_t)LR2 * (int16_t)IR2 ) + ( (int16_t)LR3 * (int16_t)IR3 ) ) >> 12 );
@@ -2208,7 +2960,7 @@ static void docop2( int gteop )
 	case 0x16:
 		if( gteop == 0x0f80416 )
 		{
-			GTELOG( "NCDT" );
+			GTELOG( cpu, "NCDT" );
 			FLAG = 0;
 
 			for( n_v = 0; n_v < 3; n_v++ )
@@ -2250,7 +3002,7 @@ static void docop2( int gteop )
 	case 0x1b:
 		if( gteop == 0x108041b )
 		{
-			GTELOG( "NCCS" );
+			GTELOG( cpu, "NCCS" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)(int16_t)L11 * (int16_t)VX0 ) + ( (int16_t)L12 * (int16_t)VY0 ) + ( (int16_t)L13 * (int16_t)VZ0 ) ) >> 12 );
@@ -2289,7 +3041,7 @@ static void docop2( int gteop )
 	case 0x1c:
 		if( gteop == 0x138041c )
 		{
-			GTELOG( "CC" );
+			GTELOG( cpu, "CC" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)RBK << 12 ) + ( (int16_t)LR1 * (int16_t)IR1 ) + ( (int16_t)LR2 * (int16_t)IR2 ) + ( (int16_t)LR3 * (int16_t)IR3 ) ) >> 12 );
@@ -2322,7 +3074,7 @@ static void docop2( int gteop )
 	case 0x1e:
 		if( gteop == 0x0c8041e )
 		{
-			GTELOG( "NCS" );
+			GTELOG( cpu, "NCS" );
 			FLAG = 0;
 
 			MAC1 = A1( ( ( (int64_t)(int16_t)L11 * (int16_t)VX0 ) + ( (int16_t)L12 * (int16_t)VY0 ) + ( (int16_t)L13 * (int16_t)VZ0 ) ) >> 12 );
@@ -2355,7 +3107,7 @@ static void docop2( int gteop )
 	case 0x20:
 		if( gteop == 0x0d80420 )
 		{
-			GTELOG( "NCT" );
+			GTELOG( cpu, "NCT" );
 			FLAG = 0;
 
 			for( n_v = 0; n_v < 3; n_v++ )
@@ -2391,7 +3143,7 @@ static void docop2( int gteop )
 	case 0x28:
 		if( GTE_OP( gteop ) == 0x0a && GTE_LM( gteop ) == 1 )
 		{
-			GTELOG( "SQR" );
+			GTELOG( cpu, "SQR" );
 			n_sf = 12 * GTE_SF( gteop );
 			FLAG = 0;
 
@@ -2408,7 +3160,7 @@ static void docop2( int gteop )
 	case 0x2a:
 		if( gteop == 0x0f8002a )
 		{
-			GTELOG( "DPCT" );
+			GTELOG( cpu, "DPCT" );
 			FLAG = 0;
 
 			for( n_pass = 0; n_pass < 3; n_pass++ )
@@ -2438,7 +3190,7 @@ static void docop2( int gteop )
 	case 0x2d:
 		if( gteop == 0x158002d )
 		{
-			GTELOG( "AVSZ3" );
+			GTELOG( cpu, "AVSZ3" );
 			FLAG = 0;
 
 			MAC0 = F( ( (int64_t)(int16_t)ZSF3 * SZ1 ) + ( (int16_t)ZSF3 * SZ2 ) + ( (int16_t)ZSF3 * SZ3 ) );
@@ -2449,7 +3201,7 @@ static void docop2( int gteop )
 	case 0x2e:
 		if( gteop == 0x168002e )
 		{
-			GTELOG( "AVSZ4" );
+			GTELOG( cpu, "AVSZ4" );
 			FLAG = 0;
 
 			MAC0 = F( ( (int64_t)(int16_t)ZSF4 * SZ0 ) + ( (int16_t)ZSF4 * SZ1 ) + ( (int16_t)ZSF4 * SZ2 ) + ( (int16_t)ZSF4 * SZ3 ) );
@@ -2460,7 +3212,7 @@ static void docop2( int gteop )
 	case 0x30:
 		if( gteop == 0x0280030 )
 		{
-			GTELOG( "RTPT" );
+			GTELOG( cpu, "RTPT" );
 			FLAG = 0;
 
 			for( n_v = 0; n_v < 3; n_v++ )
@@ -2477,9 +3229,9 @@ static void docop2( int gteop )
 				SZ3 = Lm_D( (int32_t)MAC3 );
 				SXY0 = SXY1;
 				SXY1 = SXY2;
-				SX2 = Lm_G1( F( ( (int64_t)(int32_t)OFX + ( (int64_t)(int16_t)IR1 * ( ( (uint32_t)H << 16 ) / Lm_E( SZ3 ) ) ) ) >> 16 ) );
-				SY2 = Lm_G2( F( ( (int64_t)(int32_t)OFY + ( (int64_t)(int16_t)IR2 * ( ( (uint32_t)H << 16 ) / Lm_E( SZ3 ) ) ) ) >> 16 ) );
-				MAC0 = F( (int64_t)(int32_t)DQB + ( (int64_t)(int16_t)DQA * ( ( (uint32_t)H << 16 ) / Lm_E( SZ3 ) ) ) );
+				SX2 = Lm_G1( F( ( (int64_t)(int32_t)OFX + ( (int64_t)(int16_t)IR1 * ( ( (uint32_t)H << 16 ) / Lm_E( cpu, SZ3 ) ) ) ) >> 16 ) );
+				SY2 = Lm_G2( F( ( (int64_t)(int32_t)OFY + ( (int64_t)(int16_t)IR2 * ( ( (uint32_t)H << 16 ) / Lm_E( cpu, SZ3 ) ) ) ) >> 16 ) );
+				MAC0 = F( (int64_t)(int32_t)DQB + ( (int64_t)(int16_t)DQA * ( ( (uint32_t)H << 16 ) / Lm_E( cpu, SZ3 ) ) ) );
 				IR0 = Lm_H( (int32_t)MAC0 >> 12 );
 			}
 			return;
@@ -2489,7 +3241,7 @@ static void docop2( int gteop )
 		if( GTE_OP( gteop ) == 0x09 ||
 			GTE_OP( gteop ) == 0x19 )
 		{
-			GTELOG( "GPF" );
+			GTELOG( cpu, "GPF" );
 			n_sf = 12 * GTE_SF( gteop );
 			FLAG = 0;
 
@@ -2517,7 +3269,7 @@ static void docop2( int gteop )
 	case 0x3e:
 		if( GTE_OP( gteop ) == 0x1a )
 		{
-			GTELOG( "GPL" );
+			GTELOG( cpu, "GPL" );
 			n_sf = 12 * GTE_SF( gteop );
 			FLAG = 0;
 
@@ -2546,7 +3298,7 @@ static void docop2( int gteop )
 		if( gteop == 0x108043f ||
 			gteop == 0x118043f )
 		{
-			GTELOG( "NCCT" );
+			GTELOG( cpu, "NCCT" );
 			FLAG = 0;
 
 			for( n_v = 0; n_v < 3; n_v++ )
@@ -2587,7 +3339,7 @@ static void docop2( int gteop )
 		break;
 	}
 //	usrintf_showmessage_secs( 1, "unknown GTE op %08x", gteop );
-	logerror( "%08x: unknown GTE op %08x\n", mipscpu.pc, gteop );
+	logerror( "%08x: unknown GTE op %08x\n", MIPSCPU.pc, gteop );
 	mips_stop();
 }
 
@@ -2597,6 +3349,8 @@ static void docop2( int gteop )
 
 void mips_set_info(uint32_t state, union cpuinfo *info)
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
+
 	switch (state)
 	{
 		/* --- the following bits of info are set as 64-bit signed integers --- */
@@ -2607,144 +3361,144 @@ void mips_set_info(uint32_t state, union cpuinfo *info)
 		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ4:		set_irq_line(MIPS_IRQ4, info->i);		break;
 		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ5:		set_irq_line(MIPS_IRQ5, info->i);		break;
 
-		case CPUINFO_INT_PC:							mips_set_pc( info->i );					break;
-		case CPUINFO_INT_REGISTER + MIPS_PC:			mips_set_pc( info->i );					break;
+		case CPUINFO_INT_PC:							mips_set_pc( cpu, info->i );					break;
+		case CPUINFO_INT_REGISTER + MIPS_PC:			mips_set_pc( cpu, info->i );					break;
 		case CPUINFO_INT_SP:							/* no stack */							break;
-		case CPUINFO_INT_REGISTER + MIPS_DELAYV:		mipscpu.delayv = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_DELAYR:		if( info->i <= REGPC ) mipscpu.delayr = info->i; break;
-		case CPUINFO_INT_REGISTER + MIPS_HI:			mipscpu.hi = info->i;					break;
-		case CPUINFO_INT_REGISTER + MIPS_LO:			mipscpu.lo = info->i;					break;
-		case CPUINFO_INT_REGISTER + MIPS_R0:			mipscpu.r[ 0 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R1:			mipscpu.r[ 1 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R2:			mipscpu.r[ 2 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R3:			mipscpu.r[ 3 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R4:			mipscpu.r[ 4 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R5:			mipscpu.r[ 5 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R6:			mipscpu.r[ 6 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R7:			mipscpu.r[ 7 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R8:			mipscpu.r[ 8 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R9:			mipscpu.r[ 9 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R10:			mipscpu.r[ 10 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R11:			mipscpu.r[ 11 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R12:			mipscpu.r[ 12 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R13:			mipscpu.r[ 13 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R14:			mipscpu.r[ 14 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R15:			mipscpu.r[ 15 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R16:			mipscpu.r[ 16 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R17:			mipscpu.r[ 17 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R18:			mipscpu.r[ 18 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R19:			mipscpu.r[ 19 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R20:			mipscpu.r[ 20 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R21:			mipscpu.r[ 21 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R22:			mipscpu.r[ 22 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R23:			mipscpu.r[ 23 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R24:			mipscpu.r[ 24 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R25:			mipscpu.r[ 25 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R26:			mipscpu.r[ 26 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R27:			mipscpu.r[ 27 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R28:			mipscpu.r[ 28 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R29:			mipscpu.r[ 29 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R30:			mipscpu.r[ 30 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_R31:			mipscpu.r[ 31 ] = info->i;				break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R0:			mips_set_cp0r( 0, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R1:			mips_set_cp0r( 1, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R2:			mips_set_cp0r( 2, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R3:			mips_set_cp0r( 3, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R4:			mips_set_cp0r( 4, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R5:			mips_set_cp0r( 5, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R6:			mips_set_cp0r( 6, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R7:			mips_set_cp0r( 7, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R8:			mips_set_cp0r( 8, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R9:			mips_set_cp0r( 9, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R10:		mips_set_cp0r( 10, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R11:		mips_set_cp0r( 11, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R12:		mips_set_cp0r( 12, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R13:		mips_set_cp0r( 13, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R14:		mips_set_cp0r( 14, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R15:		mips_set_cp0r( 15, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R16:		mips_set_cp0r( 16, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R17:		mips_set_cp0r( 17, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R18:		mips_set_cp0r( 18, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R19:		mips_set_cp0r( 19, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R20:		mips_set_cp0r( 20, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R21:		mips_set_cp0r( 21, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R22:		mips_set_cp0r( 22, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R23:		mips_set_cp0r( 23, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R24:		mips_set_cp0r( 24, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R25:		mips_set_cp0r( 25, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R26:		mips_set_cp0r( 26, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R27:		mips_set_cp0r( 27, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R28:		mips_set_cp0r( 28, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R29:		mips_set_cp0r( 29, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R30:		mips_set_cp0r( 30, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R31:		mips_set_cp0r( 31, info->i );			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR0:		mipscpu.cp2dr[ 0 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR1:		mipscpu.cp2dr[ 1 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR2:		mipscpu.cp2dr[ 2 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR3:		mipscpu.cp2dr[ 3 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR4:		mipscpu.cp2dr[ 4 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR5:		mipscpu.cp2dr[ 5 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR6:		mipscpu.cp2dr[ 6 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR7:		mipscpu.cp2dr[ 7 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR8:		mipscpu.cp2dr[ 8 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR9:		mipscpu.cp2dr[ 9 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR10:		mipscpu.cp2dr[ 10 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR11:		mipscpu.cp2dr[ 11 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR12:		mipscpu.cp2dr[ 12 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR13:		mipscpu.cp2dr[ 13 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR14:		mipscpu.cp2dr[ 14 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR15:		mipscpu.cp2dr[ 15 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR16:		mipscpu.cp2dr[ 16 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR17:		mipscpu.cp2dr[ 17 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR18:		mipscpu.cp2dr[ 18 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR19:		mipscpu.cp2dr[ 19 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR20:		mipscpu.cp2dr[ 20 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR21:		mipscpu.cp2dr[ 21 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR22:		mipscpu.cp2dr[ 22 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR23:		mipscpu.cp2dr[ 23 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR24:		mipscpu.cp2dr[ 24 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR25:		mipscpu.cp2dr[ 25 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR26:		mipscpu.cp2dr[ 26 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR27:		mipscpu.cp2dr[ 27 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR28:		mipscpu.cp2dr[ 28 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR29:		mipscpu.cp2dr[ 29 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR30:		mipscpu.cp2dr[ 30 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR31:		mipscpu.cp2dr[ 31 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR0:		mipscpu.cp2cr[ 0 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR1:		mipscpu.cp2cr[ 1 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR2:		mipscpu.cp2cr[ 2 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR3:		mipscpu.cp2cr[ 3 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR4:		mipscpu.cp2cr[ 4 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR5:		mipscpu.cp2cr[ 5 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR6:		mipscpu.cp2cr[ 6 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR7:		mipscpu.cp2cr[ 7 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR8:		mipscpu.cp2cr[ 8 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR9:		mipscpu.cp2cr[ 9 ].d = info->i;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR10:		mipscpu.cp2cr[ 10 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR11:		mipscpu.cp2cr[ 11 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR12:		mipscpu.cp2cr[ 12 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR13:		mipscpu.cp2cr[ 13 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR14:		mipscpu.cp2cr[ 14 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR15:		mipscpu.cp2cr[ 15 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR16:		mipscpu.cp2cr[ 16 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR17:		mipscpu.cp2cr[ 17 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR18:		mipscpu.cp2cr[ 18 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR19:		mipscpu.cp2cr[ 19 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR20:		mipscpu.cp2cr[ 20 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR21:		mipscpu.cp2cr[ 21 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR22:		mipscpu.cp2cr[ 22 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR23:		mipscpu.cp2cr[ 23 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR24:		mipscpu.cp2cr[ 24 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR25:		mipscpu.cp2cr[ 25 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR26:		mipscpu.cp2cr[ 26 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR27:		mipscpu.cp2cr[ 27 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR28:		mipscpu.cp2cr[ 28 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR29:		mipscpu.cp2cr[ 29 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR30:		mipscpu.cp2cr[ 30 ].d = info->i;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR31:		mipscpu.cp2cr[ 31 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_DELAYV:		MIPSCPU.delayv = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_DELAYR:		if( info->i <= REGPC ) MIPSCPU.delayr = info->i; break;
+		case CPUINFO_INT_REGISTER + MIPS_HI:			MIPSCPU.hi = info->i;					break;
+		case CPUINFO_INT_REGISTER + MIPS_LO:			MIPSCPU.lo = info->i;					break;
+		case CPUINFO_INT_REGISTER + MIPS_R0:			MIPSCPU.r[ 0 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R1:			MIPSCPU.r[ 1 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R2:			MIPSCPU.r[ 2 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R3:			MIPSCPU.r[ 3 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R4:			MIPSCPU.r[ 4 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R5:			MIPSCPU.r[ 5 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R6:			MIPSCPU.r[ 6 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R7:			MIPSCPU.r[ 7 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R8:			MIPSCPU.r[ 8 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R9:			MIPSCPU.r[ 9 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R10:			MIPSCPU.r[ 10 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R11:			MIPSCPU.r[ 11 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R12:			MIPSCPU.r[ 12 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R13:			MIPSCPU.r[ 13 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R14:			MIPSCPU.r[ 14 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R15:			MIPSCPU.r[ 15 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R16:			MIPSCPU.r[ 16 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R17:			MIPSCPU.r[ 17 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R18:			MIPSCPU.r[ 18 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R19:			MIPSCPU.r[ 19 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R20:			MIPSCPU.r[ 20 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R21:			MIPSCPU.r[ 21 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R22:			MIPSCPU.r[ 22 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R23:			MIPSCPU.r[ 23 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R24:			MIPSCPU.r[ 24 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R25:			MIPSCPU.r[ 25 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R26:			MIPSCPU.r[ 26 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R27:			MIPSCPU.r[ 27 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R28:			MIPSCPU.r[ 28 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R29:			MIPSCPU.r[ 29 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R30:			MIPSCPU.r[ 30 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_R31:			MIPSCPU.r[ 31 ] = info->i;				break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R0:			mips_set_cp0r( cpu, 0, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R1:			mips_set_cp0r( cpu, 1, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R2:			mips_set_cp0r( cpu, 2, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R3:			mips_set_cp0r( cpu, 3, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R4:			mips_set_cp0r( cpu, 4, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R5:			mips_set_cp0r( cpu, 5, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R6:			mips_set_cp0r( cpu, 6, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R7:			mips_set_cp0r( cpu, 7, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R8:			mips_set_cp0r( cpu, 8, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R9:			mips_set_cp0r( cpu, 9, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R10:		mips_set_cp0r( cpu, 10, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R11:		mips_set_cp0r( cpu, 11, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R12:		mips_set_cp0r( cpu, 12, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R13:		mips_set_cp0r( cpu, 13, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R14:		mips_set_cp0r( cpu, 14, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R15:		mips_set_cp0r( cpu, 15, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R16:		mips_set_cp0r( cpu, 16, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R17:		mips_set_cp0r( cpu, 17, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R18:		mips_set_cp0r( cpu, 18, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R19:		mips_set_cp0r( cpu, 19, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R20:		mips_set_cp0r( cpu, 20, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R21:		mips_set_cp0r( cpu, 21, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R22:		mips_set_cp0r( cpu, 22, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R23:		mips_set_cp0r( cpu, 23, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R24:		mips_set_cp0r( cpu, 24, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R25:		mips_set_cp0r( cpu, 25, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R26:		mips_set_cp0r( cpu, 26, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R27:		mips_set_cp0r( cpu, 27, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R28:		mips_set_cp0r( cpu, 28, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R29:		mips_set_cp0r( cpu, 29, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R30:		mips_set_cp0r( cpu, 30, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R31:		mips_set_cp0r( cpu, 31, info->i );			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR0:		MIPSCPU.cp2dr[ 0 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR1:		MIPSCPU.cp2dr[ 1 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR2:		MIPSCPU.cp2dr[ 2 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR3:		MIPSCPU.cp2dr[ 3 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR4:		MIPSCPU.cp2dr[ 4 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR5:		MIPSCPU.cp2dr[ 5 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR6:		MIPSCPU.cp2dr[ 6 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR7:		MIPSCPU.cp2dr[ 7 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR8:		MIPSCPU.cp2dr[ 8 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR9:		MIPSCPU.cp2dr[ 9 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR10:		MIPSCPU.cp2dr[ 10 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR11:		MIPSCPU.cp2dr[ 11 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR12:		MIPSCPU.cp2dr[ 12 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR13:		MIPSCPU.cp2dr[ 13 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR14:		MIPSCPU.cp2dr[ 14 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR15:		MIPSCPU.cp2dr[ 15 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR16:		MIPSCPU.cp2dr[ 16 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR17:		MIPSCPU.cp2dr[ 17 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR18:		MIPSCPU.cp2dr[ 18 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR19:		MIPSCPU.cp2dr[ 19 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR20:		MIPSCPU.cp2dr[ 20 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR21:		MIPSCPU.cp2dr[ 21 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR22:		MIPSCPU.cp2dr[ 22 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR23:		MIPSCPU.cp2dr[ 23 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR24:		MIPSCPU.cp2dr[ 24 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR25:		MIPSCPU.cp2dr[ 25 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR26:		MIPSCPU.cp2dr[ 26 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR27:		MIPSCPU.cp2dr[ 27 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR28:		MIPSCPU.cp2dr[ 28 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR29:		MIPSCPU.cp2dr[ 29 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR30:		MIPSCPU.cp2dr[ 30 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR31:		MIPSCPU.cp2dr[ 31 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR0:		MIPSCPU.cp2cr[ 0 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR1:		MIPSCPU.cp2cr[ 1 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR2:		MIPSCPU.cp2cr[ 2 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR3:		MIPSCPU.cp2cr[ 3 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR4:		MIPSCPU.cp2cr[ 4 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR5:		MIPSCPU.cp2cr[ 5 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR6:		MIPSCPU.cp2cr[ 6 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR7:		MIPSCPU.cp2cr[ 7 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR8:		MIPSCPU.cp2cr[ 8 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR9:		MIPSCPU.cp2cr[ 9 ].d = info->i;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR10:		MIPSCPU.cp2cr[ 10 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR11:		MIPSCPU.cp2cr[ 11 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR12:		MIPSCPU.cp2cr[ 12 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR13:		MIPSCPU.cp2cr[ 13 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR14:		MIPSCPU.cp2cr[ 14 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR15:		MIPSCPU.cp2cr[ 15 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR16:		MIPSCPU.cp2cr[ 16 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR17:		MIPSCPU.cp2cr[ 17 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR18:		MIPSCPU.cp2cr[ 18 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR19:		MIPSCPU.cp2cr[ 19 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR20:		MIPSCPU.cp2cr[ 20 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR21:		MIPSCPU.cp2cr[ 21 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR22:		MIPSCPU.cp2cr[ 22 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR23:		MIPSCPU.cp2cr[ 23 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR24:		MIPSCPU.cp2cr[ 24 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR25:		MIPSCPU.cp2cr[ 25 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR26:		MIPSCPU.cp2cr[ 26 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR27:		MIPSCPU.cp2cr[ 27 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR28:		MIPSCPU.cp2cr[ 28 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR29:		MIPSCPU.cp2cr[ 29 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR30:		MIPSCPU.cp2cr[ 30 ].d = info->i;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR31:		MIPSCPU.cp2cr[ 31 ].d = info->i;		break;
 
 		/* --- the following bits of info are set as pointers to data or functions --- */
-		case CPUINFO_PTR_IRQ_CALLBACK:					mipscpu.irq_callback = info->irqcallback;			break;
+		case CPUINFO_PTR_IRQ_CALLBACK:					MIPSCPU.irq_callback = info->irqcallback;			break;
 	}
 }
 
@@ -2756,10 +3510,12 @@ void mips_set_info(uint32_t state, union cpuinfo *info)
 
 void mips_get_info(uint32_t state, union cpuinfo *info)
 {
+	PSXCPUState &cpu = *psf_instance->cpu;
+
 	switch (state)
 	{
 		/* --- the following bits of info are returned as 64-bit signed integers --- */
-		case CPUINFO_INT_CONTEXT_SIZE:					info->i = sizeof(mipscpu);				break;
+		case CPUINFO_INT_CONTEXT_SIZE:					info->i = sizeof(MIPSCPU);				break;
 		case CPUINFO_INT_INPUT_LINES:					info->i = 6;							break;
 		case CPUINFO_INT_DEFAULT_IRQ_VECTOR:			info->i = 0;							break;
 		case CPUINFO_INT_ENDIANNESS:					info->i = CPU_IS_LE;					break;
@@ -2779,154 +3535,154 @@ void mips_get_info(uint32_t state, union cpuinfo *info)
 		case CPUINFO_INT_ADDRBUS_WIDTH + ADDRESS_SPACE_IO: 		info->i = 0;					break;
 		case CPUINFO_INT_ADDRBUS_SHIFT + ADDRESS_SPACE_IO: 		info->i = 0;					break;
 
-		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ0:		info->i = (mipscpu.cp0r[ CP0_CAUSE ] & 0x400) ? ASSERT_LINE : CLEAR_LINE; break;
-		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ1:		info->i = (mipscpu.cp0r[ CP0_CAUSE ] & 0x800) ? ASSERT_LINE : CLEAR_LINE; break;
-		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ2:		info->i = (mipscpu.cp0r[ CP0_CAUSE ] & 0x1000) ? ASSERT_LINE : CLEAR_LINE; break;
-		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ3:		info->i = (mipscpu.cp0r[ CP0_CAUSE ] & 0x2000) ? ASSERT_LINE : CLEAR_LINE; break;
-		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ4:		info->i = (mipscpu.cp0r[ CP0_CAUSE ] & 0x4000) ? ASSERT_LINE : CLEAR_LINE; break;
-		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ5:		info->i = (mipscpu.cp0r[ CP0_CAUSE ] & 0x8000) ? ASSERT_LINE : CLEAR_LINE; break;
+		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ0:		info->i = (MIPSCPU.cp0r[ CP0_CAUSE ] & 0x400) ? ASSERT_LINE : CLEAR_LINE; break;
+		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ1:		info->i = (MIPSCPU.cp0r[ CP0_CAUSE ] & 0x800) ? ASSERT_LINE : CLEAR_LINE; break;
+		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ2:		info->i = (MIPSCPU.cp0r[ CP0_CAUSE ] & 0x1000) ? ASSERT_LINE : CLEAR_LINE; break;
+		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ3:		info->i = (MIPSCPU.cp0r[ CP0_CAUSE ] & 0x2000) ? ASSERT_LINE : CLEAR_LINE; break;
+		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ4:		info->i = (MIPSCPU.cp0r[ CP0_CAUSE ] & 0x4000) ? ASSERT_LINE : CLEAR_LINE; break;
+		case CPUINFO_INT_INPUT_STATE + MIPS_IRQ5:		info->i = (MIPSCPU.cp0r[ CP0_CAUSE ] & 0x8000) ? ASSERT_LINE : CLEAR_LINE; break;
 
 		case CPUINFO_INT_PREVIOUSPC:					/* not implemented */					break;
 
-		case CPUINFO_INT_PC:							info->i = mipscpu.pc;					break;
-		case CPUINFO_INT_REGISTER + MIPS_PC:			info->i = mipscpu.pc;					break;
+		case CPUINFO_INT_PC:							info->i = MIPSCPU.pc;					break;
+		case CPUINFO_INT_REGISTER + MIPS_PC:			info->i = MIPSCPU.pc;					break;
 		case CPUINFO_INT_SP:
 			/* because there is no hardware stack and the pipeline causes the cpu to execute the
 			instruction after a subroutine call before the subroutine is executed there is little
 			chance of cmd_step_over() in mamedbg.c working. */
 								info->i = 0;													break;
-		case CPUINFO_INT_REGISTER + MIPS_DELAYV:		info->i = mipscpu.delayv;				break;
-		case CPUINFO_INT_REGISTER + MIPS_DELAYR:		info->i = mipscpu.delayr;				break;
-		case CPUINFO_INT_REGISTER + MIPS_HI:			info->i = mipscpu.hi;					break;
-		case CPUINFO_INT_REGISTER + MIPS_LO:			info->i = mipscpu.lo;					break;
-		case CPUINFO_INT_REGISTER + MIPS_R0:			info->i = mipscpu.r[ 0 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R1:			info->i = mipscpu.r[ 1 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R2:			info->i = mipscpu.r[ 2 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R3:			info->i = mipscpu.r[ 3 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R4:			info->i = mipscpu.r[ 4 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R5:			info->i = mipscpu.r[ 5 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R6:			info->i = mipscpu.r[ 6 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R7:			info->i = mipscpu.r[ 7 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R8:			info->i = mipscpu.r[ 8 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R9:			info->i = mipscpu.r[ 9 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R10:			info->i = mipscpu.r[ 10 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R11:			info->i = mipscpu.r[ 11 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R12:			info->i = mipscpu.r[ 12 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R13:			info->i = mipscpu.r[ 13 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R14:			info->i = mipscpu.r[ 14 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R15:			info->i = mipscpu.r[ 15 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R16:			info->i = mipscpu.r[ 16 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R17:			info->i = mipscpu.r[ 17 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R18:			info->i = mipscpu.r[ 18 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R19:			info->i = mipscpu.r[ 19 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R20:			info->i = mipscpu.r[ 20 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R21:			info->i = mipscpu.r[ 21 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R22:			info->i = mipscpu.r[ 22 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R23:			info->i = mipscpu.r[ 23 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R24:			info->i = mipscpu.r[ 24 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R25:			info->i = mipscpu.r[ 25 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R26:			info->i = mipscpu.r[ 26 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R27:			info->i = mipscpu.r[ 27 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R28:			info->i = mipscpu.r[ 28 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R29:			info->i = mipscpu.r[ 29 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R30:			info->i = mipscpu.r[ 30 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_R31:			info->i = mipscpu.r[ 31 ];				break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R0:			info->i = mipscpu.cp0r[ 0 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R1:			info->i = mipscpu.cp0r[ 1 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R2:			info->i = mipscpu.cp0r[ 2 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R3:			info->i = mipscpu.cp0r[ 3 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R4:			info->i = mipscpu.cp0r[ 4 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R5:			info->i = mipscpu.cp0r[ 5 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R6:			info->i = mipscpu.cp0r[ 6 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R7:			info->i = mipscpu.cp0r[ 7 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R8:			info->i = mipscpu.cp0r[ 8 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R9:			info->i = mipscpu.cp0r[ 9 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R10:		info->i = mipscpu.cp0r[ 10 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R11:		info->i = mipscpu.cp0r[ 11 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R12:		info->i = mipscpu.cp0r[ 12 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R13:		info->i = mipscpu.cp0r[ 13 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R14:		info->i = mipscpu.cp0r[ 14 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R15:		info->i = mipscpu.cp0r[ 15 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R16:		info->i = mipscpu.cp0r[ 16 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R17:		info->i = mipscpu.cp0r[ 17 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R18:		info->i = mipscpu.cp0r[ 18 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R19:		info->i = mipscpu.cp0r[ 19 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R20:		info->i = mipscpu.cp0r[ 20 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R21:		info->i = mipscpu.cp0r[ 21 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R22:		info->i = mipscpu.cp0r[ 22 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R23:		info->i = mipscpu.cp0r[ 23 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R24:		info->i = mipscpu.cp0r[ 24 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R25:		info->i = mipscpu.cp0r[ 25 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R26:		info->i = mipscpu.cp0r[ 26 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R27:		info->i = mipscpu.cp0r[ 27 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R28:		info->i = mipscpu.cp0r[ 28 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R29:		info->i = mipscpu.cp0r[ 29 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R30:		info->i = mipscpu.cp0r[ 30 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP0R31:		info->i = mipscpu.cp0r[ 31 ];			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR0:		info->i = mipscpu.cp2dr[ 0 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR1:		info->i = mipscpu.cp2dr[ 1 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR2:		info->i = mipscpu.cp2dr[ 2 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR3:		info->i = mipscpu.cp2dr[ 3 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR4:		info->i = mipscpu.cp2dr[ 4 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR5:		info->i = mipscpu.cp2dr[ 5 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR6:		info->i = mipscpu.cp2dr[ 6 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR7:		info->i = mipscpu.cp2dr[ 7 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR8:		info->i = mipscpu.cp2dr[ 8 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR9:		info->i = mipscpu.cp2dr[ 9 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR10:		info->i = mipscpu.cp2dr[ 10 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR11:		info->i = mipscpu.cp2dr[ 11 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR12:		info->i = mipscpu.cp2dr[ 12 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR13:		info->i = mipscpu.cp2dr[ 13 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR14:		info->i = mipscpu.cp2dr[ 14 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR15:		info->i = mipscpu.cp2dr[ 15 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR16:		info->i = mipscpu.cp2dr[ 16 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR17:		info->i = mipscpu.cp2dr[ 17 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR18:		info->i = mipscpu.cp2dr[ 18 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR19:		info->i = mipscpu.cp2dr[ 19 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR20:		info->i = mipscpu.cp2dr[ 20 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR21:		info->i = mipscpu.cp2dr[ 21 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR22:		info->i = mipscpu.cp2dr[ 22 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR23:		info->i = mipscpu.cp2dr[ 23 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR24:		info->i = mipscpu.cp2dr[ 24 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR25:		info->i = mipscpu.cp2dr[ 25 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR26:		info->i = mipscpu.cp2dr[ 26 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR27:		info->i = mipscpu.cp2dr[ 27 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR28:		info->i = mipscpu.cp2dr[ 28 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR29:		info->i = mipscpu.cp2dr[ 29 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR30:		info->i = mipscpu.cp2dr[ 30 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2DR31:		info->i = mipscpu.cp2dr[ 31 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR0:		info->i = mipscpu.cp2cr[ 0 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR1:		info->i = mipscpu.cp2cr[ 1 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR2:		info->i = mipscpu.cp2cr[ 2 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR3:		info->i = mipscpu.cp2cr[ 3 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR4:		info->i = mipscpu.cp2cr[ 4 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR5:		info->i = mipscpu.cp2cr[ 5 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR6:		info->i = mipscpu.cp2cr[ 6 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR7:		info->i = mipscpu.cp2cr[ 7 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR8:		info->i = mipscpu.cp2cr[ 8 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR9:		info->i = mipscpu.cp2cr[ 9 ].d;			break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR10:		info->i = mipscpu.cp2cr[ 10 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR11:		info->i = mipscpu.cp2cr[ 11 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR12:		info->i = mipscpu.cp2cr[ 12 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR13:		info->i = mipscpu.cp2cr[ 13 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR14:		info->i = mipscpu.cp2cr[ 14 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR15:		info->i = mipscpu.cp2cr[ 15 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR16:		info->i = mipscpu.cp2cr[ 16 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR17:		info->i = mipscpu.cp2cr[ 17 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR18:		info->i = mipscpu.cp2cr[ 18 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR19:		info->i = mipscpu.cp2cr[ 19 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR20:		info->i = mipscpu.cp2cr[ 20 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR21:		info->i = mipscpu.cp2cr[ 21 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR22:		info->i = mipscpu.cp2cr[ 22 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR23:		info->i = mipscpu.cp2cr[ 23 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR24:		info->i = mipscpu.cp2cr[ 24 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR25:		info->i = mipscpu.cp2cr[ 25 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR26:		info->i = mipscpu.cp2cr[ 26 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR27:		info->i = mipscpu.cp2cr[ 27 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR28:		info->i = mipscpu.cp2cr[ 28 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR29:		info->i = mipscpu.cp2cr[ 29 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR30:		info->i = mipscpu.cp2cr[ 30 ].d;		break;
-		case CPUINFO_INT_REGISTER + MIPS_CP2CR31:		info->i = mipscpu.cp2cr[ 31 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_DELAYV:		info->i = MIPSCPU.delayv;				break;
+		case CPUINFO_INT_REGISTER + MIPS_DELAYR:		info->i = MIPSCPU.delayr;				break;
+		case CPUINFO_INT_REGISTER + MIPS_HI:			info->i = MIPSCPU.hi;					break;
+		case CPUINFO_INT_REGISTER + MIPS_LO:			info->i = MIPSCPU.lo;					break;
+		case CPUINFO_INT_REGISTER + MIPS_R0:			info->i = MIPSCPU.r[ 0 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R1:			info->i = MIPSCPU.r[ 1 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R2:			info->i = MIPSCPU.r[ 2 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R3:			info->i = MIPSCPU.r[ 3 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R4:			info->i = MIPSCPU.r[ 4 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R5:			info->i = MIPSCPU.r[ 5 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R6:			info->i = MIPSCPU.r[ 6 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R7:			info->i = MIPSCPU.r[ 7 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R8:			info->i = MIPSCPU.r[ 8 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R9:			info->i = MIPSCPU.r[ 9 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R10:			info->i = MIPSCPU.r[ 10 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R11:			info->i = MIPSCPU.r[ 11 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R12:			info->i = MIPSCPU.r[ 12 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R13:			info->i = MIPSCPU.r[ 13 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R14:			info->i = MIPSCPU.r[ 14 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R15:			info->i = MIPSCPU.r[ 15 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R16:			info->i = MIPSCPU.r[ 16 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R17:			info->i = MIPSCPU.r[ 17 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R18:			info->i = MIPSCPU.r[ 18 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R19:			info->i = MIPSCPU.r[ 19 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R20:			info->i = MIPSCPU.r[ 20 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R21:			info->i = MIPSCPU.r[ 21 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R22:			info->i = MIPSCPU.r[ 22 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R23:			info->i = MIPSCPU.r[ 23 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R24:			info->i = MIPSCPU.r[ 24 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R25:			info->i = MIPSCPU.r[ 25 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R26:			info->i = MIPSCPU.r[ 26 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R27:			info->i = MIPSCPU.r[ 27 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R28:			info->i = MIPSCPU.r[ 28 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R29:			info->i = MIPSCPU.r[ 29 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R30:			info->i = MIPSCPU.r[ 30 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_R31:			info->i = MIPSCPU.r[ 31 ];				break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R0:			info->i = MIPSCPU.cp0r[ 0 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R1:			info->i = MIPSCPU.cp0r[ 1 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R2:			info->i = MIPSCPU.cp0r[ 2 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R3:			info->i = MIPSCPU.cp0r[ 3 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R4:			info->i = MIPSCPU.cp0r[ 4 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R5:			info->i = MIPSCPU.cp0r[ 5 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R6:			info->i = MIPSCPU.cp0r[ 6 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R7:			info->i = MIPSCPU.cp0r[ 7 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R8:			info->i = MIPSCPU.cp0r[ 8 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R9:			info->i = MIPSCPU.cp0r[ 9 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R10:		info->i = MIPSCPU.cp0r[ 10 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R11:		info->i = MIPSCPU.cp0r[ 11 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R12:		info->i = MIPSCPU.cp0r[ 12 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R13:		info->i = MIPSCPU.cp0r[ 13 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R14:		info->i = MIPSCPU.cp0r[ 14 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R15:		info->i = MIPSCPU.cp0r[ 15 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R16:		info->i = MIPSCPU.cp0r[ 16 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R17:		info->i = MIPSCPU.cp0r[ 17 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R18:		info->i = MIPSCPU.cp0r[ 18 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R19:		info->i = MIPSCPU.cp0r[ 19 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R20:		info->i = MIPSCPU.cp0r[ 20 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R21:		info->i = MIPSCPU.cp0r[ 21 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R22:		info->i = MIPSCPU.cp0r[ 22 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R23:		info->i = MIPSCPU.cp0r[ 23 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R24:		info->i = MIPSCPU.cp0r[ 24 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R25:		info->i = MIPSCPU.cp0r[ 25 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R26:		info->i = MIPSCPU.cp0r[ 26 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R27:		info->i = MIPSCPU.cp0r[ 27 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R28:		info->i = MIPSCPU.cp0r[ 28 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R29:		info->i = MIPSCPU.cp0r[ 29 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R30:		info->i = MIPSCPU.cp0r[ 30 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP0R31:		info->i = MIPSCPU.cp0r[ 31 ];			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR0:		info->i = MIPSCPU.cp2dr[ 0 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR1:		info->i = MIPSCPU.cp2dr[ 1 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR2:		info->i = MIPSCPU.cp2dr[ 2 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR3:		info->i = MIPSCPU.cp2dr[ 3 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR4:		info->i = MIPSCPU.cp2dr[ 4 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR5:		info->i = MIPSCPU.cp2dr[ 5 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR6:		info->i = MIPSCPU.cp2dr[ 6 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR7:		info->i = MIPSCPU.cp2dr[ 7 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR8:		info->i = MIPSCPU.cp2dr[ 8 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR9:		info->i = MIPSCPU.cp2dr[ 9 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR10:		info->i = MIPSCPU.cp2dr[ 10 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR11:		info->i = MIPSCPU.cp2dr[ 11 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR12:		info->i = MIPSCPU.cp2dr[ 12 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR13:		info->i = MIPSCPU.cp2dr[ 13 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR14:		info->i = MIPSCPU.cp2dr[ 14 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR15:		info->i = MIPSCPU.cp2dr[ 15 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR16:		info->i = MIPSCPU.cp2dr[ 16 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR17:		info->i = MIPSCPU.cp2dr[ 17 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR18:		info->i = MIPSCPU.cp2dr[ 18 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR19:		info->i = MIPSCPU.cp2dr[ 19 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR20:		info->i = MIPSCPU.cp2dr[ 20 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR21:		info->i = MIPSCPU.cp2dr[ 21 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR22:		info->i = MIPSCPU.cp2dr[ 22 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR23:		info->i = MIPSCPU.cp2dr[ 23 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR24:		info->i = MIPSCPU.cp2dr[ 24 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR25:		info->i = MIPSCPU.cp2dr[ 25 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR26:		info->i = MIPSCPU.cp2dr[ 26 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR27:		info->i = MIPSCPU.cp2dr[ 27 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR28:		info->i = MIPSCPU.cp2dr[ 28 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR29:		info->i = MIPSCPU.cp2dr[ 29 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR30:		info->i = MIPSCPU.cp2dr[ 30 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2DR31:		info->i = MIPSCPU.cp2dr[ 31 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR0:		info->i = MIPSCPU.cp2cr[ 0 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR1:		info->i = MIPSCPU.cp2cr[ 1 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR2:		info->i = MIPSCPU.cp2cr[ 2 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR3:		info->i = MIPSCPU.cp2cr[ 3 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR4:		info->i = MIPSCPU.cp2cr[ 4 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR5:		info->i = MIPSCPU.cp2cr[ 5 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR6:		info->i = MIPSCPU.cp2cr[ 6 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR7:		info->i = MIPSCPU.cp2cr[ 7 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR8:		info->i = MIPSCPU.cp2cr[ 8 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR9:		info->i = MIPSCPU.cp2cr[ 9 ].d;			break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR10:		info->i = MIPSCPU.cp2cr[ 10 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR11:		info->i = MIPSCPU.cp2cr[ 11 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR12:		info->i = MIPSCPU.cp2cr[ 12 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR13:		info->i = MIPSCPU.cp2cr[ 13 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR14:		info->i = MIPSCPU.cp2cr[ 14 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR15:		info->i = MIPSCPU.cp2cr[ 15 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR16:		info->i = MIPSCPU.cp2cr[ 16 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR17:		info->i = MIPSCPU.cp2cr[ 17 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR18:		info->i = MIPSCPU.cp2cr[ 18 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR19:		info->i = MIPSCPU.cp2cr[ 19 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR20:		info->i = MIPSCPU.cp2cr[ 20 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR21:		info->i = MIPSCPU.cp2cr[ 21 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR22:		info->i = MIPSCPU.cp2cr[ 22 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR23:		info->i = MIPSCPU.cp2cr[ 23 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR24:		info->i = MIPSCPU.cp2cr[ 24 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR25:		info->i = MIPSCPU.cp2cr[ 25 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR26:		info->i = MIPSCPU.cp2cr[ 26 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR27:		info->i = MIPSCPU.cp2cr[ 27 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR28:		info->i = MIPSCPU.cp2cr[ 28 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR29:		info->i = MIPSCPU.cp2cr[ 29 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR30:		info->i = MIPSCPU.cp2cr[ 30 ].d;		break;
+		case CPUINFO_INT_REGISTER + MIPS_CP2CR31:		info->i = MIPSCPU.cp2cr[ 31 ].d;		break;
 
 		/* --- the following bits of info are returned as pointers to data or functions --- */
 		case CPUINFO_PTR_SET_INFO:						info->setinfo = mips_set_info;			break;
@@ -2938,8 +3694,8 @@ void mips_get_info(uint32_t state, union cpuinfo *info)
 		case CPUINFO_PTR_EXECUTE:						info->execute = mips_execute;			break;
 		case CPUINFO_PTR_BURN:							info->burn = nullptr;						break;
 		case CPUINFO_PTR_DISASSEMBLE:					info->disassemble = mips_dasm;			break;
-		case CPUINFO_PTR_IRQ_CALLBACK:					info->irqcallback = mipscpu.irq_callback; break;
-		case CPUINFO_PTR_INSTRUCTION_COUNTER:			info->icount = &mips_ICount;			break;
+		case CPUINFO_PTR_IRQ_CALLBACK:					info->irqcallback = MIPSCPU.irq_callback; break;
+		case CPUINFO_PTR_INSTRUCTION_COUNTER:			info->icount = &MIPS_ICOUNT;			break;
 		case CPUINFO_PTR_REGISTER_LAYOUT:				info->p = mips_reg_layout;				break;
 		case CPUINFO_PTR_WINDOW_LAYOUT:					info->p = mips_win_layout;				break;
 	}
@@ -2947,32 +3703,38 @@ void mips_get_info(uint32_t state, union cpuinfo *info)
 
 uint32_t mips_get_cause(void)
 {
-	return mipscpu.cp0r[ CP0_CAUSE ];
+	PSXCPUState &cpu = *psf_instance->cpu;
+	return MIPSCPU.cp0r[ CP0_CAUSE ];
 }
 
 uint32_t mips_get_status(void)
 {
-	return mipscpu.cp0r[ CP0_SR ];
+	PSXCPUState &cpu = *psf_instance->cpu;
+	return MIPSCPU.cp0r[ CP0_SR ];
 }
 
 void mips_set_status(uint32_t status)
 {
-	mipscpu.cp0r[ CP0_SR ] = status;
+	PSXCPUState &cpu = *psf_instance->cpu;
+	MIPSCPU.cp0r[ CP0_SR ] = status;
 }
 
 uint32_t mips_get_ePC(void)
 {
-	return mipscpu.cp0r[ CP0_EPC ];
+	PSXCPUState &cpu = *psf_instance->cpu;
+	return MIPSCPU.cp0r[ CP0_EPC ];
 }
 
 int mips_get_icount(void)
 {
-	return mips_ICount;
+	PSXCPUState &cpu = *psf_instance->cpu;
+	return MIPS_ICOUNT;
 }
 
 void mips_set_icount(int count)
 {
-	mips_ICount = count;
+	PSXCPUState &cpu = *psf_instance->cpu;
+	MIPS_ICOUNT = count;
 }
 
 
@@ -286,33 +286,45 @@ extern void psxcpu_get_info(uint32_t state, union cpuinfo *info);
 #endif
 
 /* eng_psf.cc */
-extern int psf_refresh;
+PSF1State *psf_alloc_state(void);
+void psf_free_state(PSF1State *psf);
 
-int32_t psf_start(uint8_t *buffer, uint32_t length);
-int32_t psf_execute(void (*update)(const void *, int));
-int32_t psf_stop(void);
+int32_t psf_start(PSFInstance &inst, uint8_t *buffer, uint32_t length);
+int32_t psf_execute(PSFInstance &inst);
+int32_t psf_stop(PSFInstance &inst);
+void psf_state(PSFInstance &inst, PSFState &state);
 
 /* eng_psf2.cc */
+PSF2State *psf2_alloc_state(void);
+void psf2_free_state(PSF2State *psf2);
+
 uint32_t psf2_load_elf(uint8_t *start, uint32_t len);
 uint32_t psf2_load_file(const char *file, uint8_t *buf, uint32_t buflen);
-int32_t psf2_start(uint8_t *, uint32_t length);
-int32_t psf2_execute(void (*update)(const void *, int));
-int32_t psf2_stop(void);
+int32_t psf2_start(PSFInstance &inst, uint8_t *, uint32_t length);
+int32_t psf2_execute(PSFInstance &inst);
+int32_t psf2_stop(PSFInstance &inst);
+void psf2_state(PSFInstance &inst, PSFState &state);
 int32_t psf2_command(int32_t, int32_t);
 uint32_t psf2_get_loadaddr(void);
 void psf2_set_loadaddr(uint32_t addr);
 
 /* eng_spx.cc */
-int32_t spx_start(uint8_t *buffer, uint32_t length);
-int32_t spx_execute(void (*update)(const void *, int));
-int32_t spx_stop(void);
+SPXState *spx_alloc_state(void);
+void spx_free_state(SPXState *spx);
 
-/* plugin.cc */
-extern bool stop_flag;
+int32_t spx_start(PSFInstance &inst, uint8_t *buffer, uint32_t length);
+int32_t spx_execute(PSFInstance &inst);
+int32_t spx_stop(PSFInstance &inst);
+void spx_state(PSFInstance &inst, PSFState &state);
 
 /* psx.cc */
+PSXCPUState *mips_alloc_state(void);
+void mips_free_state(PSXCPUState *cpu);
+
 void mips_init(void);
 void mips_reset(void *param);
+void mips_exit(void);
+void mips_state(PSFState &state);
 void mips_shorten_frame(void);
 int mips_execute(int cycles);
 void mips_set_info(uint32_t state, union cpuinfo *info);
@@ -325,17 +337,28 @@ int mips_get_icount(void);
 void mips_set_icount(int count);
 
 /* psx_hw.cc */
-extern uint32_t psx_ram[((2*1024*1024)/4)+4];
-extern uint32_t psx_scratch[0x400];
-extern uint32_t initial_ram[((2*1024*1024)/4)+4];
-extern uint32_t initial_scratch[0x400];
+struct PSXMemory
+{
+	// PSX main RAM
+	uint32_t psx_ram[((2*1024*1024)/4)+4];
+	uint32_t psx_scratch[0x400];
+	// backup image to restart songs
+	uint32_t initial_ram[((2*1024*1024)/4)+4];
+	uint32_t initial_scratch[0x400];
+};
+
+#define PSXMEM (*psf_instance->mem)
+
+PSXHWState *psx_hw_alloc_state(void);
+void psx_hw_free_state(PSXHWState *hw);
 
 void psx_hw_slice(void);
 void ps2_hw_slice(void);
-void psx_hw_frame(void);
+void psx_hw_frame(int refresh);
 void ps2_hw_frame(void);
 
 void psx_hw_init(void);
+void psx_hw_state(PSFState &state);
 void psx_bios_hle(uint32_t pc);
 void psx_hw_runcounters(void);
 
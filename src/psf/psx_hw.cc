@@ -57,6 +57,7 @@
 #include "peops/spu.h"
 #include "peops2/dma.h"
 #include "peops2/registers.h"
+#include "peops2/spu.h"
 
 #define DEBUG_HLE_BIOS	(0)		// debug PS1 HLE BIOS
 #define DEBUG_SPU	(0)		// debug PS1 SPU read/write
@@ -69,15 +70,7 @@
 
 #define MAX_FILE_SLOTS	(32)
 
-static volatile int softcall_target = 0;
-static int filestat[MAX_FILE_SLOTS];
-static uint8_t *filedata[MAX_FILE_SLOTS];
-static uint32_t filesize[MAX_FILE_SLOTS], filepos[MAX_FILE_SLOTS];
 static void call_irq_routine(uint32_t routine, uint32_t parameter);
-static int intr_susp = 0;
-
-static uint64_t sys_time;
-static int timerexp = 0;
 
 typedef struct
 {
@@ -85,9 +78,6 @@ typedef struct
 	uint32_t dispatch;
 } ExternLibEntries;
 
-static int32_t iNumLibs;
-static ExternLibEntries	reglibs[32];
-
 typedef struct
 {
 	uint32_t type;
@@ -96,9 +86,6 @@ typedef struct
 	int    inUse;
 } EventFlag;
 
-static int32_t iNumFlags;
-static EventFlag evflags[32];
-
 typedef struct
 {
 	uint32_t attr;
@@ -112,9 +99,6 @@ typedef struct
 
 #define SEMA_MAX	(64)
 
-static int32_t iNumSema;
-static Semaphore semaphores[SEMA_MAX];
-
 // thread states
 enum
 {
@@ -144,9 +128,6 @@ typedef struct
 	uint32_t save_regs[37];	// CPU registers belonging to this thread
 } Thread;
 
-static int32_t iNumThreads, iCurThread;
-static Thread threads[32];
-
 #if DEBUG_THREADING
 static char *_ThreadStateNames[TS_MAXSTATE] = { "RUNNING", "READY", "WAITEVFLAG", "WAITSEMA", "WAITDELAY", "SLEEPING", "CREATED" };
 #endif
@@ -167,9 +148,6 @@ typedef struct
 	uint32_t mode;
 } IOPTimer;
 
-static IOPTimer iop_timers[8];
-static int32_t iNumTimers;
-
 typedef struct
 {
 	uint32_t count;
@@ -179,8 +157,6 @@ typedef struct
 	uint32_t interrupt;
 } Counter;
 
-static Counter root_cnts[4];	// 4 of the bastards
-
 #define CLOCK_DIV	(8)	// 33 MHz / this = what we run the R3000 at to keep the CPU usage not insane
 
 // counter modes
@@ -199,9 +175,6 @@ typedef struct
 	uint32_t fhandler;
 } EvtCtrlBlk[32];
 
-static EvtCtrlBlk *Event;
-static EvtCtrlBlk *CounterEvent;
-
 // Sony event states
 #define EvStUNUSED	0x0000
 #define EvStWAIT	0x1000
@@ -212,18 +185,86 @@ static EvtCtrlBlk *CounterEvent;
 #define EvMdINTR	0x1000
 #define EvMdNOINTR	0x2000
 
-// PSX main RAM
-uint32_t psx_ram[(2*1024*1024)/4+4];
-uint32_t psx_scratch[0x400];
-// backup image to restart songs
-uint32_t initial_ram[(2*1024*1024)/4+4];
-uint32_t initial_scratch[0x400];
+// the hardware and HLE BIOS/IOP state of one PSFInstance; the RAM it works
+// on is the instance's PSXMemory
+struct PSXHWState
+{
+	volatile int softcall_target;
+	int filestat[MAX_FILE_SLOTS];
+	uint8_t *filedata[MAX_FILE_SLOTS];
+	uint32_t filesize[MAX_FILE_SLOTS], filepos[MAX_FILE_SLOTS];
+	int intr_susp;
+
+	uint64_t sys_time;
+	int timerexp;
+
+	int32_t iNumLibs;
+	ExternLibEntries reglibs[32];
+	int32_t iNumFlags;
+	EventFlag evflags[32];
+	int32_t iNumSema;
+	Semaphore semaphores[SEMA_MAX];
+	int32_t iNumThreads, iCurThread;
+	Thread threads[32];
+	IOPTimer iop_timers[8];
+	int32_t iNumTimers;
+	Counter root_cnts[4];	// 4 of the bastards
+	EvtCtrlBlk *Event;
+	EvtCtrlBlk *CounterEvent;
+
+	uint32_t spu_delay, dma_icr, irq_data, irq_mask, dma_timer, WAI;
+	uint32_t dma4_madr, dma4_bcr, dma4_chcr, dma4_delay;
+	uint32_t dma7_madr, dma7_bcr, dma7_chcr, dma7_delay;
+	uint32_t dma4_cb, dma7_cb, dma4_fval, dma4_flag, dma7_fval, dma7_flag;
+	uint32_t irq9_cb, irq9_fval, irq9_flag;
+
+	uint32_t gpu_stat;
+	int fcnt;
+	uint32_t heap_addr, entry_int;
+	uint32_t irq_regs[37];
+	int irq_mutex;
+};
+
+#define HW (*psf_instance->hw)
 
-static uint32_t spu_delay, dma_icr, irq_data, irq_mask, dma_timer, WAI;
-static uint32_t dma4_madr, dma4_bcr, dma4_chcr, dma4_delay;
-static uint32_t dma7_madr, dma7_bcr, dma7_chcr, dma7_delay;
-static uint32_t dma4_cb, dma7_cb, dma4_fval, dma4_flag, dma7_fval, dma7_flag;
-static uint32_t irq9_cb, irq9_fval, irq9_flag;
+PSF_THREAD_LOCAL PSFInstance *psf_instance PSF_TLS_MODEL = nullptr;
+
+PSFInstance::PSFInstance() :
+	cpu(mips_alloc_state()),
+	hw(psx_hw_alloc_state()),
+	mem(new PSXMemory()),
+	spu(SPUalloc_state()),
+	spu2(SPU2alloc_state()),
+	psf(psf_alloc_state()),
+	psf2(psf2_alloc_state()),
+	spx(spx_alloc_state())
+{
+}
+
+PSFInstance::~PSFInstance()
+{
+	spx_free_state(spx);
+	psf2_free_state(psf2);
+	psf_free_state(psf);
+	SPU2free_state(spu2);
+	SPUfree_state(spu);
+	delete mem;
+	psx_hw_free_state(hw);
+	mips_free_state(cpu);
+
+	if (psf_instance == this)
+		psf_instance = nullptr;
+}
+
+PSXHWState *psx_hw_alloc_state(void)
+{
+	return new PSXHWState();
+}
+
+void psx_hw_free_state(PSXHWState *hw)
+{
+	delete hw;
+}
 
 // take a snapshot of the CPU state for a thread
 static void FreezeThread(int32_t iThread, int flag)
@@ -238,16 +279,16 @@ static void FreezeThread(int32_t iThread, int flag)
 	for (i = 0; i < 32; i++)
 	{
 		mips_get_info(CPUINFO_INT_REGISTER + MIPS_R0 + i, &mipsinfo);
-		threads[iThread].save_regs[i] = mipsinfo.i;
+		HW.threads[iThread].save_regs[i] = mipsinfo.i;
 	}
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-	threads[iThread].save_regs[32] = mipsinfo.i;
+	HW.threads[iThread].save_regs[32] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
-	threads[iThread].save_regs[33] = mipsinfo.i;
+	HW.threads[iThread].save_regs[33] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_DELAYV, &mipsinfo);
-	threads[iThread].save_regs[35] = mipsinfo.i;
+	HW.threads[iThread].save_regs[35] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_DELAYR, &mipsinfo);
-	threads[iThread].save_regs[36] = mipsinfo.i;
+	HW.threads[iThread].save_regs[36] = mipsinfo.i;
 
 
 	// if a thread is freezing itself due to a IOP syscall, we must save the RA as the PC
@@ -260,22 +301,22 @@ static void FreezeThread(int32_t iThread, int flag)
 	{
 		mips_get_info(CPUINFO_INT_PC, &mipsinfo);
 	}
-	threads[iThread].save_regs[34] = mipsinfo.i;
+	HW.threads[iThread].save_regs[34] = mipsinfo.i;
 
 	#if DEBUG_THREADING
 	{
 		char buffer[256];
 
-		DasmMIPS(buffer, mipsinfo.i, &psx_ram[(mipsinfo.i & 0x7fffffff)/4]);
+		DasmMIPS(buffer, mipsinfo.i, &PSXMEM.psx_ram[(mipsinfo.i & 0x7fffffff)/4]);
 
-		printf("IOP: FreezeThread(%d) => %08x  [%s]\n", iThread, threads[iThread].save_regs[34], buffer);
+		printf("IOP: FreezeThread(%d) => %08x  [%s]\n", iThread, HW.threads[iThread].save_regs[34], buffer);
 	}
 	#endif
 
 	// if thread was running, now it's ready
-	if (threads[iThread].iState == TS_RUNNING)
+	if (HW.threads[iThread].iState == TS_RUNNING)
 	{
-		threads[iThread].iState = TS_READY;
+		HW.threads[iThread].iState = TS_READY;
 	}
 }
 
@@ -287,15 +328,15 @@ static void ThawThread(int32_t iThread)
 
 	// the first time a thread is put on the CPU,
 	// some special setup is required
-	if (threads[iThread].iState == TS_CREATED)
+	if (HW.threads[iThread].iState == TS_CREATED)
 	{
 		// PC = starting routine
-		threads[iThread].save_regs[34] = threads[iThread].routine-4;	// compensate for weird delay slot effects
+		HW.threads[iThread].save_regs[34] = HW.threads[iThread].routine-4;	// compensate for weird delay slot effects
 		// SP = thread's stack area
-		threads[iThread].save_regs[29] = (threads[iThread].stackloc + threads[iThread].stacksize) - 16;
-		threads[iThread].save_regs[29] |= 0x80000000;
+		HW.threads[iThread].save_regs[29] = (HW.threads[iThread].stackloc + HW.threads[iThread].stacksize) - 16;
+		HW.threads[iThread].save_regs[29] |= 0x80000000;
 
-		threads[iThread].save_regs[35] = threads[iThread].save_regs[36] = 0;
+		HW.threads[iThread].save_regs[35] = HW.threads[iThread].save_regs[36] = 0;
 
 		#if DEBUG_THREADING
 //		printf("IOP: Initial setup for thread %d => PC %x SP %x\n", iThread, threads[iThread].save_regs[34]+4, threads[iThread].save_regs[29]);
@@ -307,30 +348,30 @@ static void ThawThread(int32_t iThread)
 		char buffer[256];
 
 		mips_get_info(CPUINFO_INT_PC, &mipsinfo);
-		DasmMIPS(buffer, mipsinfo.i, &psx_ram[(mipsinfo.i & 0x7fffffff)/4]);
+		DasmMIPS(buffer, mipsinfo.i, &PSXMEM.psx_ram[(mipsinfo.i & 0x7fffffff)/4]);
 
-		printf("IOP: ThawThread(%d) => %08x  [%s] (wake %d)\n", iThread, threads[iThread].save_regs[34], buffer, wakecount);
+		printf("IOP: ThawThread(%d) => %08x  [%s] (wake %d)\n", iThread, HW.threads[iThread].save_regs[34], buffer, wakecount);
 	}
 	#endif
 
 	for (i = 0; i < 32; i++)
 	{
-		mipsinfo.i = threads[iThread].save_regs[i];
+		mipsinfo.i = HW.threads[iThread].save_regs[i];
 		mips_set_info(CPUINFO_INT_REGISTER + MIPS_R0 + i, &mipsinfo);
 	}
 
-	mipsinfo.i = threads[iThread].save_regs[32];
+	mipsinfo.i = HW.threads[iThread].save_regs[32];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-	mipsinfo.i = threads[iThread].save_regs[33];
+	mipsinfo.i = HW.threads[iThread].save_regs[33];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
-	mipsinfo.i = threads[iThread].save_regs[34];
+	mipsinfo.i = HW.threads[iThread].save_regs[34];
 	mips_set_info(CPUINFO_INT_PC, &mipsinfo);
-	mipsinfo.i = threads[iThread].save_regs[35];
+	mipsinfo.i = HW.threads[iThread].save_regs[35];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_DELAYV, &mipsinfo);
-	mipsinfo.i = threads[iThread].save_regs[36];
+	mipsinfo.i = HW.threads[iThread].save_regs[36];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_DELAYR, &mipsinfo);
 
-	threads[iThread].iState = TS_RUNNING;
+	HW.threads[iThread].iState = TS_RUNNING;
 }
 
 // find a new thread to run
@@ -341,8 +382,8 @@ static void ps2_reschedule(void)
 	iNextThread = -1;
 
 	// see if any thread other than the current one is ready to run
-	i = iCurThread+1;
-	if (i >= iNumThreads)
+	i = HW.iCurThread+1;
+	if (i >= HW.iNumThreads)
 	{
 		i = 0;
 	}
@@ -351,11 +392,11 @@ static void ps2_reschedule(void)
 
 	// starting with the next thread after this one,
 	// see who wants to run
-	while (i < iNumThreads)
+	while (i < HW.iNumThreads)
 	{
-		if (i != iCurThread)
+		if (i != HW.iCurThread)
 		{
-			if (threads[i].iState == TS_READY)
+			if (HW.threads[i].iState == TS_READY)
 			{
 			  	iNextThread = i;
 				break;
@@ -369,11 +410,11 @@ static void ps2_reschedule(void)
 	// go around and try from zero
 	if ((starti > 0) && (iNextThread == -1))
 	{
-		for (i = 0; i < iNumThreads; i++)
+		for (i = 0; i < HW.iNumThreads; i++)
 		{
-			if (i != iCurThread)
+			if (i != HW.iCurThread)
 			{
-				if (threads[i].iState == TS_READY)
+				if (HW.threads[i].iState == TS_READY)
 				{
 				  	iNextThread = i;
 					break;
@@ -385,44 +426,44 @@ static void ps2_reschedule(void)
 	if (iNextThread != -1)
 	{
 		#if DEBUG_THREADING
-		for (i = 0; i < iNumThreads; i++)
+		for (i = 0; i < HW.iNumThreads; i++)
 		{
-			printf("Thread %02d: %s\n", i, _ThreadStateNames[threads[i].iState]);
+			printf("Thread %02d: %s\n", i, _ThreadStateNames[HW.threads[i].iState]);
 		}
 		#endif
 
-		if (iCurThread != -1)
+		if (HW.iCurThread != -1)
 		{
-			FreezeThread(iCurThread, 0);
+			FreezeThread(HW.iCurThread, 0);
 		}
 		ThawThread(iNextThread);
-		iCurThread = iNextThread;
-		threads[iCurThread].iState = TS_RUNNING;
+		HW.iCurThread = iNextThread;
+		HW.threads[HW.iCurThread].iState = TS_RUNNING;
 	}
 	else
 	{
 		// no thread to switch to, is the current one still running?
-		if (iCurThread != -1)
+		if (HW.iCurThread != -1)
 		{
-			if (threads[iCurThread].iState != TS_RUNNING)
+			if (HW.threads[HW.iCurThread].iState != TS_RUNNING)
 			{
 				#if DEBUG_THREADING
 				printf("IOP: no threads to run\n");
 
-				for (i = 0; i < iNumThreads; i++)
+				for (i = 0; i < HW.iNumThreads; i++)
 				{
-					printf("Thread %02d: %s\n", i, _ThreadStateNames[threads[i].iState]);
+					printf("Thread %02d: %s\n", i, _ThreadStateNames[HW.threads[i].iState]);
 				}
 				#endif
 
 				mips_shorten_frame();	// kill the CPU
-				iCurThread = -1;	// no threads are active
+				HW.iCurThread = -1;	// no threads are active
 			}
 		}
 		else
 		{
 			mips_shorten_frame();	// kill the CPU
-			iCurThread = -1;	// no threads are active
+			HW.iCurThread = -1;	// no threads are active
 		}
 	}
 }
@@ -431,9 +472,9 @@ static void psx_irq_update(void)
 {
 	union cpuinfo mipsinfo;
 
-	if ((irq_data & irq_mask) != 0)
+	if ((HW.irq_data & HW.irq_mask) != 0)
 	{	// assert the line
-		WAI = 0;
+		HW.WAI = 0;
 		mipsinfo.i = ASSERT_LINE;
 		mips_set_info( CPUINFO_INT_INPUT_STATE + MIPS_IRQ0, &mipsinfo );
 	}
@@ -447,25 +488,24 @@ static void psx_irq_update(void)
 
 static void psx_irq_set(uint32_t irq)
 {
-	irq_data |= irq;
+	HW.irq_data |= irq;
 
 	psx_irq_update();
 }
 
-static uint32_t gpu_stat = 0;
 
 static uint32_t psx_hw_read(offs_t offset, uint32_t mem_mask)
 {
 	if (offset <= 0x007fffff)
 	{
 		offset &= 0x1fffff;
-		return LE32(psx_ram[offset>>2]);
+		return LE32(PSXMEM.psx_ram[offset>>2]);
 	}
 
 	if (offset >= 0x80000000 && offset <= 0x807fffff)
 	{
 		offset &= 0x1fffff;
-		return LE32(psx_ram[offset>>2]);
+		return LE32(PSXMEM.psx_ram[offset>>2]);
 	}
 
 	if (offset == 0xbfc00180 || offset == 0xbfc00184)	// exception vector
@@ -475,18 +515,18 @@ static uint32_t psx_hw_read(offs_t offset, uint32_t mem_mask)
 
 	if (offset == 0x1f801014)
 	{
-		return spu_delay;
+		return HW.spu_delay;
 	}
 
 	if (offset == 0xbf801014)
 	{
-		return spu_delay;
+		return HW.spu_delay;
 	}
 
 	if (offset == 0x1f801814)
 	{
-		gpu_stat ^= 0xffffffff;
-		return gpu_stat;
+		HW.gpu_stat ^= 0xffffffff;
+		return HW.gpu_stat;
 	}
 
 	if (offset >= 0x1f801c00 && offset <= 0x1f801dff)
@@ -533,15 +573,15 @@ static uint32_t psx_hw_read(offs_t offset, uint32_t mem_mask)
 		{
 			case 0:
 //				printf("RC: read counter %d count = %x\n", cnt, root_cnts[cnt].count);
-				return root_cnts[cnt].count;
+				return HW.root_cnts[cnt].count;
 				break;
 			case 4:
 //				printf("RC: read counter %d mode\n", cnt);
-				return root_cnts[cnt].mode;
+				return HW.root_cnts[cnt].mode;
 				break;
 			case 8:
 //				printf("RC: read counter %d target\n", cnt);
-				return root_cnts[cnt].target;
+				return HW.root_cnts[cnt].target;
 				break;
 		}
 
@@ -550,16 +590,16 @@ static uint32_t psx_hw_read(offs_t offset, uint32_t mem_mask)
 
 	if (offset == 0x1f8010f4)
 	{
-		return dma_icr;
+		return HW.dma_icr;
 	}
 	else if (offset == 0x1f801070)
 	{
 //		printf("Read IRQ_data %x (mask %08x)\n", irq_data, mem_mask);
-		return irq_data;
+		return HW.irq_data;
 	}
 	else if (offset == 0x1f801074)
 	{
-		return irq_mask;
+		return HW.irq_mask;
 	}
 
 /*	if (offset == 0xbf801508)
@@ -622,7 +662,7 @@ static void ps2_dma4(uint32_t madr, uint32_t bcr, uint32_t chcr)
 		SPU2readDMA4Mem(madr&0x1fffff, bcr);
 	}
 
-	dma4_delay = 80;
+	HW.dma4_delay = 80;
 }
 
 static void ps2_dma7(uint32_t madr, uint32_t bcr, uint32_t chcr)
@@ -644,7 +684,7 @@ static void ps2_dma7(uint32_t madr, uint32_t bcr, uint32_t chcr)
 //		SPU2readDMA7Mem(madr&0x1fffff, bcr);
 	}
 
-	dma7_delay = 80;
+	HW.dma7_delay = 80;
 }
 
 static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
@@ -658,8 +698,8 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 
 		mips_get_info(CPUINFO_INT_PC, &mipsinfo);
 
-		psx_ram[offset>>2] &= LE32(mem_mask);
-		psx_ram[offset>>2] |= LE32(data);
+		PSXMEM.psx_ram[offset>>2] &= LE32(mem_mask);
+		PSXMEM.psx_ram[offset>>2] |= LE32(data);
 		return;
 	}
 
@@ -668,15 +708,15 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 		offset &= 0x1fffff;
 //		if (offset < 0x10000) printf("Write %x to kernel @ %x\n", data, offset);
 		mips_get_info(CPUINFO_INT_PC, &mipsinfo);
-		psx_ram[offset>>2] &= LE32(mem_mask);
-		psx_ram[offset>>2] |= LE32(data);
+		PSXMEM.psx_ram[offset>>2] &= LE32(mem_mask);
+		PSXMEM.psx_ram[offset>>2] |= LE32(data);
 		return;
 	}
 
 	if (offset == 0x1f801014 || offset == 0xbf801014)
 	{
-		spu_delay &= mem_mask;
-		spu_delay |= data;
+		HW.spu_delay &= mem_mask;
+		HW.spu_delay |= data;
 		return;
 	}
 
@@ -723,15 +763,15 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 		switch (offset & 0xf)
 		{
 			case 0:
-				root_cnts[cnt].count = data;
+				HW.root_cnts[cnt].count = data;
 //				printf("RC: counter %d count = %x\n", cnt, data);
 				break;
 			case 4:
-				root_cnts[cnt].mode = data;
+				HW.root_cnts[cnt].mode = data;
 //				printf("RC: counter %d mode = %x\n", cnt, data);
 				break;
 			case 8:
-				root_cnts[cnt].target = data;
+				HW.root_cnts[cnt].target = data;
 //				printf("RC: counter %d target = %x\n", cnt, data);
 				break;
 		}
@@ -742,49 +782,49 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 	// DMA4
 	if (offset == 0x1f8010c0)
 	{
-		dma4_madr = data;
+		HW.dma4_madr = data;
 		return;
 	}
 	else if (offset == 0x1f8010c4)
 	{
-		dma4_bcr = data;
+		HW.dma4_bcr = data;
 		return;
 	}
 	else if (offset == 0x1f8010c8)
 	{
-		dma4_chcr = data;
-		psx_dma4(dma4_madr, dma4_bcr, dma4_chcr);
+		HW.dma4_chcr = data;
+		psx_dma4(HW.dma4_madr, HW.dma4_bcr, HW.dma4_chcr);
 
-		if (dma_icr & (1 << (16+4)))
+		if (HW.dma_icr & (1 << (16+4)))
 		{
-			dma_timer = 3;
+			HW.dma_timer = 3;
 		}
 		return;
 	}
 	else if (offset == 0x1f8010f4)
 	{
-		dma_icr = ( dma_icr & mem_mask ) |
-			  ( ~mem_mask & 0x80000000 & dma_icr) |
-			  ( ~data & ~mem_mask & 0x7f000000 & dma_icr) |
+		HW.dma_icr = ( HW.dma_icr & mem_mask ) |
+			  ( ~mem_mask & 0x80000000 & HW.dma_icr) |
+			  ( ~data & ~mem_mask & 0x7f000000 & HW.dma_icr) |
 			  ( data & ~mem_mask & 0x00ffffff);
 
-		if ((dma_icr & 0x7f000000) != 0)
+		if ((HW.dma_icr & 0x7f000000) != 0)
 		{
-			dma_icr &= ~0x80000000;
+			HW.dma_icr &= ~0x80000000;
 		}
 
 		return;
 	}
 	else if (offset == 0x1f801070)
 	{
-		irq_data = (irq_data & mem_mask) | (irq_data & irq_mask & data);
+		HW.irq_data = (HW.irq_data & mem_mask) | (HW.irq_data & HW.irq_mask & data);
 		psx_irq_update();
 		return;
 	}
 	else if (offset == 0x1f801074)
 	{
-		irq_mask &= mem_mask;
-		irq_mask |= data;
+		HW.irq_mask &= mem_mask;
+		HW.irq_mask |= data;
 		psx_irq_update();
 		return;
 	}
@@ -792,45 +832,45 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 	// PS2 DMA4
 	if (offset == 0xbf8010c0)
 	{
-		dma4_madr = data;
+		HW.dma4_madr = data;
 		return;
 	}
 	else if (offset == 0xbf8010c8)
 	{
-		dma4_chcr = data;
-		ps2_dma4(dma4_madr, dma4_bcr, dma4_chcr);
+		HW.dma4_chcr = data;
+		ps2_dma4(HW.dma4_madr, HW.dma4_bcr, HW.dma4_chcr);
 
-		if (dma_icr & (1 << (16+4)))
+		if (HW.dma_icr & (1 << (16+4)))
 		{
-			dma_timer = 3;
+			HW.dma_timer = 3;
 		}
 		return;
 	}
 
 	if (offset == 0xbf8010c4 || offset == 0xbf8010c6)
 	{
-		dma4_bcr &= mem_mask;
-		dma4_bcr |= data;
+		HW.dma4_bcr &= mem_mask;
+		HW.dma4_bcr |= data;
 		return;
 	}
 
 	// PS2 DMA7
 	if (offset == 0xbf801500)
 	{
-		dma7_madr = data;
+		HW.dma7_madr = data;
 		return;
 	}
 	else if (offset == 0xbf801504)
 	{
-		dma7_chcr = data;
-		ps2_dma7(dma7_madr, dma7_bcr, dma7_chcr);
+		HW.dma7_chcr = data;
+		ps2_dma7(HW.dma7_madr, HW.dma7_bcr, HW.dma7_chcr);
 		return;
 	}
 
 	if (offset == 0xbf801508 || offset == 0xbf80150a)
 	{
-		dma7_bcr &= mem_mask;
-		dma7_bcr |= data;
+		HW.dma7_bcr &= mem_mask;
+		HW.dma7_bcr |= data;
 		return;
 	}
 
@@ -847,17 +887,19 @@ static void psx_hw_write(offs_t offset, uint32_t data, uint32_t mem_mask)
 // called per sample, 1/44100th of a second (768 clock cycles)
 void psx_hw_slice(void)
 {
+	PSXHWState &hw = HW;
+
 	psx_hw_runcounters();
 
-	if (!WAI)
+	if (!hw.WAI)
 		mips_execute(768/CLOCK_DIV);
 
-	if (dma_timer)
+	if (hw.dma_timer)
 	{
-		dma_timer--;
-		if (dma_timer == 0)
+		hw.dma_timer--;
+		if (hw.dma_timer == 0)
 		{
-			dma_icr |= (1 << (24+4));
+			hw.dma_icr |= (1 << (24+4));
 			psx_irq_set(0x0008);
 		}
 	}
@@ -867,20 +909,20 @@ void ps2_hw_slice(void)
 {
 	int i = 0;
 
-	timerexp = 0;
+	HW.timerexp = 0;
 	psx_hw_runcounters();
 
-	if (iCurThread != -1)
+	if (HW.iCurThread != -1)
 	{
 		mips_execute(836/CLOCK_DIV);
 	}
 	else	// no thread, don't run CPU, just update counters
 	{
-		if (timerexp)
+		if (HW.timerexp)
 		{
 			ps2_reschedule();
 
-			if (iCurThread != -1)
+			if (HW.iCurThread != -1)
 			{
 				mips_execute((836/CLOCK_DIV)-i);
 				i = (836/CLOCK_DIV);
@@ -889,21 +931,20 @@ void ps2_hw_slice(void)
 	}
 }
 
-static int fcnt = 0;
 
-void psx_hw_frame(void)
+void psx_hw_frame(int refresh)
 {
-	if (psf_refresh == 50)
+	if (refresh == 50)
 	{
-		fcnt++;;
+		HW.fcnt++;;
 
-		if (fcnt < 6)
+		if (HW.fcnt < 6)
 		{
 			psx_irq_set(1);
 		}
 		else
 		{
-			fcnt = 0;
+			HW.fcnt = 0;
 		}
 	}
 	else	// NTSC
@@ -928,20 +969,17 @@ enum
 	BLK_BK = 12
 };
 
-static uint32_t heap_addr, entry_int = 0;
 
-static uint32_t irq_regs[37];
 
-static int irq_mutex = 0;
 
 static void call_irq_routine(uint32_t routine, uint32_t parameter)
 {
 	int j, oldICount;
 	union cpuinfo mipsinfo;
 
-	if (!irq_mutex)
+	if (!HW.irq_mutex)
 	{
-		irq_mutex = 1;
+		HW.irq_mutex = 1;
 	}
 	else
 	{
@@ -953,18 +991,18 @@ static void call_irq_routine(uint32_t routine, uint32_t parameter)
 	for (j = 0; j < 32; j++)
 	{
 		mips_get_info(CPUINFO_INT_REGISTER + MIPS_R0 + j, &mipsinfo);
-		irq_regs[j] = mipsinfo.i;
+		HW.irq_regs[j] = mipsinfo.i;
 	}
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-	irq_regs[32] = mipsinfo.i;
+	HW.irq_regs[32] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
-	irq_regs[33] = mipsinfo.i;
+	HW.irq_regs[33] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_PC, &mipsinfo);
-	irq_regs[34] = mipsinfo.i;
+	HW.irq_regs[34] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_DELAYV, &mipsinfo);
-	irq_regs[35] = mipsinfo.i;
+	HW.irq_regs[35] = mipsinfo.i;
 	mips_get_info(CPUINFO_INT_REGISTER + MIPS_DELAYR, &mipsinfo);
-	irq_regs[36] = mipsinfo.i;
+	HW.irq_regs[36] = mipsinfo.i;
 
 	// PC = timer handler routine
 	mipsinfo.i = routine;
@@ -979,11 +1017,11 @@ static void call_irq_routine(uint32_t routine, uint32_t parameter)
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
 
 	// make sure we're set
-	psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
+	PSXMEM.psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
 
-	softcall_target = 0;
+	HW.softcall_target = 0;
 	oldICount = mips_get_icount();
-	while (!softcall_target)
+	while (!HW.softcall_target)
 	{
 		mips_execute(10);
 	}
@@ -992,22 +1030,22 @@ static void call_irq_routine(uint32_t routine, uint32_t parameter)
 	// restore IRQ regs
 	for (j = 0; j < 32; j++)
 	{
-		mipsinfo.i = irq_regs[j];
+		mipsinfo.i = HW.irq_regs[j];
 		mips_set_info(CPUINFO_INT_REGISTER + MIPS_R0 + j, &mipsinfo);
 	}
 
-	mipsinfo.i = irq_regs[32];
+	mipsinfo.i = HW.irq_regs[32];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-	mipsinfo.i = irq_regs[33];
+	mipsinfo.i = HW.irq_regs[33];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
-	mipsinfo.i = irq_regs[34];
+	mipsinfo.i = HW.irq_regs[34];
 	mips_set_info(CPUINFO_INT_PC, &mipsinfo);
-	mipsinfo.i = irq_regs[35];
+	mipsinfo.i = HW.irq_regs[35];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_DELAYV, &mipsinfo);
-	mipsinfo.i = irq_regs[36];
+	mipsinfo.i = HW.irq_regs[36];
 	mips_set_info(CPUINFO_INT_REGISTER + MIPS_DELAYR, &mipsinfo);
 
-	irq_mutex = 0;
+	HW.irq_mutex = 0;
 }
 
 static void psx_bios_exception(uint32_t pc)
@@ -1030,20 +1068,20 @@ static void psx_bios_exception(uint32_t pc)
 			for (i = 0; i < 32; i++)
 			{
 				mips_get_info(CPUINFO_INT_REGISTER + MIPS_R0 + i, &mipsinfo);
-				irq_regs[i] = mipsinfo.i;
+				HW.irq_regs[i] = mipsinfo.i;
 			}
 			mips_get_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-			irq_regs[32] = mipsinfo.i;
+			HW.irq_regs[32] = mipsinfo.i;
 			mips_get_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
-			irq_regs[33] = mipsinfo.i;
+			HW.irq_regs[33] = mipsinfo.i;
 
 			// check BIOS-driven interrupts
-			if (irq_data & 1)	// VSync
+			if (HW.irq_data & 1)	// VSync
 			{
-				if (CounterEvent[3][1].status == LE32(EvStACTIVE))
+				if (HW.CounterEvent[3][1].status == LE32(EvStACTIVE))
 				{
 					// run the handler
-					mipsinfo.i = LE32(CounterEvent[3][1].fhandler);
+					mipsinfo.i = LE32(HW.CounterEvent[3][1].fhandler);
 //	       				printf("Cause = %x, ePC = %x\n", mips_get_cause(), mips_get_ePC());
 //	       				printf("VBL running handler @ %x\n", mipsinfo.i);
 					mips_set_info(CPUINFO_INT_PC, &mipsinfo);
@@ -1051,11 +1089,11 @@ static void psx_bios_exception(uint32_t pc)
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
 
 					// make sure we're set
-					psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
+					PSXMEM.psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
 
-					softcall_target = 0;
+					HW.softcall_target = 0;
 					oldICount = mips_get_icount();
-					while (!softcall_target)
+					while (!HW.softcall_target)
 					{
 						mips_execute(10);
 					}
@@ -1063,19 +1101,19 @@ static void psx_bios_exception(uint32_t pc)
 
 //	       				printf("Exiting softcall handler\n");
 
-					irq_data &= ~1;		// clear the VBL IRQ if we handled it
+					HW.irq_data &= ~1;		// clear the VBL IRQ if we handled it
 				}
 			}
-			else if (irq_data & 0x70)	// root counters
+			else if (HW.irq_data & 0x70)	// root counters
 			{
 				for (i = 0; i < 4; i++)
 				{
-					if (irq_data & (1 << (i+4)))
+					if (HW.irq_data & (1 << (i+4)))
 					{
-						if (CounterEvent[i][1].status == LE32(EvStACTIVE))
+						if (HW.CounterEvent[i][1].status == LE32(EvStACTIVE))
 						{
 							// run the handler
-							mipsinfo.i = LE32(CounterEvent[i][1].fhandler);
+							mipsinfo.i = LE32(HW.CounterEvent[i][1].fhandler);
 //							printf("Cause = %x, ePC = %x\n", mips_get_cause(), mips_get_ePC());
 //							printf("Counter %d running handler @ %x\n", i, mipsinfo.i);
 							mips_set_info(CPUINFO_INT_PC, &mipsinfo);
@@ -1083,18 +1121,18 @@ static void psx_bios_exception(uint32_t pc)
 							mips_set_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
 
 							// make sure we're set
-							psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
+							PSXMEM.psx_ram[0x1000/4] = LE32(FUNCT_HLECALL);
 
-							softcall_target = 0;
+							HW.softcall_target = 0;
 							oldICount = mips_get_icount();
-							while (!softcall_target)
+							while (!HW.softcall_target)
 							{
 								mips_execute(10);
 							}
 							mips_set_icount(oldICount);
 
 //							printf("Exiting softcall handler\n");
-							irq_data &= ~(1 << (i+4));
+							HW.irq_data &= ~(1 << (i+4));
 						}
 						else
 						{
@@ -1104,34 +1142,34 @@ static void psx_bios_exception(uint32_t pc)
 				}
 			}
 
-			if (entry_int)
+			if (HW.entry_int)
 			{
 				psx_hw_write(0x1f801070, 0xffffffff, 0);
 
-				a0 = entry_int;
+				a0 = HW.entry_int;
 
 //				printf("taking entry_int\n");
 
 				// RA (and PC)
-				mipsinfo.i = LE32(psx_ram[((a0&0x1fffff)+0)/4]);
+				mipsinfo.i = LE32(PSXMEM.psx_ram[((a0&0x1fffff)+0)/4]);
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
 				mips_set_info(CPUINFO_INT_PC, &mipsinfo);
 				// SP
-				mipsinfo.i = LE32(psx_ram[((a0&0x1fffff)+4)/4]);
+				mipsinfo.i = LE32(PSXMEM.psx_ram[((a0&0x1fffff)+4)/4]);
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R29, &mipsinfo);
 				// FP
-				mipsinfo.i = LE32(psx_ram[((a0&0x1fffff)+8)/4]);
+				mipsinfo.i = LE32(PSXMEM.psx_ram[((a0&0x1fffff)+8)/4]);
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R30, &mipsinfo);
 
 				// S0-S7 are next
 				for (i = 0; i < 8; i++)
 				{
-					mipsinfo.i = LE32(psx_ram[((a0&0x1fffff)+12+(i*4))/4]);
+					mipsinfo.i = LE32(PSXMEM.psx_ram[((a0&0x1fffff)+12+(i*4))/4]);
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R16 + i, &mipsinfo);
 				}
 
 				// GP
-				mipsinfo.i = LE32(psx_ram[((a0&0x1fffff)+44)/4]);
+				mipsinfo.i = LE32(PSXMEM.psx_ram[((a0&0x1fffff)+44)/4]);
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R28, &mipsinfo);
 
 				// v0 = 1
@@ -1145,13 +1183,13 @@ static void psx_bios_exception(uint32_t pc)
 				// note: the entry_int won't be bailing us out here, so do it ourselves
 				for (i = 0; i < 32; i++)
 				{
-					mipsinfo.i = irq_regs[i];
+					mipsinfo.i = HW.irq_regs[i];
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R0 + i, &mipsinfo);
 				}
 
-				mipsinfo.i = irq_regs[32];
+				mipsinfo.i = HW.irq_regs[32];
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-				mipsinfo.i = irq_regs[33];
+				mipsinfo.i = HW.irq_regs[33];
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
 				mipsinfo.i = mips_get_ePC();
 				mips_set_info(CPUINFO_INT_PC, &mipsinfo);
@@ -1251,66 +1289,129 @@ static uint32_t calc_spec(uint32_t a1)
 
 void psx_hw_init(void)
 {
-	timerexp = 0;
+	HW.timerexp = 0;
 
-	memset(filestat, 0, sizeof(filestat));
-	memset(filedata, 0, sizeof(filedata));
+	memset(HW.filestat, 0, sizeof(HW.filestat));
+	memset(HW.filedata, 0, sizeof(HW.filedata));
 
-	dma4_cb = dma7_cb = 0;
+	HW.dma4_cb = HW.dma7_cb = 0;
 
-	sys_time = 0;
+	HW.sys_time = 0;
 
 	// clear registered libraries table
-	memset(reglibs, 0, sizeof(reglibs));
-	iNumLibs = 0;
+	memset(HW.reglibs, 0, sizeof(HW.reglibs));
+	HW.iNumLibs = 0;
 
-	memset(evflags, 0, sizeof(evflags));
-	iNumFlags = 0;
+	memset(HW.evflags, 0, sizeof(HW.evflags));
+	HW.iNumFlags = 0;
 
-	memset(threads, 0, sizeof(threads));
-	iNumThreads = 1;	// we always have at least one thread
+	memset(HW.threads, 0, sizeof(HW.threads));
+	HW.iNumThreads = 1;	// we always have at least one thread
 
-	memset(semaphores, 0, sizeof(semaphores));
-	iNumSema = 0;
+	memset(HW.semaphores, 0, sizeof(HW.semaphores));
+	HW.iNumSema = 0;
 
 	// set the initial thread to "RUNNING"
-	threads[0].iState = TS_RUNNING;
-	iCurThread = 0;
+	HW.threads[0].iState = TS_RUNNING;
+	HW.iCurThread = 0;
 
-	memset(iop_timers, 0, sizeof(iop_timers));
-	iNumTimers = 0;
+	memset(HW.iop_timers, 0, sizeof(HW.iop_timers));
+	HW.iNumTimers = 0;
 
 	// set PS1 BIOS HLE breakpoints
-	psx_ram[0xa0/4] = LE32(FUNCT_HLECALL);
-	psx_ram[0xb0/4] = LE32(FUNCT_HLECALL);
-	psx_ram[0xc0/4] = LE32(FUNCT_HLECALL);
-
-	Event = (EvtCtrlBlk *)&psx_ram[0x1000/4];
-	CounterEvent = (Event + (32*2));
-
-	dma_icr = 0;
-	spu_delay = 0;
-	irq_data = 0;
-	irq_mask = 0;
-	softcall_target = 0;
-	gpu_stat = 0;
-	dma4_madr = dma4_bcr = dma4_chcr = 0;
-	heap_addr = 0;
-	entry_int = 0;
-
-	WAI = 0;
-
-	root_cnts[0].mode = RC_EN;
-	root_cnts[1].mode = RC_EN;
-	root_cnts[2].mode = RC_EN;
-	root_cnts[0].sysclock = 0;
-	root_cnts[1].sysclock = 0;
-	root_cnts[2].sysclock = 0;
-
-	root_cnts[3].mode = (RC_RESET | RC_IQ1 | RC_IQ2);
-	root_cnts[3].sysclock = 0;
-	root_cnts[3].target = 1;
-	root_cnts[3].interrupt = 1;
+	PSXMEM.psx_ram[0xa0/4] = LE32(FUNCT_HLECALL);
+	PSXMEM.psx_ram[0xb0/4] = LE32(FUNCT_HLECALL);
+	PSXMEM.psx_ram[0xc0/4] = LE32(FUNCT_HLECALL);
+
+	HW.Event = (EvtCtrlBlk *)&PSXMEM.psx_ram[0x1000/4];
+	HW.CounterEvent = (HW.Event + (32*2));
+
+	HW.dma_icr = 0;
+	HW.spu_delay = 0;
+	HW.irq_data = 0;
+	HW.irq_mask = 0;
+	HW.softcall_target = 0;
+	HW.gpu_stat = 0;
+	HW.dma4_madr = HW.dma4_bcr = HW.dma4_chcr = 0;
+	HW.heap_addr = 0;
+	HW.entry_int = 0;
+
+	HW.WAI = 0;
+
+	HW.root_cnts[0].mode = RC_EN;
+	HW.root_cnts[1].mode = RC_EN;
+	HW.root_cnts[2].mode = RC_EN;
+	HW.root_cnts[0].sysclock = 0;
+	HW.root_cnts[1].sysclock = 0;
+	HW.root_cnts[2].sysclock = 0;
+
+	HW.root_cnts[3].mode = (RC_RESET | RC_IQ1 | RC_IQ2);
+	HW.root_cnts[3].sysclock = 0;
+	HW.root_cnts[3].target = 1;
+	HW.root_cnts[3].interrupt = 1;
+}
+
+// everything that changes while a song plays (initial_ram and
+// initial_scratch are only written at startup)
+void psx_hw_state(PSFState &state)
+{
+	state.io((void *)&HW.softcall_target, sizeof(HW.softcall_target));
+	state.io(HW.filestat);
+	state.io(HW.filedata);
+	state.io(HW.filesize);
+	state.io(HW.filepos);
+	state.io(HW.intr_susp);
+	state.io(HW.sys_time);
+	state.io(HW.timerexp);
+
+	state.io(HW.iNumLibs);
+	state.io(HW.reglibs);
+	state.io(HW.iNumFlags);
+	state.io(HW.evflags);
+	state.io(HW.iNumSema);
+	state.io(HW.semaphores);
+	state.io(HW.iNumThreads);
+	state.io(HW.iCurThread);
+	state.io(HW.threads);
+	state.io(HW.iop_timers);
+	state.io(HW.iNumTimers);
+	state.io(HW.root_cnts);
+	state.io(HW.Event);
+	state.io(HW.CounterEvent);
+
+	state.io(PSXMEM.psx_ram);
+	state.io(PSXMEM.psx_scratch);
+
+	state.io(HW.spu_delay);
+	state.io(HW.dma_icr);
+	state.io(HW.irq_data);
+	state.io(HW.irq_mask);
+	state.io(HW.dma_timer);
+	state.io(HW.WAI);
+	state.io(HW.dma4_madr);
+	state.io(HW.dma4_bcr);
+	state.io(HW.dma4_chcr);
+	state.io(HW.dma4_delay);
+	state.io(HW.dma7_madr);
+	state.io(HW.dma7_bcr);
+	state.io(HW.dma7_chcr);
+	state.io(HW.dma7_delay);
+	state.io(HW.dma4_cb);
+	state.io(HW.dma7_cb);
+	state.io(HW.dma4_fval);
+	state.io(HW.dma4_flag);
+	state.io(HW.dma7_fval);
+	state.io(HW.dma7_flag);
+	state.io(HW.irq9_cb);
+	state.io(HW.irq9_fval);
+	state.io(HW.irq9_flag);
+
+	state.io(HW.gpu_stat);
+	state.io(HW.fcnt);
+	state.io(HW.heap_addr);
+	state.io(HW.entry_int);
+	state.io(HW.irq_regs);
+	state.io(HW.irq_mutex);
 }
 
 void psx_bios_hle(uint32_t pc)
@@ -1338,7 +1439,7 @@ void psx_bios_hle(uint32_t pc)
 	if (pc == 0x80001000)
 	{
 //		printf("hit softcall target\n");
-		softcall_target = 1;
+		HW.softcall_target = 1;
 		return;
 	}
 
@@ -1367,27 +1468,27 @@ void psx_bios_hle(uint32_t pc)
 				case 0x13:	// setjmp
 					// RA
 					mips_get_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
-					psx_ram[((a0&0x1fffff)+0)/4] = LE32(mipsinfo.i);
+					PSXMEM.psx_ram[((a0&0x1fffff)+0)/4] = LE32(mipsinfo.i);
 					#if DEBUG_HLE_BIOS
 					printf("HLEBIOS: setjmp(%08x) => PC %08x\n", a0, mipsinfo.i);
 					#endif
 					// SP
 					mips_get_info(CPUINFO_INT_REGISTER + MIPS_R29, &mipsinfo);
-					psx_ram[((a0&0x1fffff)+4)/4] = LE32(mipsinfo.i);
+					PSXMEM.psx_ram[((a0&0x1fffff)+4)/4] = LE32(mipsinfo.i);
 					// FP
 					mips_get_info(CPUINFO_INT_REGISTER + MIPS_R30, &mipsinfo);
-					psx_ram[((a0&0x1fffff)+8)/4] = LE32(mipsinfo.i);
+					PSXMEM.psx_ram[((a0&0x1fffff)+8)/4] = LE32(mipsinfo.i);
 
 					// S0-S7 are next
 					for (i = 0; i < 8; i++)
 					{
 						mips_get_info(CPUINFO_INT_REGISTER + MIPS_R16 + i, &mipsinfo);
-						psx_ram[((a0&0x1fffff)+12+(i*4))/4] = LE32(mipsinfo.i);
+						PSXMEM.psx_ram[((a0&0x1fffff)+12+(i*4))/4] = LE32(mipsinfo.i);
 					}
 
 					// GP
 					mips_get_info(CPUINFO_INT_REGISTER + MIPS_R28, &mipsinfo);
-					psx_ram[((a0&0x1fffff)+44)/4] = LE32(mipsinfo.i);
+					PSXMEM.psx_ram[((a0&0x1fffff)+44)/4] = LE32(mipsinfo.i);
 
 					// v0 = 0
 					mipsinfo.i = 0;
@@ -1402,8 +1503,8 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: strncmp(%08x, %08x, %d)\n", a0, a1, a2);
 						#endif
 
-						dst = (uint8_t *)psx_ram;
-						src = (uint8_t *)psx_ram;
+						dst = (uint8_t *)PSXMEM.psx_ram;
+						src = (uint8_t *)PSXMEM.psx_ram;
 						dst += (a0 & 0x1fffff);
 						src += (a1 & 0x1fffff);
 
@@ -1421,8 +1522,8 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: strcpy(%08x, %08x)\n", a0, a1);
 						#endif
 
-						dst = (uint8_t *)psx_ram;
-						src = (uint8_t *)psx_ram;
+						dst = (uint8_t *)PSXMEM.psx_ram;
+						src = (uint8_t *)PSXMEM.psx_ram;
 						dst += (a0 & 0x1fffff);
 						src += (a1 & 0x1fffff);
 
@@ -1447,7 +1548,7 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: bzero(%08x, %08x)\n", a0, a1);
 						#endif
 
-						dst = (uint8_t *)psx_ram;
+						dst = (uint8_t *)PSXMEM.psx_ram;
 						dst += (a0 & 0x1fffff);
 						memset(dst, 0, a1);
 					}
@@ -1461,8 +1562,8 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: memcpy(%08x, %08x, %08x)\n", a0, a1, a2);
 						#endif
 
-						dst = (uint8_t *)psx_ram;
-						src = (uint8_t *)psx_ram;
+						dst = (uint8_t *)PSXMEM.psx_ram;
+						src = (uint8_t *)PSXMEM.psx_ram;
 						dst += (a0 & 0x1fffff);
 						src += (a1 & 0x1fffff);
 
@@ -1488,7 +1589,7 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: memset(%08x, %08x, %08x)\n", a0, a1, a2);
 						#endif
 
-						dst = (uint8_t *)psx_ram;
+						dst = (uint8_t *)PSXMEM.psx_ram;
 						dst += (a0 & 0x1fffff);
 
 						while (a2)
@@ -1529,25 +1630,25 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: malloc(%x)\n", a0);
 						#endif
 
-						chunk = heap_addr;
+						chunk = HW.heap_addr;
 
 						// find a free block that's big enough
-						while ((a0 > LE32(psx_ram[(chunk+BLK_SIZE)/4])) ||
-						       (LE32(psx_ram[(chunk+BLK_STAT)/4]) ==  1))
+						while ((a0 > LE32(PSXMEM.psx_ram[(chunk+BLK_SIZE)/4])) ||
+						       (LE32(PSXMEM.psx_ram[(chunk+BLK_STAT)/4]) ==  1))
 						{
-							chunk = LE32(psx_ram[(chunk+BLK_FD)]);
+							chunk = LE32(PSXMEM.psx_ram[(chunk+BLK_FD)]);
 						}
 
 						// split free block
 						fd = chunk + 16 + a0;	// free block starts after block record and allocation size
-						psx_ram[(fd+BLK_STAT)/4] = psx_ram[(chunk+BLK_STAT)/4];
-						psx_ram[(fd+BLK_SIZE)/4] = LE32(LE32(psx_ram[(chunk+BLK_SIZE)/4]) - a0);
-						psx_ram[(fd+BLK_FD)/4] = psx_ram[(chunk+BLK_FD)/4];
-						psx_ram[(fd+BLK_BK)/4] = chunk;
+						PSXMEM.psx_ram[(fd+BLK_STAT)/4] = PSXMEM.psx_ram[(chunk+BLK_STAT)/4];
+						PSXMEM.psx_ram[(fd+BLK_SIZE)/4] = LE32(LE32(PSXMEM.psx_ram[(chunk+BLK_SIZE)/4]) - a0);
+						PSXMEM.psx_ram[(fd+BLK_FD)/4] = PSXMEM.psx_ram[(chunk+BLK_FD)/4];
+						PSXMEM.psx_ram[(fd+BLK_BK)/4] = chunk;
 
-						psx_ram[(chunk+BLK_STAT)/4] = LE32(1);
-						psx_ram[(chunk+BLK_SIZE)/4] = LE32(a0);
-						psx_ram[(chunk+BLK_FD)/4] = LE32(fd);
+						PSXMEM.psx_ram[(chunk+BLK_STAT)/4] = LE32(1);
+						PSXMEM.psx_ram[(chunk+BLK_SIZE)/4] = LE32(a0);
+						PSXMEM.psx_ram[(chunk+BLK_FD)/4] = LE32(fd);
 
 						mipsinfo.i = chunk + 16;
 						mipsinfo.i |= 0x80000000;
@@ -1564,26 +1665,26 @@ void psx_bios_hle(uint32_t pc)
 					printf("HLEBIOS: InitHeap(%08x, %08x)\n", a0, a1);
 					#endif
 
-					heap_addr = a0 & 0x3fffffff;
+					HW.heap_addr = a0 & 0x3fffffff;
 
-					psx_ram[(heap_addr+BLK_STAT)/4] = LE32(0);
-					psx_ram[(heap_addr+BLK_FD)/4] = LE32(0);
-					psx_ram[(heap_addr+BLK_BK)/4] = LE32(0);
+					PSXMEM.psx_ram[(HW.heap_addr+BLK_STAT)/4] = LE32(0);
+					PSXMEM.psx_ram[(HW.heap_addr+BLK_FD)/4] = LE32(0);
+					PSXMEM.psx_ram[(HW.heap_addr+BLK_BK)/4] = LE32(0);
 
 					// if heap size out of range, clamp it
 					if (((a0 & 0x1fffff) + a1) >= 2*1024*1024)
 					{
-						psx_ram[(heap_addr+BLK_SIZE)/4] = LE32(0x1ffffc - (a0 & 0x1fffff));
+						PSXMEM.psx_ram[(HW.heap_addr+BLK_SIZE)/4] = LE32(0x1ffffc - (a0 & 0x1fffff));
 					}
 					else
 					{
-						psx_ram[(heap_addr+BLK_SIZE)/4] = LE32(a1);
+						PSXMEM.psx_ram[(HW.heap_addr+BLK_SIZE)/4] = LE32(a1);
 					}
 					break;
 
 				case 0x3f:	// printf
 					#if DEBUG_HLE_BIOS
-					printf("HLEBIOS: printf(%08x) = %s\n", a0, &psx_ram[(a0&0x1fffff)/4]);
+					printf("HLEBIOS: printf(%08x) = %s\n", a0, &PSXMEM.psx_ram[(a0&0x1fffff)/4]);
 					#endif
 					break;
 
@@ -1616,7 +1717,7 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: DeliverEvent(ev %d, spec %d)\n", ev, spec);
 						#endif
 
-						if (Event[ev][spec].status != LE32(EvStACTIVE))
+						if (HW.Event[ev][spec].status != LE32(EvStACTIVE))
 						{
 							#if DEBUG_HLE_BIOS
 							printf("event not active\n");
@@ -1625,15 +1726,15 @@ void psx_bios_hle(uint32_t pc)
 						}
 
 						// if interrupt mode, do the call
-						if (Event[ev][spec].mode == LE32(EvMdINTR))
+						if (HW.Event[ev][spec].mode == LE32(EvMdINTR))
 						{
 							#if DEBUG_HLE_BIOS
-							printf("INTR type, need to call handler %x\n", LE32(Event[ev][spec].fhandler));
+							printf("INTR type, need to call handler %x\n", LE32(HW.Event[ev][spec].fhandler));
 							#endif
 						}
 						else
 						{
-							Event[ev][spec].status = LE32(EvStALREADY);
+							HW.Event[ev][spec].status = LE32(EvStALREADY);
 						}
 					}
 					break;
@@ -1653,9 +1754,9 @@ void psx_bios_hle(uint32_t pc)
 						}
 						#endif
 
-						Event[ev][spec].status = LE32(EvStWAIT);
-						Event[ev][spec].mode = LE32(a2);
-						Event[ev][spec].fhandler = LE32(a3);
+						HW.Event[ev][spec].status = LE32(EvStWAIT);
+						HW.Event[ev][spec].mode = LE32(a2);
+						HW.Event[ev][spec].fhandler = LE32(a3);
 
 						// v0 = ev | spec<<8;
 						mipsinfo.i = ev | (spec<<8);
@@ -1675,13 +1776,13 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: WaitEvent(ev %d spec %d) PC=%x\n", ev, spec, mipsinfo.i);
 						#endif
 
-						Event[ev][spec].status = LE32(EvStACTIVE);
+						HW.Event[ev][spec].status = LE32(EvStACTIVE);
 
 						// v0 = 1
 						mipsinfo.i = 1;
 						mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 
-						WAI = 1;
+						HW.WAI = 1;
 						mips_shorten_frame();
 					}
 					break;
@@ -1698,9 +1799,9 @@ void psx_bios_hle(uint32_t pc)
 						#endif
 
 						// v0 = (is event ready?)
-						if (Event[ev][spec].status == LE32(EvStALREADY))
+						if (HW.Event[ev][spec].status == LE32(EvStALREADY))
 						{
-							Event[ev][spec].status = LE32(EvStACTIVE);
+							HW.Event[ev][spec].status = LE32(EvStACTIVE);
 							mipsinfo.i = 1;
 						}
 						else
@@ -1708,7 +1809,7 @@ void psx_bios_hle(uint32_t pc)
 							mipsinfo.i = 0;
 						}
 
-						WAI = 1;
+						HW.WAI = 1;
 
 						mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 
@@ -1729,7 +1830,7 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: EnableEvent(ev %d spec %d)\n", ev, spec);
 						#endif
 
-						Event[ev][spec].status = LE32(EvStACTIVE);
+						HW.Event[ev][spec].status = LE32(EvStACTIVE);
 
 						// v0 = 1
 						mipsinfo.i = 1;
@@ -1748,7 +1849,7 @@ void psx_bios_hle(uint32_t pc)
 						printf("HLEBIOS: DisableEvent(ev %d spec %d)\n", ev, spec);
 						#endif
 
-						Event[ev][spec].status = LE32(EvStWAIT);
+						HW.Event[ev][spec].status = LE32(EvStWAIT);
 
 						// v0 = 1
 						mipsinfo.i = 1;
@@ -1759,13 +1860,13 @@ void psx_bios_hle(uint32_t pc)
 				case 0x17:	// ReturnFromException
 					for (i = 0; i < 32; i++)
 					{
-						mipsinfo.i = irq_regs[i];
+						mipsinfo.i = HW.irq_regs[i];
 						mips_set_info(CPUINFO_INT_REGISTER + MIPS_R0 + i, &mipsinfo);
 					}
 
-					mipsinfo.i = irq_regs[32];
+					mipsinfo.i = HW.irq_regs[32];
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_HI, &mipsinfo);
-					mipsinfo.i = irq_regs[33];
+					mipsinfo.i = HW.irq_regs[33];
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_LO, &mipsinfo);
 					mipsinfo.i = mips_get_ePC();
 //					printf("ReturnFromException: IRQ state %x\n", irq_data & irq_mask);
@@ -1782,7 +1883,7 @@ void psx_bios_hle(uint32_t pc)
 					#if DEBUG_HLE_BIOS
 					printf("HLEBIOS: HookEntryInt(%08x)\n", a0);
 					#endif
-					entry_int = a0;
+					HW.entry_int = a0;
 					break;
 
 				case 0x3f:	// puts
@@ -1812,11 +1913,11 @@ void psx_bios_hle(uint32_t pc)
 					#endif
 
 					// v0 = (a0*4)+0x8600
-					mipsinfo.i = LE32(psx_ram[((a0<<2) + 0x8600)/4]);
+					mipsinfo.i = LE32(PSXMEM.psx_ram[((a0<<2) + 0x8600)/4]);
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 
 					// (a0*4)+0x8600 = a1;
-					psx_ram[((a0<<2) + 0x8600)/4] = LE32(a1);
+					PSXMEM.psx_ram[((a0<<2) + 0x8600)/4] = LE32(a1);
 					break;
 
 				default:
@@ -1837,78 +1938,79 @@ void psx_bios_hle(uint32_t pc)
 
 void psx_hw_runcounters(void)
 {
+	PSXHWState &hw = HW;
 	int i;
 
 	// don't process any IRQ sources when interrupts are suspended
-	if (!intr_susp)
+	if (!hw.intr_susp)
 	{
-		if (dma4_delay)
+		if (hw.dma4_delay)
 		{
-			dma4_delay--;
+			hw.dma4_delay--;
 
-			if (dma4_delay == 0)
+			if (hw.dma4_delay == 0)
 			{
 				SPU2interruptDMA4();
 
-				if (dma4_cb)
+				if (hw.dma4_cb)
 				{
-					call_irq_routine(dma4_cb, dma4_flag);
+					call_irq_routine(hw.dma4_cb, hw.dma4_flag);
 				}
 			}
 		}
 
-		if (dma7_delay)
+		if (hw.dma7_delay)
 		{
-			dma7_delay--;
+			hw.dma7_delay--;
 
-			if (dma7_delay == 0)
+			if (hw.dma7_delay == 0)
 			{
 				SPU2interruptDMA7();
 
-				if (dma7_cb)
+				if (hw.dma7_cb)
 				{
-					call_irq_routine(dma7_cb, dma7_flag);
+					call_irq_routine(hw.dma7_cb, hw.dma7_flag);
 				}
 			}
 		}
 
-		for (i = 0; i < iNumThreads; i++)
+		for (i = 0; i < hw.iNumThreads; i++)
 		{
-			if (threads[i].iState == TS_WAITDELAY)
+			if (hw.threads[i].iState == TS_WAITDELAY)
 			{
-				if (threads[i].waitparm > CLOCK_DIV)
+				if (hw.threads[i].waitparm > CLOCK_DIV)
 				{
-					threads[i].waitparm -= CLOCK_DIV;
+					hw.threads[i].waitparm -= CLOCK_DIV;
 				}
 				else	// time's up
 				{
-					threads[i].waitparm = 0;
-					threads[i].iState = TS_READY;
+					hw.threads[i].waitparm = 0;
+					hw.threads[i].iState = TS_READY;
 
-					timerexp = 1;
+					hw.timerexp = 1;
 
 					ps2_reschedule();
 				}
 			}
 		}
 
-		sys_time += 836;
+		hw.sys_time += 836;
 
-		if (iNumTimers > 0)
+		if (hw.iNumTimers > 0)
 		{
-			for (i = 0; i < iNumTimers; i++)
+			for (i = 0; i < hw.iNumTimers; i++)
 			{
-				if (iop_timers[i].iActive > 0)
+				if (hw.iop_timers[i].iActive > 0)
 				{
-					iop_timers[i].count += 836;
-					if (iop_timers[i].count >= iop_timers[i].target)
+					hw.iop_timers[i].count += 836;
+					if (hw.iop_timers[i].count >= hw.iop_timers[i].target)
 					{
-						iop_timers[i].count -= iop_timers[i].target;
+						hw.iop_timers[i].count -= hw.iop_timers[i].target;
 
 	//					printf("Timer %d: handler = %08x, param = %08x\n", i, iop_timers[i].handler, iop_timers[i].hparam);
-						call_irq_routine(iop_timers[i].handler, iop_timers[i].hparam);
+						call_irq_routine(hw.iop_timers[i].handler, hw.iop_timers[i].hparam);
 
-						timerexp = 1;
+						hw.timerexp = 1;
 					}
 				}
 			}
@@ -1918,26 +2020,26 @@ void psx_hw_runcounters(void)
 // PS1 root counters
 	for (i = 0; i < 4; i++)
 	{
-		if ((!(root_cnts[i].mode & RC_EN)) && (root_cnts[i].mode != 0))
+		if ((!(hw.root_cnts[i].mode & RC_EN)) && (hw.root_cnts[i].mode != 0))
 		{
-			if (root_cnts[i].mode & RC_DIV8)
+			if (hw.root_cnts[i].mode & RC_DIV8)
 			{
-				root_cnts[i].count += 768/8;
+				hw.root_cnts[i].count += 768/8;
 			}
 			else
 			{
-				root_cnts[i].count += 768;
+				hw.root_cnts[i].count += 768;
 			}
 
-			if (root_cnts[i].count >= root_cnts[i].target)
+			if (hw.root_cnts[i].count >= hw.root_cnts[i].target)
 			{
-				if (!(root_cnts[i].mode & RC_RESET))
+				if (!(hw.root_cnts[i].mode & RC_RESET))
 				{
-					root_cnts[i].mode |= RC_EN;
+					hw.root_cnts[i].mode |= RC_EN;
 				}
 				else
 				{
-					root_cnts[i].count %= root_cnts[i].target;
+					hw.root_cnts[i].count %= hw.root_cnts[i].target;
 				}
 
 				psx_irq_set(1<<(4+i));
@@ -2099,7 +2201,7 @@ static void iop_sprintf(char *out, char *fmt, uint32_t pstart)
 				mips_get_info(curparm, &mipsinfo);
 				curparm++;
 
-				pstr = (char *)psx_ram;
+				pstr = (char *)PSXMEM.psx_ram;
 				pstr += (mipsinfo.i & 0x1fffff);
 
 				snprintf(temp, sizeof temp, tfmt, pstr);
@@ -2142,19 +2244,19 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 	a3 = mipsinfo.i;
 
 	scan = (pc&0x0fffffff)/4;
-	while ((psx_ram[scan] != LE32(0x41e00000)) && (scan >= (0x10000/4)))
+	while ((PSXMEM.psx_ram[scan] != LE32(0x41e00000)) && (scan >= (0x10000/4)))
 	{
 		scan--;
 	}
 
-	if (psx_ram[scan] != LE32(0x41e00000))
+	if (PSXMEM.psx_ram[scan] != LE32(0x41e00000))
 	{
 		printf("FATAL ERROR: couldn't find IOP link signature\n");
 		return;
 	}
 
 	scan += 3;	// skip zero and version
-	memcpy(name, &psx_ram[scan], 8);
+	memcpy(name, &PSXMEM.psx_ram[scan], 8);
 	name[8] = '\0';
 
 //	printf("IOP: call module [%s] service %d (PC=%08x)\n", name, callnum, pc);
@@ -2164,7 +2266,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 		switch (callnum)
 		{
 			case 4:	// printf
-				mname = (char *)psx_ram;
+				mname = (char *)PSXMEM.psx_ram;
 				mname += a0 & 0x1fffff;
 				mname += (a0 & 3);
 
@@ -2244,7 +2346,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				a0 /= 4;
 				#if DEBUG_THREADING
 				printf("   : flags %x routine %08x pri %x stacksize %d refCon %08x\n",
-					psx_ram[a0], psx_ram[a0+1], psx_ram[a0+2], psx_ram[a0+3], psx_ram[a0+4]);
+					PSXMEM.psx_ram[a0], PSXMEM.psx_ram[a0+1], PSXMEM.psx_ram[a0+2], PSXMEM.psx_ram[a0+3], PSXMEM.psx_ram[a0+4]);
 				#endif
 
 				newAlloc = psf2_get_loadaddr();
@@ -2254,17 +2356,17 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					newAlloc &= ~0xf;
 					newAlloc += 16;
 				}
-				psf2_set_loadaddr(newAlloc + LE32(psx_ram[a0+3]));
+				psf2_set_loadaddr(newAlloc + LE32(PSXMEM.psx_ram[a0+3]));
 
-				threads[iNumThreads].iState = TS_CREATED;
-				threads[iNumThreads].stackloc = newAlloc;
-				threads[iNumThreads].flags = LE32(psx_ram[a0]);
-				threads[iNumThreads].routine = LE32(psx_ram[a0+2]);
-				threads[iNumThreads].stacksize = LE32(psx_ram[a0+3]);
-				threads[iNumThreads].refCon = LE32(psx_ram[a0+4]);
+				HW.threads[HW.iNumThreads].iState = TS_CREATED;
+				HW.threads[HW.iNumThreads].stackloc = newAlloc;
+				HW.threads[HW.iNumThreads].flags = LE32(PSXMEM.psx_ram[a0]);
+				HW.threads[HW.iNumThreads].routine = LE32(PSXMEM.psx_ram[a0+2]);
+				HW.threads[HW.iNumThreads].stacksize = LE32(PSXMEM.psx_ram[a0+3]);
+				HW.threads[HW.iNumThreads].refCon = LE32(PSXMEM.psx_ram[a0+4]);
 
-				mipsinfo.i = iNumThreads;
-				iNumThreads++;
+				mipsinfo.i = HW.iNumThreads;
+				HW.iNumThreads++;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
@@ -2273,9 +2375,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: StartThread(%d %d)\n", a0, a1);
 				#endif
 
-				FreezeThread(iCurThread, 1);
+				FreezeThread(HW.iCurThread, 1);
 				ThawThread(a0);
-				iCurThread = a0;
+				HW.iCurThread = a0;
 				break;
 
 			case 20:// GetThreadID
@@ -2283,19 +2385,19 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: GetThreadId()\n");
 				#endif
 
-				mipsinfo.i = iCurThread;
+				mipsinfo.i = HW.iCurThread;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
 			case 24:// SleepThread
 				#if DEBUG_THREADING
 				mips_get_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
-				printf("IOP: SleepThread() [curThread %d, PC=%x]\n", iCurThread, mipsinfo.i);
+				printf("IOP: SleepThread() [curThread %d, PC=%x]\n", HW.iCurThread, mipsinfo.i);
 				#endif
 
-				FreezeThread(iCurThread, 1);
-				threads[iCurThread].iState = TS_SLEEPING;
-				iCurThread = -1;
+				FreezeThread(HW.iCurThread, 1);
+				HW.threads[HW.iCurThread].iState = TS_SLEEPING;
+				HW.iCurThread = -1;
 
 				ps2_reschedule();
 				break;
@@ -2306,7 +2408,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 
 				// set thread to "ready to go"
-				threads[a0].iState = TS_READY;
+				HW.threads[a0].iState = TS_READY;
 				break;
 
 			case 26:// iWakeupThread
@@ -2315,9 +2417,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 
 				// set thread to "ready to go" if it's not running
-				if (threads[a0].iState != TS_RUNNING)
+				if (HW.threads[a0].iState != TS_RUNNING)
 				{
-					threads[a0].iState = TS_READY;
+					HW.threads[a0].iState = TS_READY;
 				}
 				break;
 
@@ -2327,7 +2429,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 					#if DEBUG_THREADING
 					mips_get_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
-					printf("IOP: DelayThread(%d) (PC=%x) [curthread = %d]\n", a0, mipsinfo.i, iCurThread);
+					printf("IOP: DelayThread(%d) (PC=%x) [curthread = %d]\n", a0, mipsinfo.i, HW.iCurThread);
 					#endif
 
 					if (a0 < 100)
@@ -2336,12 +2438,12 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					}
 					dTicks = (double)a0;
 
-					FreezeThread(iCurThread, 1);
-					threads[iCurThread].iState = TS_WAITDELAY;
+					FreezeThread(HW.iCurThread, 1);
+					HW.threads[HW.iCurThread].iState = TS_WAITDELAY;
 					dTicks /= (double)1000000.0;
 					dTicks *= (double)36864000.0;	// 768*48000 = IOP native-mode clock rate
-					threads[iCurThread].waitparm = (uint32_t)dTicks;
-					iCurThread = -1;
+					HW.threads[HW.iCurThread].waitparm = (uint32_t)dTicks;
+					HW.iCurThread = -1;
 
 					ps2_reschedule();
 				}
@@ -2355,8 +2457,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				a0 &= 0x1fffff;
 				a0 /= 4;
 
-				psx_ram[a0] = LE32(sys_time & 0xffffffff);  	// low
-				psx_ram[a0+1] = LE32(sys_time >> 32);	// high
+				PSXMEM.psx_ram[a0] = LE32(HW.sys_time & 0xffffffff);  	// low
+				PSXMEM.psx_ram[a0+1] = LE32(HW.sys_time >> 32);	// high
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2377,8 +2479,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					hi = dTicks>>32;
 					lo = dTicks & 0xffffffff;
 
-					psx_ram[((a1 & 0x1fffff)/4)] = LE32(lo);
-					psx_ram[((a1 & 0x1fffff)/4)+1] = LE32(hi);
+					PSXMEM.psx_ram[((a1 & 0x1fffff)/4)] = LE32(lo);
+					PSXMEM.psx_ram[((a1 & 0x1fffff)/4)+1] = LE32(hi);
 
 					mipsinfo.i = 0;
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2401,8 +2503,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					a1 /= 4;
 					a2 /= 4;
 
-					temp = LE32(psx_ram[a0]);
-					temp |= (uint64_t)LE32(psx_ram[a0+1])<<32;
+					temp = LE32(PSXMEM.psx_ram[a0]);
+					temp |= (uint64_t)LE32(PSXMEM.psx_ram[a0+1])<<32;
 
 					temp *= (uint64_t)1000000;
 					temp /= (uint64_t)36864000;
@@ -2411,8 +2513,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					seconds = (temp / 1000000) & 0xffffffff;
 					usec = (temp % 1000000) & 0xffffffff;
 
-					psx_ram[a1] = LE32(seconds);
-					psx_ram[a2] = LE32(usec);
+					PSXMEM.psx_ram[a1] = LE32(seconds);
+					PSXMEM.psx_ram[a2] = LE32(usec);
 				}
 				break;
 
@@ -2434,17 +2536,17 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				a0 &= 0x1fffff;
 				a0 /= 4;
 
-				evflags[iNumFlags].type = LE32(psx_ram[a0]);
-				evflags[iNumFlags].value = LE32(psx_ram[a0+1]);
-				evflags[iNumFlags].param = LE32(psx_ram[a0+2]);
-				evflags[iNumFlags].inUse = 1;
+				HW.evflags[HW.iNumFlags].type = LE32(PSXMEM.psx_ram[a0]);
+				HW.evflags[HW.iNumFlags].value = LE32(PSXMEM.psx_ram[a0+1]);
+				HW.evflags[HW.iNumFlags].param = LE32(PSXMEM.psx_ram[a0+2]);
+				HW.evflags[HW.iNumFlags].inUse = 1;
 
 				#if DEBUG_HLE_IOP
-				printf("     Flag %02d: type %d init %08x param %08x\n", iNumFlags, evflags[iNumFlags].type, evflags[iNumFlags].value, evflags[iNumFlags].param);
+				printf("     Flag %02d: type %d init %08x param %08x\n", HW.iNumFlags, HW.evflags[HW.iNumFlags].type, HW.evflags[HW.iNumFlags].value, HW.evflags[HW.iNumFlags].param);
 				#endif
 
-				mipsinfo.i = iNumFlags+1;
-				iNumFlags++;
+				mipsinfo.i = HW.iNumFlags+1;
+				HW.iNumFlags++;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
@@ -2454,7 +2556,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: SetEventFlag(%d %08x)\n", a0, a1);
 				#endif
 
-				evflags[a0].value |= a1;
+				HW.evflags[a0].value |= a1;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2466,16 +2568,16 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: iSetEventFlag(%08x %08x)\n", a0, a1);
 				#endif
 
-				evflags[a0].value |= a1;
+				HW.evflags[a0].value |= a1;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 
-				for (i=0; i < iNumThreads; i++)
+				for (i=0; i < HW.iNumThreads; i++)
 				{
-					if ((threads[i].iState == TS_WAITEVFLAG) && (threads[i].waitparm == a0))
+					if ((HW.threads[i].iState == TS_WAITEVFLAG) && (HW.threads[i].waitparm == a0))
 					{
-						threads[i].iState = TS_READY;
+						HW.threads[i].iState = TS_READY;
 					}
 				}
 				break;
@@ -2487,7 +2589,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: ClearEventFlag(%d %08x) (PC=%x)\n", a0, a1, mipsinfo.i);
 				#endif
 
-				evflags[a0].value &= a1;
+				HW.evflags[a0].value &= a1;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2499,7 +2601,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: iClearEventFlag(%d %08x)\n", a0, a1);
 				#endif
 
-				evflags[a0].value &= a1;
+				HW.evflags[a0].value &= a1;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2513,12 +2615,12 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 
 				// if we're not set, freeze this thread
-				if (!(evflags[a0].value & a1))
+				if (!(HW.evflags[a0].value & a1))
 				{
-					FreezeThread(iCurThread, 1);
-					threads[iCurThread].iState = TS_WAITEVFLAG;
-					threads[iCurThread].waitparm = a0;
-					iCurThread = -1;
+					FreezeThread(HW.iCurThread, 1);
+					HW.threads[HW.iCurThread].iState = TS_WAITEVFLAG;
+					HW.threads[HW.iCurThread].waitparm = a0;
+					HW.iCurThread = -1;
 
 					ps2_reschedule();
 				}
@@ -2548,7 +2650,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				mipsinfo.i = -1;
 				for (i = 0; i < SEMA_MAX; i++)
 				{
-					if (!semaphores[i].inuse)
+					if (!HW.semaphores[i].inuse)
 					{
 						mipsinfo.i = i;
 						break;
@@ -2567,14 +2669,14 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 				if (mipsinfo.i != -1)
 				{
-					semaphores[mipsinfo.i].attr = LE32(psx_ram[a0]);
-					semaphores[mipsinfo.i].option = LE32(psx_ram[a0+1]);
-					semaphores[mipsinfo.i].init = LE32(psx_ram[a0+2]);
-					semaphores[mipsinfo.i].max = LE32(psx_ram[a0+3]);
+					HW.semaphores[mipsinfo.i].attr = LE32(PSXMEM.psx_ram[a0]);
+					HW.semaphores[mipsinfo.i].option = LE32(PSXMEM.psx_ram[a0+1]);
+					HW.semaphores[mipsinfo.i].init = LE32(PSXMEM.psx_ram[a0+2]);
+					HW.semaphores[mipsinfo.i].max = LE32(PSXMEM.psx_ram[a0+3]);
 
-					semaphores[mipsinfo.i].current = semaphores[mipsinfo.i].init;
+					HW.semaphores[mipsinfo.i].current = HW.semaphores[mipsinfo.i].init;
 
-					semaphores[mipsinfo.i].inuse = 1;
+					HW.semaphores[mipsinfo.i].inuse = 1;
 				}
 
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2582,16 +2684,16 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 			case 6: // SignalSema
 				#if DEBUG_HLE_IOP
-				printf("IOP: SignalSema(%d) (current %d)\n", a0, semaphores[a0].current);
+				printf("IOP: SignalSema(%d) (current %d)\n", a0, HW.semaphores[a0].current);
 				#endif
 
 				foundthread = 0;
-				for (i=0; i < iNumThreads; i++)
+				for (i=0; i < HW.iNumThreads; i++)
 				{
-					if ((threads[i].iState == TS_WAITSEMA) && (threads[i].waitparm == a0))
+					if ((HW.threads[i].iState == TS_WAITSEMA) && (HW.threads[i].waitparm == a0))
 					{
-						threads[i].iState = TS_READY;
-						semaphores[a0].threadsWaiting--;
+						HW.threads[i].iState = TS_READY;
+						HW.semaphores[a0].threadsWaiting--;
 						foundthread = 1;
 						break;
 					}
@@ -2601,9 +2703,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 				if (!foundthread)
 				{
-					if (semaphores[a0].current < semaphores[a0].max)
+					if (HW.semaphores[a0].current < HW.semaphores[a0].max)
 					{
-						semaphores[a0].current++;
+						HW.semaphores[a0].current++;
 					}
 					else
 					{
@@ -2620,12 +2722,12 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 
 				foundthread = 0;
-				for (i=0; i < iNumThreads; i++)
+				for (i=0; i < HW.iNumThreads; i++)
 				{
-					if ((threads[i].iState == TS_WAITSEMA) && (threads[i].waitparm == a0))
+					if ((HW.threads[i].iState == TS_WAITSEMA) && (HW.threads[i].waitparm == a0))
 					{
-						threads[i].iState = TS_READY;
-						semaphores[a0].threadsWaiting--;
+						HW.threads[i].iState = TS_READY;
+						HW.semaphores[a0].threadsWaiting--;
 						foundthread = 1;
 						break;
 					}
@@ -2635,9 +2737,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 				if (!foundthread)
 				{
-					if (semaphores[a0].current < semaphores[a0].max)
+					if (HW.semaphores[a0].current < HW.semaphores[a0].max)
 					{
-						semaphores[a0].current++;
+						HW.semaphores[a0].current++;
 					}
 					else
 					{
@@ -2651,18 +2753,18 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 			case 8: // WaitSema
 				#if DEBUG_HLE_IOP
 				mips_get_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
-				printf("IOP: WaitSema(%d) (cnt %d) (th %d) (PC=%x)\n", a0, iCurThread, semaphores[a0].current, mipsinfo.i);
+				printf("IOP: WaitSema(%d) (cnt %d) (th %d) (PC=%x)\n", a0, HW.iCurThread, HW.semaphores[a0].current, mipsinfo.i);
 				#endif
 
-				if (semaphores[a0].current > 0)
+				if (HW.semaphores[a0].current > 0)
 				{
-					semaphores[a0].current--;
+					HW.semaphores[a0].current--;
 				}
 				else
 				{
-					FreezeThread(iCurThread, 1);
-					threads[iCurThread].iState = TS_WAITSEMA;
-					threads[iCurThread].waitparm = a0;
+					FreezeThread(HW.iCurThread, 1);
+					HW.threads[HW.iCurThread].iState = TS_WAITSEMA;
+					HW.threads[HW.iCurThread].waitparm = a0;
 					ps2_reschedule();
 				}
 
@@ -2690,11 +2792,11 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: AllocHardTimer doesn't support 16-bit timers!\n");
 				}
 
-				iop_timers[iNumTimers].source = a0;
-				iop_timers[iNumTimers].prescale = a2;
+				HW.iop_timers[HW.iNumTimers].source = a0;
+				HW.iop_timers[HW.iNumTimers].prescale = a2;
 
-				mipsinfo.i = iNumTimers+1;
-				iNumTimers++;
+				mipsinfo.i = HW.iNumTimers+1;
+				HW.iNumTimers++;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
@@ -2707,7 +2809,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				break;
 
 			case 10:// GetTimerCounter
-				mipsinfo.i = iop_timers[a0-1].count;
+				mipsinfo.i = HW.iop_timers[a0-1].count;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
@@ -2717,9 +2819,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 				// id, compare, handler, common (last is param for handler)
 
-				iop_timers[a0-1].target = a1;
-				iop_timers[a0-1].handler = a2;
-				iop_timers[a0-1].hparam = a3;
+				HW.iop_timers[a0-1].target = a1;
+				HW.iop_timers[a0-1].handler = a2;
+				HW.iop_timers[a0-1].hparam = a3;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2731,9 +2833,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 				// id, source, mode, prescale
 
-				iop_timers[a0-1].source = a1;
-				iop_timers[a0-1].mode = a2;
-				iop_timers[a0-1].prescale = a3;
+				HW.iop_timers[a0-1].source = a1;
+				HW.iop_timers[a0-1].mode = a2;
+				HW.iop_timers[a0-1].prescale = a3;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2744,8 +2846,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: StartHardTimer(%d)\n", a0);
 				#endif
 
-				iop_timers[a0-1].iActive = 1;
-				iop_timers[a0-1].count = 0;
+				HW.iop_timers[a0-1].iActive = 1;
+				HW.iop_timers[a0-1].count = 0;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2756,7 +2858,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: StopHardTimer(%d)\n", a0);
 				#endif
 
-				iop_timers[a0-1].iActive = 0;
+				HW.iop_timers[a0-1].iActive = 0;
 
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2779,8 +2881,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: memcpy(%08x, %08x, %d)\n", a0, a1, a2);
 					#endif
 
-					dst = (uint8_t *)&psx_ram[(a0&0x1fffff)/4];
-					src = (uint8_t *)&psx_ram[(a1&0x1fffff)/4];
+					dst = (uint8_t *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
+					src = (uint8_t *)&PSXMEM.psx_ram[(a1&0x1fffff)/4];
 					// get exact byte alignment
 					dst += a0 % 4;
 					src += a1 % 4;
@@ -2807,8 +2909,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: memmove(%08x, %08x, %d)\n", a0, a1, a2);
 					#endif
 
-					dst = (uint8_t *)&psx_ram[(a0&0x1fffff)/4];
-					src = (uint8_t *)&psx_ram[(a1&0x1fffff)/4];
+					dst = (uint8_t *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
+					src = (uint8_t *)&PSXMEM.psx_ram[(a1&0x1fffff)/4];
 					// get exact byte alignment
 					dst += a0 % 4;
 					src += a1 % 4;
@@ -2839,7 +2941,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: memset(%08x, %02x, %d) [PC=%x]\n", a0, a1, a2, mipsinfo.i);
 					#endif
 
-					dst = (uint8_t *)&psx_ram[(a0&0x1fffff)/4];
+					dst = (uint8_t *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
 					dst += (a0 & 3);
 
 					memset(dst, a1, a2);
@@ -2854,15 +2956,15 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: bzero(%08x, %08x)\n", a0, a1);
 					#endif
 
-					dst = (uint8_t *)&psx_ram[(a0&0x1fffff)/4];
+					dst = (uint8_t *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
 					dst += (a0 & 3);
 					memset(dst, 0, a1);
 				}
 				break;
 
 			case 19:	// sprintf
-				mname = (char *)psx_ram;
-				str1 = (char *)psx_ram;
+				mname = (char *)PSXMEM.psx_ram;
+				str1 = (char *)PSXMEM.psx_ram;
 				mname += a0 & 0x1fffff;
 				str1 += a1 & 0x1fffff;
 
@@ -2887,8 +2989,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: strcpy(%08x, %08x)\n", a0, a1);
 					#endif
 
-					dst = (uint8_t *)&psx_ram[(a0&0x1fffff)/4];
-					src = (uint8_t *)&psx_ram[(a1&0x1fffff)/4];
+					dst = (uint8_t *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
+					src = (uint8_t *)&PSXMEM.psx_ram[(a1&0x1fffff)/4];
 					// get exact byte alignment
 					dst += a0 % 4;
 					src += a1 % 4;
@@ -2916,7 +3018,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: strlen(%08x) [PC=%x]\n", a0, mipsinfo.i);
 					#endif
 
-					dst = (char *)&psx_ram[(a0&0x1fffff)/4];
+					dst = (char *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
 					dst += (a0 & 3);
 					mipsinfo.i = strlen(dst);
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -2931,8 +3033,8 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: strncpy(%08x, %08x, %d)\n", a0, a1, a2);
 					#endif
 
-					dst = (char *)&psx_ram[(a0&0x1fffff)/4];
-					src = (char *)&psx_ram[(a1&0x1fffff)/4];
+					dst = (char *)&PSXMEM.psx_ram[(a0&0x1fffff)/4];
+					src = (char *)&PSXMEM.psx_ram[(a1&0x1fffff)/4];
 					// get exact byte alignment
 					dst += a0 % 4;
 					src += a1 % 4;
@@ -2954,7 +3056,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 
 			case 36:	// strtol
-				mname = (char *)&psx_ram[(a0 & 0x1fffff)/4];
+				mname = (char *)&PSXMEM.psx_ram[(a0 & 0x1fffff)/4];
 				mname += (a0 & 3);
 
 				if (a1)
@@ -2982,25 +3084,25 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 
 				if (a0 == 9)
 				{
-					irq9_fval = a1;
-					irq9_cb = a2;
-					irq9_flag = a3;
+					HW.irq9_fval = a1;
+					HW.irq9_cb = a2;
+					HW.irq9_flag = a3;
 				}
 
 				// DMA4?
 				if (a0 == 36)
 				{
-					dma4_fval = a1;
-					dma4_cb = a2;
-					dma4_flag = a3;
+					HW.dma4_fval = a1;
+					HW.dma4_cb = a2;
+					HW.dma4_flag = a3;
 				}
 
 				// DMA7?
 				if (a0 == 40)
 				{
-					dma7_fval = a1;
-					dma7_cb = a2;
-					dma7_flag = a3;
+					HW.dma7_fval = a1;
+					HW.dma7_cb = a2;
+					HW.dma7_flag = a3;
 				}
 				break;
 
@@ -3040,7 +3142,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#endif
 
 				// if already suspended, return an error code
-				if (intr_susp)
+				if (HW.intr_susp)
 				{
 					mipsinfo.i = -102;
 				}
@@ -3048,7 +3150,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				{
 					mipsinfo.i = 0;
 				}
-				intr_susp = 1;
+				HW.intr_susp = 1;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
@@ -3056,7 +3158,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				#if DEBUG_HLE_IOP
 				printf("IOP: CpuResumeIntr\n");
 				#endif
-				intr_susp = 0;
+				HW.intr_susp = 0;
 				mipsinfo.i = 0;
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
@@ -3092,17 +3194,17 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				printf("IOP: RegisterLibraryEntries(%08x) (PC=%x)\n", a0, mipsinfo.i);
 				#endif
 
-				if (psx_ram[a0/4] == LE32(0x41c00000))
+				if (PSXMEM.psx_ram[a0/4] == LE32(0x41c00000))
 				{
 					a0 += 3*4;
-					memcpy(&reglibs[iNumLibs].name, &psx_ram[a0/4], 8);
-					reglibs[iNumLibs].name[8] = '\0';
+					memcpy(&HW.reglibs[HW.iNumLibs].name, &PSXMEM.psx_ram[a0/4], 8);
+					HW.reglibs[HW.iNumLibs].name[8] = '\0';
 					#if DEBUG_HLE_IOP
-					printf("Lib name [%s]\n", &reglibs[iNumLibs].name);
+					printf("Lib name [%s]\n", &HW.reglibs[HW.iNumLibs].name);
 					#endif
 					a0 += 2*4;
-					reglibs[iNumLibs].dispatch = a0;
-					iNumLibs++;
+					HW.reglibs[HW.iNumLibs].dispatch = a0;
+					HW.iNumLibs++;
 				}
 				else
 				{
@@ -3175,7 +3277,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				break;
 
 			case 14: // Kprintf
-				mname = (char *)psx_ram;
+				mname = (char *)PSXMEM.psx_ram;
 				mname += a0 & 0x1fffff;
 				mname += (a0 & 3);
 
@@ -3218,9 +3320,9 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 		switch (callnum)
 		{
 			case 7:	// LoadStartModule
-				mname = (char *)&psx_ram[(a0 & 0x1fffff)/4];
+				mname = (char *)&PSXMEM.psx_ram[(a0 & 0x1fffff)/4];
 				mname += 8;
-				str1 = (char *)&psx_ram[(a2 & 0x1fffff)/4];
+				str1 = (char *)&PSXMEM.psx_ram[(a2 & 0x1fffff)/4];
 				#if DEBUG_HLE_IOP
 				printf("LoadStartModule: %s\n", mname);
 				#endif
@@ -3246,7 +3348,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					if (start != 0xffffffff)
 					{
 						uint32_t args[20], numargs = 1, argofs;
-						uint8_t *argwalk = (uint8_t *)psx_ram;
+						uint8_t *argwalk = (uint8_t *)PSXMEM.psx_ram;
 
 						argwalk += (a2 & 0x1fffff);
 
@@ -3277,7 +3379,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 							#if DEBUG_HLE_IOP
 //							printf("Arg %d: %08x [%s]\n", i, args[i], &argbase[args[i]-a2]);
 							#endif
-							psx_ram[(newAlloc/4)+i] = LE32(args[i]);
+							PSXMEM.psx_ram[(newAlloc/4)+i] = LE32(args[i]);
 						}
 
 						// set argv and argc
@@ -3312,7 +3414,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					slot2use = -1;
 					for (i = 0; i < MAX_FILE_SLOTS; i++)
 					{
-						if (filestat[i] == 0)
+						if (HW.filestat[i] == 0)
 						{
 							slot2use = i;
 							break;
@@ -3327,7 +3429,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 						return;
 					}
 
-					mname = (char *)psx_ram;
+					mname = (char *)PSXMEM.psx_ram;
 					mname += (a0 & 0x1fffff);
 
 					if (!strncmp(mname, "aofile:", 7))
@@ -3348,14 +3450,14 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					printf("IOP: open(\"%s\") (PC=%08x)\n", mname, mipsinfo.i);
 					#endif
 
-					filedata[slot2use] = (uint8_t *) malloc(6*1024*1024);
-					filesize[slot2use] = psf2_load_file(mname, filedata[slot2use], 6*1024*1024);
-					filepos[slot2use] = 0;
-					filestat[slot2use] = 1;
+					HW.filedata[slot2use] = (uint8_t *) malloc(6*1024*1024);
+					HW.filesize[slot2use] = psf2_load_file(mname, HW.filedata[slot2use], 6*1024*1024);
+					HW.filepos[slot2use] = 0;
+					HW.filestat[slot2use] = 1;
 
-					if (filesize[slot2use] == 0xffffffff)
+					if (HW.filesize[slot2use] == 0xffffffff)
 					{
-						mipsinfo.i = filesize[slot2use];
+						mipsinfo.i = HW.filesize[slot2use];
 					}
 					else
 					{
@@ -3370,19 +3472,19 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				mips_get_info(CPUINFO_INT_REGISTER + MIPS_R31, &mipsinfo);
 				printf("IOP: close(%d) (PC=%08x)\n", a0, mipsinfo.i);
 				#endif
-				free(filedata[a0]);
-				filedata[a0] = (uint8_t *)nullptr;
-				filepos[a0] = 0;
-				filesize[a0] = 0;
-				filestat[a0] = 0;
+				free(HW.filedata[a0]);
+				HW.filedata[a0] = (uint8_t *)nullptr;
+				HW.filepos[a0] = 0;
+				HW.filesize[a0] = 0;
+				HW.filestat[a0] = 0;
 				break;
 
 			case 6:	// read
 				#if DEBUG_HLE_IOP
-				printf("IOP: read(%x %x %d) [pos %d size %d]\n", a0, a1, a2, filepos[a0], filesize[a0]);
+				printf("IOP: read(%x %x %d) [pos %d size %d]\n", a0, a1, a2, HW.filepos[a0], HW.filesize[a0]);
 				#endif
 
-				if (filepos[a0] >= filesize[a0])
+				if (HW.filepos[a0] >= HW.filesize[a0])
 				{
 					mipsinfo.i = 0;
 				}
@@ -3390,16 +3492,16 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				{
 					uint8_t *rp;
 
-					if ((filepos[a0] + a2) > filesize[a0])
+					if ((HW.filepos[a0] + a2) > HW.filesize[a0])
 					{
-						a2 = filesize[a0] - filepos[a0];
+						a2 = HW.filesize[a0] - HW.filepos[a0];
 					}
 
-					rp = (uint8_t *)psx_ram;
+					rp = (uint8_t *)PSXMEM.psx_ram;
 					rp += (a1 & 0x1fffff);
-					memcpy(rp, &filedata[a0][filepos[a0]], a2);
+					memcpy(rp, &HW.filedata[a0][HW.filepos[a0]], a2);
 
-					filepos[a0] += a2;
+					HW.filepos[a0] += a2;
 					mipsinfo.i = a2;
 				}
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
@@ -3414,23 +3516,23 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 				switch (a2)
 				{
 					case 0:	// SEEK_SET
-						if (a1 <= filesize[a0])
+						if (a1 <= HW.filesize[a0])
 						{
-							filepos[a0] = a1;
+							HW.filepos[a0] = a1;
 						}
 						break;
 					case 1:	// SEEK_CUR
-						if ((a1 + filepos[a0]) < filesize[a0])
+						if ((a1 + HW.filepos[a0]) < HW.filesize[a0])
 						{
-							filepos[a0] += a1;
+							HW.filepos[a0] += a1;
 						}
 						break;
 					case 2:	// SEEK_END
-						filepos[a0] = filesize[a0] - a1;
+						HW.filepos[a0] = HW.filesize[a0] - a1;
 						break;
 				}
 
-				mipsinfo.i = filepos[a0];
+				mipsinfo.i = HW.filepos[a0];
 				mips_set_info(CPUINFO_INT_REGISTER + MIPS_R2, &mipsinfo);
 				break;
 
@@ -3460,11 +3562,11 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 	{
 		int lib;
 
-		if (iNumLibs > 0)
+		if (HW.iNumLibs > 0)
 		{
-			for (lib = 0; lib < iNumLibs; lib++)
+			for (lib = 0; lib < HW.iNumLibs; lib++)
 			{
-				if (!strcmp(name, reglibs[lib].name))
+				if (!strcmp(name, HW.reglibs[lib].name))
 				{
 					#if DEBUG_HLE_IOP
 					uint32_t PC;
@@ -3478,12 +3580,12 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_DELAYV, &mipsinfo);
 					mips_set_info(CPUINFO_INT_REGISTER + MIPS_DELAYR, &mipsinfo);
 
-					mipsinfo.i = LE32(psx_ram[(reglibs[lib].dispatch/4) + callnum]);
+					mipsinfo.i = LE32(PSXMEM.psx_ram[(HW.reglibs[lib].dispatch/4) + callnum]);
 
 					// (NOTE: we get called in the delay slot!)
 					#if DEBUG_HLE_IOP
 					printf("IOP: Calling %s (%d) service %d => %08x (parms %08x %08x %08x %08x) (PC=%x)\n",
-							 reglibs[lib].name,
+							 HW.reglibs[lib].name,
 							 lib,
 							 callnum,
 							 (uint32_t)mipsinfo.i,
@@ -3491,7 +3593,7 @@ void psx_iop_call(uint32_t pc, uint32_t callnum)
 					#endif
 
 					#if 0
-					if (!strcmp(reglibs[lib].name, "ssd"))
+					if (!strcmp(HW.reglibs[lib].name, "ssd"))
 					{
 						if (callnum == 37)
 						{
@@ -0,0 +1,99 @@
+//
+// Voice mixer shared by the PEOPS SPU and SPU2 cores
+//
+// The cores run each playing voice through its own scalar stage (ADPCM
+// decoding, interpolation, envelope), which is sequential by nature, and
+// leave the enveloped samples in per-voice arrays.  Applying the voice
+// volumes and summing across voices is then done here, four voices at a
+// time with SSE2 or NEON.  It is all integer arithmetic, so the sums are
+// exactly those of the old per-voice code.  Define PEOPS_NO_SIMD to use
+// the plain loop.
+//
+
+#ifndef __SPUMIX_H
+#define __SPUMIX_H
+
+#include <stdint.h>
+
+#ifndef PEOPS_NO_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define SPUMIX_SSE2 1
+		#include <emmintrin.h>
+		#ifdef __SSE4_1__
+			#include <smmintrin.h>
+		#endif
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define SPUMIX_NEON 1
+		#include <arm_neon.h>
+	#endif
+#endif
+
+#if SPUMIX_SSE2
+static inline __m128i spu_mullo(__m128i a, __m128i b)
+{
+#ifdef __SSE4_1__
+	return _mm_mullo_epi32(a, b);
+#else
+	// the low 32 bits of a product are the same signed or unsigned
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+#endif
+
+// Returns the sum over voices i < n of val[i] * vol[i] scaled down by 0x4000,
+// either with an arithmetic shift (PEOPS SPU) or rounding toward zero like a
+// C division (PEOPS SPU2).  n must be a multiple of 4.
+template<bool truncate>
+static inline int32_t spu_mix(const int32_t *val, const int32_t *vol, int n)
+{
+#if SPUMIX_SSE2
+	__m128i sum = _mm_setzero_si128();
+
+	for (int i = 0; i < n; i += 4)
+	{
+		__m128i p = spu_mullo(_mm_loadu_si128((const __m128i *)(val + i)),
+		                      _mm_loadu_si128((const __m128i *)(vol + i)));
+
+		if (truncate)
+			p = _mm_add_epi32(p, _mm_and_si128(_mm_srai_epi32(p, 31), _mm_set1_epi32(0x3fff)));
+
+		sum = _mm_add_epi32(sum, _mm_srai_epi32(p, 14));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#elif SPUMIX_NEON
+	int32x4_t sum = vdupq_n_s32(0);
+
+	for (int i = 0; i < n; i += 4)
+	{
+		int32x4_t p = vmulq_s32(vld1q_s32(val + i), vld1q_s32(vol + i));
+
+		if (truncate)
+			p = vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), vdupq_n_s32(0x3fff)));
+
+		sum = vaddq_s32(sum, vshrq_n_s32(p, 14));
+	}
+
+	int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0);
+#else
+	int32_t sum = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		if (truncate)
+			sum += (val[i] * vol[i]) / 0x4000;
+		else
+			sum += (val[i] * vol[i]) >> 14;
+	}
+
+	return sum;
+#endif
+}
+
+#endif // __SPUMIX_H
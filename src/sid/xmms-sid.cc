@@ -26,6 +26,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <chrono>
+
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
@@ -64,6 +66,7 @@ public:
 
 private:
     bool delayed_init();
+    bool seek(int subTune, int time, char *audioBuffer, int audioBufSize, int64_t &bytes_played);
 
     bool m_initialized = false;
     bool m_init_failed = false;
@@ -124,6 +127,60 @@ bool SIDPlugin::is_our_file(const char *filename, VFSFile &file)
 }
 
 
+/*
+ * Seek to the given time (in milliseconds) within the sub-tune.
+ * libsidplayfp cannot save and restore its state, so seeking backward
+ * restarts the sub-tune. Either way the engine then runs fast-forward,
+ * which skips the mixing of all but one in XS_SEEK_SPEED / 100 samples,
+ * until the target is reached. bytes_played is updated to match.
+ * The time taken is logged, to keep an eye on the seek latency.
+ */
+bool SIDPlugin::seek(int subTune, int time, char *audioBuffer, int audioBufSize, int64_t &bytes_played)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    int frameSize = xs_cfg.audioChannels * 2;
+    int speed = XS_SEEK_SPEED / 100;
+    int64_t target = aud::rescale<int64_t> (time, 1000,
+     xs_cfg.audioFrequency) * frameSize;
+
+    if (target < bytes_played) {
+        if (!xs_sidplayfp_initsong(subTune))
+            return false;
+        bytes_played = 0;
+    }
+
+    if (!xs_sidplayfp_fastforward(XS_SEEK_SPEED))
+        speed = 1;
+
+    while (bytes_played < target && ! check_stop ()) {
+        /* a newer request replaces this one rather than queuing behind it */
+        int again = check_seek ();
+        if (again >= 0)
+            return seek(subTune, again, audioBuffer, audioBufSize, bytes_played);
+
+        /* don't run past the target */
+        int64_t want = (target - bytes_played) / speed;
+        want = aud::clamp<int64_t> (want - want % frameSize, frameSize,
+         audioBufSize - audioBufSize % frameSize);
+
+        unsigned done = xs_sidplayfp_fillbuffer(audioBuffer, want);
+        if (!done)
+            break;
+
+        bytes_played += (int64_t) done * speed;
+    }
+
+    xs_sidplayfp_fastforward(100);
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    AUDDBG("Seek to %d ms took %d ms\n", time, (int)
+     std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+
+    return true;
+}
+
+
 /*
  * Start playing the given file
  */
@@ -180,8 +237,9 @@ bool SIDPlugin::play(const char *filename, VFSFile &file)
 
     while (! check_stop ())
     {
-        if (check_seek () >= 0)
-            AUDWARN ("Seeking is not implemented, ignoring.\n");
+        int seek_value = check_seek ();
+        if (seek_value >= 0 && !seek(subTune, seek_value, audioBuffer, audioBufSize, bytes_played))
+            break;
 
         int bufRemaining = xs_sidplayfp_fillbuffer(audioBuffer, audioBufSize);
 
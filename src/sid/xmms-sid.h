@@ -34,6 +34,10 @@
  */
 #define XS_AUDIO_FREQ (44100)
 
+/* Emulation speed used for seeking, in percent (the most libsidplayfp allows)
+ */
+#define XS_SEEK_SPEED (3200)
+
 /* Plugin-wide typedefs
  */
 struct xs_subtuneinfo_t
@@ -28,31 +28,296 @@
 #include "xs_sidplay2.h"
 
 #include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <vector>
 
 #include <sidplayfp/sidplayfp.h>
-#include <sidplayfp/SidDatabase.h>
 #include <sidplayfp/SidInfo.h>
 #include <sidplayfp/SidTune.h>
 #include <sidplayfp/SidTuneInfo.h>
 #include <sidplayfp/builders/residfp.h>
 
+#include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
 #include <libaudcore/vfs.h>
 
+#define XS_SONGLENGTHS_DB SIDDATADIR "/sidplayfp/Songlengths.md5"
+#define XS_SONGLENGTHS_IDX "sid-songlengths.idx"
+
+/* Binary song length index, built from the HVSC text database and kept
+ * in the user config directory. The entries are sorted by MD5 so they
+ * can be binary-searched straight from the mapped file.
+ */
+struct xs_idx_header_t {
+    char magic[8];
+    int64_t dbSize, dbTime;     /* of the text database it was built from */
+    uint32_t nentries, nlengths;
+};
+
+struct xs_idx_entry_t {
+    uint8_t md5[16];
+    uint32_t first, count;      /* range of lengths (in ms) for the subtunes */
+};
+
+static const char xs_idx_magic[8] = {'X', 'S', 'L', 'E', 'N', 'I', 'X', '1'};
+
 struct SidState {
     sidplayfp *currEng;
     sidbuilder *currBuilder;
     SidTune *currTune;
 
-    SidDatabase database;
-    bool database_loaded = false;
+    const char *database = nullptr;     /* mapped index, or nullptr */
+    int64_t database_size = 0;
+    bool database_tried = false;
     pthread_mutex_t database_mutex = PTHREAD_MUTEX_INITIALIZER;
 };
 
 static SidState state;
 
 
+static int xs_hexdigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool xs_parse_md5(const char *str, uint8_t *md5)
+{
+    for (int i = 0; i < 16; i++) {
+        int hi = xs_hexdigit(str[i * 2]), lo = xs_hexdigit(str[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        md5[i] = (hi << 4) | lo;
+    }
+
+    return true;
+}
+
+/* Parse one "m:ss[.mmm][(attr)]" time, returning milliseconds or -1
+ */
+static int xs_parse_time(const char *&str)
+{
+    char *end;
+    long mins = strtol(str, &end, 10);
+    if (end == str || *end != ':')
+        return -1;
+
+    str = end + 1;
+    long secs = strtol(str, &end, 10);
+    if (end == str)
+        return -1;
+
+    long ms = 0;
+    if (*end == '.') {
+        int scale = 100;
+        for (end++; *end >= '0' && *end <= '9'; end++) {
+            ms += (*end - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    /* skip attributes of old style databases */
+    if (*end == '(') {
+        while (*end && *end != ')')
+            end++;
+        if (*end)
+            end++;
+    }
+
+    str = end;
+    return (mins * 60 + secs) * 1000 + ms;
+}
+
+/* Convert the text database into an index file
+ */
+static bool xs_build_index(const char *idxName, const struct stat &dbStat)
+{
+    Index<char> text = VFSFile::read_file("file://" XS_SONGLENGTHS_DB, VFS_APPEND_NULL);
+    if (!text.len())
+        return false;
+
+    std::vector<xs_idx_entry_t> entries;
+    std::vector<int32_t> lengths;
+
+    for (char *line = text.begin(); line && *line; ) {
+        char *next = strchr(line, '\n');
+        if (next)
+            *next++ = 0;
+
+        xs_idx_entry_t entry;
+        if (line[0] != ';' && strlen(line) > 33 && line[32] == '=' &&
+            xs_parse_md5(line, entry.md5)) {
+            const char *str = line + 33;
+            int len;
+
+            entry.first = lengths.size();
+            while (*str == ' ')
+                str++;
+            while ((len = xs_parse_time(str)) >= 0) {
+                lengths.push_back(len);
+                while (*str == ' ')
+                    str++;
+            }
+
+            entry.count = lengths.size() - entry.first;
+            entries.push_back(entry);
+        }
+
+        line = next;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+     [](const xs_idx_entry_t &a, const xs_idx_entry_t &b)
+        { return memcmp(a.md5, b.md5, 16) < 0; });
+
+    xs_idx_header_t header;
+    memcpy(header.magic, xs_idx_magic, sizeof header.magic);
+    header.dbSize = dbStat.st_size;
+    header.dbTime = dbStat.st_mtime;
+    header.nentries = entries.size();
+    header.nlengths = lengths.size();
+
+    /* write to a temporary file first, so that another instance never
+     * maps a half-written index */
+    StringBuf tmpName = str_concat({idxName, ".tmp"});
+    FILE *fp = fopen(tmpName, "wb");
+    if (!fp)
+        return false;
+
+    bool ok = fwrite(&header, sizeof header, 1, fp) == 1 &&
+        fwrite(entries.data(), sizeof(xs_idx_entry_t), entries.size(), fp) == entries.size() &&
+        fwrite(lengths.data(), sizeof(int32_t), lengths.size(), fp) == lengths.size();
+
+    if (fclose(fp) != 0 || !ok || rename(tmpName, idxName) != 0) {
+        remove(tmpName);
+        return false;
+    }
+
+    AUDDBG("[SIDPlayFP] Indexed %d song lengths of %d tunes.\n",
+        (int)lengths.size(), (int)entries.size());
+    return true;
+}
+
+/* Map the index file, checking that it is complete and up to date
+ */
+static bool xs_map_index(const char *idxName, const struct stat &dbStat)
+{
+    struct stat idxStat;
+    if (stat(idxName, &idxStat) < 0 || idxStat.st_size < (off_t)sizeof(xs_idx_header_t))
+        return false;
+
+#ifndef _WIN32
+    int fd = open(idxName, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    void *data = mmap(nullptr, idxStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+#else
+    void *data = malloc(idxStat.st_size);
+    FILE *fp = fopen(idxName, "rb");
+    bool ok = fp && fread(data, 1, idxStat.st_size, fp) == (size_t)idxStat.st_size;
+    if (fp)
+        fclose(fp);
+
+    if (!ok) {
+        free(data);
+        return false;
+    }
+#endif
+
+    const xs_idx_header_t *header = (const xs_idx_header_t *)data;
+
+    if (memcmp(header->magic, xs_idx_magic, sizeof header->magic) ||
+        header->dbSize != dbStat.st_size || header->dbTime != dbStat.st_mtime ||
+        idxStat.st_size != (off_t)(sizeof(xs_idx_header_t) +
+         (int64_t)header->nentries * sizeof(xs_idx_entry_t) +
+         (int64_t)header->nlengths * sizeof(int32_t))) {
+#ifndef _WIN32
+        munmap(data, idxStat.st_size);
+#else
+        free(data);
+#endif
+        return false;
+    }
+
+    state.database = (const char *)data;
+    state.database_size = idxStat.st_size;
+    return true;
+}
+
+/* Open the song length index, (re)building it if the text database
+ * has changed since it was written. Mutex must be locked.
+ */
+static void xs_open_index()
+{
+    if (state.database_tried)
+        return;
+
+    state.database_tried = true;
+
+    struct stat dbStat;
+    if (stat(XS_SONGLENGTHS_DB, &dbStat) < 0)
+        return;
+
+    StringBuf idxName = filename_build({aud_get_path(AudPath::UserDir), XS_SONGLENGTHS_IDX});
+
+    if (!xs_map_index(idxName, dbStat) &&
+        (!xs_build_index(idxName, dbStat) || !xs_map_index(idxName, dbStat)))
+        AUDERR("[SIDPlayFP] Could not index song length database.\n");
+}
+
+static void xs_close_index()
+{
+    if (state.database) {
+#ifndef _WIN32
+        munmap((void *)state.database, state.database_size);
+#else
+        free((void *)state.database);
+#endif
+        state.database = nullptr;
+    }
+
+    state.database_tried = false;
+}
+
+/* Look up the subtune lengths of a tune by its MD5, returning the
+ * number of subtunes found. Mutex must be locked.
+ */
+static int xs_find_index(const uint8_t *md5, const int32_t *&lengths)
+{
+    const xs_idx_header_t *header = (const xs_idx_header_t *)state.database;
+    const xs_idx_entry_t *entries = (const xs_idx_entry_t *)(header + 1);
+    const xs_idx_entry_t *end = entries + header->nentries;
+
+    const xs_idx_entry_t *found = std::lower_bound(entries, end, md5,
+     [](const xs_idx_entry_t &entry, const uint8_t *key)
+        { return memcmp(entry.md5, key, 16) < 0; });
+
+    if (found == end || memcmp(found->md5, md5, 16))
+        return 0;
+
+    lengths = (const int32_t *)end + found->first;
+    return found->count;
+}
+
+
 /* Check if we can play the given file
  */
 bool xs_sidplayfp_probe(const void *buf, int64_t bufSize)
@@ -163,9 +428,6 @@ bool xs_sidplayfp_init()
             state.currEng->setRoms((uint8_t*)kernal.begin(), (uint8_t*)basic.begin(), (uint8_t*)chargen.begin());
     }
 
-    /* Load song length database */
-    state.database_loaded = state.database.open(SIDDATADIR "/sidplayfp/Songlengths.md5");
-
     /* Create the sidtune */
     state.currTune = new SidTune(0);
 
@@ -193,8 +455,9 @@ void xs_sidplayfp_close()
         state.currTune = nullptr;
     }
 
-    if (state.database_loaded)
-        state.database.close();
+    pthread_mutex_lock(&state.database_mutex);
+    xs_close_index();
+    pthread_mutex_unlock(&state.database_mutex);
 }
 
 
@@ -224,6 +487,15 @@ unsigned xs_sidplayfp_fillbuffer(char * audioBuffer, unsigned audioBufSize)
 }
 
 
+/* Set the emulation speed relative to the output rate (100 = normal);
+ * the engine mixes only one sample out of every percent / 100
+ */
+bool xs_sidplayfp_fastforward(int percent)
+{
+    return state.currEng->fastForward(percent);
+}
+
+
 /* Load a given SID-tune file
  */
 bool xs_sidplayfp_load(const void *buf, int64_t bufSize)
@@ -259,18 +531,26 @@ bool xs_sidplayfp_getinfo(xs_tuneinfo_t &ti, const void *buf, int64_t bufSize)
     /* Fill in subtune information */
     ti.subTunes.insert(0, ti.nsubTunes);
 
-    if (state.database_loaded)
+    /* The song length database is indexed on first use */
+    pthread_mutex_lock(&state.database_mutex);
+    xs_open_index();
+
+    if (state.database)
     {
-        pthread_mutex_lock(&state.database_mutex);
+        char md5str[SidTune::MD5_LENGTH + 1];
+        uint8_t md5[16];
 
-        for (int i = 0; i < ti.nsubTunes; i++)
+        if (myTune.createMD5New(md5str) && xs_parse_md5(md5str, md5))
         {
-            myTune.selectSong(i + 1);
-            ti.subTunes[i].tuneLength = state.database.lengthMs(myTune);
-        }
+            const int32_t *lengths;
+            int count = xs_find_index(md5, lengths);
 
-        pthread_mutex_unlock(&state.database_mutex);
+            for (int i = 0; i < ti.nsubTunes && i < count; i++)
+                ti.subTunes[i].tuneLength = lengths[i];
+        }
     }
 
+    pthread_mutex_unlock(&state.database_mutex);
+
     return true;
 }
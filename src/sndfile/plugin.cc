@@ -20,8 +20,17 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <sndfile.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define USE_MMAP
+#endif
+
 #define WANT_VFS_STDIO_COMPAT
 #include <libaudcore/plugin.h>
 #include <libaudcore/i18n.h>
@@ -48,6 +57,11 @@ public:
     bool is_our_file (const char * filename, VFSFile & file);
     bool read_tag (const char * filename, VFSFile & file, Tuple & tuple, Index<char> * image);
     bool play (const char * filename, VFSFile & file);
+
+private:
+#ifdef USE_MMAP
+    bool play_mapped (const char * filename, SNDFILE * sndfile, const SF_INFO & sfinfo);
+#endif
 };
 
 EXPORT SndfilePlugin aud_plugin_instance;
@@ -312,6 +326,346 @@ bool SndfilePlugin::read_tag (const char * filename, VFSFile & file, Tuple & tup
     return true;
 }
 
+#ifdef USE_MMAP
+
+/* Direct access to uncompressed PCM in local files.  The file is mapped into
+ * memory and slices of the data chunk are handed to the output in their stored
+ * sample format, bypassing libsndfile's float conversion entirely.  libsndfile
+ * has already validated the header; we only need to locate the sample data.
+ */
+struct PCMMapping
+{
+    int format = -1;
+    int64_t offset = 0;
+    int64_t length = 0;
+    int frame_size = 0;
+};
+
+static inline int get_le16 (const unsigned char * p)
+    { return p[0] | (p[1] << 8); }
+static inline int64_t get_le32 (const unsigned char * p)
+    { return (int64_t) (uint32_t) (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24)); }
+static inline int64_t get_le64 (const unsigned char * p)
+    { return get_le32 (p) | (get_le32 (p + 4) << 32); }
+static inline int get_be16 (const unsigned char * p)
+    { return (p[0] << 8) | p[1]; }
+static inline int64_t get_be32 (const unsigned char * p)
+    { return (int64_t) (uint32_t) (((uint32_t) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]); }
+
+static int pcm_format (int bits, bool is_float, bool big_endian, bool unsigned8)
+{
+    if (is_float)
+    {
+#ifdef WORDS_BIGENDIAN
+        return (bits == 32 && big_endian) ? FMT_FLOAT : -1;
+#else
+        return (bits == 32 && ! big_endian) ? FMT_FLOAT : -1;
+#endif
+    }
+
+    switch (bits)
+    {
+        case 8: return unsigned8 ? FMT_U8 : FMT_S8;
+        case 16: return big_endian ? FMT_S16_BE : FMT_S16_LE;
+        case 24: return big_endian ? FMT_S24_3BE : FMT_S24_3LE;
+        case 32: return big_endian ? FMT_S32_BE : FMT_S32_LE;
+        default: return -1;
+    }
+}
+
+static bool set_mapping (PCMMapping & pcm, int format, int align,
+ int64_t offset, int64_t length, int64_t size)
+{
+    /* the frame layout must agree with what libsndfile reported */
+    if (format < 0 || align != pcm.frame_size || offset > size)
+        return false;
+
+    pcm.format = format;
+    pcm.offset = offset;
+    pcm.length = aud::clamp (length, (int64_t) 0, size - offset);
+    return true;
+}
+
+/* RIFF/WAVE, including WAVE_FORMAT_EXTENSIBLE and RF64 */
+static bool map_riff (const unsigned char * p, int64_t size, PCMMapping & pcm)
+{
+    if (size < 12 || memcmp (p + 8, "WAVE", 4))
+        return false;
+
+    bool rf64 = ! memcmp (p, "RF64", 4);
+    if (! rf64 && memcmp (p, "RIFF", 4))
+        return false;
+
+    int64_t rf64_data_size = -1;
+    int format = -1, align = 0;
+
+    for (int64_t pos = 12; pos + 8 <= size;)
+    {
+        const unsigned char * chunk = p + pos;
+        int64_t len = get_le32 (chunk + 4);
+        pos += 8;
+
+        if (! memcmp (chunk, "ds64", 4) && len >= 16 && pos + 16 <= size)
+            rf64_data_size = get_le64 (p + pos + 8);
+        else if (! memcmp (chunk, "fmt ", 4) && len >= 16 && pos + 16 <= size)
+        {
+            int tag = get_le16 (p + pos);
+            align = get_le16 (p + pos + 12);
+            int bits = get_le16 (p + pos + 14);
+
+            if (tag == 0xfffe && len >= 26 && pos + 26 <= size)
+                tag = get_le16 (p + pos + 24);  /* first two bytes of subformat GUID */
+
+            if (tag != 1 && tag != 3)
+                return false;
+
+            format = pcm_format (bits, tag == 3, false, true);
+        }
+        else if (! memcmp (chunk, "data", 4))
+        {
+            if (rf64 && len == 0xffffffff)
+                len = rf64_data_size;
+
+            return set_mapping (pcm, format, align, pos, len, size);
+        }
+
+        pos += len + (len & 1);
+    }
+
+    return false;
+}
+
+/* Sony Wave64: GUID chunk IDs, 64-bit sizes including the header, 8-byte alignment */
+static bool map_w64 (const unsigned char * p, int64_t size, PCMMapping & pcm)
+{
+    if (size < 40 || memcmp (p, "riff", 4) || memcmp (p + 24, "wave", 4))
+        return false;
+
+    int format = -1, align = 0;
+
+    for (int64_t pos = 40; pos + 24 <= size;)
+    {
+        const unsigned char * chunk = p + pos;
+        int64_t len = get_le64 (chunk + 16);
+
+        if (len < 24)
+            return false;
+
+        if (! memcmp (chunk, "fmt ", 4) && len >= 40 && pos + 40 <= size)
+        {
+            int tag = get_le16 (chunk + 24);
+            align = get_le16 (chunk + 36);
+            int bits = get_le16 (chunk + 38);
+
+            if (tag == 0xfffe && len >= 50 && pos + 50 <= size)
+                tag = get_le16 (chunk + 48);
+
+            if (tag != 1 && tag != 3)
+                return false;
+
+            format = pcm_format (bits, tag == 3, false, true);
+        }
+        else if (! memcmp (chunk, "data", 4))
+            return set_mapping (pcm, format, align, pos + 24, len - 24, size);
+
+        pos += (len + 7) & ~(int64_t) 7;
+    }
+
+    return false;
+}
+
+/* AIFF, and AIFF-C with "NONE" (big-endian) or "sowt" (little-endian) samples */
+static bool map_aiff (const unsigned char * p, int64_t size, PCMMapping & pcm)
+{
+    if (size < 12 || memcmp (p, "FORM", 4))
+        return false;
+
+    bool aifc = ! memcmp (p + 8, "AIFC", 4);
+    if (! aifc && memcmp (p + 8, "AIFF", 4))
+        return false;
+
+    int format = -1, align = 0;
+
+    for (int64_t pos = 12; pos + 8 <= size;)
+    {
+        const unsigned char * chunk = p + pos;
+        int64_t len = get_be32 (chunk + 4);
+        pos += 8;
+
+        if (! memcmp (chunk, "COMM", 4) && len >= 18 && pos + 18 <= size)
+        {
+            bool big_endian = true;
+            int bits = get_be16 (p + pos + 6);
+            align = get_be16 (p + pos) * ((bits + 7) / 8);
+
+            if (aifc)
+            {
+                if (len < 22 || pos + 22 > size)
+                    return false;
+                if (! memcmp (p + pos + 18, "sowt", 4))
+                    big_endian = false;
+                else if (memcmp (p + pos + 18, "NONE", 4))
+                    return false;
+            }
+
+            format = pcm_format (bits, false, big_endian, false);
+        }
+        else if (! memcmp (chunk, "SSND", 4) && len >= 8 && pos + 8 <= size)
+        {
+            int64_t skip = get_be32 (p + pos);
+            return set_mapping (pcm, format, align, pos + 8 + skip, len - 8 - skip, size);
+        }
+
+        pos += len + (len & 1);
+    }
+
+    return false;
+}
+
+/* The file is mapped shared, so if another process truncates it during
+ * playback, touching the pages past the new end would raise SIGBUS.  Its size
+ * is therefore checked before each block; once the block is no longer covered,
+ * playback continues from the same frame through libsndfile, reading raw so
+ * that the output format stays the same.  A truncation between the check and
+ * the copy in write_audio() is not caught. */
+bool SndfilePlugin::play_mapped (const char * filename, SNDFILE * sndfile, const SF_INFO & sfinfo)
+{
+    switch (sfinfo.format & SF_FORMAT_SUBMASK)
+    {
+        case SF_FORMAT_PCM_S8:
+        case SF_FORMAT_PCM_U8:
+        case SF_FORMAT_PCM_16:
+        case SF_FORMAT_PCM_24:
+        case SF_FORMAT_PCM_32:
+        case SF_FORMAT_FLOAT:
+            break;
+        default:
+            return false;
+    }
+
+    StringBuf path = uri_to_filename (filename);
+    if (! path || sfinfo.channels < 1 || sfinfo.samplerate < 1)
+        return false;
+
+    int fd = open (path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void * map = MAP_FAILED;
+
+    if (! fstat (fd, & st) && st.st_size > 0 && (uint64_t) st.st_size <= SIZE_MAX)
+        map = mmap (nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED)
+    {
+        close (fd);
+        return false;
+    }
+
+    auto p = (const unsigned char *) map;
+    int64_t size = st.st_size;
+
+    PCMMapping pcm;
+    int bytes = 0;
+
+    switch (sfinfo.format & SF_FORMAT_SUBMASK)
+    {
+        case SF_FORMAT_PCM_S8:
+        case SF_FORMAT_PCM_U8: bytes = 1; break;
+        case SF_FORMAT_PCM_16: bytes = 2; break;
+        case SF_FORMAT_PCM_24: bytes = 3; break;
+        default: bytes = 4; break;
+    }
+
+    pcm.frame_size = sfinfo.channels * bytes;
+
+    bool found = false;
+
+    switch (sfinfo.format & SF_FORMAT_TYPEMASK)
+    {
+        case SF_FORMAT_WAV:
+        case SF_FORMAT_WAVEX:
+        case SF_FORMAT_RF64:
+            found = map_riff (p, size, pcm);
+            break;
+        case SF_FORMAT_W64:
+            found = map_w64 (p, size, pcm);
+            break;
+        case SF_FORMAT_AIFF:
+            found = map_aiff (p, size, pcm);
+            break;
+    }
+
+    if (! found)
+    {
+        munmap (map, size);
+        close (fd);
+        return false;
+    }
+
+    int64_t total = aud::min ((int64_t) sfinfo.frames, pcm.length / pcm.frame_size);
+    int64_t block = aud::max (sfinfo.samplerate / 50, 1);
+    const char * data = (const char *) p + pcm.offset;
+
+    madvise (map, size, MADV_SEQUENTIAL);
+
+    open_audio (pcm.format, sfinfo.samplerate, sfinfo.channels);
+
+    int64_t pos = 0;
+    bool mapped = true;
+    Index<char> buffer;
+
+    while (! check_stop ())
+    {
+        int seek_value = check_seek ();
+        if (seek_value != -1)
+        {
+            pos = aud::min (aud::rescale<int64_t> (seek_value, 1000, sfinfo.samplerate), total);
+            if (! mapped)
+                sf_seek (sndfile, pos, SEEK_SET);
+        }
+
+        int64_t frames = aud::min (block, total - pos);
+        if (frames <= 0)
+            break;
+
+        if (mapped && (fstat (fd, & st) ||
+         st.st_size < pcm.offset + (pos + frames) * pcm.frame_size))
+        {
+            AUDWARN ("%s was truncated during playback.\n", filename);
+            munmap (map, size);
+            mapped = false;
+
+            buffer.resize (block * pcm.frame_size);
+            sf_seek (sndfile, pos, SEEK_SET);
+        }
+
+        if (mapped)
+            write_audio (data + pos * pcm.frame_size, frames * pcm.frame_size);
+        else
+        {
+            int64_t bytes_read = sf_read_raw (sndfile, buffer.begin (), frames * pcm.frame_size);
+            frames = bytes_read / pcm.frame_size;
+            if (frames <= 0)
+                break;
+
+            write_audio (buffer.begin (), frames * pcm.frame_size);
+        }
+
+        pos += frames;
+    }
+
+    if (mapped)
+        munmap (map, size);
+
+    close (fd);
+
+    return true;
+}
+
+#endif // USE_MMAP
+
 bool SndfilePlugin::play (const char * filename, VFSFile & file)
 {
     SF_INFO sfinfo {}; // must be zeroed before sf_open()
@@ -323,6 +677,14 @@ bool SndfilePlugin::play (const char * filename, VFSFile & file)
     if (sndfile == nullptr)
         return false;
 
+#ifdef USE_MMAP
+    if (! stream && play_mapped (filename, sndfile, sfinfo))
+    {
+        sf_close (sndfile);
+        return true;
+    }
+#endif
+
     open_audio (FMT_FLOAT, sfinfo.samplerate, sfinfo.channels);
 
     Index<float> buffer;
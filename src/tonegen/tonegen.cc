@@ -16,20 +16,22 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <libaudcore/audio.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 
-#include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
 #define MIN_FREQ        10
-#define MAX_FREQ        20000
 #define OUTPUT_FREQ     44100
-#define BUF_SAMPLES     512
-#define BUF_BYTES       (BUF_SAMPLES * sizeof(float))
+#define MIN_RATE        1000
+#define MAX_RATE        768000
+#define BUF_FRAMES      1024
+#define SWEEP_STEP      32      /* frames between updates of the sweep frequency */
 
 #ifndef PI
 #define PI              3.14159265358979323846
@@ -64,83 +66,459 @@ bool ToneGen::is_our_file(const char *filename, VFSFile &file)
     return false;
 }
 
-static Index<double> tone_filename_parse(const char *filename)
+struct sweep_t
 {
-    Index<double> frequencies;
+    double from, to, secs;
+};
+
+/* everything that can be set in a tone:// URI */
+struct tone_params_t
+{
+    Index<double> sines;
+    Index<sweep_t> sweeps;
+    Index<double> impulses;
+    bool white = false, pink = false;
+    uint32_t seed = 1;
 
+    int rate = OUTPUT_FREQ;
+    int channels = 1;
+    int format = FMT_FLOAT;
+    double length = 0;          /* seconds, 0 = endless */
+    double level = 0;           /* dBFS */
+    int gap_on = 0, gap_off = 0; /* ms */
+
+    int sources() const
+        { return sines.len() + sweeps.len() + impulses.len() + white + pink; }
+};
+
+static const struct {
+    const char *name;
+    int format;
+} formats[] = {
+    {"float", FMT_FLOAT},
+    {"s8", FMT_S8},
+    {"u8", FMT_U8},
+    {"s16", FMT_S16_NE},
+    {"s24", FMT_S24_NE},
+    {"s32", FMT_S32_NE}
+};
+
+static bool valid_freq(double freq, int rate)
+{
+    return freq >= MIN_FREQ && freq < rate / 2.0;
+}
+
+/* tone://440;880 plays two sines, as it always did.  Other items are
+ * key=value pairs; see the about text. */
+static bool tone_filename_parse(const char *filename, tone_params_t &p)
+{
     if (strncmp(filename, "tone://", 7))
-        return frequencies;
+        return false;
 
+    Index<double> sines;
     auto strings = str_list_to_index(filename + 7, ";");
 
     for (const char *str : strings)
     {
-        double freq = strtod(str, nullptr);
-        if (freq >= MIN_FREQ && freq <= MAX_FREQ)
-            frequencies.append(freq);
+        const char *value = strchr(str, '=');
+
+        if (!value)
+        {
+            if (!strcmp(str, "white"))
+                p.white = true;
+            else if (!strcmp(str, "pink"))
+                p.pink = true;
+            else
+                sines.append(strtod(str, nullptr));
+
+            continue;
+        }
+
+        StringBuf key = str_copy(str, value - str);
+        value++;
+
+        if (!strcmp(key, "sine"))
+            sines.append(strtod(value, nullptr));
+        else if (!strcmp(key, "sweep"))
+        {
+            /* sweep=FROM-TO[:SECONDS], logarithmic, repeated */
+            char *end;
+            sweep_t sweep;
+            sweep.from = strtod(value, &end);
+            sweep.to = (*end == '-') ? strtod(end + 1, &end) : sweep.from;
+            sweep.secs = (*end == ':') ? strtod(end + 1, nullptr) : 10;
+            p.sweeps.append(sweep);
+        }
+        else if (!strcmp(key, "impulse"))
+            p.impulses.append(strtod(value, nullptr));
+        else if (!strcmp(key, "noise"))
+        {
+            p.white |= !strcmp(value, "white");
+            p.pink |= !strcmp(value, "pink");
+        }
+        else if (!strcmp(key, "seed"))
+            p.seed = strtoul(value, nullptr, 10);
+        else if (!strcmp(key, "rate"))
+            p.rate = aud::clamp(atoi(value), MIN_RATE, MAX_RATE);
+        else if (!strcmp(key, "channels"))
+            p.channels = aud::clamp(atoi(value), 1, AUD_MAX_CHANNELS);
+        else if (!strcmp(key, "format"))
+        {
+            for (auto &f : formats)
+                if (!strcmp(value, f.name))
+                    p.format = f.format;
+        }
+        else if (!strcmp(key, "length"))
+            p.length = aud::max(strtod(value, nullptr), 0.0);
+        else if (!strcmp(key, "level"))
+            p.level = aud::min(strtod(value, nullptr), 0.0);
+        else if (!strcmp(key, "gaps"))
+        {
+            /* gaps=ON,OFF: ON ms of signal, then OFF ms of silence */
+            char *end;
+            p.gap_on = aud::max((int)strtol(value, &end, 10), 0);
+            p.gap_off = (*end == ',') ? aud::max(atoi(end + 1), 0) : p.gap_on;
+        }
+    }
+
+    /* the frequency limits depend on the sample rate */
+    for (double freq : sines)
+        if (valid_freq(freq, p.rate))
+            p.sines.append(freq);
+
+    for (int i = p.sweeps.len(); i--;)
+    {
+        sweep_t &sw = p.sweeps[i];
+        if (!valid_freq(sw.from, p.rate) || !valid_freq(sw.to, p.rate) || sw.secs <= 0)
+            p.sweeps.remove(i, 1);
     }
 
-    return frequencies;
+    for (int i = p.impulses.len(); i--;)
+        if (!(p.impulses[i] > 0 && p.impulses[i] <= p.rate))
+            p.impulses.remove(i, 1);
+
+    return p.sources() > 0;
 }
 
-static StringBuf tone_title(const char *filename)
+static StringBuf tone_title(const tone_params_t &p)
 {
-    auto freqs = tone_filename_parse(filename);
-    if (!freqs.len())
-        return StringBuf();
+    auto title = str_copy(_("Tone Generator: "));
+    const char *sep = " ";
 
-    auto title = str_printf(_("%s %.1f Hz"), _("Tone Generator: "), freqs[0]);
-    for (int i = 1; i < freqs.len(); i++)
-        str_append_printf(title, ";%.1f Hz", freqs[i]);
+    for (double freq : p.sines)
+    {
+        str_append_printf(title, "%s%.1f Hz", sep, freq);
+        sep = ";";
+    }
+    for (auto &sw : p.sweeps)
+    {
+        str_append_printf(title, _("%ssweep %.1f-%.1f Hz"), sep, sw.from, sw.to);
+        sep = ";";
+    }
+    for (double freq : p.impulses)
+    {
+        str_append_printf(title, _("%simpulses %.1f Hz"), sep, freq);
+        sep = ";";
+    }
+    if (p.white)
+    {
+        str_append_printf(title, _("%swhite noise"), sep);
+        sep = ";";
+    }
+    if (p.pink)
+        str_append_printf(title, _("%spink noise"), sep);
 
     return title;
 }
 
-struct tone_t
+/* A sine is the imaginary part of a unit vector (c, s) rotated by (wc, ws)
+ * every sample, so each sample costs four multiplications instead of a sin().
+ * Rounding slowly changes the length of the vector; it is set back to 1
+ * after every buffer. */
+struct osc_t
 {
-    double wd;
-    unsigned period, t;
+    double c, s, wc, ws;
+
+    void set_phase(double phase)
+        { c = cos(phase); s = sin(phase); }
+    void set_freq(double w)
+        { wc = cos(w); ws = sin(w); }
+
+    double next()
+    {
+        double out = s;
+        double c2 = c * wc - s * ws;
+        s = s * wc + c * ws;
+        c = c2;
+        return out;
+    }
+
+    void normalize()
+    {
+        double g = (3 - (c * c + s * s)) / 2;
+        c *= g;
+        s *= g;
+    }
 };
 
-bool ToneGen::play(const char *filename, VFSFile &file)
+/* logarithmic sweep from sw.from to sw.to, starting over every sw.secs.
+ * The frequency is changed every SWEEP_STEP frames, to its mean over the
+ * step, so that the phase at the end of each step is exact. */
+struct sweep_state_t
 {
-    float data[BUF_SAMPLES];
+    sweep_t sw;
+    osc_t osc;
+    int64_t cycle, pos;     /* in frames */
+    double ratio;           /* frequency change per SWEEP_STEP frames */
+    double mean;            /* mean frequency of a step / frequency at its start */
+    bool set_freq;
 
-    auto frequencies = tone_filename_parse(filename);
-    if (!frequencies.len())
-        return false;
+    /* sum of ratio^i for i < n */
+    double steps(int64_t n) const
+        { return (ratio != 1) ? (pow(ratio, n) - 1) / (ratio - 1) : n; }
+
+    void init(const sweep_t &sweep, int rate, int64_t frame)
+    {
+        sw = sweep;
+        cycle = aud::max((int64_t)lround(sw.secs * rate / SWEEP_STEP), (int64_t)1) * SWEEP_STEP;
+        ratio = pow(sw.to / sw.from, (double)SWEEP_STEP / cycle);
+        mean = (ratio != 1) ? (ratio - 1) / log(ratio) : 1;
+        pos = frame % cycle;
+        set_freq = true;
 
-    set_stream_bitrate(16 * OUTPUT_FREQ);
-    open_audio(FMT_FLOAT, OUTPUT_FREQ, 1);
+        /* phase after all the complete cycles and steps so far */
+        int64_t step = pos / SWEEP_STEP;
+        double phase = SWEEP_STEP * ((frame / cycle) * steps(cycle / SWEEP_STEP) + steps(step))
+         + (pos % SWEEP_STEP) * pow(ratio, step);
 
-    Index<tone_t> tone;
-    tone.resize(frequencies.len());
-    for (int i = 0; i < frequencies.len(); i++)
+        osc.set_phase(fmod(2 * PI * sw.from * mean * phase / rate, 2 * PI));
+    }
+
+    double next(int rate)
     {
-        double f = frequencies[i];
-        tone[i].wd = 2 * PI * f / OUTPUT_FREQ;
-        tone[i].period = (INT_MAX * 2U / OUTPUT_FREQ) * (OUTPUT_FREQ / f);
-        tone[i].t = 0;
+        if (pos >= cycle)
+            pos = 0;
+
+        if (set_freq || !(pos % SWEEP_STEP))
+        {
+            osc.set_freq(2 * PI * sw.from * mean * pow(ratio, pos / SWEEP_STEP) / rate);
+            set_freq = false;
+        }
+
+        pos++;
+        return osc.next();
     }
+};
+
+/* impulses at frames round(k * period), counted from the start so that
+ * they are exact to the sample */
+struct impulse_t
+{
+    double period;
+    int64_t k, next;
+
+    void init(double freq, int rate, int64_t frame)
+    {
+        period = rate / freq;
+        k = ceil(frame / period);
+        while ((next = llround(k * period)) < frame)
+            k++;
+    }
+
+    void generate(float *mono, int64_t frame, int frames)
+    {
+        while (next < frame + frames)
+        {
+            mono[next - frame] += 1;
+            next = llround(++k * period);
+        }
+    }
+};
+
+/* xorshift32, the same sequence for the same seed */
+struct noise_t
+{
+    uint32_t x;
+    float b[7];
+
+    void init(uint32_t seed)
+    {
+        x = seed ? seed : 1;
+        memset(b, 0, sizeof b);
+    }
+
+    float white()
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return (int32_t)x * (1.0f / 2147483648.0f);
+    }
+
+    /* Paul Kellet's pink noise filter, within -1...1 */
+    float pink(float w)
+    {
+        b[0] = 0.99886f * b[0] + w * 0.0555179f;
+        b[1] = 0.99332f * b[1] + w * 0.0750759f;
+        b[2] = 0.96900f * b[2] + w * 0.1538520f;
+        b[3] = 0.86650f * b[3] + w * 0.3104856f;
+        b[4] = 0.55000f * b[4] + w * 0.5329522f;
+        b[5] = -0.7616f * b[5] - w * 0.0168980f;
+        float out = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + w * 0.5362f;
+        b[6] = w * 0.115926f;
+        return out * 0.11f;
+    }
+};
+
+struct tone_state_t
+{
+    Index<osc_t> sines;
+    Index<sweep_state_t> sweeps;
+    Index<impulse_t> impulses;
+    Index<noise_t> noise;       /* one per channel */
+
+    /* sets up all generators for the given position; noise starts over */
+    void init(const tone_params_t &p, int64_t frame)
+    {
+        sines.resize(p.sines.len());
+        for (int i = 0; i < p.sines.len(); i++)
+        {
+            double w = 2 * PI * p.sines[i] / p.rate;
+            sines[i].set_phase(fmod(w * frame, 2 * PI));
+            sines[i].set_freq(w);
+        }
+
+        sweeps.resize(p.sweeps.len());
+        for (int i = 0; i < p.sweeps.len(); i++)
+            sweeps[i].init(p.sweeps[i], p.rate, frame);
+
+        impulses.resize(p.impulses.len());
+        for (int i = 0; i < p.impulses.len(); i++)
+            impulses[i].init(p.impulses[i], p.rate, frame);
+
+        noise.resize(p.channels);
+        for (int c = 0; c < p.channels; c++)
+            noise[c].init(p.seed + 0x9e3779b9u * c);
+    }
+};
+
+/* Fills mono with the sum of the tonal generators (the same on every
+ * channel), then data with that plus noise (different on every channel). */
+static void tone_generate(const tone_params_t &p, tone_state_t &st, float gain,
+ float *mono, float *data, int64_t frame, int frames)
+{
+    for (int i = 0; i < frames; i++)
+        mono[i] = 0;
+
+    for (osc_t &osc : st.sines)
+    {
+        for (int i = 0; i < frames; i++)
+            mono[i] += osc.next();
+        osc.normalize();
+    }
+
+    for (sweep_state_t &sweep : st.sweeps)
+    {
+        for (int i = 0; i < frames; i++)
+            mono[i] += sweep.next(p.rate);
+        sweep.osc.normalize();
+    }
+
+    for (impulse_t &impulse : st.impulses)
+        impulse.generate(mono, frame, frames);
+
+    for (int c = 0; c < p.channels; c++)
+    {
+        noise_t &noise = st.noise[c];
+        float *out = data + c;
+
+        if (p.white && p.pink)
+        {
+            for (int i = 0; i < frames; i++, out += p.channels)
+                out[0] = gain * (mono[i] + noise.white() + noise.pink(noise.white()));
+        }
+        else if (p.white)
+        {
+            for (int i = 0; i < frames; i++, out += p.channels)
+                out[0] = gain * (mono[i] + noise.white());
+        }
+        else if (p.pink)
+        {
+            for (int i = 0; i < frames; i++, out += p.channels)
+                out[0] = gain * (mono[i] + noise.pink(noise.white()));
+        }
+        else
+        {
+            for (int i = 0; i < frames; i++, out += p.channels)
+                out[0] = gain * mono[i];
+        }
+    }
+}
+
+bool ToneGen::play(const char *filename, VFSFile &file)
+{
+    tone_params_t p;
+    if (!tone_filename_parse(filename, p))
+        return false;
+
+    int samples = BUF_FRAMES * p.channels;
+    Index<float> mono, data;
+    Index<char> out;
+
+    mono.resize(BUF_FRAMES);
+    data.resize(samples);
+    if (p.format != FMT_FLOAT)
+        out.resize(FMT_SIZEOF(p.format) * samples);
+
+    /* dithering can cause a little bit of clipping */
+    float gain = 0.999 * pow(10, p.level / 20) / p.sources();
+
+    int64_t frame = 0;
+    int64_t end = p.length ? (int64_t)(p.length * p.rate) : -1;
+    int64_t gap_on = (int64_t)p.gap_on * p.rate / 1000;
+    int64_t gap_cycle = (p.gap_on && p.gap_off) ? gap_on + (int64_t)p.gap_off * p.rate / 1000 : 0;
+
+    tone_state_t st;
+    st.init(p, frame);
+
+    set_stream_bitrate(8 * FMT_SIZEOF(p.format) * p.channels * p.rate);
+    open_audio(p.format, p.rate, p.channels);
 
     while (!check_stop())
     {
-        for (int i = 0; i < BUF_SAMPLES; i++)
+        int seek_value = check_seek();
+        if (seek_value >= 0)
+        {
+            frame = (int64_t)seek_value * p.rate / 1000;
+            st.init(p, frame);
+        }
+
+        int frames = BUF_FRAMES;
+        if (end >= 0)
         {
-            double sum_sines = 0;
+            if (frame >= end)
+                break;
+            frames = aud::min((int64_t)frames, end - frame);
+        }
+
+        tone_generate(p, st, gain, mono.begin(), data.begin(), frame, frames);
 
-            for (int j = 0; j < frequencies.len(); j++)
-            {
-                sum_sines += sin(tone[j].wd * tone[j].t);
-                if (tone[j].t > tone[j].period)
-                    tone[j].t -= tone[j].period;
-                tone[j].t++;
-            }
-            /* dithering can cause a little bit of clipping */
-            data[i] = (sum_sines * 0.999 / (double)frequencies.len());
+        if (gap_cycle)
+        {
+            for (int i = 0; i < frames; i++)
+                if ((frame + i) % gap_cycle >= gap_on)
+                    memset(&data[i * p.channels], 0, p.channels * sizeof(float));
         }
 
-        write_audio(data, BUF_BYTES);
+        frame += frames;
+
+        if (p.format == FMT_FLOAT)
+            write_audio(data.begin(), frames * p.channels * sizeof(float));
+        else
+        {
+            audio_to_int(data.begin(), out.begin(), p.format, frames * p.channels);
+            write_audio(out.begin(), FMT_SIZEOF(p.format) * frames * p.channels);
+        }
     }
 
     return true;
@@ -148,12 +526,16 @@ bool ToneGen::play(const char *filename, VFSFile &file)
 
 bool ToneGen::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
-    StringBuf title = tone_title(filename);
-    if (!title)
+    tone_params_t p;
+    if (!tone_filename_parse(filename, p))
         return false;
 
-    tuple.set_str(Tuple::Title, title);
-    tuple.set_int(Tuple::Channels, 1);
+    tuple.set_str(Tuple::Title, tone_title(p));
+    tuple.set_int(Tuple::Channels, p.channels);
+
+    if (p.length)
+        tuple.set_int(Tuple::Length, p.length * 1000);
+
     return true;
 }
 
@@ -161,6 +543,11 @@ const char ToneGen::about[] =
  N_("Sine tone generator by Håvard Kvålen <havardk@xmms.org>\n"
     "Modified by Daniel J. Peng <danielpeng@bigfoot.com>\n\n"
     "To use it, add a URL: tone://frequency1;frequency2;frequency3;...\n"
-    "e.g. tone://2000;2005 to play a 2000 Hz tone and a 2005 Hz tone");
+    "e.g. tone://2000;2005 to play a 2000 Hz tone and a 2005 Hz tone\n\n"
+    "More signals: sweep=20-20000:10 (log sweep, seconds), white, pink,\n"
+    "impulse=1 (per second), seed=N (noise)\n"
+    "Output: rate=48000, channels=2, format=float|s8|u8|s16|s24|s32,\n"
+    "length=60 (seconds), level=-6 (dBFS), gaps=500,250 (ms on, off)\n"
+    "e.g. tone://pink;channels=6;rate=96000;format=s24;length=600");
 
 const char *const ToneGen::schemes[] = {"tone", nullptr};
@@ -1,9 +1,12 @@
 /* AY/YM emulator implementation. */
 
 #include <inttypes.h>
+#include <math.h>
+#include <string.h>
 #include "ayemu.h"
 
 #include <libaudcore/runtime.h>
+#include <libaudcore/templates.h>
 
 const char *ayemu_err;
 
@@ -119,6 +122,59 @@ static void gen_env()
 }
 
 
+/* step kernels, one per position of the step within a sample
+    (will calculated by gen_kernels()) */
+static int bKernelsInit = 0;
+static int BoxKernel [AYEMU_PHASES][AYEMU_BLEP_TAPS];
+static int BlepKernel [AYEMU_PHASES][AYEMU_BLEP_TAPS];
+
+/* make step kernels.  The box kernel averages the chip output over each
+    sample, as sampling it at every chip tick did.  The band-limited kernel is
+    the difference of a band-limited step (a windowed sinc, integrated) from
+    sample to sample; it delays the output by 7 samples.  The taps of each
+    kernel add up exactly to 1 << AYEMU_DELTA_SHIFT, so that the running sum
+    of the differences comes back to the chip output without drifting.
+    Will execute once before first use. */
+static void gen_kernels()
+{
+  const double cutoff = 0.45;	/* of the output sample rate */
+  const int center = AYEMU_BLEP_TAPS / 2 - 1;
+  const int one = 1 << AYEMU_DELTA_SHIFT;
+  int phase, tap, k;
+
+  for (phase = 0; phase < AYEMU_PHASES; phase++) {
+    double offset = (double) phase / AYEMU_PHASES;
+    double taps[AYEMU_BLEP_TAPS], sum = 0;
+    int isum = 0, peak = 0;
+
+    BoxKernel[phase][1] = phase * one / AYEMU_PHASES;
+    BoxKernel[phase][0] = one - BoxKernel[phase][1];
+
+    for (tap = 0; tap < AYEMU_BLEP_TAPS; tap++) {
+      /* integrate the impulse response over one sample */
+      taps[tap] = 0;
+      for (k = 0; k < 16; k++) {
+	double t = tap - 1 - center - offset + (k + 0.5) / 16;
+	double x = 2 * cutoff * t;
+	double w = (fabs(t) < center + 1) ?
+	  0.42 + 0.5 * cos(M_PI * t / (center + 1)) + 0.08 * cos(2 * M_PI * t / (center + 1)) : 0;
+	taps[tap] += 2 * cutoff * (x ? sin(M_PI * x) / (M_PI * x) : 1) * w / 16;
+      }
+      sum += taps[tap];
+    }
+
+    for (tap = 0; tap < AYEMU_BLEP_TAPS; tap++) {
+      BlepKernel[phase][tap] = lrint(taps[tap] / sum * one);
+      isum += BlepKernel[phase][tap];
+      if (BlepKernel[phase][tap] > BlepKernel[phase][peak])
+	peak = tap;
+    }
+    BlepKernel[phase][peak] += one - isum;
+  }
+  bKernelsInit = 1;
+}
+
+
 /**
  * \retval ayemu_init none.
  *
@@ -145,9 +201,16 @@ void ayemu_reset(ayemu_ay_t *ay)
   if (!check_magic(ay)) return;
 
   ay->cnt_a = ay->cnt_b = ay->cnt_c = ay->cnt_n = ay->cnt_e = 0;
+  ay->per_a = ay->per_b = ay->per_c = ay->per_n = ay->per_e = 1;
   ay->bit_a = ay->bit_b = ay->bit_c = ay->bit_n = 0;
   ay->env_pos = ay->EnvNum = 0;
   ay->Cur_Seed = 0xffff;
+
+  ay->tick_pos = 0;
+  ay->out_l = ay->out_r = 0;
+  ay->acc_l = ay->acc_r = 0;
+  memset(ay->delta_l, 0, sizeof(ay->delta_l));
+  memset(ay->delta_r, 0, sizeof(ay->delta_r));
 }
 
 
@@ -304,6 +367,19 @@ int ayemu_set_stereo(ayemu_ay_t *ay, ayemu_stereo_t stereo_type, int *custom_eq)
 }
 
 
+/** Select band-limited synthesis (1) or the box filter (0).
+ *
+ * Band-limited synthesis removes the aliasing of high tones and noise;
+ * the box filter sounds like the original libayemu.
+ */
+void ayemu_set_blep(ayemu_ay_t *ay, int enable)
+{
+  if (!check_magic(ay)) return;
+
+  ay->blep = enable;
+}
+
+
 #define WARN_IF_REGISTER_GREAT_THAN(r,m) \
 if (*(regs + r) > m) \
    AUDWARN("possible bad register data- R%d > %d\n", r, m)
@@ -346,6 +422,14 @@ void ayemu_set_regs(ayemu_ay_t *ay, unsigned char *regs)
   ay->regs.env_c = regs[10] & 0x10;
   ay->regs.env_freq = regs[11] + (regs[12] << 8);
 
+  /* a generator steps when its counter reaches the period; period 0 steps
+     on every tick, just like period 1 */
+  ay->per_a = ay->regs.tone_a ? ay->regs.tone_a : 1;
+  ay->per_b = ay->regs.tone_b ? ay->regs.tone_b : 1;
+  ay->per_c = ay->regs.tone_c ? ay->regs.tone_c : 1;
+  ay->per_n = ay->regs.noise ? ay->regs.noise * 2 : 1;
+  ay->per_e = ay->regs.env_freq ? ay->regs.env_freq : 1;
+
   if (regs[13] != 0xff) {                   /* R13 = 255 means continue curent envelop */
     ay->regs.env_style = regs[13] & 0x0f;
     ay->env_pos = ay->cnt_e = 0;
@@ -361,36 +445,155 @@ static void prepare_generation(ayemu_ay_t *ay)
 
   if (!bEnvGenInit) gen_env ();
 
+  if (!bKernelsInit) gen_kernels ();
+
   if (ay->default_chip_flag) ayemu_set_chip_type(ay, AYEMU_AY, nullptr);
 
   if (ay->default_stereo_flag) ayemu_set_stereo(ay, AYEMU_ABC, nullptr);
 
   if (ay->default_sound_format_flag) ayemu_set_sound_format(ay, 44100, 2, 16);
 
-  ay->ChipTacts_per_outcount = ay->ChipFreq / ay->sndfmt.freq / 8;
+  /* the loudest output of all channels together is AYEMU_MAX_AMP */
+  max_l = (ay->table[31] * ay->eq[0] + ay->table[31] * ay->eq[2] + ay->table[31] * ay->eq[3]) / 100;
+  max_r = (ay->table[31] * ay->eq[1] + ay->table[31] * ay->eq[3] + ay->table[31] * ay->eq[5]) / 100;
+  vol = (max_l > max_r) ? max_l : max_r;  // =157283 on all defaults
+  if (vol < 1)
+    vol = 1;
 
   {  /* GenVols */
     int n, m;
-    int vol;
     for (n = 0; n < 32; n++) {
-      vol = ay->table[n];
       for (m=0; m < 6; m++)
-	ay->vols[m][n] = (int) (((double) vol * ay->eq[m]) / 100);
+	ay->vols[m][n] = (int) ((double) ay->table[n] * ay->eq[m] / 100 * AYEMU_MAX_AMP / vol);
     }
   }
 
-  /* ������ ����������������� ����
-     �������� ���vols [x][31] ���������������     TODO: �������� � ��;-)
-  */
-  max_l = ay->vols[0][31] + ay->vols[2][31] + ay->vols[3][31];
-  max_r = ay->vols[1][31] + ay->vols[3][31] + ay->vols[5][31];
-  vol = (max_l > max_r) ? max_l : max_r;  // =157283 on all defaults
-  ay->Amp_Global = ay->ChipTacts_per_outcount *vol / AYEMU_MAX_AMP;
-
+  ay->tick_pos = 0;
   ay->dirty = 0;
 }
 
 
+/* output of the chip for the current state of the generators */
+static inline void mix_output(ayemu_ay_t *ay, int *l, int *r)
+{
+  int env = Envelope [ay->regs.env_style][ay->env_pos];
+  int tmpvol;
+  int mix_l = 0, mix_r = 0;
+
+  if ((ay->bit_a | !ay->regs.R7_tone_a) & (ay->bit_n | !ay->regs.R7_noise_a)) {
+    tmpvol = (ay->regs.env_a)? env : ay->regs.vol_a * 2 + 1;
+    mix_l += ay->vols[0][tmpvol];
+    mix_r += ay->vols[1][tmpvol];
+  }
+
+  if ((ay->bit_b | !ay->regs.R7_tone_b) & (ay->bit_n | !ay->regs.R7_noise_b)) {
+    tmpvol =(ay->regs.env_b)? env :  ay->regs.vol_b * 2 + 1;
+    mix_l += ay->vols[2][tmpvol];
+    mix_r += ay->vols[3][tmpvol];
+  }
+
+  if ((ay->bit_c | !ay->regs.R7_tone_c) & (ay->bit_n | !ay->regs.R7_noise_c)) {
+    tmpvol = (ay->regs.env_c)? env : ay->regs.vol_c * 2 + 1;
+    mix_l += ay->vols[4][tmpvol];
+    mix_r += ay->vols[5][tmpvol];
+  }
+
+  *l = mix_l;
+  *r = mix_r;
+}
+
+/* ticks until the counter reaches its period, at least 1 */
+static inline int ticks_left(int cnt, int per)
+{
+  return (cnt < per) ? per - cnt : 1;
+}
+
+/* Run the chip for one block of snd_numcount samples.
+ * Only the ticks at which some generator steps are visited; in between,
+ * all counters are advanced at once.  Where the output changes, the
+ * difference is added to the delta buffers.
+ */
+static void render_block(ayemu_ay_t *ay, int snd_numcount)
+{
+  /* time is counted in 1/ChipFreq of a sample; the generators are clocked
+     at ChipFreq / 8, so a tick is 8 * freq of these units */
+  const int64_t tick = (int64_t) 8 * ay->sndfmt.freq;
+  const int64_t end = (int64_t) snd_numcount * ay->ChipFreq;
+  const int (*kernel)[AYEMU_BLEP_TAPS] = ay->blep ? BlepKernel : BoxKernel;
+  const int taps = ay->blep ? AYEMU_BLEP_TAPS : AYEMU_BOX_TAPS;
+  int64_t t = ay->tick_pos;
+
+  while (t < end) {
+    int64_t remain = (end - t + tick - 1) / tick;
+    int n, l, r;
+
+    n = ticks_left(ay->cnt_a, ay->per_a);
+    n = aud::min(n, ticks_left(ay->cnt_b, ay->per_b));
+    n = aud::min(n, ticks_left(ay->cnt_c, ay->per_c));
+    n = aud::min(n, ticks_left(ay->cnt_n, ay->per_n));
+    n = aud::min(n, ticks_left(ay->cnt_e, ay->per_e));
+
+    if (n > remain) {		/* nothing happens until the end of the block */
+      ay->cnt_a += remain;
+      ay->cnt_b += remain;
+      ay->cnt_c += remain;
+      ay->cnt_n += remain;
+      ay->cnt_e += remain;
+      t += remain * tick;
+      break;
+    }
+
+    t += (n - 1) * tick;
+
+    if ((ay->cnt_a += n) >= ay->per_a) {
+      ay->cnt_a = 0;
+      ay->bit_a = ! ay->bit_a;
+    }
+    if ((ay->cnt_b += n) >= ay->per_b) {
+      ay->cnt_b = 0;
+      ay->bit_b = ! ay->bit_b;
+    }
+    if ((ay->cnt_c += n) >= ay->per_c) {
+      ay->cnt_c = 0;
+      ay->bit_c = ! ay->bit_c;
+    }
+
+    /* GenNoise (c) Hacker KAY & Sergey Bulba */
+    if ((ay->cnt_n += n) >= ay->per_n) {
+      ay->cnt_n = 0;
+      ay->Cur_Seed = ((ay->Cur_Seed * 2 + 1) ^ \
+	(((ay->Cur_Seed >> 16) ^ (ay->Cur_Seed >> 13)) & 1)) & 0x1ffff;
+      ay->bit_n = ((ay->Cur_Seed >> 16) & 1);
+    }
+
+    if ((ay->cnt_e += n) >= ay->per_e) {
+      ay->cnt_e = 0;
+      if (++ay->env_pos > 127)
+	ay->env_pos = 64;
+    }
+
+    mix_output(ay, &l, &r);
+
+    if (l != ay->out_l || r != ay->out_r) {
+      int pos = t / ay->ChipFreq;
+      const int *k = kernel[(t % ay->ChipFreq) * AYEMU_PHASES / ay->ChipFreq];
+      int dl = l - ay->out_l, dr = r - ay->out_r;
+
+      for (int i = 0; i < taps; i++) {
+	ay->delta_l[pos + i] += dl * k[i];
+	ay->delta_r[pos + i] += dr * k[i];
+      }
+
+      ay->out_l = l;
+      ay->out_r = r;
+    }
+
+    t += tick;
+  }
+
+  ay->tick_pos = t - end;
+}
+
 /*! Generate sound.
  * Fill sound buffer with current register data
  * Return value: pointer to next data in output sound buffer
@@ -398,9 +601,6 @@ static void prepare_generation(ayemu_ay_t *ay)
  */
 void *ayemu_gen_sound(ayemu_ay_t *ay, void *buff, size_t sound_bufsize)
 {
-  int mix_l, mix_r;
-  int tmpvol;
-  int m;
   int snd_numcount;
   unsigned char *sound_buf = (unsigned char *) buff;
 
@@ -410,75 +610,38 @@ void *ayemu_gen_sound(ayemu_ay_t *ay, void *buff, size_t sound_bufsize)
   prepare_generation(ay);
 
   snd_numcount = sound_bufsize / (ay->sndfmt.channels * (ay->sndfmt.bpc >> 3));
-  while (snd_numcount-- > 0) {
-    mix_l = mix_r = 0;
-
-    for (m = 0 ; m < ay->ChipTacts_per_outcount ; m++) {
-      if (++ay->cnt_a >= ay->regs.tone_a) {
-	ay->cnt_a = 0;
-	ay->bit_a = ! ay->bit_a;
-      }
-      if (++ay->cnt_b >= ay->regs.tone_b) {
-	ay->cnt_b = 0;
-	ay->bit_b = ! ay->bit_b;
-      }
-      if (++ay->cnt_c >= ay->regs.tone_c) {
-	ay->cnt_c = 0;
-	ay->bit_c = ! ay->bit_c;
-      }
-
-      /* GenNoise (c) Hacker KAY & Sergey Bulba */
-      if (++ay->cnt_n >= (ay->regs.noise * 2)) {
-	ay->cnt_n = 0;
-	ay->Cur_Seed = (ay->Cur_Seed * 2 + 1) ^ \
-	  (((ay->Cur_Seed >> 16) ^ (ay->Cur_Seed >> 13)) & 1);
-	ay->bit_n = ((ay->Cur_Seed >> 16) & 1);
-      }
-
-      if (++ay->cnt_e >= ay->regs.env_freq) {
-	ay->cnt_e = 0;
-	if (++ay->env_pos > 127)
-	  ay->env_pos = 64;
+  while (snd_numcount > 0) {
+    int block = aud::min(snd_numcount, AYEMU_BLOCK);
+
+    render_block(ay, block);
+
+    for (int i = 0; i < block; i++) {
+      ay->acc_l += ay->delta_l[i];
+      ay->acc_r += ay->delta_r[i];
+
+      int mix_l = aud::clamp(ay->acc_l >> AYEMU_DELTA_SHIFT, -32768, 32767);
+      int mix_r = aud::clamp(ay->acc_r >> AYEMU_DELTA_SHIFT, -32768, 32767);
+
+      if (ay->sndfmt.bpc == 8) {
+	*sound_buf++ = (mix_l >> 8) + 128; /* 8 bit sound */
+	if (ay->sndfmt.channels != 1)
+	  *sound_buf++ = (mix_r >> 8) + 128;
+      } else {
+	int16_t *p = (int16_t *) sound_buf; /* 16 bit sound */
+	*p++ = mix_l;
+	if (ay->sndfmt.channels != 1)
+	  *p++ = mix_r;
+	sound_buf = (unsigned char *) p;
       }
+    }
 
-#define ENVVOL Envelope [ay->regs.env_style][ay->env_pos]
+    /* keep the tails of the kernels for the next block */
+    memmove(ay->delta_l, ay->delta_l + block, AYEMU_BLEP_TAPS * sizeof(int32_t));
+    memmove(ay->delta_r, ay->delta_r + block, AYEMU_BLEP_TAPS * sizeof(int32_t));
+    memset(ay->delta_l + AYEMU_BLEP_TAPS, 0, block * sizeof(int32_t));
+    memset(ay->delta_r + AYEMU_BLEP_TAPS, 0, block * sizeof(int32_t));
 
-      if ((ay->bit_a | !ay->regs.R7_tone_a) & (ay->bit_n | !ay->regs.R7_noise_a)) {
-	tmpvol = (ay->regs.env_a)? ENVVOL : ay->regs.vol_a * 2 + 1;
-	mix_l += ay->vols[0][tmpvol];
-	mix_r += ay->vols[1][tmpvol];
-      }
-
-      if ((ay->bit_b | !ay->regs.R7_tone_b) & (ay->bit_n | !ay->regs.R7_noise_b)) {
-	tmpvol =(ay->regs.env_b)? ENVVOL :  ay->regs.vol_b * 2 + 1;
-	mix_l += ay->vols[2][tmpvol];
-	mix_r += ay->vols[3][tmpvol];
-      }
-
-      if ((ay->bit_c | !ay->regs.R7_tone_c) & (ay->bit_n | !ay->regs.R7_noise_c)) {
-	tmpvol = (ay->regs.env_c)? ENVVOL : ay->regs.vol_c * 2 + 1;
-	mix_l += ay->vols[4][tmpvol];
-	mix_r += ay->vols[5][tmpvol];
-      }
-    } /* end for (m=0; ...) */
-
-    mix_l /= ay->Amp_Global;
-    mix_r /= ay->Amp_Global;
-
-    if (ay->sndfmt.bpc == 8) {
-      mix_l = (mix_l >> 8) | 128; /* 8 bit sound */
-      mix_r = (mix_r >> 8) | 128;
-      *sound_buf++ = mix_l;
-      if (ay->sndfmt.channels != 1)
-	*sound_buf++ = mix_r;
-    } else {
-      *sound_buf++ = mix_l & 0x00FF; /* 16 bit sound */
-      *sound_buf++ = (mix_l >> 8);
-      if (ay->sndfmt.channels != 1) {
-	*sound_buf++ = mix_r & 0x00FF;
-	*sound_buf++ = (mix_r >> 8);
-      }
-    }
+    snd_numcount -= block;
   }
   return sound_buf;
 }
@@ -62,6 +62,20 @@ typedef struct
 ayemu_regdata_t;
 
 
+/** Block rendering parameters \internal
+ *
+ * Sound is rendered in blocks of up to #AYEMU_BLOCK samples.  Every change
+ * of the chip output is added as a step to a buffer of differences, either
+ * spread over two samples (AYEMU_BOX_TAPS) or, with band-limited synthesis,
+ * over AYEMU_BLEP_TAPS samples; the buffer is summed up at the end of the block.
+ */
+#define AYEMU_BLOCK 1024
+#define AYEMU_BOX_TAPS 2
+#define AYEMU_BLEP_TAPS 16
+#define AYEMU_PHASES 64		/**< step positions per sample */
+#define AYEMU_DELTA_SHIFT 14	/**< fixed point bits of step kernels */
+
+
 /** Output sound format \internal */
 typedef struct
 {
@@ -108,13 +122,27 @@ typedef struct
   int cnt_c;			/**< back counter of C */
   int cnt_n;			/**< back counter of noise generator */
   int cnt_e;			/**< back counter of envelop generator */
-  int ChipTacts_per_outcount;   /**< chip's counts per one sound signal count */
-  int Amp_Global;		/**< scale factor for amplitude */
-  int vols[6][32];              /**< stereo type (channel volumes) and chip table.
+  int per_a;			/**< period of A in chip ticks (at least 1) */
+  int per_b;			/**< period of B in chip ticks */
+  int per_c;			/**< period of C in chip ticks */
+  int per_n;			/**< period of noise generator in chip ticks */
+  int per_e;			/**< period of envelop generator in chip ticks */
+  int vols[6][32];              /**< stereo type (channel volumes) and chip table,
+				   scaled to output amplitude.
 				   This cache calculated by #table and #eq  */
   int EnvNum;		        /**< number of current envilopment (0...15) */
   int env_pos;			/**< current position in envelop (0...127) */
   int Cur_Seed;		        /**< random numbers counter */
+
+  int blep;			/**< band-limited synthesis instead of box filter */
+  int64_t tick_pos;		/**< position of next chip tick in current block,
+				   in 1/ChipFreq of a sample */
+  int out_l;			/**< current output of the chip, left */
+  int out_r;			/**< current output of the chip, right */
+  int32_t acc_l;		/**< sum of differences so far, left */
+  int32_t acc_r;		/**< sum of differences so far, right */
+  int32_t delta_l[AYEMU_BLOCK + AYEMU_BLEP_TAPS]; /**< differences, left */
+  int32_t delta_r[AYEMU_BLOCK + AYEMU_BLEP_TAPS]; /**< differences, right */
 }
 ayemu_ay_t;
 
@@ -136,6 +164,9 @@ ayemu_set_stereo(ayemu_ay_t *ay, ayemu_stereo_t stereo, int *custom_eq);
 EXTERN int
 ayemu_set_sound_format (ayemu_ay_t *ay, int freq, int chans, int bits);
 
+EXTERN void
+ayemu_set_blep(ayemu_ay_t *ay, int enable);
+
 EXTERN void
 ayemu_set_regs (ayemu_ay_t *ay, unsigned char *regs);
 
@@ -63,11 +63,21 @@ struct ayemu_vtx_t
    */
   bool load_data(VFSFile &file);
 
+  /** Get 14-bytes frame of AY register data by number.
+   * \return Return value: true if success, false if no such frame.
+   */
+  bool get_frame(int frame, unsigned char *regs);
+
   /** Get next 14-bytes frame of AY register data.
    * \return Return value: true if success, false if not enough data.
    */
   bool get_next_frame(unsigned char *regs);
 
+  /** Get envelope shape (R13) in effect at the given frame.
+   * \return Return value: the shape, or 255 if none was set before.
+   */
+  int env_shape_at(int frame);
+
   /** Print formatted file name. If fmt is nullptr the default format %a - %t will be used
    * \return none.
    */
@@ -23,6 +23,7 @@
 #include <libaudcore/audstrings.h>
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
+#include <libaudcore/preferences.h>
 #include <libaudcore/runtime.h>
 
 #include "vtx.h"
@@ -33,16 +34,21 @@ class VTXPlugin : public InputPlugin
 public:
     static const char about[];
     static const char *const exts[];
+    static const char *const defaults[];
+    static const PreferencesWidget widgets[];
+    static const PluginPreferences prefs;
 
     static constexpr PluginInfo info = {
         N_("VTX Decoder"),
         PACKAGE,
-        about
+        about,
+        &prefs
     };
 
     constexpr VTXPlugin() : InputPlugin(info, InputInfo()
         .with_exts(exts)) {}
 
+    bool init();
     bool is_our_file(const char *filename, VFSFile &file);
     bool read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image);
     bool play(const char *filename, VFSFile &file);
@@ -55,14 +61,25 @@ public:
 
 EXPORT VTXPlugin aud_plugin_instance;
 
-#define SNDBUFSIZE 1024
-static char sndbuf[SNDBUFSIZE];
-static int freq = 44100;
+#define CFG_ID "vtx"
+
 static int chans = 2;
 static int bits = 16;
 
 const char *const VTXPlugin::exts[] = { "vtx", nullptr };
 
+const char *const VTXPlugin::defaults[] = {
+    "sample_rate", "44100",
+    "blep", "TRUE",
+    nullptr
+};
+
+bool VTXPlugin::init()
+{
+    aud_config_set_defaults(CFG_ID, defaults);
+    return true;
+}
+
 bool VTXPlugin::is_our_file(const char *filename, VFSFile &file)
 {
     char buf[2];
@@ -81,7 +98,8 @@ bool VTXPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Inde
     tuple.set_str(Tuple::Artist, tmp.hdr.author);
     tuple.set_str(Tuple::Title, tmp.hdr.title);
 
-    tuple.set_int(Tuple::Length, tmp.hdr.regdata_size / 14 * 1000 / 50);
+    if (tmp.hdr.playerFreq > 0)
+        tuple.set_int(Tuple::Length, tmp.hdr.regdata_size / 14 * 1000 / tmp.hdr.playerFreq);
 
     tuple.set_str(Tuple::Genre, (tmp.hdr.chiptype == AYEMU_AY) ? "AY chiptunes" : "YM chiptunes");
     tuple.set_str(Tuple::Album, tmp.hdr.from);
@@ -101,16 +119,10 @@ bool VTXPlugin::play(const char *filename, VFSFile &file)
     ayemu_ay_t ay;
     ayemu_vtx_t vtx;
 
-    bool eof = false;
-    void *stream;               /* pointer to current position in sound buffer */
     unsigned char regs[14];
-    int need;
-    int left;                   /* how many sound frames can play with current AY register frame */
-    int donow;
-    int rate;
-
-    left = 0;
-    rate = chans * (bits / 8);
+    int freq = aud_get_int(CFG_ID, "sample_rate");
+    int rate = chans * (bits / 8);
+    bool seeked = false;
 
     memset(&ay, 0, sizeof(ay));
 
@@ -124,56 +136,74 @@ bool VTXPlugin::play(const char *filename, VFSFile &file)
         AUDERR("Error read vtx data from %s\n", filename);
         return false;
     }
+    else if (vtx.hdr.playerFreq <= 0)
+    {
+        AUDERR("Bad player frequency in %s\n", filename);
+        return false;
+    }
+
+    freq = aud::clamp(freq, 8000, 192000);
 
     ayemu_init(&ay);
     ayemu_set_chip_type(&ay, vtx.hdr.chiptype, nullptr);
     ayemu_set_chip_freq(&ay, vtx.hdr.chipFreq);
     ayemu_set_stereo(&ay, (ayemu_stereo_t) vtx.hdr.stereo, nullptr);
+    ayemu_set_sound_format(&ay, freq, chans, bits);
+    ayemu_set_blep(&ay, aud_get_bool(CFG_ID, "blep"));
 
-    set_stream_bitrate(14 * 50 * 8);
+    /* one AY register frame at a time */
+    Index<char> sndbuf;
+    sndbuf.resize((freq / vtx.hdr.playerFreq + 1) * rate);
+
+    set_stream_bitrate(14 * vtx.hdr.playerFreq * 8);
     open_audio(FMT_S16_NE, freq, chans);
 
-    while (!check_stop() && !eof)
+    while (!check_stop())
     {
-        /* (time in sec) * 50 = offset in AY register data frames */
+        /* (time in ms) * playerFreq / 1000 = offset in AY register data frames */
         int seek_value = check_seek();
         if (seek_value >= 0)
-            vtx.pos = seek_value / 20;
-
-        /* fill sound buffer */
-        stream = sndbuf;
-
-        for (need = SNDBUFSIZE / rate; need > 0; need -= donow)
         {
-            if (left > 0)
-            {                   /* use current AY register frame */
-                donow = (need > left) ? left : need;
-                left -= donow;
-                stream = ayemu_gen_sound(&ay, (char *)stream, donow * rate);
-            }
-            else
-            {                   /* get next AY register frame */
-                if (!vtx.get_next_frame(regs))
-                {
-                    donow = need;
-                    memset(stream, 0, donow * rate);
-                    eof = true;
-                }
-                else
-                {
-                    left = freq / vtx.hdr.playerFreq;
-                    ayemu_set_regs(&ay, regs);
-                    donow = 0;
-                }
-            }
+            vtx.pos = (int64_t) seek_value * vtx.hdr.playerFreq / 1000;
+            seeked = true;
         }
 
-        write_audio(sndbuf, SNDBUFSIZE);
+        if (!vtx.get_next_frame(regs))
+            break;
+
+        /* the envelope shape is only written when it changes */
+        if (seeked && regs[13] == 0xff)
+            regs[13] = vtx.env_shape_at(vtx.pos - 1);
+
+        seeked = false;
+        ayemu_set_regs(&ay, regs);
+
+        /* count samples from the start, so that rounding doesn't add up */
+        int64_t start = (int64_t) (vtx.pos - 1) * freq / vtx.hdr.playerFreq;
+        int64_t end = (int64_t) vtx.pos * freq / vtx.hdr.playerFreq;
+        int bytes = (end - start) * rate;
+
+        ayemu_gen_sound(&ay, sndbuf.begin(), bytes);
+        write_audio(sndbuf.begin(), bytes);
     }
 
     return true;
 }
 
+static const ComboItem sample_rates[] = {
+    ComboItem(N_("44100 Hz"), 44100),
+    ComboItem(N_("48000 Hz"), 48000),
+    ComboItem(N_("96000 Hz"), 96000),
+    ComboItem(N_("192000 Hz"), 192000)
+};
+
+const PreferencesWidget VTXPlugin::widgets[] = {
+    WidgetCombo(N_("Sample rate:"), WidgetInt(CFG_ID, "sample_rate"), {{sample_rates}}),
+    WidgetCheck(N_("Band-limited synthesis (less aliasing)"), WidgetBool(CFG_ID, "blep"))
+};
+
+const PluginPreferences VTXPlugin::prefs = {{widgets}};
+
 const char VTXPlugin::about[] =
  N_("Vortex file format player by Sashnov Alexander <sashnov@ngs.ru>\n"
     "Based on in_vtx.dll by Roman Sherbakov <v_soft@microfor.ru>\n"
@@ -133,22 +133,53 @@ bool ayemu_vtx_t::load_data(VFSFile &file)
   return true;
 }
 
+/** Get 14-bytes frame of AY register data by number.
+ *
+ * The data is stored register by register: first R0 of all frames, then R1...
+ * Return value: true if success, false if no such frame.
+ */
+bool ayemu_vtx_t::get_frame(int frame, unsigned char *regs)
+{
+  int numframes = hdr.regdata_size / 14;
+  if (frame < 0 || frame >= numframes)
+    return false;
+
+  const unsigned char *p = &regdata[frame];
+  for (int n = 0 ; n < 14 ; n++, p += numframes)
+    regs[n] = *p;
+  return true;
+}
+
 /** Get next 14-bytes frame of AY register data.
  *
  * Return value: true if success, false if not enough data.
  */
 bool ayemu_vtx_t::get_next_frame(unsigned char *regs)
+{
+  if (!get_frame(pos, regs))
+    return false;
+
+  pos++;
+  return true;
+}
+
+/** Find the envelope shape (R13) in effect at the given frame.
+ *
+ * R13 = 255 in a frame keeps the shape of an earlier frame.
+ * Return value: the shape, or 255 if none was set before.
+ */
+int ayemu_vtx_t::env_shape_at(int frame)
 {
   int numframes = hdr.regdata_size / 14;
-  if (pos++ >= numframes)
-    return 0;
-  else {
-    int n;
-    unsigned char *p = &regdata[pos];
-    for(n = 0 ; n < 14 ; n++, p+=numframes)
-      regs[n] = *p;
-    return 1;
+  if (frame >= numframes)
+    frame = numframes - 1;
+
+  for (; frame >= 0; frame--) {
+    unsigned char r13 = regdata[13 * numframes + frame];
+    if (r13 != 0xff)
+      return r13;
   }
+  return 0xff;
 }
 
 /** Print formatted file name. If fmt is nullptr the default format %a - %t will be used
@@ -25,8 +25,6 @@
 #include "NDSSystem.h"
 
 // ========================================================= IPC FIFO
-IPC_FIFO ipc_fifo[2]; // 0 - ARM9, 1 - ARM7
-
 void IPC_FIFOinit(uint8_t proc)
 {
 	memset(&ipc_fifo[proc], 0, sizeof(IPC_FIFO));
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "types.h"
+#include "NDSInstance.h"
 
 //=================================================== IPC FIFO
 struct IPC_FIFO
@@ -31,7 +32,7 @@ struct IPC_FIFO
 	uint8_t size;
 };
 
-extern IPC_FIFO ipc_fifo[2];
+#define ipc_fifo (nds_instance->ipc_fifos) // 0 - ARM9, 1 - ARM7
 extern void IPC_FIFOinit(uint8_t proc);
 extern void IPC_FIFOsend(uint8_t proc, uint32_t val);
 extern uint32_t IPC_FIFOrecv(uint8_t proc);
@@ -64,60 +64,6 @@ static uint64_t isqrt(uint64_t x)
 	return root;
 }
 
-uint32_t partie = 1;
-uint32_t _MMU_MAIN_MEM_MASK = 0x3FFFFF;
-uint32_t _MMU_MAIN_MEM_MASK16 = 0x3FFFFF & ~1;
-uint32_t _MMU_MAIN_MEM_MASK32 = 0x3FFFFF & ~3;
-
-MMU_struct MMU;
-MMU_struct_new MMU_new;
-MMU_struct_timing MMU_timing;
-
-uint8_t *MMU_struct::MMU_MEM[2][256] =
-{
-	//arm9
-	{
-		/* 0X*/	DUP16(MMU.ARM9_ITCM),
-		/* 1X*/	//DUP16(MMU.ARM9_ITCM)
-		/* 1X*/	DUP16(MMU.UNUSED_RAM),
-		/* 2X*/	DUP16(MMU.MAIN_MEM),
-		/* 3X*/	DUP16(MMU.SWIRAM),
-		/* 4X*/	DUP16(MMU.ARM9_REG),
-		/* 5X*/	DUP16(MMU.ARM9_VMEM),
-		/* 6X*/	DUP16(MMU.ARM9_LCD),
-		/* 7X*/	DUP16(MMU.ARM9_OAM),
-		/* 8X*/	DUP16(nullptr),
-		/* 9X*/	DUP16(nullptr),
-		/* AX*/	DUP16(MMU.UNUSED_RAM),
-		/* BX*/	DUP16(MMU.UNUSED_RAM),
-		/* CX*/	DUP16(MMU.UNUSED_RAM),
-		/* DX*/	DUP16(MMU.UNUSED_RAM),
-		/* EX*/	DUP16(MMU.UNUSED_RAM),
-		/* FX*/	DUP16(MMU.ARM9_BIOS)
-	},
-	//arm7
-	{
-		/* 0X*/	DUP16(MMU.ARM7_BIOS),
-		/* 1X*/	DUP16(MMU.UNUSED_RAM),
-		/* 2X*/	DUP16(MMU.MAIN_MEM),
-		/* 3X*/	DUP8(MMU.SWIRAM),
-				DUP8(MMU.ARM7_ERAM),
-		/* 4X*/	DUP8(MMU.ARM7_REG),
-				DUP8(MMU.ARM7_WIRAM),
-		/* 5X*/	DUP16(MMU.UNUSED_RAM),
-		/* 6X*/	DUP16(MMU.ARM9_LCD),
-		/* 7X*/	DUP16(MMU.UNUSED_RAM),
-		/* 8X*/	DUP16(nullptr),
-		/* 9X*/	DUP16(nullptr),
-		/* AX*/	DUP16(MMU.UNUSED_RAM),
-		/* BX*/	DUP16(MMU.UNUSED_RAM),
-		/* CX*/	DUP16(MMU.UNUSED_RAM),
-		/* DX*/	DUP16(MMU.UNUSED_RAM),
-		/* EX*/	DUP16(MMU.UNUSED_RAM),
-		/* FX*/	DUP16(MMU.UNUSED_RAM)
-	}
-};
-
 uint32_t MMU_struct::MMU_MASK[2][256] =
 {
 	//arm9
@@ -173,15 +119,8 @@ uint32_t MMU_struct::MMU_MASK[2][256] =
 // for all of the below, values = 41 indicate unmapped memory
 static const uint8_t VRAM_PAGE_UNMAPPED = 41;
 
-static const unsigned VRAM_LCDC_PAGES = 41;
-static uint8_t vram_lcdc_map[VRAM_LCDC_PAGES];
-
-// in the range of 0x06000000 - 0x06800000 in 16KB pages (the ARM9 vram mappable area)
-// this maps to 16KB pages in the LCDC buffer which is what will actually contain the data
-uint8_t vram_arm9_map[VRAM_ARM9_PAGES];
-
-// this chooses which banks are mapped in the 128K banks starting at 0x06000000 in ARM7
-static uint8_t vram_arm7_map[2];
+#define vram_lcdc_map (nds_instance->vram->lcdc_map)
+#define vram_arm7_map (nds_instance->vram->arm7_map)
 
 struct TVramBankInfo
 {
@@ -328,8 +267,6 @@ static inline uint32_t MMU_LCDmap(int PROCNUM, uint32_t addr, bool &unmapped, bo
 		return LCDC_HACKY_LOCATION + (vram_page << 14) + ofs;
 }
 
-VramConfiguration vramConfiguration;
-
 // maps the specified bank to LCDC
 static inline void MMU_vram_lcdc(int bank)
 {
@@ -672,7 +609,7 @@ static inline void MMU_VRAMmapControl(uint8_t block, uint8_t VRAMBankCnt)
 	MMU_VRAMmapRefreshBank(VRAM_BANK_D);
 
 	//fprintf(stderr, vramConfiguration.describe().c_str());
-	//fprintf(stderr, "vram remapped at vcount=%d\n",nds.VCount);
+	//fprintf(stderr, "vram remapped at vcount=%d\n",NDS_system.VCount);
 
 	// -------------------------------
 	// set up arm9 mirrorings
@@ -715,7 +652,53 @@ static inline void MMU_VRAMmapControl(uint8_t block, uint8_t VRAMBankCnt)
 
 void MMU_Init()
 {
+	uint8_t *const mem[2][256] =
+	{
+		//arm9
+		{
+			/* 0X*/	DUP16(MMU.ARM9_ITCM),
+			/* 1X*/	//DUP16(MMU.ARM9_ITCM)
+			/* 1X*/	DUP16(MMU.UNUSED_RAM),
+			/* 2X*/	DUP16(MMU.MAIN_MEM),
+			/* 3X*/	DUP16(MMU.SWIRAM),
+			/* 4X*/	DUP16(MMU.ARM9_REG),
+			/* 5X*/	DUP16(MMU.ARM9_VMEM),
+			/* 6X*/	DUP16(MMU.ARM9_LCD),
+			/* 7X*/	DUP16(MMU.ARM9_OAM),
+			/* 8X*/	DUP16(nullptr),
+			/* 9X*/	DUP16(nullptr),
+			/* AX*/	DUP16(MMU.UNUSED_RAM),
+			/* BX*/	DUP16(MMU.UNUSED_RAM),
+			/* CX*/	DUP16(MMU.UNUSED_RAM),
+			/* DX*/	DUP16(MMU.UNUSED_RAM),
+			/* EX*/	DUP16(MMU.UNUSED_RAM),
+			/* FX*/	DUP16(MMU.ARM9_BIOS)
+		},
+		//arm7
+		{
+			/* 0X*/	DUP16(MMU.ARM7_BIOS),
+			/* 1X*/	DUP16(MMU.UNUSED_RAM),
+			/* 2X*/	DUP16(MMU.MAIN_MEM),
+			/* 3X*/	DUP8(MMU.SWIRAM),
+					DUP8(MMU.ARM7_ERAM),
+			/* 4X*/	DUP8(MMU.ARM7_REG),
+					DUP8(MMU.ARM7_WIRAM),
+			/* 5X*/	DUP16(MMU.UNUSED_RAM),
+			/* 6X*/	DUP16(MMU.ARM9_LCD),
+			/* 7X*/	DUP16(MMU.UNUSED_RAM),
+			/* 8X*/	DUP16(nullptr),
+			/* 9X*/	DUP16(nullptr),
+			/* AX*/	DUP16(MMU.UNUSED_RAM),
+			/* BX*/	DUP16(MMU.UNUSED_RAM),
+			/* CX*/	DUP16(MMU.UNUSED_RAM),
+			/* DX*/	DUP16(MMU.UNUSED_RAM),
+			/* EX*/	DUP16(MMU.UNUSED_RAM),
+			/* FX*/	DUP16(MMU.UNUSED_RAM)
+		}
+	};
+
 	memset((void*)&MMU, 0, sizeof(MMU_struct));
+	memcpy(MMU.MMU_MEM, mem, sizeof(mem));
 
 	MMU.CART_ROM = MMU.UNUSED_RAM;
 
@@ -736,6 +719,9 @@ void MMU_Init()
 void MMU_DeInit()
 {
 	mc_free(&MMU.fw);
+#ifndef ARMCPU_NO_BLOCK_CACHE
+	armcpu_flushCodeBlocks();
+#endif
 }
 
 void MMU_Reset()
@@ -757,6 +743,10 @@ void MMU_Reset()
 	memset(MMU.ARM7_WIRAM, 0, sizeof(MMU.ARM7_WIRAM));
 	memset(MMU.SWIRAM, 0, sizeof(MMU.SWIRAM));
 
+#ifndef ARMCPU_NO_BLOCK_CACHE
+	armcpu_flushCodeBlocks();
+#endif
+
 	IPC_FIFOinit(ARMCPU_ARM9);
 	IPC_FIFOinit(ARMCPU_ARM7);
 
@@ -829,6 +819,24 @@ void MMU_Reset()
 	MMU_timing.arm9dataCache.Reset();
 }
 
+void MMU_State(NDSState &state)
+{
+	state.ioSparse(&MMU, sizeof(MMU_struct));
+	// backupDevice is left alone; it owns heap memory and 2SF playback never touches it
+	state.io(MMU_new.dma);
+	state.io(MMU_new.gxstat);
+	state.io(MMU_new.sqrt);
+	state.io(MMU_new.div);
+	state.io(MMU_new.dsi_tsc);
+	state.io(MMU_timing);
+	state.io(partie);
+	state.io(vramConfiguration);
+	state.io(vram_lcdc_map);
+	state.io(vram_arm9_map);
+	state.io(vram_arm7_map);
+	state.io(ipc_fifo, 2 * sizeof(IPC_FIFO));
+}
+
 void SetupMMU(bool debugConsole, bool dsi)
 {
 	if (debugConsole)
@@ -1182,7 +1190,7 @@ static inline uint16_t read_timer(int proc, int timerIndex)
 		return MMU.timer[proc][timerIndex];
 
 	// for unchained timers, we do not keep the timer up to date. its value will need to be calculated here
-	int32_t diff = (nds.timerCycle[proc][timerIndex] - nds_timer) & 0xFFFFFFFF;
+	int32_t diff = (NDS_system.timerCycle[proc][timerIndex] - nds_timer) & 0xFFFFFFFF;
 	assert(diff >= 0);
 	if (diff < 0)
 		fprintf(stderr, "NEW EMULOOP BAD NEWS PLEASE REPORT: TIME READ DIFF < 0 (%d) (%d) (%d)\n", diff, timerIndex, MMU.timerMODE[proc][timerIndex]);
@@ -1233,7 +1241,7 @@ static inline void write_timer(int proc, int timerIndex, uint16_t val)
 	}
 
 	int remain = 65536 - MMU.timerReload[proc][timerIndex];
-	nds.timerCycle[proc][timerIndex] = nds_timer + (remain << MMU.timerMODE[proc][timerIndex]);
+	NDS_system.timerCycle[proc][timerIndex] = nds_timer + (remain << MMU.timerMODE[proc][timerIndex]);
 
 	T1WriteWord(MMU.MMU_MEM[proc][0x40], 0x102 + timerIndex * 4, val);
 	NDS_RescheduleTimers();
@@ -1251,7 +1259,7 @@ uint32_t TGXSTAT::read32()
 
 	ret |= (this->gxfifo_irq & 0x3) << 30; // user's irq flags
 
-	//fprintf(stderr, "vc=%03d Returning gxstat read: %08X\n",nds.VCount,ret);
+	//fprintf(stderr, "vc=%03d Returning gxstat read: %08X\n",NDS_system.VCount,ret);
 
 	return ret;
 }
@@ -1361,7 +1369,7 @@ void DmaController::exec()
 
 	// we'll need to unfreeze the arm9 bus now
 	if (this->procnum == ARMCPU_ARM9)
-		nds.freezeBus &= ~(1 << (this->chan + 1));
+		NDS_system.freezeBus &= ~(1 << (this->chan + 1));
 
 	this->dmaCheck = false;
 
@@ -1421,7 +1429,7 @@ template<int PROCNUM> void DmaController::doCopy()
 		todo = 128; // this is a hack. maybe an alright one though. it should be 4 words at a time. this is a whole scanline
 
 		// apparently this dma turns off after it finishes a frame
-		if (nds.VCount == 191)
+		if (NDS_system.VCount == 191)
 			this->enable = 0;
 	}
 	if (this->startmode == EDMAMode_Card)
@@ -1594,6 +1602,7 @@ void FASTCALL _MMU_ARM9_write08(uint32_t adr, uint8_t val)
 
 	if (adr < 0x02000000)
 	{
+		MMU_codeWrite(MMU_CODE_PAGE_ITCM + ((adr & 0x7FFF) >> MMU_CODE_PAGE_SHIFT));
 		T1WriteByte(MMU.ARM9_ITCM, adr & 0x7FFF, val);
 		return;
 	}
@@ -1686,6 +1695,7 @@ void FASTCALL _MMU_ARM9_write16(uint32_t adr, uint16_t val)
 
 	if (adr < 0x02000000)
 	{
+		MMU_codeWrite(MMU_CODE_PAGE_ITCM + ((adr & 0x7FFF) >> MMU_CODE_PAGE_SHIFT));
 		T1WriteWord(MMU.ARM9_ITCM, adr & 0x7FFF, val);
 		return;
 	}
@@ -1824,6 +1834,7 @@ void FASTCALL _MMU_ARM9_write32(uint32_t adr, uint32_t val)
 
 	if (adr < 0x02000000)
 	{
+		MMU_codeWrite(MMU_CODE_PAGE_ITCM + ((adr & 0x7FFF) >> MMU_CODE_PAGE_SHIFT));
 		T1WriteLong(MMU.ARM9_ITCM, adr & 0x7FFF, val);
 		return;
 	}
@@ -2113,11 +2124,11 @@ uint32_t FASTCALL _MMU_ARM9_read32(uint32_t adr)
 		switch (adr)
 		{
 			case REG_DSIMODE:
-				if (!nds.Is_DSI())
+				if (!NDS_system.Is_DSI())
 					break;
 				return 1;
 			case 0x04004008:
-				if (!nds.Is_DSI())
+				if (!NDS_system.Is_DSI())
 					break;
 				return 0x8000;
 
@@ -2243,6 +2254,8 @@ void FASTCALL _MMU_ARM7_write08(uint32_t adr, uint8_t val)
 	}
 
 	// Removed the &0xFF as they are implicit with the adr&0x0FFFFFFF [shash]
+	if ((adr & 0x0F800000) == 0x03800000)
+		MMU_codeWrite(MMU_CODE_PAGE_ERAM + ((adr & 0xFFFF) >> MMU_CODE_PAGE_SHIFT));
 	MMU.MMU_MEM[ARMCPU_ARM7][adr >> 20][adr & MMU.MMU_MASK[ARMCPU_ARM7][adr >> 20]] = val;
 }
 
@@ -2275,13 +2288,13 @@ void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val)
 		switch (adr)
 		{
 			case REG_DISPA_VCOUNT:
-				if (nds.VCount >= 202 && nds.VCount <= 212)
+				if (NDS_system.VCount >= 202 && NDS_system.VCount <= 212)
 				{
-					fprintf(stderr, "VCOUNT set to %i (previous value %i)\n", val, nds.VCount);
-					nds.VCount = val;
+					fprintf(stderr, "VCOUNT set to %i (previous value %i)\n", val, NDS_system.VCount);
+					NDS_system.VCount = val;
 				}
 				else
-					fprintf(stderr, "Attempt to set VCOUNT while not within 202-212 (%i), ignored\n", nds.VCount);
+					fprintf(stderr, "Attempt to set VCOUNT while not within 202-212 (%i), ignored\n", NDS_system.VCount);
 				return;
 
 			case REG_EXMEMCNT:
@@ -2347,7 +2360,7 @@ void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val)
 								if (MMU.powerMan_Reg[0] & PM_SYSTEM_PWR)
 								{
 									fprintf(stderr, "SYSTEM POWERED OFF VIA ARM7 SPI POWER DEVICE\n");
-									execute = false;
+									NDS_execute = false;
 								}
 							}
 
@@ -2367,7 +2380,7 @@ void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val)
 
 					case 2:
 					{
-						if (nds.Is_DSI())
+						if (NDS_system.Is_DSI())
 						{
 							// pass data to TSC
 							val = MMU_new.dsi_tsc.write16(val);
@@ -2539,6 +2552,8 @@ void FASTCALL _MMU_ARM7_write16(uint32_t adr, uint16_t val)
 	}
 
 	// Removed the &0xFF as they are implicit with the adr&0x0FFFFFFF [shash]
+	if ((adr & 0x0F800000) == 0x03800000)
+		MMU_codeWrite(MMU_CODE_PAGE_ERAM + ((adr & 0xFFFF) >> MMU_CODE_PAGE_SHIFT));
 	T1WriteWord(MMU.MMU_MEM[ARMCPU_ARM7][adr >> 20], adr & MMU.MMU_MASK[ARMCPU_ARM7][adr >> 20], val);
 }
 
@@ -2619,6 +2634,8 @@ void FASTCALL _MMU_ARM7_write32(uint32_t adr, uint32_t val)
 	}
 
 	// Removed the &0xFF as they are implicit with the adr&0x0FFFFFFF [shash]
+	if ((adr & 0x0F800000) == 0x03800000)
+		MMU_codeWrite(MMU_CODE_PAGE_ERAM + ((adr & 0xFFFF) >> MMU_CODE_PAGE_SHIFT));
 	T1WriteLong(MMU.MMU_MEM[ARMCPU_ARM7][adr >> 20], adr & MMU.MMU_MASK[ARMCPU_ARM7][adr >> 20], val);
 }
 
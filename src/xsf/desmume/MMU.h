@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include "NDSInstance.h"
 #include "FIFO.h"
+#include "instructions.h"
 #include "mem.h"
 #include "registers.h"
 #include "mc.h"
@@ -358,7 +360,7 @@ struct MMU_struct
 	// (also since the emulator doesn't prevent unaligned accesses)
 	uint8_t MORE_UNUSED_RAM[4];
 
-	static uint8_t *MMU_MEM[2][256];
+	uint8_t *MMU_MEM[2][256];
 	static uint32_t MMU_MASK[2][256];
 
 	uint8_t ARM9_RW_MODE;
@@ -444,13 +446,14 @@ struct MMU_struct_new
 	bool is_dma(uint32_t adr) { return adr >= _REG_DMA_CONTROL_MIN && adr <= _REG_DMA_CONTROL_MAX; }
 };
 
-extern MMU_struct MMU;
-extern MMU_struct_new MMU_new;
+#define MMU (*nds_instance->mmu)
+#define MMU_new (*nds_instance->mmu_new)
 
 void MMU_Init();
 void MMU_DeInit();
 
 void MMU_Reset();
+void MMU_State(NDSState &state);
 
 void MMU_setRom(uint8_t *rom, uint32_t mask);
 void MMU_unsetRom();
@@ -507,10 +510,23 @@ struct VramConfiguration
 	}
 };
 
-extern VramConfiguration vramConfiguration;
-
 const int VRAM_ARM9_PAGES = 512;
-extern uint8_t vram_arm9_map[VRAM_ARM9_PAGES];
+const unsigned VRAM_LCDC_PAGES = 41;
+
+// Which VRAM banks are mapped where. Everything is mapped through to ARM9_LCD in blocks of 16KB;
+// the maps hold pages of the LCDC buffer, which is what actually contains the data.
+struct MMU_struct_vram
+{
+	VramConfiguration config;
+	uint8_t lcdc_map[VRAM_LCDC_PAGES];
+	// in the range of 0x06000000 - 0x06800000 in 16KB pages (the ARM9 vram mappable area)
+	uint8_t arm9_map[VRAM_ARM9_PAGES];
+	// which banks are mapped in the 128K banks starting at 0x06000000 in ARM7
+	uint8_t arm7_map[2];
+};
+
+#define vramConfiguration (nds_instance->vram->config)
+#define vram_arm9_map (nds_instance->vram->arm9_map)
 
 template<int PROCNUM, MMU_ACCESS_TYPE AT> uint8_t _MMU_read08(uint32_t addr);
 template<int PROCNUM, MMU_ACCESS_TYPE AT> uint16_t _MMU_read16(uint32_t addr);
@@ -540,13 +556,51 @@ uint8_t  FASTCALL _MMU_ARM7_read08(uint32_t adr);
 uint16_t FASTCALL _MMU_ARM7_read16(uint32_t adr);
 uint32_t FASTCALL _MMU_ARM7_read32(uint32_t adr);
 
-extern uint32_t partie;
+#define partie (nds_instance->tsc_partie)
 
-extern uint32_t _MMU_MAIN_MEM_MASK;
-extern uint32_t _MMU_MAIN_MEM_MASK16;
-extern uint32_t _MMU_MAIN_MEM_MASK32;
+#define _MMU_MAIN_MEM_MASK (nds_instance->main_mem_mask)
+#define _MMU_MAIN_MEM_MASK16 (nds_instance->main_mem_mask16)
+#define _MMU_MAIN_MEM_MASK32 (nds_instance->main_mem_mask32)
 void SetupMMU(bool debugConsole, bool dsi);
 
+// the ARM block caches (see armcpu.cc) keep decoded instructions for code run from main memory,
+// ITCM and the ARM7 exclusive WRAM, in 1KB pages numbered by their offset into that memory.
+// every write into those areas has to go through MMU_codeWrite so the pages it touches get dropped.
+#define MMU_CODE_PAGE_SHIFT 10
+enum
+{
+	MMU_CODE_PAGE_MAIN = 0,
+	MMU_CODE_PAGE_ITCM = MMU_CODE_PAGE_MAIN + (sizeof(MMU_struct::MAIN_MEM) >> MMU_CODE_PAGE_SHIFT),
+	MMU_CODE_PAGE_ERAM = MMU_CODE_PAGE_ITCM + (sizeof(MMU_struct::ARM9_ITCM) >> MMU_CODE_PAGE_SHIFT),
+	MMU_CODE_PAGES = MMU_CODE_PAGE_ERAM + (sizeof(MMU_struct::ARM7_ERAM) >> MMU_CODE_PAGE_SHIFT)
+};
+
+#ifndef ARMCPU_NO_BLOCK_CACHE
+template<int SIZE> struct armcpu_codeblock;
+
+struct armcpu_codecache
+{
+	uint8_t pageUsed[MMU_CODE_PAGES];
+	armcpu_codeblock<4> *armBlocks[2][MMU_CODE_PAGES];
+	armcpu_codeblock<2> *thumbBlocks[2][MMU_CODE_PAGES];
+
+	// handler of the prefetched instruction
+	OpFunc op[2];
+};
+
+#define armcpu_codePageUsed (nds_instance->code_cache->pageUsed)
+void armcpu_invalidateCodePage(uint32_t page);
+void armcpu_flushCodeBlocks();
+#endif
+
+inline void MMU_codeWrite(uint32_t page)
+{
+#ifndef ARMCPU_NO_BLOCK_CACHE
+	if (armcpu_codePageUsed[page])
+		armcpu_invalidateCodePage(page);
+#endif
+}
+
 // ALERT!!!!!!!!!!!!!!
 // the following inline functions dont do the 0x0FFFFFFF mask.
 // this may result in some unexpected behavior
@@ -697,6 +751,7 @@ inline void _MMU_write08(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint8_t
 
 	if ((addr & 0x0F000000) == 0x02000000)
 	{
+		MMU_codeWrite(MMU_CODE_PAGE_MAIN + ((addr & _MMU_MAIN_MEM_MASK) >> MMU_CODE_PAGE_SHIFT));
 		T1WriteByte( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK, val);
 #ifdef HAVE_LUA
 		CallRegisteredLuaMemHook(addr, 1, val, LUAMEMHOOK_WRITE);
@@ -735,6 +790,7 @@ inline void _MMU_write16(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint16_
 
 	if ((addr & 0x0F000000) == 0x02000000)
 	{
+		MMU_codeWrite(MMU_CODE_PAGE_MAIN + ((addr & _MMU_MAIN_MEM_MASK16) >> MMU_CODE_PAGE_SHIFT));
 		T1WriteWord( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK16, val);
 #ifdef HAVE_LUA
 		CallRegisteredLuaMemHook(addr, 2, val, LUAMEMHOOK_WRITE);
@@ -773,6 +829,7 @@ inline void _MMU_write32(int PROCNUM, MMU_ACCESS_TYPE AT, uint32_t addr, uint32_
 
 	if ((addr & 0x0F000000) == 0x02000000)
 	{
+		MMU_codeWrite(MMU_CODE_PAGE_MAIN + ((addr & _MMU_MAIN_MEM_MASK32) >> MMU_CODE_PAGE_SHIFT));
 		T1WriteLong( MMU.MAIN_MEM, addr & _MMU_MAIN_MEM_MASK32, val);
 #ifdef HAVE_LUA
 		CallRegisteredLuaMemHook(addr, 4, val, LUAMEMHOOK_WRITE);
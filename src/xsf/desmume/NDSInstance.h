@@ -0,0 +1,157 @@
+/*
+	This file is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 2 of the License, or
+	(at your option) any later version.
+
+	This file is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with the this software.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct MMU_struct;
+struct MMU_struct_new;
+struct MMU_struct_timing;
+struct MMU_struct_vram;
+struct IPC_FIFO;
+struct armcpu_codecache;
+struct armcpu_t;
+struct armcp15_t;
+struct NDSSystem;
+struct Sequencer;
+struct GameInfo;
+struct TCommonSettings;
+class SPU_struct;
+struct SPU_struct_output;
+class SampleCache;
+class FrameRing;
+
+// One emulated DS.
+//
+// The emulator code still refers to the machine by the names it had as globals (MMU, NDS_ARM9,
+// CommonSettings...); those are macros that go through nds_instance, the instance bound to the
+// calling thread, so several machines can run at the same time on different threads. Globals whose
+// names were ordinary words (nds, execute, sequencer, cp15) are reached as NDS_system, NDS_execute,
+// NDS_sequencer and NDS_cp15 instead, so that the macros cannot capture unrelated identifiers. Everything
+// lives in blocks owned by the instance; the only thread-local storage is nds_instance itself, which
+// keeps the plugin loadable with dlopen(). An instance must stay on the thread it was bound to.
+struct NDSInstance
+{
+	NDSInstance();
+	~NDSInstance();
+
+	// MMU.h
+	MMU_struct *mmu;
+	MMU_struct_new *mmu_new;
+	MMU_struct_timing *mmu_timing;
+	uint32_t main_mem_mask;
+	uint32_t main_mem_mask16;
+	uint32_t main_mem_mask32;
+	armcpu_codecache *code_cache;
+	MMU_struct_vram *vram;
+	uint32_t tsc_partie;
+
+	// FIFO.h
+	IPC_FIFO *ipc_fifos;
+
+	// armcpu.h, cp15.h
+	armcpu_t *arm9;
+	armcpu_t *arm7;
+	armcp15_t *arm9_cp15;
+
+	// NDSSystem.h
+	NDSSystem *system;
+	Sequencer *hw_sequencer;
+	uint64_t timer;
+	uint64_t arm9_timer;
+	uint64_t arm7_timer;
+	volatile bool running;
+	GameInfo *game_info;
+	TCommonSettings *settings;
+
+	// SPU.h
+	SPU_struct *spu;
+	SPU_struct_output *spu_output;
+	SampleCache *sample_cache;
+
+	// sndif2sf.h
+	FrameRing *sndif_ring;
+	uint32_t sndif_buffer_bytes;
+
+	NDSInstance(const NDSInstance &) = delete;
+	NDSInstance &operator=(const NDSInstance &) = delete;
+};
+
+// The emulated CPUs go through this pointer for nearly every register and memory access. With GCC,
+// __thread avoids the initialisation check C++ puts around each use of an extern thread_local, and
+// a single pointer is small enough for the initial-exec model even in a dlopen()ed plugin, which
+// saves a __tls_get_addr call per access.
+#if defined(__GNUC__)
+# define NDS_THREAD_LOCAL __thread
+#else
+# define NDS_THREAD_LOCAL thread_local
+#endif
+#if defined(__GLIBC__) && defined(__GNUC__)
+# define NDS_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+# define NDS_TLS_MODEL
+#endif
+
+extern NDS_THREAD_LOCAL NDSInstance *nds_instance NDS_TLS_MODEL;
+
+// Binds an instance to the calling thread for the lifetime of the binding, then restores whatever
+// was bound before, so no path out of the scope leaves nds_instance pointing at a dead instance.
+class NDSInstanceBinding
+{
+public:
+	explicit NDSInstanceBinding(NDSInstance &instance) : previous(nds_instance) { nds_instance = &instance; }
+	~NDSInstanceBinding() { nds_instance = this->previous; }
+
+	NDSInstanceBinding(const NDSInstanceBinding &) = delete;
+	NDSInstanceBinding &operator=(const NDSInstanceBinding &) = delete;
+
+private:
+	NDSInstance *previous;
+};
+
+// Saves or restores the state of the bound instance for seek snapshots. Every module hands the
+// memory holding its state to io(); a loading NDSState walks the same sequence of calls and copies
+// the blocks back. Pointers (and vtables) are kept as they are, so a snapshot can only be restored
+// into the instance that took it.
+class NDSState
+{
+public:
+	NDSState(std::vector<uint8_t> &buf, bool loading) : buf(buf), pos(0), loading(loading) { }
+
+	bool isLoading() const { return this->loading; }
+
+	void io(void *ptr, size_t size)
+	{
+		if (this->loading)
+			memcpy(ptr, &this->buf[this->pos], size);
+		else
+			this->buf.insert(this->buf.end(), (uint8_t *)ptr, (uint8_t *)ptr + size);
+
+		this->pos += size;
+	}
+
+	template<typename T> void io(T &val) { this->io(&val, sizeof(val)); }
+
+	// for large, mostly empty blocks: only the 4KB pages that are not all zero are stored
+	void ioSparse(void *ptr, size_t size);
+
+private:
+	std::vector<uint8_t> &buf;
+	size_t pos;
+	bool loading;
+};
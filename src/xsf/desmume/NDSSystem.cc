@@ -23,25 +23,20 @@
 #include <zlib.h>
 #include "NDSSystem.h"
 #include "MMU.h"
+#include "MMU_timing.h"
 #include "cp15.h"
 #include "bios.h"
 #include "readwrite.h"
 #include "firmware.h"
 #include "slot1.h"
+#include "../sndif2sf.h"
 
 // ===============================================================
 
-TCommonSettings CommonSettings;
-
-GameInfo gameInfo;
-NDSSystem nds;
-static std::unique_ptr<CFIRMWARE> firmware;
-volatile bool execute = false;
-
 int NDS_Init()
 {
 	MMU_Init();
-	nds.VCount = 0;
+	NDS_system.VCount = 0;
 
 	armcpu_new(&NDS_ARM7, 1);
 	armcpu_new(&NDS_ARM9, 0);
@@ -140,15 +135,15 @@ void NDS_FreeROM()
 	MMU_unsetRom();
 }
 
-void NDS_Sleep() { nds.sleeping = true; }
+void NDS_Sleep() { NDS_system.sleeping = true; }
 
 enum ESI_DISPCNT
 {
 	ESI_DISPCNT_HStart, ESI_DISPCNT_HStartIRQ, ESI_DISPCNT_HDraw, ESI_DISPCNT_HBlank
 };
 
-uint64_t nds_timer;
-static uint64_t nds_arm9_timer, nds_arm7_timer;
+#define nds_arm9_timer (nds_instance->arm9_timer)
+#define nds_arm7_timer (nds_instance->arm7_timer)
 
 struct TSequenceItem
 {
@@ -173,7 +168,7 @@ template<int procnum, int num> struct TSequenceItem_Timer : public TSequenceItem
 {
 	bool isTriggered() const
 	{
-		return this->enabled && nds_timer >= nds.timerCycle[procnum][num];
+		return this->enabled && nds_timer >= NDS_system.timerCycle[procnum][num];
 	}
 
 	void schedule()
@@ -183,7 +178,7 @@ template<int procnum, int num> struct TSequenceItem_Timer : public TSequenceItem
 
 	uint64_t next() const
 	{
-		return nds.timerCycle[procnum][num];
+		return NDS_system.timerCycle[procnum][num];
 	}
 
 	void exec()
@@ -211,9 +206,9 @@ template<int procnum, int num> struct TSequenceItem_Timer : public TSequenceItem
 				over = true;
 				int remain = 65536 - MMU.timerReload[procnum][i];
 				int ctr = 0;
-				while (nds.timerCycle[procnum][i] <= nds_timer)
+				while (NDS_system.timerCycle[procnum][i] <= nds_timer)
 				{
-					nds.timerCycle[procnum][i] += remain << MMU.timerMODE[procnum][i];
+					NDS_system.timerCycle[procnum][i] += remain << MMU.timerMODE[procnum][i];
 					++ctr;
 				}
 #ifndef NDEBUG
@@ -318,7 +313,7 @@ struct TSequenceItem_sqrtunit : public TSequenceItem
 	}
 };
 
-static struct Sequencer
+struct Sequencer
 {
 	bool nds_vblankEnded;
 	bool reschedule;
@@ -340,11 +335,13 @@ static struct Sequencer
 
 	void execHardware();
 	uint64_t findNext();
-} sequencer;
+};
+
+#define NDS_sequencer (*nds_instance->hw_sequencer)
 
 void NDS_RescheduleTimers()
 {
-#define check(X, Y) sequencer.timer_##X##_##Y .schedule();
+#define check(X, Y) NDS_sequencer.timer_##X##_##Y .schedule();
 	check(0, 0); check(0, 1); check(0, 2); check(0, 3);
 	check(1, 0); check(1, 1); check(1, 2); check(1, 3);
 #undef check
@@ -360,13 +357,13 @@ void NDS_RescheduleDMA()
 
 static void initSchedule()
 {
-	sequencer.init();
+	NDS_sequencer.init();
 
 	// begin at the very end of the last scanline
 	// so that at t=0 we can increment to scanline=0
-	nds.VCount = 262;
+	NDS_system.VCount = 262;
 
-	sequencer.nds_vblankEnded = false;
+	NDS_sequencer.nds_vblankEnded = false;
 }
 
 // 2196372 ~= (ARM7_CLOCK << 16) / 1000000
@@ -408,7 +405,7 @@ static void execHardware_hblank()
 	// by drawing scanline N at the end of drawing time (but before subsequent interrupt or hdma-driven events happen)
 	// don't try to do this at the end of the scanline, because some games (sonic classics) may use hblank IRQ to set
 	// scroll regs for the next scanline
-	if (nds.VCount < 192)
+	if (NDS_system.VCount < 192)
 		// trigger hblank dmas
 		// but notice, we do that just after we finished drawing the line
 		// (values copied by this hdma should not be used until the next scanline)
@@ -431,8 +428,8 @@ static void execHardware_hblank()
 
 static void execHardware_hstart_vblankEnd()
 {
-	sequencer.nds_vblankEnded = true;
-	sequencer.reschedule = true;
+	NDS_sequencer.nds_vblankEnded = true;
+	NDS_sequencer.reschedule = true;
 
 	// turn off vblank status bit
 	T1WriteWord(MMU.ARM9_REG, 4, T1ReadWord(MMU.ARM9_REG, 4) & ~1);
@@ -480,7 +477,7 @@ static void execHardware_hstart_vcount_irq()
 static void execHardware_hstart_vcount()
 {
 	uint16_t vmatch = execHardware_gen_vmatch_goal();
-	if (nds.VCount == vmatch)
+	if (NDS_system.VCount == vmatch)
 	{
 		// arm9 vmatch
 		T1WriteWord(MMU.ARM9_REG, 4, T1ReadWord(MMU.ARM9_REG, 4) | 4);
@@ -492,7 +489,7 @@ static void execHardware_hstart_vcount()
 
 	vmatch = T1ReadWord(MMU.ARM7_REG, 4);
 	vmatch = (vmatch >> 8) | ((vmatch << 1) & (1 << 8));
-	if (nds.VCount == vmatch)
+	if (NDS_system.VCount == vmatch)
 	{
 		// arm7 vmatch
 		T1WriteWord(MMU.ARM7_REG, 4, T1ReadWord(MMU.ARM7_REG, 4) | 4);
@@ -510,8 +507,8 @@ static void execHardware_hstart_irq()
 	// 100% accurate emulation would require the read of VCOUNT to be in the pipeline already with the irq coming in behind it, thus
 	// allowing the vcount to register as 192 occasionally (maybe about 1 out of 28 frames)
 	// the actual length of the delay is in execHardware() where the events are scheduled
-	sequencer.reschedule = true;
-	if (nds.VCount == 192)
+	NDS_sequencer.reschedule = true;
+	if (NDS_system.VCount == 192)
 		// when the vcount hits 192, vblank begins
 		execHardware_hstart_vblankStart();
 
@@ -520,15 +517,15 @@ static void execHardware_hstart_irq()
 
 static void execHardware_hstart()
 {
-	++nds.VCount;
+	++NDS_system.VCount;
 
-	if (nds.VCount == 263)
+	if (NDS_system.VCount == 263)
 		// when the vcount hits 263 it rolls over to 0
-		nds.VCount = 0;
-	if (nds.VCount == 262)
+		NDS_system.VCount = 0;
+	if (NDS_system.VCount == 262)
 		// when the vcount hits 262, vblank ends (oam pre-renders by one scanline)
 		execHardware_hstart_vblankEnd();
-	else if (nds.VCount == 192)
+	else if (NDS_system.VCount == 192)
 	{
 		// turn on vblank status bit
 		T1WriteWord(MMU.ARM9_REG, 4, T1ReadWord(MMU.ARM9_REG, 4) | 1);
@@ -542,10 +539,10 @@ static void execHardware_hstart()
 	}
 
 	// write the new vcount
-	T1WriteWord(MMU.ARM9_REG, 6, nds.VCount & 0xFFFF);
-	T1WriteWord(MMU.ARM9_REG, 0x1006, nds.VCount & 0xFFFF);
-	T1WriteWord(MMU.ARM7_REG, 6, nds.VCount & 0xFFFF);
-	T1WriteWord(MMU.ARM7_REG, 0x1006, nds.VCount & 0xFFFF);
+	T1WriteWord(MMU.ARM9_REG, 6, NDS_system.VCount & 0xFFFF);
+	T1WriteWord(MMU.ARM9_REG, 0x1006, NDS_system.VCount & 0xFFFF);
+	T1WriteWord(MMU.ARM7_REG, 6, NDS_system.VCount & 0xFFFF);
+	T1WriteWord(MMU.ARM7_REG, 0x1006, NDS_system.VCount & 0xFFFF);
 
 	// turn off hblank status bit
 	T1WriteWord(MMU.ARM9_REG, 4, T1ReadWord(MMU.ARM9_REG, 4) & 0xFFFD);
@@ -557,7 +554,7 @@ static void execHardware_hstart()
 	// trigger hstart dmas
 	triggerDma(EDMAMode_HStart);
 
-	if (nds.VCount < 192)
+	if (NDS_system.VCount < 192)
 		// this is hacky.
 		// there is a corresponding hack in doDMA.
 		// it should be driven by a fifo (and generate just in time as the scanline is displayed)
@@ -568,7 +565,7 @@ static void execHardware_hstart()
 
 void NDS_Reschedule()
 {
-	sequencer.reschedule = true;
+	NDS_sequencer.reschedule = true;
 }
 
 static inline uint64_t _fast_min(uint64_t a, uint64_t b)
@@ -697,11 +694,11 @@ template<bool doarm9, bool doarm7>
 static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t s32next, int32_t arm9, int32_t arm7)
 {
 	int32_t timer = minarmtime<doarm9, doarm7>(arm9, arm7);
-	while (timer < s32next && !sequencer.reschedule && execute)
+	while (timer < s32next && !NDS_sequencer.reschedule && NDS_execute)
 	{
 		if (doarm9 && (!doarm7 || arm9 <= timer))
 		{
-			if (!NDS_ARM9.waitIRQ && !nds.freezeBus)
+			if (!NDS_ARM9.waitIRQ && !NDS_system.freezeBus)
 			{
 				arm9 += armcpu_exec<ARMCPU_ARM9>();
 			}
@@ -710,7 +707,7 @@ static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t
 		}
 		if (doarm7 && (!doarm9 || arm7 <= timer))
 		{
-			if (!NDS_ARM7.waitIRQ && !nds.freezeBus)
+			if (!NDS_ARM7.waitIRQ && !NDS_system.freezeBus)
 			{
 				arm7 += armcpu_exec<ARMCPU_ARM7>() << 1;
 			}
@@ -734,41 +731,41 @@ static std::pair<int32_t, int32_t> armInnerLoop(uint64_t nds_timer_base, int32_t
 
 template<bool FORCE> void NDS_exec(int32_t)
 {
-	sequencer.nds_vblankEnded = false;
+	NDS_sequencer.nds_vblankEnded = false;
 
-	if (nds.sleeping)
+	if (NDS_system.sleeping)
 	{
 		// speculative code: if ANY irq happens, wake up the arm7.
 		// I think the arm7 program analyzes the system and may decide not to wake up
 		// if it is dissatisfied with the conditions
 		if (MMU.reg_IE[1] & MMU.gen_IF<1>())
-			nds.sleeping = false;
+			NDS_system.sleeping = false;
 	}
 	else
 	{
 		for (;;)
 		{
-			sequencer.execHardware();
+			NDS_sequencer.execHardware();
 
 			// break out once per frame
-			if (sequencer.nds_vblankEnded)
+			if (NDS_sequencer.nds_vblankEnded)
 				break;
 			// it should be benign to execute execHardware in the next frame,
 			// since there won't be anything for it to do (everything should be scheduled in the future)
 
 			// bail in case the system halted
-			if (!execute)
+			if (!NDS_execute)
 				break;
 
 			execHardware_interrupts();
 
 			// find next work unit:
-			uint64_t next = sequencer.findNext();
+			uint64_t next = NDS_sequencer.findNext();
 			next = std::min(next, nds_timer + kMaxWork); // lets set an upper limit for now
 
 			//fprintf(stderr, "%d\n", next - nds_timer);
 
-			sequencer.reschedule = false;
+			NDS_sequencer.reschedule = false;
 
 			// cast these down to 32bits so that things run faster on 32bit procs
 			uint64_t nds_timer_base = nds_timer;
@@ -984,9 +981,9 @@ void NDS_Reset()
 	if (!header)
 		return;
 
-	nds.sleeping = false;
-	nds.cardEjected = false;
-	nds.freezeBus = 0;
+	NDS_system.sleeping = false;
+	NDS_system.cardEjected = false;
+	NDS_system.freezeBus = 0;
 
 	nds_timer = 0;
 	nds_arm9_timer = 0;
@@ -1006,7 +1003,7 @@ void NDS_Reset()
 	// at any, it's important that this be done long before the user code ever runs
 	_MMU_write08<ARMCPU_ARM9>(REG_WRAMCNT, 3);
 
-	firmware.reset(new CFIRMWARE());
+	std::unique_ptr<CFIRMWARE> firmware(new CFIRMWARE());
 	fw_success = firmware->load();
 
 	if (NDS_ARM7.BIOS_loaded && NDS_ARM9.BIOS_loaded && CommonSettings.BootFromFirmware && fw_success)
@@ -1083,8 +1080,8 @@ void NDS_Reset()
 	}
 
 	// only ARM9 have co-processor
-	reconstruct(&cp15);
-	cp15.reset(&NDS_ARM9);
+	reconstruct(&NDS_cp15);
+	NDS_cp15.reset(&NDS_ARM9);
 
 	// bitbox 4k demo is so stripped down it relies on default stack values
 	// otherwise the arm7 will crash before making a sound
@@ -1104,9 +1101,9 @@ void NDS_Reset()
 	// n.b.: im not sure about all these, I dont know enough about arm9 svc/irq/etc modes
 	// and how theyre named in desmume to match them up correctly. i just guessed.
 
-	memset(nds.timerCycle, 0, sizeof(uint64_t) * 8);
-	nds.old = 0;
-	SetupMMU(false, nds.Is_DSI());
+	memset(NDS_system.timerCycle, 0, sizeof(uint64_t) * 8);
+	NDS_system.old = 0;
+	SetupMMU(false, NDS_system.Is_DSI());
 
 	_MMU_write16<ARMCPU_ARM9>(REG_KEYINPUT, 0x3FF);
 	_MMU_write16<ARMCPU_ARM7>(REG_KEYINPUT, 0x3FF);
@@ -1124,7 +1121,7 @@ void NDS_Reset()
 
 	// Copy the whole header to Main RAM 0x27FFE00 on startup. (http://nocash.emubase.de/gbatek.htm#dscartridgeheader)
 	// once upon a time this copied 0x90 more. this was thought to be wrong, and changed.
-	if (nds.Is_DSI())
+	if (NDS_system.Is_DSI())
 	{
 		// dsi needs this copied later in memory. there are probably a number of things that  get copied to a later location in memory.. thats where the NDS consoles tend to stash stuff.
 		for (int i = 0; i < 92; ++i)
@@ -1155,6 +1152,86 @@ void NDS_Reset()
 	SPU_ReInit();
 }
 
+// ===============================================================
+
+NDS_THREAD_LOCAL NDSInstance *nds_instance NDS_TLS_MODEL = nullptr;
+
+NDSInstance::NDSInstance() : mmu(new MMU_struct()), mmu_new(nullptr), mmu_timing(new MMU_struct_timing()),
+	main_mem_mask(0x3FFFFF), main_mem_mask16(0x3FFFFF & ~1), main_mem_mask32(0x3FFFFF & ~3), code_cache(nullptr),
+	vram(new MMU_struct_vram()), tsc_partie(1), ipc_fifos(new IPC_FIFO[2]()),
+	arm9(new armcpu_t()), arm7(new armcpu_t()), arm9_cp15(new armcp15_t()),
+	system(new NDSSystem()), hw_sequencer(new Sequencer()), timer(0), arm9_timer(0), arm7_timer(0), running(false),
+	game_info(new GameInfo()), settings(new TCommonSettings()), spu(nullptr), spu_output(new SPU_struct_output()),
+	sample_cache(new SampleCache()), sndif_ring(new FrameRing()), sndif_buffer_bytes(0)
+{
+#ifndef ARMCPU_NO_BLOCK_CACHE
+	this->code_cache = new armcpu_codecache();
+#endif
+
+	// the backup device looks at CommonSettings while it is constructed
+	NDSInstanceBinding binding(*this);
+	this->mmu_new = new MMU_struct_new;
+}
+
+NDSInstance::~NDSInstance()
+{
+	if (nds_instance == this)
+		nds_instance = nullptr;
+
+	delete this->mmu;
+	delete this->mmu_new;
+	delete this->mmu_timing;
+#ifndef ARMCPU_NO_BLOCK_CACHE
+	delete this->code_cache;
+#endif
+	delete this->vram;
+	delete[] this->ipc_fifos;
+	delete this->arm9;
+	delete this->arm7;
+	delete this->arm9_cp15;
+	delete this->system;
+	delete this->hw_sequencer;
+	delete this->game_info;
+	delete this->settings;
+	delete this->spu;
+	delete this->spu_output;
+	delete this->sample_cache;
+	delete this->sndif_ring;
+}
+
+void NDSState::ioSparse(void *ptr, size_t size)
+{
+	static const size_t PAGE = 4096;
+	uint8_t *mem = static_cast<uint8_t *>(ptr);
+
+	// one flag byte per page, followed by the pages that are in use
+	for (size_t offset = 0; offset < size; offset += PAGE)
+	{
+		size_t len = std::min(PAGE, size - offset);
+		uint8_t *page = mem + offset;
+		uint8_t used = page[0] || memcmp(page, page + 1, len - 1) != 0;
+
+		this->io(used);
+		if (used)
+			this->io(page, len);
+		else if (this->loading)
+			memset(page, 0, len);
+	}
+}
+
+void NDS_State(NDSState &state)
+{
+	MMU_State(state);
+	armcpu_State(state);
+	state.io(NDS_cp15);
+	state.io(NDS_system);
+	state.io(NDS_sequencer);
+	state.io(nds_timer);
+	state.io(nds_arm9_timer);
+	state.io(nds_arm7_timer);
+	SPU_State(state);
+}
+
 // these templates needed to be instantiated manually
 template void NDS_exec<false>(int32_t nb);
 template void NDS_exec<true>(int32_t nb);
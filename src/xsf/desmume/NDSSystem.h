@@ -56,7 +56,7 @@ template<typename Type> struct buttonstruct
 	};
 };
 
-extern volatile bool execute;
+#define NDS_execute (nds_instance->running)
 
 struct NDS_header
 {
@@ -110,7 +110,7 @@ struct NDS_header
 	uint8_t reserved[160];
 };
 
-extern uint64_t nds_timer;
+#define nds_timer (nds_instance->timer)
 void NDS_Reschedule();
 void NDS_RescheduleDMA();
 void NDS_RescheduleTimers();
@@ -169,7 +169,7 @@ struct NDS_fw_config_data
 	uint8_t language;
 };
 
-extern NDSSystem nds;
+#define NDS_system (*nds_instance->system)
 
 int NDS_Init ();
 
@@ -249,7 +249,7 @@ struct GameInfo
 	bool isHomebrew;
 };
 
-extern GameInfo gameInfo;
+#define gameInfo (*nds_instance->game_info)
 
 struct UserButtons : buttonstruct<bool>
 {
@@ -273,6 +273,7 @@ struct UserInput
 
 void NDS_FreeROM();
 void NDS_Reset();
+void NDS_State(NDSState &state);
 
 void NDS_Sleep();
 
@@ -280,7 +281,7 @@ void execHardware_doAllDma(EDMAMode modeNum);
 
 template<bool FORCE> void NDS_exec(int32_t nb = 560190 << 1);
 
-extern struct TCommonSettings
+struct TCommonSettings
 {
 	TCommonSettings() : UseExtBIOS(false), SWIFromBIOS(false), PatchSWI3(false), UseExtFirmware(false), BootFromFirmware(false), ConsoleType(NDS_CONSOLE_TYPE_FAT), rigorous_timing(false), advanced_timing(true),
 		spuInterpolationMode(SPUInterpolation_Linear), manualBackupType(0), spu_captureMuted(false), spu_advanced(false)
@@ -291,8 +292,8 @@ extern struct TCommonSettings
 		NDS_FillDefaultFirmwareConfigData(&this->InternalFirmConf);
 
     bool solo = false;
-    static char* soloEnv = strdup("SOLO_2SF_n");
-    static char* muteEnv = strdup("MUTE_2SF_n");
+    char soloEnv[] = "SOLO_2SF_n";
+    char muteEnv[] = "MUTE_2SF_n";
 		for (int i = 0; i < 16; ++i) {
       if (i < 10) {
         soloEnv[9] = '0' + i;
@@ -345,4 +346,6 @@ extern struct TCommonSettings
 	bool spu_muteChannels[16];
 	bool spu_captureMuted;
 	bool spu_advanced;
-} CommonSettings;
+};
+
+#define CommonSettings (*nds_instance->settings)
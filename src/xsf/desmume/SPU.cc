@@ -50,18 +50,6 @@ static inline u8 read08(u32 addr) { return _MMU_read08<ARMCPU_ARM7,MMU_AT_DEBUG>
 #define K_ADPCM_LOOPING_RECOVERY_INDEX 99999
 #define COSINE_INTERPOLATION_RESOLUTION 8192
 
-SPU_struct *SPU_core = 0;
-int SPU_currentCoreNum = SNDCORE_DUMMY;
-static int volume = 100;
-SampleCache spuSampleCache;
-
-static size_t buffersize = 0;
-static ESynchMode synchmode = ESynchMode_Synchronous;
-static ESynchMethod synchmethod = ESynchMethod_0;
-static ISynchronizingAudioBuffer* synchronizer = metaspu_construct(synchmethod);
-
-static int SNDCoreId=-1;
-static SoundInterface_struct *SNDCore=NULL;
 extern SoundInterface_struct *SNDCoreList[];
 
 static const int format_shift[] = { 2, 1, 3, 0 };
@@ -80,17 +68,17 @@ static const s16 wavedutytbl[8][8] = {
 
 static const double ARM7_CLOCK = 33513982;
 
-double DESMUME_SAMPLE_RATE = 48000;
-static double samples_per_hline = (DESMUME_SAMPLE_RATE / 59.8261f) / 263.0f;
-static double sampleLength = DESMUME_SAMPLE_RATE / 32728.498;
-
 void SetDesmumeSampleRate(double rate) {
   DESMUME_SAMPLE_RATE = rate;
-  sampleLength = DESMUME_SAMPLE_RATE / 32728.498;
-  samples_per_hline = (DESMUME_SAMPLE_RATE / 59.8261f) / 263.0f;
+  SPU_output.sampleLength = DESMUME_SAMPLE_RATE / 32728.498;
+  SPU_output.samples_per_hline = (DESMUME_SAMPLE_RATE / 59.8261f) / 263.0f;
 }
 
-static double samples = 0;
+SPU_struct_output::~SPU_struct_output()
+{
+  delete synchronizer;
+  free(postProcessBuffer);
+}
 
 template<typename T>
 static FORCEINLINE T MinMax(T val, T min, T max)
@@ -109,11 +97,11 @@ int SPU_ChangeSoundCore(int coreid, int buffersize)
 {
   int i;
 
-  ::buffersize = buffersize;
+  SPU_output.buffersize = buffersize;
 
   // Make sure the old core is freed
-  if (SNDCore)
-    SNDCore->DeInit();
+  if (SPU_output.SNDCore)
+    SPU_output.SNDCore->DeInit();
 
   // So which core do we want?
   if (coreid == SNDCORE_DEFAULT)
@@ -127,43 +115,43 @@ int SPU_ChangeSoundCore(int coreid, int buffersize)
     if (SNDCoreList[i]->id == coreid)
     {
       // Set to current core
-      SNDCore = SNDCoreList[i];
+      SPU_output.SNDCore = SNDCoreList[i];
       break;
     }
   }
 
-  SNDCoreId = coreid;
+  SPU_output.SNDCoreId = coreid;
 
   //If the user picked the dummy core, disable the user spu
-  if(SNDCore == &SNDDummy)
+  if(SPU_output.SNDCore == &SNDDummy)
     return 0;
 
   //If the core wasnt found in the list for some reason, disable the user spu
-  if (SNDCore == NULL)
+  if (SPU_output.SNDCore == NULL)
     return -1;
 
   // Since it failed, instead of it being fatal, disable the user spu
-  if (SNDCore->Init(buffersize * 2) == -1)
+  if (SPU_output.SNDCore->Init(buffersize * 2) == -1)
   {
-    SNDCore = 0;
+    SPU_output.SNDCore = 0;
     return -1;
   }
 
-  SNDCore->SetVolume(volume);
+  SPU_output.SNDCore->SetVolume(SPU_output.volume);
 
-  SPU_SetSynchMode(synchmode,synchmethod);
+  SPU_SetSynchMode(SPU_output.synchmode,SPU_output.synchmethod);
 
   return 0;
 }
 
 SoundInterface_struct *SPU_SoundCore()
 {
-  return SNDCore;
+  return SPU_output.SNDCore;
 }
 
 void SPU_ReInit(bool fakeBoot)
 {
-  SPU_Init(SNDCoreId, buffersize);
+  SPU_Init(SPU_output.SNDCoreId, SPU_output.buffersize);
 
   // Firmware set BIAS to 0x200
   if (fakeBoot)
@@ -172,48 +160,50 @@ void SPU_ReInit(bool fakeBoot)
 
 int SPU_Init(int coreid, int buffersize)
 {
-  SPU_core = new SPU_struct((int)ceil(samples_per_hline));
+  SPU_core = new SPU_struct((int)ceil(SPU_output.samples_per_hline));
   SPU_Reset();
 
-  SPU_SetSynchMode(synchmode, synchmethod);
+  if (!SPU_output.synchronizer)
+    SPU_output.synchronizer = metaspu_construct(SPU_output.synchmethod);
+  SPU_SetSynchMode(SPU_output.synchmode, SPU_output.synchmethod);
 
   return SPU_ChangeSoundCore(coreid, buffersize);
 }
 
 void SPU_Pause(int pause)
 {
-  if (SNDCore == NULL) return;
+  if (SPU_output.SNDCore == NULL) return;
 
   if(pause)
-    SNDCore->MuteAudio();
+    SPU_output.SNDCore->MuteAudio();
   else
-    SNDCore->UnMuteAudio();
+    SPU_output.SNDCore->UnMuteAudio();
 }
 
 void SPU_SetSynchMode(int mode, int method)
 {
-  synchmode = (ESynchMode)mode;
-  if(synchmethod != (ESynchMethod)method)
+  SPU_output.synchmode = (ESynchMode)mode;
+  if(SPU_output.synchmethod != (ESynchMethod)method)
   {
-    synchmethod = (ESynchMethod)method;
-    delete synchronizer;
+    SPU_output.synchmethod = (ESynchMethod)method;
+    delete SPU_output.synchronizer;
     //grr does this need to be locked? spu might need a lock method
     // or maybe not, maybe the platform-specific code that calls this function can deal with it.
-    synchronizer = metaspu_construct(synchmethod);
+    SPU_output.synchronizer = metaspu_construct(SPU_output.synchmethod);
   }
 }
 
 void SPU_ClearOutputBuffer()
 {
-  if(SNDCore && SNDCore->ClearBuffer)
-    SNDCore->ClearBuffer();
+  if(SPU_output.SNDCore && SPU_output.SNDCore->ClearBuffer)
+    SPU_output.SNDCore->ClearBuffer();
 }
 
 void SPU_SetVolume(int volume)
 {
-  ::volume = volume;
-  if (SNDCore)
-    SNDCore->SetVolume(volume);
+  SPU_output.volume = volume;
+  if (SPU_output.SNDCore)
+    SPU_output.SNDCore->SetVolume(volume);
 }
 
 
@@ -229,7 +219,7 @@ void SPU_Reset(void)
   for (i = 0x400; i < 0x51D; i++)
     T1WriteByte(MMU.ARM7_REG, i, 0);
 
-  samples = 0;
+  SPU_output.samples = 0;
 }
 
 //------------------------------------------
@@ -269,11 +259,36 @@ SPU_struct::~SPU_struct()
 
 void SPU_DeInit(void)
 {
-  if(SNDCore)
-    SNDCore->DeInit();
-  SNDCore = 0;
+  if(SPU_output.SNDCore)
+    SPU_output.SNDCore->DeInit();
+  SPU_output.SNDCore = 0;
 
   delete SPU_core; SPU_core=0;
+
+  delete SPU_output.synchronizer; SPU_output.synchronizer=NULL;
+  free(SPU_output.postProcessBuffer); SPU_output.postProcessBuffer=NULL;
+  SPU_output.postProcessBufferSize=0;
+}
+
+void SPU_State(NDSState &state)
+{
+  s32 *sndbuf = SPU_core->sndbuf;
+  s16 *outbuf = SPU_core->outbuf;
+  u32 bufsize = SPU_core->bufsize;
+
+  state.io(*SPU_core);
+  SPU_core->sndbuf = sndbuf;
+  SPU_core->outbuf = outbuf;
+  SPU_core->bufsize = bufsize;
+  state.io(sndbuf, bufsize * 2 * sizeof(s32));
+  state.io(outbuf, bufsize * 2 * sizeof(s16));
+  state.io(SPU_output.samples);
+  state.io(spu_core_samples);
+  SPU_output.synchronizer->state(state);
+
+  // decoded samples may belong to memory the snapshot has just overwritten
+  if (state.isLoading())
+    spuSampleCache.clear();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1334,15 +1349,14 @@ static void SPU_MixAudio(bool actuallyMix, SPU_struct *SPU, int length)
 //emulates one hline of the cpu core.
 //this will produce a variable number of samples, calculated to keep a 44100hz output
 //in sync with the emulator framerate
-int spu_core_samples = 0;
 void SPU_Emulate_core()
 {
   bool needToMix = true;
   SoundInterface_struct *soundProcessor = SPU_SoundCore();
 
-  samples += samples_per_hline;
-  spu_core_samples = (int)(samples);
-  samples -= spu_core_samples;
+  SPU_output.samples += SPU_output.samples_per_hline;
+  spu_core_samples = (int)(SPU_output.samples);
+  SPU_output.samples -= spu_core_samples;
 
   SPU_MixAudio(needToMix, SPU_core, spu_core_samples);
 
@@ -1353,18 +1367,16 @@ void SPU_Emulate_core()
 
   if (soundProcessor->FetchSamples != NULL)
   {
-    soundProcessor->FetchSamples(SPU_core->outbuf, spu_core_samples, synchmode, synchronizer);
+    soundProcessor->FetchSamples(SPU_core->outbuf, spu_core_samples, SPU_output.synchmode, SPU_output.synchronizer);
   }
   else
   {
-    SPU_DefaultFetchSamples(SPU_core->outbuf, spu_core_samples, synchmode, synchronizer);
+    SPU_DefaultFetchSamples(SPU_core->outbuf, spu_core_samples, SPU_output.synchmode, SPU_output.synchronizer);
   }
 }
 
 void SPU_Emulate_user(bool mix)
 {
-  static s16 *postProcessBuffer = NULL;
-  static size_t postProcessBufferSize = 0;
   size_t freeSampleCount = 0;
   size_t processedSampleCount = 0;
   SoundInterface_struct *soundProcessor = SPU_SoundCore();
@@ -1382,29 +1394,29 @@ void SPU_Emulate_user(bool mix)
     return;
   }
 
-  if (freeSampleCount > buffersize)
+  if (freeSampleCount > SPU_output.buffersize)
   {
-    freeSampleCount = buffersize;
+    freeSampleCount = SPU_output.buffersize;
   }
 
   // If needed, resize the post-process buffer to guarantee that
   // we can store all the sound data.
-  if (postProcessBufferSize < freeSampleCount * 2 * sizeof(s16))
+  if (SPU_output.postProcessBufferSize < freeSampleCount * 2 * sizeof(s16))
   {
-    postProcessBufferSize = freeSampleCount * 2 * sizeof(s16);
-    postProcessBuffer = (s16 *)realloc(postProcessBuffer, postProcessBufferSize);
+    SPU_output.postProcessBufferSize = freeSampleCount * 2 * sizeof(s16);
+    SPU_output.postProcessBuffer = (s16 *)realloc(SPU_output.postProcessBuffer, SPU_output.postProcessBufferSize);
   }
 
   if (soundProcessor->PostProcessSamples != NULL)
   {
-    processedSampleCount = soundProcessor->PostProcessSamples(postProcessBuffer, freeSampleCount, synchmode, synchronizer);
+    processedSampleCount = soundProcessor->PostProcessSamples(SPU_output.postProcessBuffer, freeSampleCount, SPU_output.synchmode, SPU_output.synchronizer);
   }
   else
   {
-    processedSampleCount = SPU_DefaultPostProcessSamples(postProcessBuffer, freeSampleCount, synchmode, synchronizer);
+    processedSampleCount = SPU_DefaultPostProcessSamples(SPU_output.postProcessBuffer, freeSampleCount, SPU_output.synchmode, SPU_output.synchronizer);
   }
 
-  soundProcessor->UpdateAudio(postProcessBuffer, processedSampleCount);
+  soundProcessor->UpdateAudio(SPU_output.postProcessBuffer, processedSampleCount);
 }
 
 void SPU_DefaultFetchSamples(s16 *sampleBuffer, size_t sampleCount, ESynchMode synchMode, ISynchronizingAudioBuffer *theSynchronizer)
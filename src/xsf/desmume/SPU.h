@@ -29,6 +29,7 @@
 #include "matrix.h"
 #include "metaspu.h"
 #include "../spu/samplecache.h"
+#include "NDSInstance.h"
 
 class EMUFILE;
 
@@ -73,7 +74,6 @@ struct SoundInterface_struct
 
 extern SoundInterface_struct SNDDummy;
 extern SoundInterface_struct SNDFile;
-extern int SPU_currentCoreNum;
 
 struct channel_struct
 {
@@ -221,8 +221,36 @@ public:
    void ShutUp();
 };
 
-extern SPU_struct *SPU_core;
-extern int spu_core_samples;
+#define SPU_core (nds_instance->spu)
+
+// what sits between SPU_core and the frontend: the sound core, the synchronizer and the sample clock
+struct SPU_struct_output
+{
+   int currentCoreNum = SNDCORE_DUMMY;
+   int volume = 100;
+
+   size_t buffersize = 0;
+   ESynchMode synchmode = ESynchMode_Synchronous;
+   ESynchMethod synchmethod = ESynchMethod_0;
+   ISynchronizingAudioBuffer *synchronizer = nullptr;
+   s16 *postProcessBuffer = nullptr;
+   size_t postProcessBufferSize = 0;
+
+   int SNDCoreId = -1;
+   SoundInterface_struct *SNDCore = nullptr;
+
+   double sampleRate = 48000;
+   double samples_per_hline = (48000 / 59.8261f) / 263.0f;
+   double sampleLength = 48000 / 32728.498;
+   double samples = 0;
+   int core_samples = 0;
+
+   ~SPU_struct_output();
+};
+
+#define SPU_output (*nds_instance->spu_output)
+#define SPU_currentCoreNum (SPU_output.currentCoreNum)
+#define spu_core_samples (SPU_output.core_samples)
 
 int SPU_ChangeSoundCore(int coreid, int buffersize);
 SoundInterface_struct *SPU_SoundCore();
@@ -235,6 +263,7 @@ void SPU_SetSynchMode(int mode, int method);
 void SPU_ClearOutputBuffer(void);
 void SPU_Reset(void);
 void SPU_DeInit(void);
+void SPU_State(NDSState &state);
 void SPU_KeyOn(int channel);
 static FORCEINLINE void SPU_WriteByte(u32 addr, u8 val)
 {
@@ -262,9 +291,9 @@ void SPU_Emulate_user(bool mix = true);
 void SPU_DefaultFetchSamples(s16 *sampleBuffer, size_t sampleCount, ESynchMode synchMode, ISynchronizingAudioBuffer *theSynchronizer);
 size_t SPU_DefaultPostProcessSamples(s16 *postProcessBuffer, size_t requestedSampleCount, ESynchMode synchMode, ISynchronizingAudioBuffer *theSynchronizer);
 
-extern double DESMUME_SAMPLE_RATE;
+#define DESMUME_SAMPLE_RATE (SPU_output.sampleRate)
 void SetDesmumeSampleRate(double rate);
 
-extern SampleCache spuSampleCache;
+#define spuSampleCache (*nds_instance->sample_cache)
 
 #endif
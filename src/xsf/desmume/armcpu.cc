@@ -40,9 +40,6 @@ static inline uint32_t armcpu_prefetch(armcpu_t *armcpu)
 		return armcpu_prefetch<1>();
 }
 
-armcpu_t NDS_ARM7;
-armcpu_t NDS_ARM9;
-
 int armcpu_new(armcpu_t *armcpu, uint32_t id)
 {
 	armcpu->proc_ID = id;
@@ -193,6 +190,157 @@ uint32_t armcpu_Wait4IRQ(armcpu_t *cpu)
 	return 1;
 }
 
+#ifndef ARMCPU_NO_BLOCK_CACHE
+// Block cache
+//
+// Code running from main memory, ITCM (arm9) or the exclusive WRAM (arm7) is fetched and decoded once
+// into 1KB blocks holding the opcode and its handler, so the next time around the prefetch skips both
+// the MMU read and the table lookup, and armcpu_exec calls the handler directly.
+// Blocks are kept per cpu and per instruction set, and are indexed by the offset into the backing
+// memory rather than by address, so mirrors share one block. A write into a page that has been
+// decoded drops the page (MMU_codeWrite), and everything is thrown away on MMU_Reset.
+// Code anywhere else (bios, shared WRAM, vram...) is decoded on every fetch like before.
+//
+// Define ARMCPU_NO_BLOCK_CACHE to go back to fetching through the MMU every time, or
+// ARMCPU_CHECK_BLOCK_CACHE to read every cached instruction again and report stale blocks.
+
+template<int SIZE> struct armcpu_codeblock
+{
+	enum { COUNT = (1 << MMU_CODE_PAGE_SHIFT) / SIZE };
+
+	uint32_t valid[COUNT / 32];
+	OpFunc op[COUNT];
+	uint32_t opcode[COUNT];
+};
+
+#define armcpu_armBlocks (nds_instance->code_cache->armBlocks)
+#define armcpu_thumbBlocks (nds_instance->code_cache->thumbBlocks)
+#define armcpu_op (nds_instance->code_cache->op)
+
+void armcpu_invalidateCodePage(uint32_t page)
+{
+	armcpu_codePageUsed[page] = 0;
+
+	for (int proc = 0; proc < 2; ++proc)
+	{
+		if (armcpu_armBlocks[proc][page])
+			memset(armcpu_armBlocks[proc][page]->valid, 0, sizeof(armcpu_armBlocks[proc][page]->valid));
+		if (armcpu_thumbBlocks[proc][page])
+			memset(armcpu_thumbBlocks[proc][page]->valid, 0, sizeof(armcpu_thumbBlocks[proc][page]->valid));
+	}
+}
+
+void armcpu_flushCodeBlocks()
+{
+	for (int proc = 0; proc < 2; ++proc)
+		for (int page = 0; page < MMU_CODE_PAGES; ++page)
+		{
+			delete armcpu_armBlocks[proc][page];
+			armcpu_armBlocks[proc][page] = nullptr;
+			delete armcpu_thumbBlocks[proc][page];
+			armcpu_thumbBlocks[proc][page] = nullptr;
+		}
+
+	memset(armcpu_codePageUsed, 0, sizeof(armcpu_codePageUsed));
+}
+
+// returns the offset of a code address into the block cache's view of memory, or ~0 if it isn't cached.
+// this must follow the AT_CODE paths of _MMU_read16/_MMU_read32.
+template<int PROCNUM> static inline uint32_t armcpu_codeOffset(uint32_t adr)
+{
+	if ((adr & 0x0F000000) == 0x02000000)
+		return (MMU_CODE_PAGE_MAIN << MMU_CODE_PAGE_SHIFT) + (adr & _MMU_MAIN_MEM_MASK);
+
+	if (PROCNUM == ARMCPU_ARM9 && adr < 0x02000000)
+		return (MMU_CODE_PAGE_ITCM << MMU_CODE_PAGE_SHIFT) + (adr & 0x7FFF);
+
+	if (PROCNUM == ARMCPU_ARM7 && (adr & 0x0F800000) == 0x03800000)
+		return (MMU_CODE_PAGE_ERAM << MMU_CODE_PAGE_SHIFT) + (adr & 0xFFFF);
+
+	return ~0U;
+}
+
+template<int PROCNUM, int SIZE> static inline uint32_t armcpu_readCode(uint32_t adr)
+{
+	if (SIZE == 4)
+		return _MMU_read32<PROCNUM, MMU_AT_CODE>(adr);
+	else
+		return _MMU_read16<PROCNUM, MMU_AT_CODE>(adr);
+}
+
+template<int PROCNUM, int SIZE> static inline OpFunc armcpu_decode(uint32_t opcode)
+{
+	if (SIZE == 4)
+		return arm_instructions_set[PROCNUM][INSTRUCTION_INDEX(opcode)];
+	else
+		return thumb_instructions_set[PROCNUM][opcode >> 6];
+}
+
+template<int PROCNUM, int SIZE> static inline armcpu_codeblock<SIZE> *&armcpu_block(uint32_t page);
+template<> inline armcpu_codeblock<4> *&armcpu_block<0, 4>(uint32_t page) { return armcpu_armBlocks[0][page]; }
+template<> inline armcpu_codeblock<4> *&armcpu_block<1, 4>(uint32_t page) { return armcpu_armBlocks[1][page]; }
+template<> inline armcpu_codeblock<2> *&armcpu_block<0, 2>(uint32_t page) { return armcpu_thumbBlocks[0][page]; }
+template<> inline armcpu_codeblock<2> *&armcpu_block<1, 2>(uint32_t page) { return armcpu_thumbBlocks[1][page]; }
+
+// fetches the instruction at adr into armcpu->instruction and its handler into armcpu_op
+template<int PROCNUM, int SIZE> static inline void armcpu_fetch(armcpu_t *armcpu, uint32_t adr)
+{
+	uint32_t offset = armcpu_codeOffset<PROCNUM>(adr);
+
+	if (offset == ~0U)
+	{
+		armcpu->instruction = armcpu_readCode<PROCNUM, SIZE>(adr);
+		armcpu_op[PROCNUM] = armcpu_decode<PROCNUM, SIZE>(armcpu->instruction);
+		return;
+	}
+
+	uint32_t page = offset >> MMU_CODE_PAGE_SHIFT;
+	uint32_t index = (offset & ((1 << MMU_CODE_PAGE_SHIFT) - 1)) / SIZE;
+	uint32_t bit = 1 << (index & 31);
+	armcpu_codeblock<SIZE> *&block = armcpu_block<PROCNUM, SIZE>(page);
+
+	if (block && (block->valid[index >> 5] & bit))
+	{
+		armcpu->instruction = block->opcode[index];
+		armcpu_op[PROCNUM] = block->op[index];
+#ifdef ARMCPU_CHECK_BLOCK_CACHE
+		uint32_t opcode = armcpu_readCode<PROCNUM, SIZE>(adr);
+		if (opcode == armcpu->instruction)
+			return;
+		fprintf(stderr, "armcpu: ARM%c block cache has %08X at %08X, memory has %08X\n", PROCNUM ? '7' : '9', armcpu->instruction, adr, opcode);
+#else
+		return;
+#endif
+	}
+
+	if (!block)
+		block = new armcpu_codeblock<SIZE>();
+
+	armcpu->instruction = armcpu_readCode<PROCNUM, SIZE>(adr);
+	armcpu_op[PROCNUM] = armcpu_decode<PROCNUM, SIZE>(armcpu->instruction);
+
+	block->opcode[index] = armcpu->instruction;
+	block->op[index] = armcpu_op[PROCNUM];
+	block->valid[index >> 5] |= bit;
+	armcpu_codePageUsed[page] = 1;
+}
+#endif
+
+void armcpu_State(NDSState &state)
+{
+	state.io(NDS_ARM9);
+	state.io(NDS_ARM7);
+
+#ifndef ARMCPU_NO_BLOCK_CACHE
+	// the handlers of the instructions the cpus have already prefetched
+	state.io(armcpu_op);
+
+	// the restored memory need not hold the code the blocks were decoded from
+	if (state.isLoading())
+		armcpu_flushCodeBlocks();
+#endif
+}
+
 template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
 {
 	armcpu_t *const armcpu = &ARMPROC;
@@ -206,7 +354,11 @@ template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
 		armcpu->instruct_adr = curInstruction;
 		armcpu->next_instruction = curInstruction + 4;
 		armcpu->R[15] = curInstruction + 8;
+#ifdef ARMCPU_NO_BLOCK_CACHE
 		armcpu->instruction = _MMU_read32<PROCNUM, MMU_AT_CODE>(curInstruction);
+#else
+		armcpu_fetch<PROCNUM, 4>(armcpu, curInstruction);
+#endif
 
 		return MMU_codeFetchCycles<PROCNUM, 32>(curInstruction);
 	}
@@ -216,7 +368,11 @@ template<uint32_t PROCNUM> static inline uint32_t armcpu_prefetch()
 	armcpu->instruct_adr = curInstruction;
 	armcpu->next_instruction = curInstruction + 2;
 	armcpu->R[15] = curInstruction + 4;
+#ifdef ARMCPU_NO_BLOCK_CACHE
 	armcpu->instruction = _MMU_read16<PROCNUM, MMU_AT_CODE>(curInstruction);
+#else
+	armcpu_fetch<PROCNUM, 2>(armcpu, curInstruction);
+#endif
 
 	if (!PROCNUM)
 	{
@@ -254,7 +410,7 @@ void armcpu_exception(armcpu_t *cpu, uint32_t number)
 			cpumode = ABT;
 			break;
 		case EXCEPTION_RESERVED_0x14:
-			execute = false;
+			NDS_execute = false;
 			break;
 		case EXCEPTION_IRQ:
 			cpumode = IRQ;
@@ -308,7 +464,7 @@ uint32_t TRAPUNDEF(armcpu_t *cpu)
 	}
 	else
 	{
-		execute = false;
+		NDS_execute = false;
 		return 4;
 	}
 }
@@ -338,7 +494,11 @@ template<int PROCNUM> uint32_t armcpu_exec()
 #ifdef HAVE_LUA
 			CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 4, ARMPROC.instruction, LUAMEMHOOK_EXEC); // should report even if condition=false?
 #endif
+#ifdef ARMCPU_NO_BLOCK_CACHE
 			cExecute = arm_instructions_set[PROCNUM][INSTRUCTION_INDEX(ARMPROC.instruction)](ARMPROC.instruction);
+#else
+			cExecute = armcpu_op[PROCNUM](ARMPROC.instruction);
+#endif
 		}
 		else
 			cExecute = 1; // If condition=false: 1S cycle
@@ -349,7 +509,11 @@ template<int PROCNUM> uint32_t armcpu_exec()
 #ifdef HAVE_LUA
 	CallRegisteredLuaMemHook(ARMPROC.instruct_adr, 2, ARMPROC.instruction, LUAMEMHOOK_EXEC);
 #endif
+#ifdef ARMCPU_NO_BLOCK_CACHE
 	cExecute = thumb_instructions_set[PROCNUM][ARMPROC.instruction>>6](ARMPROC.instruction);
+#else
+	cExecute = armcpu_op[PROCNUM](ARMPROC.instruction);
+#endif
 
 	cFetch = armcpu_prefetch<PROCNUM>();
 	return MMU_fetchExecuteCycles<PROCNUM>(cExecute, cFetch);
@@ -221,8 +221,10 @@ bool armcpu_irqException(armcpu_t *armcpu);
 void armcpu_exception(armcpu_t *cpu, uint32_t number);
 uint32_t TRAPUNDEF(armcpu_t* cpu);
 uint32_t armcpu_Wait4IRQ(armcpu_t *cpu);
+void armcpu_State(NDSState &state);
 
-extern armcpu_t NDS_ARM7, NDS_ARM9;
+#define NDS_ARM7 (*nds_instance->arm7)
+#define NDS_ARM9 (*nds_instance->arm9)
 
 template<int PROCNUM> uint32_t armcpu_exec();
 
@@ -20,8 +20,6 @@
 #include "cp15.h"
 #include "MMU.h"
 
-armcp15_t cp15;
-
 bool armcp15_t::reset(armcpu_t *c)
 {
 	//fprintf(stderr, "CP15 Reset\n");
@@ -528,19 +526,19 @@ void maskPrecalc()
 #define precalc(num) \
 { \
 	uint32_t mask = 0, set = 0xFFFFFFFF; /* (x & 0) == 0xFF..FF is allways false (disabled) */ \
-	if (BIT_N(cp15.protectBaseSize##num, 0)) /* if region is enabled */ \
+	if (BIT_N(NDS_cp15.protectBaseSize##num, 0)) /* if region is enabled */ \
 	{ \
 		/* reason for this define: naming includes var */ \
-		mask = MASKFROMREG(cp15.protectBaseSize##num); \
-		set = SETFROMREG(cp15.protectBaseSize##num); \
-		if (SIZEIDENTIFIER(cp15.protectBaseSize##num) == 0x1F) \
+		mask = MASKFROMREG(NDS_cp15.protectBaseSize##num); \
+		set = SETFROMREG(NDS_cp15.protectBaseSize##num); \
+		if (SIZEIDENTIFIER(NDS_cp15.protectBaseSize##num) == 0x1F) \
 		{ \
 			/* for the 4GB region, u32 suffers wraparound */ \
 			mask = 0; \
 			set = 0; /* (x & 0) == 0  is allways true (enabled) */ \
 		} \
 	} \
-	cp15.setSingleRegionAccess(cp15.DaccessPerm, cp15.IaccessPerm, num, mask, set); \
+	NDS_cp15.setSingleRegionAccess(NDS_cp15.DaccessPerm, NDS_cp15.IaccessPerm, num, mask, set); \
 }
 	precalc(0);
 	precalc(1);
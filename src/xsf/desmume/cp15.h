@@ -107,5 +107,5 @@ public:
 	bool isAccessAllowed(uint32_t address,uint32_t access);
 };
 
-extern armcp15_t cp15;
+#define NDS_cp15 (*nds_instance->arm9_cp15)
 void maskPrecalc();
@@ -48,6 +48,23 @@ public:
       buf[offset++] = sample & 0xFFFF;
     }
     return samples;
+  }
+
+	virtual void state(NDSState &state) {
+    uint32_t count = buffer.size();
+    state.io(count);
+    if (state.isLoading())
+      buffer = std::queue<uint32_t>();
+    // saving rotates the queue once, leaving it as it was
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t sample = 0;
+      if (!state.isLoading()) {
+        sample = buffer.front();
+        buffer.pop();
+      }
+      state.io(sample);
+      buffer.push(sample);
+    }
   }
 };
 
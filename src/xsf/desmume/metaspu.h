@@ -27,6 +27,7 @@
 #include <algorithm>
 
 #include "types.h"
+#include "NDSInstance.h"
 
 class ISynchronizingAudioBuffer
 {
@@ -37,6 +38,9 @@ public:
 
 	//returns the number of samples actually supplied, which may not match the number requested
 	virtual int output_samples(s16* buf, int samples_requested) = 0;
+
+	//saves or restores the queued samples
+	virtual void state(NDSState &state) = 0;
 };
 
 enum ESynchMode
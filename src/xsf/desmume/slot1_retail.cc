@@ -98,7 +98,7 @@ static uint32_t read32_GCDATAIN(uint8_t PROCNUM)
 				// this still works, since it will have read 00 originally and then read 00 to validate.
 
 				// staff of kings verifies this (it also uses the arm7 IRQ 20)
-				if (nds.cardEjected) // TODO - handle this with ejected card slot1 device (and verify using this case)
+				if (NDS_system.cardEjected) // TODO - handle this with ejected card slot1 device (and verify using this case)
 					return 0xFFFFFFFF;
 				else
 					return 0;
@@ -43,25 +43,21 @@
 #include <memory>
 #include <sstream>
 #include <iostream>
+#include <atomic>
+#include <vector>
 
 #include <libaudcore/i18n.h>
 #include <libaudcore/plugin.h>
 #include <libaudcore/preferences.h>
 #include <libaudcore/audstrings.h>
 #include <libaudcore/runtime.h>
+#include <libaudcore/threads.h>
 
 #include "desmume/NDSSystem.h"
 #include "spu/samplecache.h"
 #include "sndif2sf.h"
 #include "XSFFile.h"
 
-#if _WIN32
-#include <windows.h>
-#define sleep Sleep
-#else
-#include <unistd.h>
-#endif
-
 class XSFPlugin : public InputPlugin
 {
 public:
@@ -159,11 +155,12 @@ public:
   ~vfsfile_istream() { delete rdbuf(nullptr); }
 };
 
-/* xsf_get_lib: called to load secondary files */
-static String dirpath;
-
 bool ignore_length;
 
+/* set from the preferences window; each play() applies it to its own instance */
+static std::atomic<int> interp_mode;
+void setInterp();
+
 #define CFG_ID "xsf"
 
 const char* const XSFPlugin::defaults[] =
@@ -172,21 +169,17 @@ const char* const XSFPlugin::defaults[] =
   "fade", "5000",
   "sample_rate", "32728",
   "interpolation_mode", "none",
+  "snapshot_budget", "64",
   nullptr
 };
 
 bool XSFPlugin::init()
 {
 	aud_config_set_defaults(CFG_ID, defaults);
+	setInterp();
 	return true;
 }
 
-Index<char> xsf_get_lib(char *filename)
-{
-	VFSFile file(filename_build({dirpath, filename}), "r");
-	return file ? file.read_all() : Index<char>();
-}
-
 bool XSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Index<char> *image)
 {
   try {
@@ -221,17 +214,89 @@ bool XSFPlugin::read_tag(const char *filename, VFSFile &file, Tuple &tuple, Inde
 
 static void xsf_reset(int frameSkip)
 {
-  execute = false;
+  NDS_execute = false;
   NDS_Reset();
   spuSampleCache.clear();
-  execute = true;
+  NDS_execute = true;
 
   if (frameSkip > 0) {
     for (int i = 0; i < frameSkip; ++i) {
       NDS_exec<false>();
     }
   }
-  buffer_rope.clear();
+  output_ring.clear();
+}
+
+/* The emulator only runs forward.  So that a backward seek does not have to
+ * replay the track from the start, the emulator state is saved every so often
+ * as the song plays, and the seek restores the last snapshot before the target.
+ * When the snapshots outgrow the memory budget, every other one is dropped and
+ * the interval doubled. */
+class SnapshotList
+{
+public:
+  SnapshotList(int64_t budget) : budget(budget) {}
+
+  // saves the bound instance if <pos> is far enough past the last snapshot
+  void checkpoint(float pos);
+
+  // restores the last snapshot at or before <pos> and returns its time, or -1
+  float restore(float pos);
+
+  // the time of the last snapshot at or before <pos>, or -1
+  float find(float pos) const;
+
+private:
+  struct Snapshot {
+    float time;
+    std::vector<uint8_t> data;
+  };
+
+  std::vector<Snapshot> snapshots;
+  int64_t budget;
+  float interval = 5000;
+};
+
+void SnapshotList::checkpoint(float pos)
+{
+  if (!budget)
+    return;
+  if (snapshots.size() && pos < snapshots.back().time + interval)
+    return;
+
+  snapshots.push_back(Snapshot{pos, {}});
+  NDSState state(snapshots.back().data, false);
+  NDS_State(state);
+
+  if ((int64_t)(snapshots.back().data.size() * snapshots.size()) > budget) {
+    // keep the first snapshot so that seeking to the start never resets
+    for (size_t i = 1; i < snapshots.size(); i++)
+      snapshots.erase(snapshots.begin() + i);
+    interval *= 2;
+  }
+}
+
+float SnapshotList::find(float pos) const
+{
+  float found = -1;
+  for (const Snapshot& snap : snapshots) {
+    if (snap.time > pos)
+      break;
+    found = snap.time;
+  }
+  return found;
+}
+
+float SnapshotList::restore(float pos)
+{
+  for (size_t i = snapshots.size(); i--; ) {
+    if (snapshots[i].time <= pos) {
+      NDSState state(snapshots[i].data, true);
+      NDS_State(state);
+      return snapshots[i].time;
+    }
+  }
+  return -1;
 }
 
 bool map2SF(std::vector<uint8_t>& rom, XSFFile* xsf)
@@ -251,7 +316,7 @@ bool map2SF(std::vector<uint8_t>& rom, XSFFile* xsf)
   return true;
 }
 
-bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
+bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, const String& dirpath, int level)
 {
   if (level <= 10 && xsf->GetTagExists("_lib"))
   {
@@ -259,7 +324,7 @@ bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
     if (!vs)
       return false;
     XSFFile libxsf(vs, 4, 8);
-    if (!recursiveLoad2SF(rom, &libxsf, level + 1))
+    if (!recursiveLoad2SF(rom, &libxsf, dirpath, level + 1))
       return false;
   }
 
@@ -276,7 +341,7 @@ bool recursiveLoad2SF(std::vector<uint8_t>& rom, XSFFile* xsf, int level)
       if (!vs)
         return false;
       XSFFile libxsf(vs, 4, 8);
-      if (!recursiveLoad2SF(rom, &libxsf, level + 1))
+      if (!recursiveLoad2SF(rom, &libxsf, dirpath, level + 1))
         return false;
     }
   }
@@ -293,7 +358,7 @@ void setInterp() {
   } else if (interp == "sharp") {
     interpMode = 3;
   }
-  CommonSettings.spuInterpolationMode = (SPUInterpolationMode)interpMode;
+  interp_mode = interpMode;
 }
 
 bool XSFPlugin::play(const char *filename, VFSFile &file)
@@ -303,18 +368,15 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
   int fade = aud_get_int(CFG_ID, "fade");
   int frameSkip = -1;
 	float pos = 0.0;
-	setInterp();
 
 	const char * slash = strrchr(filename, '/');
 	if (!slash)
 		return false;
 
-  while (execute && !check_stop()) {
-    std::cerr << "waiting for thread to finish..." << std::endl;
-    sleep(100);
-  }
+	String dirpath = String(str_copy(filename, slash + 1 - filename));
 
-	dirpath = String(str_copy(filename, slash + 1 - filename));
+  NDSInstance instance;
+  NDSInstanceBinding binding(instance);
 
 	Index<char> buf = file.read_all();
   try {
@@ -328,7 +390,7 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     length = xsf.GetLengthMS(115000) + fade;
 
     std::vector<uint8_t> rom;
-    if (!recursiveLoad2SF(rom, &xsf, 0) || !rom.size())
+    if (!recursiveLoad2SF(rom, &xsf, dirpath, 0) || !rom.size())
       return false;
 
     if (NDS_Init())
@@ -341,7 +403,7 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     int BUFFERSIZE = DESMUME_SAMPLE_RATE / 59.837; //truncates to 737, the traditional value, for 44100
     SPU_ChangeSoundCore(SNDIFID_2SF, BUFFERSIZE);
 
-    execute = false;
+    NDS_execute = false;
 
     MMU_unsetRom();
     NDS_SetROM(rom.data(), rom.size());
@@ -357,46 +419,55 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
     set_stream_bitrate(DESMUME_SAMPLE_RATE*2*2*8);
     open_audio(FMT_S16_NE, DESMUME_SAMPLE_RATE, 2);
 
+    SnapshotList snapshots((int64_t)aud_get_int(CFG_ID, "snapshot_budget") << 20);
+
     ignore_length = aud_get_bool(CFG_ID, "ignore_length");
     while (!check_stop() && (pos < length || ignore_length))
     {
+      CommonSettings.spuInterpolationMode = (SPUInterpolationMode)interp_mode.load();
+
+      // the output ring is empty here, so the emulator state is all there is
+      snapshots.checkpoint(pos);
+
       int seek_value = check_seek();
 
       if (seek_value >= 0)
       {
-        if (seek_value < pos) {
-          xsf_reset(frameSkip);
-          pos = 0;
+        // use a snapshot if it is closer to the target than we are
+        float snap = snapshots.find(seek_value);
+        if (seek_value < pos || snap > pos) {
+          if (snap >= 0) {
+            pos = snapshots.restore(seek_value);
+          } else {
+            xsf_reset(frameSkip);
+            pos = 0;
+          }
         }
         while (pos < seek_value)
         {
-          while (buffer_rope.size()) {
-            pos += buffer_rope.front().size() * 1000 / DESMUME_SAMPLE_RATE / 4;
-            buffer_rope.pop_front();
-          }
+          unsigned frames = output_ring.readable();
+          pos += frames * 1000 / DESMUME_SAMPLE_RATE;
+          output_ring.consume(frames);
           NDS_exec<false>();
           SPU_Emulate_user();
         }
-        buffer_rope.clear();
+        output_ring.clear();
       }
 
-      while (!buffer_rope.size() && !check_stop()) {
+      while (!output_ring.readable() && !check_stop()) {
         NDS_exec<false>();
         SPU_Emulate_user();
       }
-      while (buffer_rope.size() && !check_stop()) {
-        auto& front = buffer_rope.front();
+      while (output_ring.readable() && !check_stop()) {
+        unsigned frames;
+        int16_t* sampleBuffer = output_ring.peek(frames);
         if (pos > length - fade && !ignore_length) {
           float fadeFactor = (length - pos) / (1.0 * fade);
-          int sampleCount = front.size() / 2;
-          int16_t* sampleBuffer = reinterpret_cast<int16_t*>(front.data());
-          for (int i = 0; i < sampleCount; i++) {
-            sampleBuffer[i] *= fadeFactor;
-          }
+          xsf_apply_fade(sampleBuffer, frames * 2, fadeFactor);
         }
-        write_audio(front.data(), front.size());
-        pos += front.size() * 1000 / DESMUME_SAMPLE_RATE / 4;
-        buffer_rope.pop_front();
+        write_audio(sampleBuffer, frames * 4);
+        pos += frames * 1000 / DESMUME_SAMPLE_RATE;
+        output_ring.consume(frames);
       }
     }
   } catch (std::exception& e) {
@@ -406,8 +477,7 @@ bool XSFPlugin::play(const char *filename, VFSFile &file)
 
   MMU_unsetRom();
   NDS_DeInit();
-	dirpath = String();
-  execute = false;
+  NDS_execute = false;
 	return !error;
 }
 
@@ -444,7 +514,8 @@ const PreferencesWidget XSFPlugin::widgets[] = {
   WidgetCheck(N_("Ignore length from file"), WidgetBool(CFG_ID, "ignore_length", [] { ignore_length = aud_get_bool(CFG_ID, "ignore_length"); } )),
   WidgetSpin(N_("Default fade time:"), WidgetInt(CFG_ID, "fade"), { 0, 15000, 100, N_("ms") }),
   WidgetCombo(N_("Sample rate:"), WidgetInt(CFG_ID, "sample_rate"), {{ sampleRateItems }}),
-  WidgetCombo(N_("Interpolation mode:"), WidgetString(CFG_ID, "interpolation_mode", setInterp), {{ interpItems }})
+  WidgetCombo(N_("Interpolation mode:"), WidgetString(CFG_ID, "interpolation_mode", setInterp), {{ interpItems }}),
+  WidgetSpin(N_("Memory for seek snapshots:"), WidgetInt(CFG_ID, "snapshot_budget"), { 0, 1024, 16, N_("MiB") })
 };
 
 const PluginPreferences XSFPlugin::prefs = {{widgets}};
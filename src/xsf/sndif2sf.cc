@@ -30,33 +30,75 @@
 
 #include "sndif2sf.h"
 #include "desmume/NDSSystem.h"
-#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
-std::list<std::vector<std::uint8_t>> buffer_rope;
+#ifndef XSF_NO_SIMD
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define XSF_SSE2 1
+    #include <emmintrin.h>
+  #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define XSF_NEON 1
+    #include <arm_neon.h>
+  #endif
+#endif
 
-static struct
+void FrameRing::write(const int16_t *frames, unsigned count)
 {
-  std::vector<uint8_t> buf;
-  unsigned filled, used;
-  uint32_t bufferbytes, cycles;
-  int xfs_load, sync_type;
-} sndifwork = {std::vector<uint8_t>(), 0, 0, 0, 0, 0, 0};
+  unsigned write = m_write.load(std::memory_order_relaxed);
+  count = std::min(count, writable());
+
+  while (count) {
+    unsigned pos = write & (CAPACITY - 1);
+    unsigned chunk = std::min(count, CAPACITY - pos);
+    memcpy(&m_data[pos * 2], frames, chunk * 2 * sizeof(int16_t));
+    frames += chunk * 2;
+    write += chunk;
+    count -= chunk;
+  }
+
+  m_write.store(write, std::memory_order_release);
+}
+
+int16_t *FrameRing::peek(unsigned &count)
+{
+  unsigned pos = m_read.load(std::memory_order_relaxed) & (CAPACITY - 1);
+  count = std::min(readable(), CAPACITY - pos);
+  return &m_data[pos * 2];
+}
+
+// each sample becomes (sample * gain) >> 15, eight at a time where possible
+void xsf_apply_fade(int16_t *samples, unsigned count, float factor)
+{
+  int16_t gain = std::max(0L, std::min(32767L, std::lround(factor * 32768)));
+  unsigned i = 0;
+
+#if XSF_SSE2
+  __m128i gains = _mm_set1_epi32(gain);
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+    __m128i lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(x, _mm_setzero_si128()), gains), 15);
+    __m128i hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(x, _mm_setzero_si128()), gains), 15);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i), _mm_packs_epi32(lo, hi));
+  }
+#elif XSF_NEON
+  for (; i + 8 <= count; i += 8)
+    vst1q_s16(samples + i, vqdmulhq_n_s16(vld1q_s16(samples + i), gain));
+#endif
+
+  for (; i < count; i++)
+    samples[i] = (samples[i] * gain) >> 15;
+}
 
 static void SNDIFDeInit() {
-  int buffersize = sndifwork.buf.size();
-  sndifwork.buf.resize(0);
-  sndifwork.buf.resize(buffersize);
-  buffer_rope.clear();
+  output_ring.clear();
 }
 
 static int SNDIFInit(int buffersize)
 {
-  uint32_t bufferbytes = buffersize * sizeof(int16_t);
   SNDIFDeInit();
-  sndifwork.buf.resize(bufferbytes + 3);
-  sndifwork.bufferbytes = bufferbytes;
-  sndifwork.filled = sndifwork.used = 0;
-  sndifwork.cycles = 0;
+  nds_instance->sndif_buffer_bytes = buffersize * sizeof(int16_t);
   return 0;
 }
 
@@ -66,21 +108,13 @@ static void SNDIFSetVolume(int) { }
 
 static uint32_t SNDIFGetAudioSpace()
 {
-  return sndifwork.bufferbytes >> 2; // bytes to samples
+  return std::min(nds_instance->sndif_buffer_bytes >> 2, output_ring.writable()); // bytes to samples
 }
 
 static void SNDIFUpdateAudio(int16_t *buffer, uint32_t num_samples)
 {
-  num_samples <<= 1; // stereo
-  uint32_t num_bytes = num_samples << 1;
-  if (num_bytes > sndifwork.bufferbytes) {
-    num_bytes = sndifwork.bufferbytes;
-    num_samples = num_bytes >> 1;
-  }
-  memcpy(&sndifwork.buf[0], buffer, num_bytes);
-  buffer_rope.push_back(std::vector<uint8_t>(reinterpret_cast<uint8_t*>(buffer), reinterpret_cast<uint8_t*>(buffer) + num_bytes));
-  sndifwork.filled = num_bytes;
-  sndifwork.used = 0;
+  num_samples = std::min(num_samples, nds_instance->sndif_buffer_bytes >> 2);
+  output_ring.write(buffer, num_samples);
 }
 
 const int SNDIFID_2SF = 1;
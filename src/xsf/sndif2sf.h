@@ -30,10 +30,37 @@
 #pragma once
 
 #include "desmume/SPU.h"
-#include <list>
-#include <vector>
+#include <atomic>
 #include <cstdint>
 
+// Fixed-size ring of stereo frames between the SPU output (producer) and the
+// plugin's playback loop (consumer).  Indices only ever grow, so a full ring
+// and an empty one can be told apart without wasting a slot.
+class FrameRing
+{
+public:
+  static constexpr unsigned CAPACITY = 8192; // frames, must be a power of two
+
+  void clear() { m_read.store(m_write.load()); }
+
+  unsigned readable() const { return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_relaxed); }
+  unsigned writable() const { return CAPACITY - (m_write.load(std::memory_order_relaxed) - m_read.load(std::memory_order_acquire)); }
+
+  // producer: frames beyond writable() are dropped
+  void write(const int16_t *frames, unsigned count);
+
+  // consumer: returns the oldest frames that lie contiguously in the ring
+  int16_t *peek(unsigned &count);
+  void consume(unsigned count) { m_read.store(m_read.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+private:
+  int16_t m_data[CAPACITY * 2];
+  std::atomic<unsigned> m_write{0}, m_read{0};
+};
+
+// scales interleaved samples by factor (0 to 1)
+void xsf_apply_fade(int16_t *samples, unsigned count, float factor);
+
 extern const int SNDIFID_2SF;
 extern SoundInterface_struct SNDIF_2SF;
-extern std::list<std::vector<std::uint8_t>> buffer_rope;
+#define output_ring (*nds_instance->sndif_ring)